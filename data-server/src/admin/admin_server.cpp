@@ -1,5 +1,6 @@
 #include "admin_server.h"
 
+#include "common/ds_config.h"
 #include "net/session.h"
 #include "frame/sf_logger.h"
 #include "server/range_server.h"
@@ -33,10 +34,25 @@ Status AdminServer::Start(uint16_t port) {
 
     FLOG_INFO("[Admin] server listen on 0.0.0.0:%u", port);
 
+    auto http_port = static_cast<uint16_t>(ds_config.metric_config.http_port);
+    if (http_port > 0) {
+        http_server_.reset(new net::HttpServer());
+        ret = http_server_->ListenAndServe("0.0.0.0", http_port,
+                [this](const net::HttpRequest& req, net::HttpResponse* resp) {
+                    serveHttp(req, resp);
+                });
+        if (!ret.ok()) return ret;
+
+        FLOG_INFO("[Admin] metrics http server listen on 0.0.0.0:%u", http_port);
+    }
+
     return Status::OK();
 }
 
 Status AdminServer::Stop() {
+    if (http_server_) {
+        http_server_->Stop();
+    }
     return Status::OK();
 }
 
@@ -3,6 +3,7 @@ _Pragma("once");
 #include "server/context_server.h"
 #include "proto/gen/ds_admin.pb.h"
 #include "net/server.h"
+#include "net/http_server.h"
 
 namespace sharkstore {
 namespace dataserver {
@@ -34,9 +35,13 @@ private:
     Status getPending(const ds_adminpb::GetPendingsRequest& req, ds_adminpb::GetPendingsResponse* resp);
     Status flushDB(const ds_adminpb::FlushDBRequest& req, ds_adminpb::FlushDBResponse* resp);
 
+    // http接口，目前只有/metrics
+    void serveHttp(const net::HttpRequest& req, net::HttpResponse* resp);
+
 private:
     server::ContextServer* context_ = nullptr;
     std::unique_ptr<net::Server> net_server_;
+    std::unique_ptr<net::HttpServer> http_server_;
     // TODO: worker thread
 };
 
@@ -93,6 +93,11 @@ static const ConfigGeterMap cfg_getters = {
         // metric
         ADD_CFG_GETTER(metric, interval),
 
+        // trace
+        ADD_CFG_GETTER(trace, sample_interval),
+        ADD_CFG_GETTER(trace, slow_threshold_ms),
+        ADD_CFG_GETTER(trace, slow_log_size),
+
         // worker
         ADD_CFG_GETTER_STR(worker, ip_addr),
         ADD_CFG_GETTER(worker, port),
@@ -5,9 +5,13 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
+#include "common/object_pool.h"
+#include "frame/sf_socket_buff.h"
+#include "proto/gen/funcpb.pb.h"
 #include "server/version.h"
 #include "server/range_server.h"
 #include "server/run_status.h"
+#include "server/thread_placement.h"
 #include "server/worker.h"
 
 namespace sharkstore {
@@ -56,6 +60,100 @@ static Status getServerInfo(ContextServer* ctx, const vector<string>& path, Json
     return Status::OK();
 }
 
+static Status getPoolInfo(ContextServer* ctx, const vector<string>& path, JsonWriter& writer) {
+    writer.Key("pools");
+    writer.StartArray();
+    for (const auto& stats : common::ObjectPool::AllStats()) {
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(stats.name.c_str());
+        writer.Key("object_size");
+        writer.Uint64(stats.object_size);
+        writer.Key("alloc_count");
+        writer.Uint64(stats.alloc_count);
+        writer.Key("free_count");
+        writer.Uint64(stats.free_count);
+        writer.Key("in_use");
+        writer.Uint64(stats.in_use);
+        writer.Key("capacity");
+        writer.Uint64(stats.create_count);
+        writer.Key("shared_free");
+        writer.Uint64(stats.shared_free);
+        writer.EndObject();
+    }
+
+    // frame层的应答结构体
+    int64_t alloc_count = 0;
+    int used_count = 0, total_count = 0;
+    response_buff_stat(&alloc_count, &used_count, &total_count);
+    writer.StartObject();
+    writer.Key("name");
+    writer.String("response_buff");
+    writer.Key("object_size");
+    writer.Uint64(sizeof(response_buff_t));
+    writer.Key("alloc_count");
+    writer.Int64(alloc_count);
+    writer.Key("in_use");
+    writer.Int(used_count);
+    writer.Key("capacity");
+    writer.Int(total_count);
+    writer.EndObject();
+    writer.EndArray();
+    return Status::OK();
+}
+
+// 按功能号、处理阶段的耗时统计(微秒)，可以跟功能号名称只返回该功能号，如latency.kFuncSelect
+static Status getLatencyInfo(ContextServer* ctx, const vector<string>& path, JsonWriter& writer) {
+    const auto& statistics = ctx->run_status->GetStatistics();
+    auto func_ids = statistics.FuncIDs();
+    if (path.size() > 1) {
+        funcpb::FunctionID func_id;
+        if (!funcpb::FunctionID_Parse(path[1], &func_id)) {
+            return Status(Status::kInvalidArgument, "function id", path[1]);
+        }
+        func_ids = {static_cast<int>(func_id)};
+    }
+
+    writer.Key("funcs");
+    writer.StartArray();
+    for (auto func_id : func_ids) {
+        writer.StartObject();
+        writer.Key("func");
+        writer.String(funcpb::FunctionID_Name(static_cast<funcpb::FunctionID>(func_id)).c_str());
+        writer.Key("func_id");
+        writer.Int(func_id);
+        writer.Key("stages");
+        writer.StartArray();
+        for (uint32_t i = 0; i < monitor::kHistogramTypeNum; ++i) {
+            auto type = static_cast<monitor::HistogramType>(i);
+            monitor::HistogramData data;
+            if (!statistics.GetFuncData(func_id, type, &data) || data.count == 0) {
+                continue;
+            }
+            writer.StartObject();
+            writer.Key("stage");
+            writer.String(monitor::HistogramTypeName(type));
+            writer.Key("count");
+            writer.Uint64(data.count);
+            writer.Key("p50");
+            writer.Double(data.median);
+            writer.Key("p95");
+            writer.Double(data.percentile95);
+            writer.Key("p99");
+            writer.Double(data.percentile99);
+            writer.Key("max");
+            writer.Double(data.max);
+            writer.Key("avg");
+            writer.Double(data.average);
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+    }
+    writer.EndArray();
+    return Status::OK();
+}
+
 static Status getRangeInfo(ContextServer* ctx, const vector<string>& path, JsonWriter& writer) {
     assert(!path.empty());
     auto rs = ctx->range_server;
@@ -110,6 +208,8 @@ static Status getRangeInfo(ContextServer* ctx, const vector<string>& path, JsonW
     }
     writer.Key("submit_queue");
     writer.Uint64(rng->GetSubmitQueueSize());
+    writer.Key("watch_notify_backlog");
+    writer.Uint64(rng->GetNotifyBacklog());
 
     // table info
     writer.Key("table_id");
@@ -142,6 +242,10 @@ static Status getRaftInfo(ContextServer* ctx, const vector<string>& path, JsonWr
         writer.Uint64(ss.total_snap_applying);
         writer.Key("snap_send");
         writer.Uint64(ss.total_snap_sending);
+        writer.Key("outbound_bytes");
+        writer.Uint64(ss.outbound_bytes);
+        writer.Key("outbound_rafts");
+        writer.Uint64(ss.outbound_rafts);
         return Status::OK();
     }
 
@@ -199,18 +303,204 @@ static Status getRaftInfo(ContextServer* ctx, const vector<string>& path, JsonWr
     return Status::OK();
 }
 
+static Status getWatchInfo(ContextServer* ctx, const vector<string>& path, JsonWriter& writer) {
+    auto coalescer = ctx->range_server->watch_server_->Coalescer();
+    writer.Key("coalesce_window_ms");
+    writer.Int(coalescer == nullptr ? 0 : coalescer->WindowMs());
+    if (coalescer != nullptr) {
+        watch::CoalesceStats stats;
+        coalescer->GetStats(&stats);
+        writer.Key("coalesced_frames");
+        writer.Uint64(stats.frames);
+        writer.Key("coalesced_batches");
+        writer.Uint64(stats.batches);
+        writer.Key("squashed_events");
+        writer.Uint64(stats.squashed);
+    }
+
+    auto notifier = ctx->range_server->watch_server_->Notifier();
+    writer.Key("async_notify");
+    writer.Bool(notifier != nullptr);
+    if (notifier == nullptr) {
+        return Status::OK();
+    }
+
+    watch::NotifyStats stats;
+    notifier->GetStats(&stats);
+    writer.Key("notify_threads");
+    writer.Int(notifier->ThreadNum());
+    writer.Key("published");
+    writer.Uint64(stats.published);
+    writer.Key("notified");
+    writer.Uint64(stats.notified);
+    writer.Key("overflowed");
+    writer.Uint64(stats.overflowed);
+    writer.Key("reloads");
+    writer.Uint64(stats.reloads);
+    writer.Key("backlog");
+    writer.Uint64(stats.backlog);
+    writer.Key("max_backlog");
+    writer.Uint64(stats.max_backlog);
+    writer.Key("queued_tasks");
+    writer.Uint64(stats.queued_tasks);
+    writer.Key("avg_delay_us");
+    writer.Uint64(stats.avg_delay_us);
+    writer.Key("max_delay_us");
+    writer.Uint64(stats.max_delay_us);
+    return Status::OK();
+}
+
+static void writeTrace(const monitor::Trace& trace, JsonWriter& writer) {
+    writer.StartObject();
+    writer.Key("trace_id");
+    writer.Uint64(trace.trace_id);
+    writer.Key("range_id");
+    writer.Uint64(trace.range_id);
+    if (trace.func_id >= 0) {
+        writer.Key("func");
+        writer.String(funcpb::FunctionID_Name(static_cast<funcpb::FunctionID>(trace.func_id)).c_str());
+    }
+    writer.Key("role");
+    writer.String(trace.origin ? "leader" : "follower");
+    writer.Key("begin");
+    writer.Int64(trace.begin);
+    writer.Key("duration_us");
+    writer.Int64(trace.end > 0 ? trace.Duration() : -1);
+    // 各阶段相对于开始的时间(微秒)
+    writer.Key("spans");
+    writer.StartArray();
+    for (const auto& span : trace.spans) {
+        writer.StartObject();
+        writer.Key("stage");
+        writer.String(span.stage);
+        if (span.node != 0) {
+            writer.Key("node");
+            writer.Uint64(span.node);
+        }
+        writer.Key("offset_us");
+        writer.Int64(span.time - trace.begin);
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+}
+
+// 采样的请求追踪，trace.<trace_id>返回指定的追踪，否则返回慢请求
+static Status getTraceInfo(ContextServer* ctx, const vector<string>& path, JsonWriter& writer) {
+    auto tracer = ctx->run_status->GetTracer();
+    if (path.size() > 1) {
+        uint64_t trace_id = 0;
+        try {
+            trace_id = std::stoull(path[1]);
+        } catch (std::exception& e) {
+            return Status(Status::kInvalidArgument, "trace id", path[1]);
+        }
+        monitor::Trace trace;
+        if (!tracer->GetTrace(trace_id, &trace)) {
+            return Status(Status::kNotFound, "trace", path[1]);
+        }
+        writer.Key("trace");
+        writeTrace(trace, writer);
+        return Status::OK();
+    }
+
+    monitor::TracerStats stats;
+    tracer->GetStats(&stats);
+    writer.Key("sample_interval");
+    writer.Uint64(tracer->SampleInterval());
+    writer.Key("slow_threshold_us");
+    writer.Int64(tracer->SlowThreshold());
+    writer.Key("sampled");
+    writer.Uint64(stats.sampled);
+    writer.Key("finished");
+    writer.Uint64(stats.finished);
+    writer.Key("slow");
+    writer.Uint64(stats.slow);
+    writer.Key("dropped");
+    writer.Uint64(stats.dropped);
+    writer.Key("active");
+    writer.Uint64(stats.active);
+
+    writer.Key("traces");
+    writer.StartArray();
+    for (const auto& trace : tracer->GetSlowTraces()) {
+        writeTrace(trace, writer);
+    }
+    writer.EndArray();
+    return Status::OK();
+}
+
 static Status getRocksdbInfo(ContextServer* ctx, const vector<string>& path, JsonWriter& writer) {
     writer.Key("version");
     writer.String(server::GetRocksdbVersion().c_str());
     return Status::OK();
 }
 
+static Status getThreadInfo(ContextServer* ctx, const vector<string>& path, JsonWriter& writer) {
+    using server::ThreadPlacement;
+
+    writer.Key("numa_nodes");
+    writer.StartArray();
+    for (const auto& node : ThreadPlacement::NumaTopology()) {
+        writer.StartObject();
+        writer.Key("node");
+        writer.Int(node.first);
+        writer.Key("cpus");
+        writer.String(server::FormatCpuList(node.second).c_str());
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    writer.Key("pools");
+    writer.StartArray();
+    for (const auto& pool : ThreadPlacement::Instance().GetPools()) {
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(pool.name.c_str());
+        writer.Key("config");
+        writer.String(pool.placement.config.c_str());
+        writer.Key("cpus");
+        writer.String(server::FormatCpuList(pool.placement.cpus).c_str());
+        writer.Key("numa_nodes");
+        writer.String(server::FormatCpuList(pool.placement.nodes).c_str());
+        writer.Key("applied");
+        writer.Uint64(pool.applied);
+        if (!pool.error.empty()) {
+            writer.Key("error");
+            writer.String(pool.error.c_str());
+        }
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    // 线程实际的cpu亲和性
+    writer.Key("threads");
+    writer.StartArray();
+    for (const auto& group : ThreadPlacement::GetThreads()) {
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(group.name.c_str());
+        writer.Key("cpus");
+        writer.String(group.cpus.c_str());
+        writer.Key("count");
+        writer.Int(group.count);
+        writer.EndObject();
+    }
+    writer.EndArray();
+    return Status::OK();
+}
+
 static const GetInfoFunMap get_info_funcs = {
         {"", getServerInfo},
         {"server", getServerInfo},
+        {"latency", getLatencyInfo},
+        {"pool", getPoolInfo},
         {"raft", getRaftInfo},
         {"range", getRangeInfo},
         {"rocksdb", getRocksdbInfo},
+        {"threads", getThreadInfo},
+        {"trace", getTraceInfo},
+        {"watch", getWatchInfo},
 };
 
 Status AdminServer::getInfo(const ds_adminpb::GetInfoRequest& req, ds_adminpb::GetInfoResponse* resp) {
@@ -0,0 +1,375 @@
+#include "admin_server.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <algorithm>
+#include <initializer_list>
+
+#include "common/ds_config.h"
+#include "proto/gen/funcpb.pb.h"
+#include "raft/server.h"
+#include "server/range_server.h"
+#include "server/run_status.h"
+#include "server/version.h"
+#include "server/worker.h"
+#include "storage/metric.h"
+
+namespace sharkstore {
+namespace dataserver {
+namespace admin {
+
+using sharkstore::dataserver::server::ContextServer;
+
+namespace {
+
+using Labels = std::initializer_list<std::pair<const char*, std::string>>;
+
+// prometheus文本格式(0.0.4)，同一个指标的样本连续输出在HELP和TYPE之后
+class MetricsWriter {
+public:
+    explicit MetricsWriter(std::string* out) : out_(out) {}
+
+    void Family(const char* name, const char* type, const char* help) {
+        out_->append("# HELP ").append(name).append(" ").append(help).append("\n");
+        out_->append("# TYPE ").append(name).append(" ").append(type).append("\n");
+    }
+
+    void Sample(const std::string& name, const Labels& labels, uint64_t value) {
+        writeName(name, labels);
+        out_->append(std::to_string(value)).append("\n");
+    }
+
+    void Sample(const std::string& name, const Labels& labels, double value) {
+        writeName(name, labels);
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.17g", value);
+        out_->append(buf).append("\n");
+    }
+
+    // 只有一个样本、没有标签的指标
+    void Gauge(const char* name, const char* help, uint64_t value) {
+        Family(name, "gauge", help);
+        Sample(name, {}, value);
+    }
+
+    void Counter(const char* name, const char* help, uint64_t value) {
+        Family(name, "counter", help);
+        Sample(name, {}, value);
+    }
+
+private:
+    void writeName(const std::string& name, const Labels& labels) {
+        out_->append(name);
+        if (labels.size() > 0) {
+            out_->push_back('{');
+            bool first = true;
+            for (const auto& label : labels) {
+                if (!first) out_->push_back(',');
+                first = false;
+                out_->append(label.first).append("=\"");
+                appendEscaped(label.second);
+                out_->push_back('"');
+            }
+            out_->push_back('}');
+        }
+        out_->push_back(' ');
+    }
+
+    void appendEscaped(const std::string& value) {
+        for (auto c : value) {
+            switch (c) {
+                case '\\':
+                    out_->append("\\\\");
+                    break;
+                case '"':
+                    out_->append("\\\"");
+                    break;
+                case '\n':
+                    out_->append("\\n");
+                    break;
+                default:
+                    out_->push_back(c);
+            }
+        }
+    }
+
+private:
+    std::string* out_;
+};
+
+void writeServerMetrics(ContextServer* ctx, MetricsWriter& w) {
+    w.Family("sharkstore_ds_build_info", "gauge", "Build information of the data server.");
+    w.Sample("sharkstore_ds_build_info",
+             {{"version", server::GetGitDescribe()}, {"build_type", server::GetBuildType()}},
+             static_cast<uint64_t>(1));
+
+    w.Gauge("sharkstore_ds_ranges", "Number of ranges on this node.",
+            ctx->range_server->GetRangesSize());
+    w.Gauge("sharkstore_ds_leader_ranges", "Number of ranges led by this node.",
+            ctx->run_status->GetLeaderCount());
+    w.Gauge("sharkstore_ds_splitting_ranges", "Number of ranges being split.",
+            ctx->run_status->GetSplitCount());
+
+    w.Family("sharkstore_ds_worker_queue_size", "gauge", "Requests waiting in the worker queues.");
+    w.Sample("sharkstore_ds_worker_queue_size", {{"queue", "fast"}},
+             static_cast<uint64_t>(ctx->worker->FastQueueSize()));
+    w.Sample("sharkstore_ds_worker_queue_size", {{"queue", "slow"}},
+             static_cast<uint64_t>(ctx->worker->SlowQueueSize()));
+}
+
+// 按功能号和阶段的耗时，从启动开始累计
+// 导出的桶取直方图10us到10s之间的桶边界，每隔一个取一个，累计数是准确值
+const std::vector<size_t>& latencyBuckets() {
+    static const std::vector<size_t> buckets = [] {
+        std::vector<size_t> result;
+        for (size_t b = 0; monitor::HistogramStat::BucketLimit(b) <= 10000000; ++b) {
+            if (monitor::HistogramStat::BucketLimit(b) < 10) continue;
+            if (result.empty() || b == result.back() + 2) {
+                result.push_back(b);
+            }
+        }
+        return result;
+    }();
+    return buckets;
+}
+
+void writeLatencyMetrics(ContextServer* ctx, MetricsWriter& w) {
+    static const char* kName = "sharkstore_ds_request_latency_microseconds";
+    static const std::string kBucket = std::string(kName) + "_bucket";
+    static const std::string kSum = std::string(kName) + "_sum";
+    static const std::string kCount = std::string(kName) + "_count";
+
+    const auto& buckets = latencyBuckets();
+    const auto& statistics = ctx->run_status->GetStatistics();
+    w.Family(kName, "histogram", "Request latency by function and processing stage.");
+    for (auto func_id : statistics.FuncIDs()) {
+        auto func = funcpb::FunctionID_Name(static_cast<funcpb::FunctionID>(func_id));
+        if (func.empty()) func = std::to_string(func_id);
+        for (uint32_t i = 0; i < monitor::kHistogramTypeNum; ++i) {
+            auto type = static_cast<monitor::HistogramType>(i);
+            monitor::HistogramStat stat;
+            if (!statistics.GetFuncStat(func_id, type, &stat) || stat.Empty()) {
+                continue;
+            }
+            std::string stage = monitor::HistogramTypeName(type);
+            // 合并时记录还在进行，+Inf和_count用桶的总数，保证累计值单调
+            uint64_t cumulative = 0;
+            size_t next = 0;
+            for (auto b : buckets) {
+                for (; next <= b; ++next) {
+                    cumulative += stat.bucket_at(next);
+                }
+                w.Sample(kBucket,
+                         {{"func", func},
+                          {"stage", stage},
+                          {"le", std::to_string(monitor::HistogramStat::BucketLimit(b))}},
+                         cumulative);
+            }
+            for (; next < stat.num_buckets_; ++next) {
+                cumulative += stat.bucket_at(next);
+            }
+            w.Sample(kBucket, {{"func", func}, {"stage", stage}, {"le", "+Inf"}}, cumulative);
+            w.Sample(kSum, {{"func", func}, {"stage", stage}}, stat.sum());
+            w.Sample(kCount, {{"func", func}, {"stage", stage}}, cumulative);
+        }
+    }
+}
+
+// 读写的key数和字节数，速率由监控系统根据累计值计算
+void writeStorageMetrics(ContextServer* ctx, MetricsWriter& w) {
+    storage::MetricTotal total;
+    storage::Metric::GetTotalAll(&total);
+    w.Counter("sharkstore_ds_storage_keys_read_total", "Keys read from the storage.",
+              total.keys_read);
+    w.Counter("sharkstore_ds_storage_keys_written_total", "Keys written to the storage.",
+              total.keys_write);
+    w.Counter("sharkstore_ds_storage_bytes_read_total", "Bytes read from the storage.",
+              total.bytes_read);
+    w.Counter("sharkstore_ds_storage_bytes_written_total", "Bytes written to the storage.",
+              total.bytes_write);
+
+    auto ranges = ctx->range_server->GetRanges();
+    std::vector<std::pair<std::string, storage::MetricTotal>> range_totals;
+    range_totals.reserve(ranges.size());
+    for (const auto& rng : ranges) {
+        storage::MetricTotal t;
+        rng->GetMetricTotal(&t);
+        range_totals.emplace_back(std::to_string(rng->GetID()), t);
+    }
+
+    struct Field {
+        const char* name;
+        const char* help;
+        uint64_t storage::MetricTotal::*value;
+    };
+    static const Field kFields[] = {
+        {"sharkstore_ds_range_keys_read_total", "Keys read from the range.",
+         &storage::MetricTotal::keys_read},
+        {"sharkstore_ds_range_keys_written_total", "Keys written to the range.",
+         &storage::MetricTotal::keys_write},
+        {"sharkstore_ds_range_bytes_read_total", "Bytes read from the range.",
+         &storage::MetricTotal::bytes_read},
+        {"sharkstore_ds_range_bytes_written_total", "Bytes written to the range.",
+         &storage::MetricTotal::bytes_write},
+    };
+    for (const auto& field : kFields) {
+        w.Family(field.name, "counter", field.help);
+        for (const auto& rt : range_totals) {
+            w.Sample(field.name, {{"range_id", rt.first}}, rt.second.*field.value);
+        }
+    }
+}
+
+void writeRaftMetrics(ContextServer* ctx, MetricsWriter& w) {
+    raft::ServerStatus ss;
+    ctx->raft_server->GetStatus(&ss);
+    w.Gauge("sharkstore_ds_raft_groups", "Number of raft groups.", ss.total_rafts_count);
+    w.Gauge("sharkstore_ds_raft_consensus_queue_size",
+            "Tasks waiting in the raft consensus threads.", ss.consensus_queue_size);
+    w.Gauge("sharkstore_ds_raft_apply_queue_size", "Tasks waiting in the raft apply threads.",
+            ss.apply_queue_size);
+    w.Gauge("sharkstore_ds_raft_snapshots_sending", "Raft snapshots being sent.",
+            ss.total_snap_sending);
+    w.Gauge("sharkstore_ds_raft_snapshots_applying", "Raft snapshots being applied.",
+            ss.total_snap_applying);
+    w.Gauge("sharkstore_ds_raft_outbound_bytes", "Raft bytes replicating but not acked.",
+            ss.outbound_bytes);
+    w.Gauge("sharkstore_ds_raft_outbound_groups", "Raft groups with replicating data.",
+            ss.outbound_rafts);
+}
+
+void writeWatchMetrics(ContextServer* ctx, MetricsWriter& w) {
+    auto notifier = ctx->range_server->watch_server_->Notifier();
+    if (notifier == nullptr) {
+        return;
+    }
+
+    watch::NotifyStats stats;
+    notifier->GetStats(&stats);
+    w.Counter("sharkstore_ds_watch_events_published_total", "Watch events published to the notify logs.",
+              stats.published);
+    w.Counter("sharkstore_ds_watch_events_notified_total", "Watch events notified by the notify threads.",
+              stats.notified);
+    w.Gauge("sharkstore_ds_watch_notify_backlog", "Watch events waiting in the notify logs.",
+            stats.backlog);
+    w.Counter("sharkstore_ds_watch_events_overflowed_total",
+              "Watch events dropped because the notify log of the range was full.", stats.overflowed);
+    w.Counter("sharkstore_ds_watch_reloads_total",
+              "Watcher reloads from the db and the event buffer after a notify log overflow.",
+              stats.reloads);
+}
+
+void writeRocksdbMetrics(ContextServer* ctx, MetricsWriter& w) {
+    // 整数类型的rocksdb属性，指标名为sharkstore_ds_rocksdb_加属性名(-换成_)
+    static const char* kProperties[] = {
+        "estimate-num-keys",
+        "estimate-live-data-size",
+        "total-sst-files-size",
+        "cur-size-all-mem-tables",
+        "num-immutable-mem-table",
+        "estimate-table-readers-mem",
+        "estimate-pending-compaction-bytes",
+        "num-running-compactions",
+        "num-running-flushes",
+        "actual-delayed-write-rate",
+        "is-write-stopped",
+        "background-errors",
+    };
+
+    auto db = ctx->rocks_db;
+    for (auto prop : kProperties) {
+        uint64_t value = 0;
+        if (!db->GetIntProperty(std::string("rocksdb.") + prop, &value)) {
+            continue;
+        }
+        std::string name = std::string("sharkstore_ds_rocksdb_") + prop;
+        std::replace(name.begin(), name.end(), '-', '_');
+        auto help = std::string("RocksDB property rocksdb.") + prop + ".";
+        w.Family(name.c_str(), "gauge", help.c_str());
+        w.Sample(name, {}, value);
+    }
+
+    w.Family("sharkstore_ds_rocksdb_cache_usage_bytes", "gauge", "RocksDB cache usage.");
+    if (ctx->block_cache) {
+        w.Sample("sharkstore_ds_rocksdb_cache_usage_bytes", {{"cache", "block"}},
+                 static_cast<uint64_t>(ctx->block_cache->GetUsage()));
+        w.Sample("sharkstore_ds_rocksdb_cache_usage_bytes", {{"cache", "block_pinned"}},
+                 static_cast<uint64_t>(ctx->block_cache->GetPinnedUsage()));
+    }
+    if (ctx->row_cache) {
+        w.Sample("sharkstore_ds_rocksdb_cache_usage_bytes", {{"cache", "row"}},
+                 static_cast<uint64_t>(ctx->row_cache->GetUsage()));
+    }
+}
+
+void writeSystemMetrics(ContextServer* ctx, MetricsWriter& w) {
+    auto system_status = ctx->run_status->GetSystemStatus();
+
+    monitor::MemInfo mem;
+    memset(&mem, 0, sizeof(mem));
+    if (system_status->GetMemInfo(mem)) {
+        w.Family("sharkstore_ds_system_memory_bytes", "gauge", "Physical memory of the machine.");
+        w.Sample("sharkstore_ds_system_memory_bytes", {{"type", "total"}}, mem.Total);
+        w.Sample("sharkstore_ds_system_memory_bytes", {{"type", "free"}}, mem.Free);
+    }
+
+    monitor::LoadAvg load;
+    memset(&load, 0, sizeof(load));
+    if (system_status->GetLoadAvg(load)) {
+        w.Family("sharkstore_ds_system_load_average", "gauge", "System load average.");
+        w.Sample("sharkstore_ds_system_load_average", {{"period", "1m"}}, load.Load1);
+        w.Sample("sharkstore_ds_system_load_average", {{"period", "5m"}}, load.Load5);
+        w.Sample("sharkstore_ds_system_load_average", {{"period", "15m"}}, load.Load15);
+    }
+
+    server::FileSystemUsage fs;
+    if (ctx->run_status->GetFilesystemUsage(&fs)) {
+        w.Family("sharkstore_ds_filesystem_bytes", "gauge", "Usage of the data file system.");
+        w.Sample("sharkstore_ds_filesystem_bytes", {{"type", "total"}}, fs.total_size);
+        w.Sample("sharkstore_ds_filesystem_bytes", {{"type", "used"}}, fs.used_size);
+        w.Sample("sharkstore_ds_filesystem_bytes", {{"type", "free"}}, fs.free_size);
+    }
+
+    // 进程的cpu时间和常驻内存，使用prometheus客户端库的标准指标名
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        double cpu = static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+                     static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+        w.Family("process_cpu_seconds_total", "counter", "Total user and system CPU time.");
+        w.Sample("process_cpu_seconds_total", {}, cpu);
+    }
+    auto fp = fopen("/proc/self/statm", "r");
+    if (fp != nullptr) {
+        unsigned long size = 0, resident = 0;
+        if (fscanf(fp, "%lu %lu", &size, &resident) == 2) {
+            w.Gauge("process_resident_memory_bytes", "Resident memory size in bytes.",
+                    static_cast<uint64_t>(resident) * static_cast<uint64_t>(sysconf(_SC_PAGESIZE)));
+        }
+        fclose(fp);
+    }
+}
+
+}  // namespace
+
+void AdminServer::serveHttp(const net::HttpRequest& req, net::HttpResponse* resp) {
+    if (req.path != "/metrics") {
+        resp->status = 404;
+        return;
+    }
+
+    resp->content_type = "text/plain; version=0.0.4; charset=utf-8";
+    MetricsWriter writer(&resp->body);
+    writeServerMetrics(context_, writer);
+    writeLatencyMetrics(context_, writer);
+    writeStorageMetrics(context_, writer);
+    writeRaftMetrics(context_, writer);
+    writeWatchMetrics(context_, writer);
+    writeRocksdbMetrics(context_, writer);
+    writeSystemMetrics(context_, writer);
+}
+
+} // namespace admin
+} // namespace dataserver
+} // namespace sharkstore
@@ -3,6 +3,7 @@
 #include <fastcommon/shared_func.h>
 #include "frame/sf_logger.h"
 #include "common/ds_config.h"
+#include "server/run_status.h"
 
 namespace sharkstore {
 namespace dataserver {
@@ -34,6 +35,24 @@ static Status setLogLevel(server::ContextServer* ctx, const std::string& value)
         return Status::OK(); \
     }}
 
+#define SET_TRACE_OPTION(opt) \
+    {"trace."#opt, [](server::ContextServer *ctx, const std::string& value) { \
+        int new_value = 0; \
+        try { \
+            new_value = std::stoi(value); \
+        } catch (std::exception &e) { \
+            return Status(Status::kInvalidArgument, "trace "#opt, value); \
+        } \
+        if (new_value < 0) { \
+            return Status(Status::kInvalidArgument, "trace "#opt, value); \
+        } \
+        ds_config.trace_config.opt = new_value; \
+        ctx->run_status->GetTracer()->SetOptions(ds_config.trace_config.sample_interval, \
+                ds_config.trace_config.slow_threshold_ms * 1000, \
+                ds_config.trace_config.slow_log_size); \
+        return Status::OK(); \
+    }}
+
 #define SET_ROCKSDB_OPTIONS(opt) \
     {"rocksdb."#opt, [](server::ContextServer *ctx, const std::string& value) { \
         auto db = ctx->rocks_db; \
@@ -67,6 +86,11 @@ static const ConfigSetFuncMap cfg_set_funcs = {
         SET_RANGE_SIZE(split_size),
         SET_RANGE_SIZE(max_size),
 
+        // request trace
+        SET_TRACE_OPTION(sample_interval),
+        SET_TRACE_OPTION(slow_threshold_ms),
+        SET_TRACE_OPTION(slow_log_size),
+
         // rocksdb configs
         SET_ROCKSDB_OPTIONS(disable_auto_compactions),
         SET_ROCKSDB_OPTIONS(write_buffer_size),
@@ -331,12 +331,46 @@ static int load_raft_config(IniContext *ini_context) {
             ini_context, section, "transport_send_threads", 4, 1);
     ds_config.raft_config.transport_recv_threads = (size_t)load_integer_value_atleast(
             ini_context, section, "transport_recv_threads", 4, 1);
+    ds_config.raft_config.transport_batch_bytes = load_bytes_value_ne(
+            ini_context, section, "transport_batch_bytes", 0);
 
     ds_config.raft_config.tick_interval_ms = (size_t)load_integer_value_atleast(
            ini_context, section, "tick_interval", 500, 100);
 
     ds_config.raft_config.max_msg_size =
         load_bytes_value_ne(ini_context, section, "max_msg_size", 1024 * 1024);
+    ds_config.raft_config.min_msg_size =
+        load_bytes_value_ne(ini_context, section, "min_msg_size", 64 * 1024);
+    if (ds_config.raft_config.min_msg_size > ds_config.raft_config.max_msg_size) {
+        ds_config.raft_config.min_msg_size = ds_config.raft_config.max_msg_size;
+    }
+
+    ds_config.raft_config.max_inflight_bytes =
+        load_bytes_value_ne(ini_context, section, "max_inflight_bytes", 32 * 1024 * 1024);
+    ds_config.raft_config.max_outbound_bytes =
+        load_bytes_value_ne(ini_context, section, "max_outbound_bytes", 512 * 1024 * 1024);
+
+    ds_config.raft_config.thread_balance_interval = (size_t)load_integer_value_atleast(
+            ini_context, section, "thread_balance_interval", 0, 0);
+    ds_config.raft_config.thread_balance_threshold = (size_t)load_integer_value_atleast(
+            ini_context, section, "thread_balance_threshold", 10, 1);
+    if (ds_config.raft_config.thread_balance_threshold >= 100) {
+        ds_config.raft_config.thread_balance_threshold = 99;
+    }
+
+    ds_config.raft_config.compression = 0;
+    temp_str = iniGetStrValue(section, "compression", ini_context);
+    if (temp_str != NULL) {
+        if (strcmp(temp_str, "lz4") == 0) {
+            ds_config.raft_config.compression = 1;
+        } else if (strcmp(temp_str, "zstd") == 0) {
+            ds_config.raft_config.compression = 2;
+        } else if (strcmp(temp_str, "none") != 0) {
+            FLOG_WARN("unknown raft compression: %s, use none", temp_str);
+        }
+    }
+    ds_config.raft_config.compression_threshold =
+        load_bytes_value_ne(ini_context, section, "compression_threshold", 4 * 1024);
 
     return 0;
 }
@@ -354,8 +388,16 @@ void print_raft_config() {
               "\n\tapply_queue: %lu"
               "\n\tsend_threads: %lu"
               "\n\trecv_threads: %lu"
+              "\n\tbatch_bytes: %lu"
               "\n\ttick_interval_ms: %lu"
               "\n\tmax_msg_size: %lu"
+              "\n\tmin_msg_size: %lu"
+              "\n\tmax_inflight_bytes: %lu"
+              "\n\tmax_outbound_bytes: %lu"
+              "\n\tthread_balance_interval: %lu"
+              "\n\tthread_balance_threshold: %lu"
+              "\n\tcompression: %d"
+              "\n\tcompression_threshold: %lu"
               ,
               ds_config.raft_config.port,
               ds_config.raft_config.log_path,
@@ -368,8 +410,16 @@ void print_raft_config() {
               ds_config.raft_config.apply_queue,
               ds_config.raft_config.transport_send_threads,
               ds_config.raft_config.transport_recv_threads,
+              ds_config.raft_config.transport_batch_bytes,
               ds_config.raft_config.tick_interval_ms,
-              ds_config.raft_config.max_msg_size
+              ds_config.raft_config.max_msg_size,
+              ds_config.raft_config.min_msg_size,
+              ds_config.raft_config.max_inflight_bytes,
+              ds_config.raft_config.max_outbound_bytes,
+              ds_config.raft_config.thread_balance_interval,
+              ds_config.raft_config.thread_balance_threshold,
+              ds_config.raft_config.compression,
+              ds_config.raft_config.compression_threshold
     );
 }
 
@@ -381,6 +431,38 @@ static int load_metric_config(IniContext *ini_context) {
     if (ds_config.metric_config.interval <= 0) {
         ds_config.metric_config.interval = 10;
     }
+
+    ds_config.metric_config.http_port =
+        iniGetIntValue(section, "http_port", ini_context, 0);
+    if (ds_config.metric_config.http_port < 0 ||
+        ds_config.metric_config.http_port > 65535) {
+        fprintf(stderr, "[ds config] invalid metric http_port: %d\n",
+                ds_config.metric_config.http_port);
+        return -1;
+    }
+    return 0;
+}
+
+static int load_trace_config(IniContext *ini_context) {
+    char *section = "trace";
+
+    ds_config.trace_config.sample_interval =
+        iniGetIntValue(section, "sample_interval", ini_context, 0);
+    if (ds_config.trace_config.sample_interval < 0) {
+        ds_config.trace_config.sample_interval = 0;
+    }
+
+    ds_config.trace_config.slow_threshold_ms =
+        iniGetIntValue(section, "slow_threshold_ms", ini_context, 100);
+    if (ds_config.trace_config.slow_threshold_ms < 0) {
+        ds_config.trace_config.slow_threshold_ms = 100;
+    }
+
+    ds_config.trace_config.slow_log_size =
+        iniGetIntValue(section, "slow_log_size", ini_context, 1000);
+    if (ds_config.trace_config.slow_log_size < 0) {
+        ds_config.trace_config.slow_log_size = 1000;
+    }
     return 0;
 }
 
@@ -411,9 +493,53 @@ static int load_watch_config(IniContext *ini_context) {
         ds_config.watch_config.watcher_thread_priority = 0;
     }
 
+    ds_config.watch_config.notify_threads =
+            iniGetIntValue(section, "notify_threads", ini_context, 4);
+    if (ds_config.watch_config.notify_threads < 0) {
+        ds_config.watch_config.notify_threads = 0;
+    }
+
+    ds_config.watch_config.notify_queue_size =
+            iniGetIntValue(section, "notify_queue_size", ini_context, 10000);
+    if (ds_config.watch_config.notify_queue_size <= 0) {
+        ds_config.watch_config.notify_queue_size = 10000;
+    }
+
+    ds_config.watch_config.coalesce_window_ms =
+            iniGetIntValue(section, "coalesce_window_ms", ini_context, 0);
+    if (ds_config.watch_config.coalesce_window_ms < 0) {
+        ds_config.watch_config.coalesce_window_ms = 0;
+    }
+
+    ds_config.watch_config.coalesce_squash =
+            iniGetIntValue(section, "coalesce_squash", ini_context, 0);
+
     return 0;
 }
 
+static void load_affinity_item(IniContext *ini_context, const char *item, char *buf, size_t size) {
+    char *temp_str = iniGetStrValue("affinity", item, ini_context);
+    snprintf(buf, size, "%s", temp_str != NULL ? temp_str : "");
+}
+
+static int load_affinity_config(IniContext *ini_context) {
+#define LOAD_AFFINITY(item, field) \
+    load_affinity_item(ini_context, item, ds_config.affinity_config.field, \
+                       sizeof(ds_config.affinity_config.field))
+
+    LOAD_AFFINITY("default", default_cpus);
+    LOAD_AFFINITY("socket", socket);
+    LOAD_AFFINITY("fast_worker", fast_worker);
+    LOAD_AFFINITY("slow_worker", slow_worker);
+    LOAD_AFFINITY("raft_consensus", raft_consensus);
+    LOAD_AFFINITY("raft_apply", raft_apply);
+    LOAD_AFFINITY("raft_transport", raft_transport);
+    LOAD_AFFINITY("raft_tick", raft_tick);
+    LOAD_AFFINITY("rocksdb", rocksdb);
+
+#undef LOAD_AFFINITY
+    return 0;
+}
 
 static int load_heartbeat_config(IniContext *ini_context) {
     char *section = "heartbeat";
@@ -473,6 +599,55 @@ static int load_woker_num_config(IniContext *ini_context) {
         ds_config.slow_worker_num = 8;
     }
 
+    ds_config.net_config.backend = 0;
+    char *temp_str = iniGetStrValue(section, "net_backend", ini_context);
+    if (temp_str != NULL) {
+        if (strcmp(temp_str, "io_uring") == 0) {
+            ds_config.net_config.backend = 1;
+        } else if (strcmp(temp_str, "shard") == 0) {
+            ds_config.net_config.backend = 2;
+        } else if (strcmp(temp_str, "epoll") != 0) {
+            FLOG_WARN("unknown net backend: %s, use epoll", temp_str);
+        }
+    }
+
+    ds_config.net_config.ring_entries =
+        iniGetIntValue(section, "uring_entries", ini_context, 1024);
+    if (ds_config.net_config.ring_entries <= 0) {
+        ds_config.net_config.ring_entries = 1024;
+    }
+
+    // provided buffer ring的槽位数必须是2的幂
+    int count = iniGetIntValue(section, "uring_buff_count", ini_context, 256);
+    ds_config.net_config.buff_count = 1;
+    while (ds_config.net_config.buff_count < count && ds_config.net_config.buff_count < 32768) {
+        ds_config.net_config.buff_count <<= 1;
+    }
+
+    ds_config.net_config.buff_size =
+        (int)load_bytes_value_ne(ini_context, section, "uring_buff_size", 16 * 1024);
+    if (ds_config.net_config.buff_size < 4096) {
+        ds_config.net_config.buff_size = 4096;
+    }
+
+    ds_config.net_config.shard_threads =
+        iniGetIntValue(section, "shard_threads", ini_context, 0);
+    if (ds_config.net_config.shard_threads < 0) {
+        ds_config.net_config.shard_threads = 0;
+    }
+    ds_config.net_config.shard_pin_cores =
+        (bool)iniGetIntValue(section, "shard_pin_cores", ini_context, 1);
+    ds_config.net_config.shard_cpu_offset =
+        iniGetIntValue(section, "shard_cpu_offset", ini_context, 0);
+    if (ds_config.net_config.shard_cpu_offset < 0) {
+        ds_config.net_config.shard_cpu_offset = 0;
+    }
+    ds_config.net_config.stream_window =
+        iniGetIntValue(section, "stream_window", ini_context, 256);
+    if (ds_config.net_config.stream_window < 0) {
+        ds_config.net_config.stream_window = 256;
+    }
+
     return 0;
 }
 
@@ -515,10 +690,18 @@ int load_from_conf_file(IniContext *ini_context, const char *filename) {
         return -1;
     }
 
+    if (load_trace_config(ini_context) != 0) {
+        return -1;
+    }
+
     if(load_watch_config(ini_context) != 0) {
         return -1;
     }
 
+    if (load_affinity_config(ini_context) != 0) {
+        return -1;
+    }
+
     ds_config.task_timeout = iniGetIntValue(NULL, "task_timeout", ini_context, 3000);
     if (ds_config.task_timeout <= 0) {
         ds_config.task_timeout = 3000;
@@ -10,6 +10,17 @@ typedef struct ds_config_s {
 
     int task_timeout;  // defualt 3,000ms
 
+    struct {
+        int backend;       // 0: epoll(frame), 1: io_uring, 2: asio shard per core
+        int ring_entries;  // io_uring submission queue entries per thread
+        int buff_count;    // provided recv buffers per thread, power of 2
+        int buff_size;     // size of each provided recv buffer
+        int shard_threads; // shard mode io threads, 0: cpu count
+        bool shard_pin_cores;
+        int shard_cpu_offset;
+        int stream_window; // shard mode max requests in flight per ordered stream
+    } net_config;
+
     struct {
         char path[PATH_MAX];
         size_t block_cache_size; // default: 1024MB
@@ -77,21 +88,54 @@ typedef struct ds_config_s {
         size_t apply_queue;
         size_t transport_send_threads;
         size_t transport_recv_threads;
+        size_t transport_batch_bytes;
         size_t tick_interval_ms;
         size_t max_msg_size;
+        size_t min_msg_size;
+        size_t max_inflight_bytes;
+        size_t max_outbound_bytes;
+        size_t thread_balance_interval;
+        size_t thread_balance_threshold;
+        int compression; // 0 none, 1 lz4, 2 zstd, default=0
+        size_t compression_threshold;
     } raft_config;
 
     struct {
         int interval;
+        int http_port;  // http /metrics listen port, 0: disabled
     } metric_config;
 
+    struct {
+        int sample_interval;    // trace one of every N writes, 0: disabled
+        int slow_threshold_ms;  // keep traces that take at least this long
+        int slow_log_size;      // ring buffer size of the slow traces
+    } trace_config;
+
     struct {
         int buffer_map_size;
         int buffer_queue_size;
         int watcher_set_size;
         int watcher_thread_priority;
+        int notify_threads;     // 0: notify in raft apply thread
+        int notify_queue_size;  // per range pending events
+        int coalesce_window_ms; // 0: send every notification at once
+        int coalesce_squash;    // keep only the latest version of a key
     } watch_config;
 
+    // cpu sets of the thread pools, cpu list(0-7,16-23) or numa nodes(node:0),
+    // empty means not bound
+    struct {
+        char default_cpus[256];    // main thread and threads of no pool below
+        char socket[256];          // worker socket threads of any net backend
+        char fast_worker[256];
+        char slow_worker[256];
+        char raft_consensus[256];
+        char raft_apply[256];
+        char raft_transport[256];  // raft socket threads
+        char raft_tick[256];
+        char rocksdb[256];         // rocksdb background flush/compaction threads
+    } affinity_config;
+
     sf_socket_thread_config_t manager_config;  // manager thread config
     sf_socket_thread_config_t worker_config;   // worker thread config
 } ds_config_t;
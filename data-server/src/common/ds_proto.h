@@ -17,6 +17,11 @@ enum ds_proto_flags {
     FAST_WORKER_FLAG = 1 << 0,
 };
 
+// flags的其余位是请求所属的stream，0表示不要求顺序
+// 同一连接上同一stream的请求在同一个worker上执行，应答按请求顺序返回
+#define DS_PROTO_STREAM_SHIFT 1
+#define DS_PROTO_STREAM_ID(flags) (((uint8_t)(flags)) >> DS_PROTO_STREAM_SHIFT)
+
 typedef struct ds_proto_header_s {
     char magic_number[4];
     char version[2];
@@ -0,0 +1,235 @@
+#include "object_pool.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <set>
+
+namespace sharkstore {
+namespace dataserver {
+namespace common {
+
+static const int kMaxPools = 16;
+// 每个线程每个池最多缓存的空闲对象数
+static const size_t kThreadCacheSize = 256;
+// 线程缓存和共享链表之间每次转移的对象数
+static const size_t kBatchSize = 64;
+
+// 一个线程在某个池上的缓存，计数只由所属线程写，统计时其他线程读
+struct ObjectPool::LocalCache {
+    Node *head = nullptr;
+    size_t count = 0;
+    std::atomic<uint64_t> alloc_count = {0};
+    std::atomic<uint64_t> free_count = {0};
+};
+
+namespace {
+
+struct Registry {
+    std::mutex mu;
+    std::vector<ObjectPool *> pools;
+    std::set<void *> threads;  // 各线程的ThreadCaches
+};
+
+// 线程退出时还可能释放对象，不析构
+Registry &registry() {
+    static auto r = new Registry;
+    return *r;
+}
+
+// 本线程的ThreadCaches已经析构，之后析构的thread_local对象可能还会分配释放
+thread_local bool caches_destroyed = false;
+
+}  // namespace
+
+struct ObjectPool::ThreadCaches {
+    LocalCache caches[kMaxPools];
+
+    ThreadCaches() {
+        auto &r = registry();
+        std::lock_guard<std::mutex> lock(r.mu);
+        r.threads.insert(this);
+    }
+
+    ~ThreadCaches() {
+        caches_destroyed = true;
+        auto &r = registry();
+        std::lock_guard<std::mutex> lock(r.mu);
+        r.threads.erase(this);
+        for (size_t i = 0; i < r.pools.size(); ++i) {
+            r.pools[i]->retire(caches[i]);
+        }
+    }
+};
+
+ObjectPool::ThreadCaches *ObjectPool::local() {
+    if (caches_destroyed) return nullptr;
+    thread_local ThreadCaches caches;
+    return &caches;
+}
+
+ObjectPool *ObjectPool::Create(const std::string &name, size_t object_size) {
+    auto &r = registry();
+    std::lock_guard<std::mutex> lock(r.mu);
+    assert(r.pools.size() < static_cast<size_t>(kMaxPools));
+    auto pool = new ObjectPool(name, object_size, static_cast<int>(r.pools.size()));
+    r.pools.push_back(pool);
+    return pool;
+}
+
+ObjectPool::ObjectPool(const std::string &name, size_t object_size, int index)
+    : name_(name), object_size_(std::max(object_size, sizeof(Node))), index_(index) {}
+
+void *ObjectPool::Alloc() {
+    auto caches = local();
+    if (caches == nullptr) {
+        return allocShared();
+    }
+
+    auto &cache = caches->caches[index_];
+    cache.alloc_count.store(cache.alloc_count.load(std::memory_order_relaxed) + 1,
+                            std::memory_order_relaxed);
+
+    if (cache.head == nullptr) {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (!shared_.empty()) {
+            auto batch = shared_.back();
+            shared_.pop_back();
+            shared_count_ -= batch.count;
+            cache.head = batch.head;
+            cache.count = batch.count;
+        }
+    }
+    if (cache.head == nullptr) {
+        ++create_count_;
+        return ::operator new(object_size_);
+    }
+
+    auto node = cache.head;
+    cache.head = node->next;
+    --cache.count;
+    return node;
+}
+
+void ObjectPool::Free(void *p) {
+    if (p == nullptr) return;
+
+    auto caches = local();
+    if (caches == nullptr) {
+        freeShared(static_cast<Node *>(p));
+        return;
+    }
+
+    auto &cache = caches->caches[index_];
+    cache.free_count.store(cache.free_count.load(std::memory_order_relaxed) + 1,
+                           std::memory_order_relaxed);
+
+    auto node = static_cast<Node *>(p);
+    node->next = cache.head;
+    cache.head = node;
+    ++cache.count;
+
+    // 缓存过多，取出一批归还到共享链表
+    if (cache.count > kThreadCacheSize) {
+        auto head = cache.head;
+        auto tail = head;
+        for (size_t i = 1; i < kBatchSize; ++i) {
+            tail = tail->next;
+        }
+        cache.head = tail->next;
+        cache.count -= kBatchSize;
+        pushShared(head, tail, kBatchSize);
+    }
+}
+
+void ObjectPool::pushShared(Node *head, Node *tail, size_t count) {
+    tail->next = nullptr;
+    std::lock_guard<std::mutex> lock(mu_);
+    shared_.push_back(Batch{head, tail, count});
+    shared_count_ += count;
+}
+
+void *ObjectPool::allocShared() {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        ++retired_alloc_;
+        if (!shared_.empty()) {
+            auto &batch = shared_.back();
+            auto node = batch.head;
+            batch.head = node->next;
+            if (--batch.count == 0) {
+                shared_.pop_back();
+            }
+            --shared_count_;
+            return node;
+        }
+    }
+    ++create_count_;
+    return ::operator new(object_size_);
+}
+
+void ObjectPool::freeShared(Node *node) {
+    node->next = nullptr;
+    std::lock_guard<std::mutex> lock(mu_);
+    shared_.push_back(Batch{node, node, 1});
+    ++shared_count_;
+    ++retired_free_;
+}
+
+void ObjectPool::retire(LocalCache &cache) {
+    if (cache.head != nullptr) {
+        auto tail = cache.head;
+        while (tail->next != nullptr) {
+            tail = tail->next;
+        }
+        pushShared(cache.head, tail, cache.count);
+        cache.head = nullptr;
+        cache.count = 0;
+    }
+
+    std::lock_guard<std::mutex> lock(mu_);
+    retired_alloc_ += cache.alloc_count.load(std::memory_order_relaxed);
+    retired_free_ += cache.free_count.load(std::memory_order_relaxed);
+}
+
+ObjectPool::Stats ObjectPool::GetStats() const {
+    Stats stats;
+    stats.name = name_;
+    stats.object_size = object_size_;
+    stats.create_count = create_count_.load();
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        stats.alloc_count = retired_alloc_;
+        stats.free_count = retired_free_;
+        stats.shared_free = shared_count_;
+    }
+    {
+        auto &r = registry();
+        std::lock_guard<std::mutex> lock(r.mu);
+        for (auto t : r.threads) {
+            auto &cache = static_cast<ThreadCaches *>(t)->caches[index_];
+            stats.alloc_count += cache.alloc_count.load(std::memory_order_relaxed);
+            stats.free_count += cache.free_count.load(std::memory_order_relaxed);
+        }
+    }
+    // 各线程的计数不是同一时刻读到的，可能短暂出现释放多于分配
+    stats.in_use = stats.alloc_count > stats.free_count ? stats.alloc_count - stats.free_count : 0;
+    return stats;
+}
+
+std::vector<ObjectPool::Stats> ObjectPool::AllStats() {
+    std::vector<ObjectPool *> pools;
+    {
+        auto &r = registry();
+        std::lock_guard<std::mutex> lock(r.mu);
+        pools = r.pools;
+    }
+    std::vector<Stats> result;
+    for (auto pool : pools) {
+        result.push_back(pool->GetStats());
+    }
+    return result;
+}
+
+}  // namespace common
+}  // namespace dataserver
+}  // namespace sharkstore
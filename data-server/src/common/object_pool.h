@@ -0,0 +1,88 @@
+_Pragma("once");
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sharkstore {
+namespace dataserver {
+namespace common {
+
+// 固定大小对象的内存池，用于每个请求都要分配的控制对象(ProtoMessage等)
+// 每个线程缓存一个空闲链表，分配和释放都不加锁；
+// 对象常常在io线程分配、在worker线程释放，释放线程缓存超过上限时按批归还到共享链表，
+// 分配线程缓存为空时从共享链表取一批，只有批量转移时加锁
+// 池本身不会析构(线程退出时会把缓存归还到池中)，使用Create创建
+// 线程的缓存析构后(其他thread_local对象析构时)仍可分配释放，直接使用共享链表
+class ObjectPool {
+public:
+    struct Stats {
+        std::string name;
+        size_t object_size = 0;
+        uint64_t alloc_count = 0;   // 累计分配次数
+        uint64_t free_count = 0;    // 累计释放次数
+        uint64_t create_count = 0;  // 向系统申请的对象数，即池的容量
+        uint64_t in_use = 0;        // 正在使用的对象数
+        uint64_t shared_free = 0;   // 共享链表中的空闲对象数
+    };
+
+    static ObjectPool *Create(const std::string &name, size_t object_size);
+
+    void *Alloc();
+    void Free(void *p);
+
+    size_t ObjectSize() const { return object_size_; }
+    Stats GetStats() const;
+
+    // 所有池的统计
+    static std::vector<Stats> AllStats();
+
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool &operator=(const ObjectPool &) = delete;
+
+private:
+    struct Node {
+        Node *next;
+    };
+
+    struct LocalCache;
+    struct ThreadCaches;
+
+    ObjectPool(const std::string &name, size_t object_size, int index);
+
+    // 本线程的缓存已经析构时返回nullptr
+    static ThreadCaches *local();
+    void pushShared(Node *head, Node *tail, size_t count);
+    // 没有线程缓存时逐个对象使用共享链表
+    void *allocShared();
+    void freeShared(Node *node);
+    // 线程退出时归还缓存的对象，累加计数
+    void retire(LocalCache &cache);
+
+private:
+    const std::string name_;
+    const size_t object_size_;
+    const int index_;
+
+    std::atomic<uint64_t> create_count_ = {0};
+
+    mutable std::mutex mu_;
+    // 按批组织的空闲对象，每批是一条链表
+    struct Batch {
+        Node *head;
+        Node *tail;
+        size_t count;
+    };
+    std::vector<Batch> shared_;
+    uint64_t shared_count_ = 0;
+    // 已退出线程的计数(包括缓存析构后的分配释放)
+    uint64_t retired_alloc_ = 0;
+    uint64_t retired_free_ = 0;
+};
+
+}  // namespace common
+}  // namespace dataserver
+}  // namespace sharkstore
@@ -61,6 +61,14 @@ int SocketBase::Send(response_buff_t *response) {
 
     return 0;
 }
+int SocketBase::SendBatch(response_buff_t *response, int requests) {
+    // Send中会再扣减一个
+    if (requests != 1) {
+        __sync_fetch_and_sub(&thread_info_.socket_status->current_recv_pkg_count, requests - 1);
+    }
+    return Send(response);
+}
+
 sf_session_entry_t * SocketBase::lookup_session_entry(int64_t session_id) {
     char key[8];
     sf_session_entry_t *entry;
@@ -23,8 +23,11 @@ public:
     virtual void Stop();
 
     virtual int Send(response_buff_t *response);
+    // response中拼接了多个请求的应答帧，按请求数扣减待处理请求数
+    // 流式应答的后续帧不对应新的请求，requests可以为0
+    virtual int SendBatch(response_buff_t *response, int requests);
     virtual bool Closed(uint64_t session_id);
-    sf_session_entry_t* lookup_session_entry(int64_t session_id);
+    virtual sf_session_entry_t* lookup_session_entry(int64_t session_id);
 
 protected:
     sf_socket_thread_t thread_info_;
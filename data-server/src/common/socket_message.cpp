@@ -1,11 +1,36 @@
 #include "socket_message.h"
 
+#include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/wire_format_lite.h>
+
+#include "object_pool.h"
 
 namespace sharkstore {
 namespace dataserver {
 namespace common {
 
+static ObjectPool *protoMessagePool() {
+    static auto pool = ObjectPool::Create("proto_message", sizeof(ProtoMessage));
+    return pool;
+}
+
+void *ProtoMessage::operator new(size_t size) {
+    // 派生类大小不同，不使用池
+    if (size != sizeof(ProtoMessage)) {
+        return ::operator new(size);
+    }
+    return protoMessagePool()->Alloc();
+}
+
+void ProtoMessage::operator delete(void *p, size_t size) {
+    if (size != sizeof(ProtoMessage)) {
+        ::operator delete(p);
+    } else {
+        protoMessagePool()->Free(p);
+    }
+}
+
 ProtoMessage *GetProtoMessage(const void *data) {
     auto msg = new ProtoMessage;
 
@@ -15,8 +40,8 @@ ProtoMessage *GetProtoMessage(const void *data) {
 
     // 拷贝数据
     if (msg->header.body_len > 0) {
-        msg->body.resize(static_cast<size_t>(msg->header.body_len));
-        memcpy(msg->body.data(), (char *)data + header_size, msg->body.size());
+        auto body = (const char *)data + header_size;
+        msg->body.assign(body, body + msg->header.body_len);
     }
     return msg;
 }
@@ -31,6 +56,39 @@ bool GetMessage(const char *data, size_t size,
     }
 }
 
+bool PeekRangeId(const char *data, size_t size, uint64_t *range_id) {
+    using google::protobuf::internal::WireFormatLite;
+
+    google::protobuf::io::CodedInputStream input(reinterpret_cast<const uint8_t *>(data),
+                                                 static_cast<int>(size));
+    const auto header_tag = WireFormatLite::MakeTag(1, WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+    const auto range_tag = WireFormatLite::MakeTag(4, WireFormatLite::WIRETYPE_VARINT);
+    while (true) {
+        auto tag = input.ReadTag();
+        if (tag == 0) {
+            return false;
+        }
+        if (tag != header_tag) {
+            if (!WireFormatLite::SkipField(&input, tag)) return false;
+            continue;
+        }
+
+        uint32_t length = 0;
+        if (!input.ReadVarint32(&length)) return false;
+        input.PushLimit(static_cast<int>(length));
+        while ((tag = input.ReadTag()) != 0) {
+            if (tag == range_tag) {
+                google::protobuf::uint64 value = 0;
+                if (!input.ReadVarint64(&value)) return false;
+                *range_id = value;
+                return true;
+            }
+            if (!WireFormatLite::SkipField(&input, tag)) return false;
+        }
+        return false;
+    }
+}
+
 void SetResponseHeader(const kvrpcpb::RequestHeader &req,
                        kvrpcpb::ResponseHeader *resp,
                        errorpb::Error *err) {
@@ -1,5 +1,6 @@
 _Pragma("once");
 
+#include <memory>
 #include <vector>
 #include <google/protobuf/message.h>
 
@@ -18,10 +19,16 @@ struct ProtoMessage {
     int64_t session_id = 0;
     int64_t begin_time = 0;
     int64_t expire_time = 0;
+    // worker线程开始处理的时间，用于请求追踪
+    int64_t deal_time = 0;
     int64_t msg_id = 0;
     ds_header_t header;
     SocketBase *socket = nullptr;
     std::vector<char> body;
+    // 引用网络层收到的请求缓冲，不拷贝到body，body_ref持有缓冲的引用计数
+    std::shared_ptr<const void> body_ref;
+    const char *body_ptr = nullptr;
+    size_t body_len = 0;
 
     ProtoMessage(){};
     explicit ProtoMessage(int64_t expire): expire_time(getticks()+expire) {};
@@ -30,12 +37,38 @@ struct ProtoMessage {
         this->session_id = other.session_id;
         this->begin_time = other.begin_time;
         this->expire_time = other.expire_time;
+        this->deal_time = other.deal_time;
         this->msg_id = other.msg_id;
         this->header = other.header;
         this->socket = other.socket;
         this->body.assign(other.body.begin(), other.body.end());
+        this->body_ref = other.body_ref;
+        this->body_ptr = other.body_ptr;
+        this->body_len = other.body_len;
     }
 
+    // 请求内容，解析时使用，不关心来自body还是引用的缓冲
+    const char *BodyData() const { return body_ref ? body_ptr : body.data(); }
+    size_t BodySize() const { return body_ref ? body_len : body.size(); }
+
+    void SetBodyRef(std::shared_ptr<const void> ref, const char *data, size_t len) {
+        std::vector<char>().swap(body);
+        body_ref = std::move(ref);
+        body_ptr = data;
+        body_len = len;
+    }
+
+    // 释放请求内容，包括引用的缓冲
+    void ReleaseBody() {
+        std::vector<char>().swap(body);
+        body_ref.reset();
+        body_ptr = nullptr;
+        body_len = 0;
+    }
+
+    // 每个请求一个，从对象池分配
+    static void *operator new(size_t size);
+    static void operator delete(void *p, size_t size);
 };
 
 // 从报文数据中解析生成ProtoMessage
@@ -45,6 +78,10 @@ ProtoMessage *GetProtoMessage(const void *data);
 bool GetMessage(const char *data, size_t size,
         google::protobuf::Message *req, bool zero_copy = true);
 
+// 从请求数据中取出header.range_id，不完整解析请求
+// 所有数据面请求的RequestHeader都是第1个字段
+bool PeekRangeId(const char *data, size_t size, uint64_t *range_id);
+
 // 设置ResponseHeader字段
 void SetResponseHeader(const kvrpcpb::RequestHeader &req,
         kvrpcpb::ResponseHeader *resp,
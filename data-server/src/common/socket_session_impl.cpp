@@ -1,6 +1,8 @@
 #include "socket_session_impl.h"
 
 #include <assert.h>
+#include <string.h>
+#include <atomic>
 
 #include "frame/sf_logger.h"
 
@@ -10,13 +12,13 @@ namespace sharkstore {
 namespace dataserver {
 namespace common {
 
-void SocketSessionImpl::Send(ProtoMessage *msg, google::protobuf::Message *resp) {
-    // // 分配回应内存
-    size_t body_len = resp == nullptr ? 0 : resp->ByteSizeLong();
-    size_t data_len = header_size + body_len;
+static std::atomic<SocketSessionImpl::SerializeObserver> serialize_observer = {nullptr};
 
-    response_buff_t *response = new_response_buff(data_len);
+void SocketSessionImpl::SetSerializeObserver(SerializeObserver observer) {
+    serialize_observer = observer;
+}
 
+void SocketSessionImpl::encodeHeader(const ProtoMessage *msg, size_t body_len, char *buf) {
     // 填充应答头部
     ds_header_t header;
     header.magic_number = DS_PROTO_MAGIC_NUMBER;
@@ -26,27 +28,66 @@ void SocketSessionImpl::Send(ProtoMessage *msg, google::protobuf::Message *resp)
     header.msg_type = DS_PROTO_FID_RPC_RESP;
     header.func_id = msg->header.func_id;
     header.proto_type = msg->header.proto_type;
+    // 带回请求的stream，客户端按stream分发应答
+    header.flags = msg->header.flags;
+
+    ds_serialize_header(&header, (ds_proto_header_t *)buf);
+}
+
+response_buff_t *SocketSessionImpl::newResponse(ProtoMessage *msg, size_t body_len) {
+    // // 分配回应内存
+    size_t data_len = header_size + body_len;
 
-    ds_serialize_header(&header, (ds_proto_header_t *)(response->buff));
+    response_buff_t *response = new_response_buff(data_len);
+
+    encodeHeader(msg, body_len, response->buff);
 
     response->session_id  = msg->session_id;
-    response->msg_id      = header.msg_id;
+    response->msg_id      = msg->header.msg_id;
     response->begin_time  = msg->begin_time;
     response->expire_time = msg->expire_time;
     response->buff_len    = static_cast<int32_t>(data_len);
 
+    return response;
+}
+
+void SocketSessionImpl::Send(ProtoMessage *msg, google::protobuf::Message *resp) {
+    sendMessage(msg, resp, 1);
+}
+
+void SocketSessionImpl::Send(ProtoMessage *msg, const std::string &body, const std::string &tail) {
+    sendBody(msg, body, tail, 1);
+}
+
+void SocketSessionImpl::SendStream(ProtoMessage *msg, google::protobuf::Message *resp) {
+    sendMessage(msg, resp, 0);
+}
+
+void SocketSessionImpl::SendStream(ProtoMessage *msg, const std::string &body, const std::string &tail) {
+    sendBody(msg, body, tail, 0);
+}
+
+void SocketSessionImpl::sendMessage(ProtoMessage *msg, google::protobuf::Message *resp, int requests) {
+    size_t body_len = resp == nullptr ? 0 : resp->ByteSizeLong();
+    response_buff_t *response = newResponse(msg, body_len);
+
     do {
         if (resp != nullptr) {
+            auto btime = get_micro_second();
             char *data = response->buff + header_size;
             if (!resp->SerializeToArray(data, body_len)) {
-                FLOG_ERROR("serialize response failed, func_id: %d", header.func_id);
+                FLOG_ERROR("serialize response failed, func_id: %d", msg->header.func_id);
                 delete_response_buff(response);
                 break;
             }
+            auto observer = serialize_observer.load(std::memory_order_relaxed);
+            if (observer != nullptr) {
+                observer(msg->header.func_id, get_micro_second() - btime);
+            }
         }
 
         //处理完成，socket send
-        msg->socket->Send(response);
+        msg->socket->SendBatch(response, requests);
 
     } while (false);
 
@@ -54,6 +95,28 @@ void SocketSessionImpl::Send(ProtoMessage *msg, google::protobuf::Message *resp)
     delete resp;
 }
 
+void SocketSessionImpl::sendBody(ProtoMessage *msg, const std::string &body, const std::string &tail,
+                                 int requests) {
+    response_buff_t *response = newResponse(msg, body.size() + tail.size());
+
+    char *data = response->buff + header_size;
+    memcpy(data, body.data(), body.size());
+    memcpy(data + body.size(), tail.data(), tail.size());
+
+    msg->socket->SendBatch(response, requests);
+
+    delete msg;
+}
+
+void SocketSessionImpl::AppendResponse(const ProtoMessage *msg, const std::string &body,
+                                       const std::string &tail, std::string *buf) {
+    auto offset = buf->size();
+    buf->resize(offset + header_size);
+    encodeHeader(msg, body.size() + tail.size(), &(*buf)[offset]);
+    buf->append(body);
+    buf->append(tail);
+}
+
 }  // namespace common
 }  // namespace dataserver
 }  // namespace sharkstore
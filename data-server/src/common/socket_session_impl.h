@@ -17,6 +17,27 @@ public:
     SocketSessionImpl& operator=(const SocketSessionImpl&) = delete;
 
     void Send(ProtoMessage *msg, google::protobuf::Message* resp) override;
+    // 发送已经序列化好的应答，body和tail依次拼接作为应答内容
+    void Send(ProtoMessage *msg, const std::string& body, const std::string& tail);
+
+    // 流式应答：同一个请求的后续应答帧，不计入已处理的请求
+    void SendStream(ProtoMessage *msg, google::protobuf::Message* resp);
+    void SendStream(ProtoMessage *msg, const std::string& body, const std::string& tail);
+
+    // 把应答帧(头部+body+tail)追加到buf，用于同一session的多个应答合并发送
+    static void AppendResponse(const ProtoMessage *msg, const std::string& body,
+                               const std::string& tail, std::string* buf);
+
+    // 应答序列化耗时的统计回调，参数为请求的功能号和耗时(微秒)
+    typedef void (*SerializeObserver)(int func_id, int64_t take_time);
+    static void SetSerializeObserver(SerializeObserver observer);
+
+private:
+    static void encodeHeader(const ProtoMessage *msg, size_t body_len, char *buf);
+    static response_buff_t *newResponse(ProtoMessage *msg, size_t body_len);
+
+    static void sendMessage(ProtoMessage *msg, google::protobuf::Message* resp, int requests);
+    static void sendBody(ProtoMessage *msg, const std::string& body, const std::string& tail, int requests);
 };
 
 } //namespace common
@@ -0,0 +1,886 @@
+#include "socket_uring_server.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <liburing.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <fastcommon/shared_func.h>
+
+#include "base/util.h"
+#include "frame/sf_logger.h"
+
+#include "ds_config.h"
+#include "ds_proto.h"
+
+namespace sharkstore {
+namespace dataserver {
+namespace common {
+
+namespace {
+
+// sqe的user_data：低3位是操作类型，其余位是连接指针
+enum OpType : uint64_t {
+    kOpAccept = 1,
+    kOpRecv = 2,
+    kOpSend = 3,
+    kOpWake = 4,
+    kOpTimer = 5,
+};
+const uint64_t kOpMask = 7;
+
+// session_id的低位记录连接所属的线程
+const int kLoopBits = 8;
+const int kMaxLoops = 1 << kLoopBits;
+
+// 一次sendmsg最多合并的应答数
+const int kMaxSendIovecs = 64;
+
+const int kBuffGroup = 0;
+
+// 检查连接超时的间隔(秒)
+const int kTimerInterval = 1;
+
+struct Conn {
+    int fd = -1;
+    int64_t session_id = 0;
+    char client_ip[INET_ADDRSTRLEN] = {0};
+
+    // 还没有凑齐一个完整请求的数据
+    std::string partial;
+
+    std::deque<response_buff_t *> pending;   // 等待发送
+    std::vector<response_buff_t *> sending;  // 已提交正在发送
+    size_t sent_offset = 0;                  // sending[0]已经发送的字节数
+    struct iovec iovs[kMaxSendIovecs];
+    struct msghdr msg;
+
+    time_t last_active = 0;  // 最近一次收到数据或发送完成的时间
+    time_t send_time = 0;    // 最近一次提交发送的时间，sending不为空时有效
+
+    int inflight = 0;  // 未完成的sqe数，为0时才能释放
+    bool closing = false;
+    bool dirty = false;  // 本轮有新的应答等待提交
+};
+
+uint64_t connData(Conn *conn, OpType op) { return reinterpret_cast<uint64_t>(conn) | op; }
+
+}  // namespace
+
+class UringLoop {
+public:
+    UringLoop(UringSocketServer *server, int index)
+        : context_(&server->thread_info_), index_(index) {}
+    ~UringLoop() { Stop(); }
+
+    UringLoop(const UringLoop &) = delete;
+    UringLoop &operator=(const UringLoop &) = delete;
+
+    int Start();
+    void Stop();
+
+    // 由worker线程调用，应答交给本线程发送
+    int Push(response_buff_t *response);
+    bool Closed(int64_t session_id);
+
+private:
+    int setup();
+    void teardown();
+    void run();
+
+    struct io_uring_sqe *getSqe();
+    void armAccept();
+    void armRecv(Conn *conn);
+    void armWake();
+    void armTimer();
+    void flushSends();
+    void submitSend(Conn *conn);
+
+    void onAccept(struct io_uring_cqe *cqe);
+    void onRecv(Conn *conn, struct io_uring_cqe *cqe);
+    void onSend(Conn *conn, struct io_uring_cqe *cqe);
+    void onWake(struct io_uring_cqe *cqe);
+    void onTimer(struct io_uring_cqe *cqe);
+
+    void onData(Conn *conn, const char *data, size_t len);
+    // 分发data中完整的请求，返回消耗的字节数，包格式错误返回-1
+    ssize_t dispatch(Conn *conn, const char *data, size_t len);
+
+    void newConn(int fd);
+    void closeConn(Conn *conn);
+    void releaseConn(Conn *conn);
+
+    void finishResponse(response_buff_t *response);
+    void dropResponse(response_buff_t *response);
+
+private:
+    sf_socket_thread_t *context_;
+    const int index_;
+
+    struct io_uring ring_;
+    bool ring_inited_ = false;
+    int listen_fd_ = -1;
+    int wake_fd_ = -1;
+    uint64_t wake_value_ = 0;
+    struct __kernel_timespec timer_ts_;
+
+    struct io_uring_buf_ring *buf_ring_ = nullptr;
+    char *buffs_ = nullptr;
+    int buff_count_ = 0;
+    int buff_size_ = 0;
+
+    std::atomic<bool> running_ = {false};
+    std::thread thread_;
+
+    // 以下只在本线程访问
+    time_t now_ = 0;  // 每轮等待返回后更新
+    int64_t session_seed_ = 0;
+    std::unordered_map<int64_t, Conn *> conns_;
+    std::vector<Conn *> dirty_conns_;
+    std::vector<response_buff_t *> draining_;
+
+    std::mutex queue_mu_;
+    std::vector<response_buff_t *> queue_;
+    bool wake_pending_ = false;
+
+    // 给其他线程判断连接是否已经关闭
+    std::mutex session_mu_;
+    std::unordered_set<int64_t> sessions_;
+};
+
+int UringLoop::Start() {
+    wake_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        FLOG_ERROR("io_uring loop %d create eventfd failed: %s", index_, strerror(errno));
+        return -1;
+    }
+
+    std::promise<int> ready;
+    auto result = ready.get_future();
+    running_ = true;
+    // ring在运行它的线程中创建，才能使用SINGLE_ISSUER
+    thread_ = std::thread([this, &ready] {
+        int ret = setup();
+        ready.set_value(ret);
+        if (ret == 0) {
+            run();
+        }
+        teardown();
+    });
+
+    char name[32] = {'\0'};
+    snprintf(name, 32, "%s_uring:%d", context_->socket_config->thread_name_prefix, index_);
+    AnnotateThread(thread_.native_handle(), name);
+
+    int ret = result.get();
+    if (ret != 0) {
+        running_ = false;
+        thread_.join();
+        close(wake_fd_);
+        wake_fd_ = -1;
+    }
+    return ret;
+}
+
+void UringLoop::Stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mu_);
+        running_ = false;
+    }
+    uint64_t value = 1;
+    if (write(wake_fd_, &value, sizeof(value)) < 0) {
+        FLOG_WARN("io_uring loop %d wakeup failed: %s", index_, strerror(errno));
+    }
+    thread_.join();
+
+    close(wake_fd_);
+    wake_fd_ = -1;
+}
+
+int UringLoop::Push(response_buff_t *response) {
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(queue_mu_);
+        if (!running_) {
+            return -1;
+        }
+        queue_.push_back(response);
+        // 本线程还没有取走之前的应答时不需要再唤醒
+        if (!wake_pending_) {
+            wake_pending_ = true;
+            wake = true;
+        }
+    }
+
+    if (wake) {
+        uint64_t value = 1;
+        if (write(wake_fd_, &value, sizeof(value)) < 0) {
+            FLOG_WARN("io_uring loop %d wakeup failed: %s", index_, strerror(errno));
+        }
+    }
+    return 0;
+}
+
+bool UringLoop::Closed(int64_t session_id) {
+    std::lock_guard<std::mutex> lock(session_mu_);
+    return sessions_.find(session_id) == sessions_.end();
+}
+
+int UringLoop::setup() {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+    int ret = io_uring_queue_init_params(ds_config.net_config.ring_entries, &ring_, &params);
+    if (ret == -EINVAL) {
+        // 6.1之前的内核不支持DEFER_TASKRUN
+        memset(&params, 0, sizeof(params));
+        ret = io_uring_queue_init_params(ds_config.net_config.ring_entries, &ring_, &params);
+    }
+    if (ret < 0) {
+        FLOG_ERROR("io_uring loop %d init ring failed: %s", index_, strerror(-ret));
+        return -1;
+    }
+    ring_inited_ = true;
+
+    buff_count_ = ds_config.net_config.buff_count;
+    buff_size_ = ds_config.net_config.buff_size;
+    buffs_ = static_cast<char *>(malloc(static_cast<size_t>(buff_count_) * buff_size_));
+    if (buffs_ == nullptr) {
+        FLOG_ERROR("io_uring loop %d alloc recv buffers failed", index_);
+        return -1;
+    }
+    buf_ring_ = io_uring_setup_buf_ring(&ring_, buff_count_, kBuffGroup, 0, &ret);
+    if (buf_ring_ == nullptr) {
+        FLOG_ERROR("io_uring loop %d setup buffer ring failed: %s", index_, strerror(-ret));
+        return -1;
+    }
+    auto mask = io_uring_buf_ring_mask(buff_count_);
+    for (int i = 0; i < buff_count_; ++i) {
+        io_uring_buf_ring_add(buf_ring_, buffs_ + static_cast<size_t>(i) * buff_size_, buff_size_,
+                              i, mask, i);
+    }
+    io_uring_buf_ring_advance(buf_ring_, buff_count_);
+
+    // 每个线程一个监听socket，由内核在线程间分配新连接
+    auto config = context_->socket_config;
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        FLOG_ERROR("io_uring loop %d create socket failed: %s", index_, strerror(errno));
+        return -1;
+    }
+    int on = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(config->port));
+    if (config->ip_addr[0] == '\0') {
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    } else if (inet_pton(AF_INET, config->ip_addr, &addr.sin_addr) != 1) {
+        FLOG_ERROR("io_uring loop %d invalid ip addr: %s", index_, config->ip_addr);
+        return -1;
+    }
+    if (bind(listen_fd_, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0 ||
+        listen(listen_fd_, SOMAXCONN) != 0) {
+        FLOG_ERROR("io_uring loop %d listen on %s:%d failed: %s", index_, config->ip_addr,
+                   config->port, strerror(errno));
+        return -1;
+    }
+
+    now_ = time(nullptr);
+    armAccept();
+    armWake();
+    armTimer();
+    return 0;
+}
+
+void UringLoop::teardown() {
+    auto status = context_->socket_status;
+    for (auto &it : conns_) {
+        auto conn = it.second;
+        if (!conn->closing) {
+            __sync_fetch_and_sub(&status->current_connections, 1);
+        }
+        close(conn->fd);
+        for (auto response : conn->sending) {
+            dropResponse(response);
+        }
+        for (auto response : conn->pending) {
+            dropResponse(response);
+        }
+        delete conn;
+    }
+    conns_.clear();
+    dirty_conns_.clear();
+    {
+        std::lock_guard<std::mutex> lock(session_mu_);
+        sessions_.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(queue_mu_);
+        for (auto response : queue_) {
+            dropResponse(response);
+        }
+        queue_.clear();
+    }
+
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        listen_fd_ = -1;
+    }
+    if (buf_ring_ != nullptr) {
+        io_uring_free_buf_ring(&ring_, buf_ring_, buff_count_, kBuffGroup);
+        buf_ring_ = nullptr;
+    }
+    if (ring_inited_) {
+        io_uring_queue_exit(&ring_);
+        ring_inited_ = false;
+    }
+    free(buffs_);
+    buffs_ = nullptr;
+}
+
+void UringLoop::run() {
+    auto status = context_->socket_status;
+    __sync_fetch_and_add(&status->actual_event_recv_threads, 1);
+
+    while (running_) {
+        // 上一轮产生的发送和重新投递的recv在这里一次提交
+        flushSends();
+        int ret = io_uring_submit_and_wait(&ring_, 1);
+        if (ret < 0 && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY) {
+            FLOG_ERROR("io_uring loop %d submit failed: %s", index_, strerror(-ret));
+            break;
+        }
+        now_ = time(nullptr);
+
+        unsigned head;
+        unsigned count = 0;
+        struct io_uring_cqe *cqe;
+        io_uring_for_each_cqe(&ring_, head, cqe) {
+            ++count;
+            auto data = io_uring_cqe_get_data64(cqe);
+            auto conn = reinterpret_cast<Conn *>(data & ~kOpMask);
+            switch (data & kOpMask) {
+                case kOpAccept:
+                    onAccept(cqe);
+                    break;
+                case kOpRecv:
+                    onRecv(conn, cqe);
+                    break;
+                case kOpSend:
+                    onSend(conn, cqe);
+                    break;
+                case kOpWake:
+                    onWake(cqe);
+                    break;
+                case kOpTimer:
+                    onTimer(cqe);
+                    break;
+                default:
+                    break;
+            }
+        }
+        io_uring_cq_advance(&ring_, count);
+    }
+
+    __sync_fetch_and_sub(&status->actual_event_recv_threads, 1);
+    FLOG_INFO("io_uring loop %d exit...", index_);
+}
+
+struct io_uring_sqe *UringLoop::getSqe() {
+    auto sqe = io_uring_get_sqe(&ring_);
+    while (sqe == nullptr) {
+        // 提交队列满，先提交已有的
+        io_uring_submit(&ring_);
+        sqe = io_uring_get_sqe(&ring_);
+    }
+    return sqe;
+}
+
+void UringLoop::armAccept() {
+    auto sqe = getSqe();
+    io_uring_prep_multishot_accept(sqe, listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    io_uring_sqe_set_data64(sqe, kOpAccept);
+}
+
+void UringLoop::armRecv(Conn *conn) {
+    auto sqe = getSqe();
+    io_uring_prep_recv_multishot(sqe, conn->fd, nullptr, 0, 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kBuffGroup;
+    io_uring_sqe_set_data64(sqe, connData(conn, kOpRecv));
+    ++conn->inflight;
+}
+
+void UringLoop::armWake() {
+    auto sqe = getSqe();
+    io_uring_prep_read(sqe, wake_fd_, &wake_value_, sizeof(wake_value_), 0);
+    io_uring_sqe_set_data64(sqe, kOpWake);
+}
+
+void UringLoop::armTimer() {
+    timer_ts_.tv_sec = kTimerInterval;
+    timer_ts_.tv_nsec = 0;
+    auto sqe = getSqe();
+    io_uring_prep_timeout(sqe, &timer_ts_, 0, 0);
+    io_uring_sqe_set_data64(sqe, kOpTimer);
+}
+
+void UringLoop::flushSends() {
+    for (auto conn : dirty_conns_) {
+        conn->dirty = false;
+        // 正在发送的连接在发送完成后接着提交
+        if (!conn->closing && conn->sending.empty()) {
+            submitSend(conn);
+        }
+    }
+    dirty_conns_.clear();
+}
+
+void UringLoop::submitSend(Conn *conn) {
+    while (conn->sending.size() < static_cast<size_t>(kMaxSendIovecs) && !conn->pending.empty()) {
+        conn->sending.push_back(conn->pending.front());
+        conn->pending.pop_front();
+    }
+
+    int count = static_cast<int>(conn->sending.size());
+    for (int i = 0; i < count; ++i) {
+        auto response = conn->sending[i];
+        size_t offset = (i == 0) ? conn->sent_offset : 0;
+        conn->iovs[i].iov_base = response->buff + offset;
+        conn->iovs[i].iov_len = response->buff_len - offset;
+    }
+    memset(&conn->msg, 0, sizeof(conn->msg));
+    conn->msg.msg_iov = conn->iovs;
+    conn->msg.msg_iovlen = count;
+
+    conn->send_time = now_;
+    auto sqe = getSqe();
+    io_uring_prep_sendmsg(sqe, conn->fd, &conn->msg, MSG_NOSIGNAL);
+    io_uring_sqe_set_data64(sqe, connData(conn, kOpSend));
+    ++conn->inflight;
+}
+
+void UringLoop::onAccept(struct io_uring_cqe *cqe) {
+    if (cqe->res >= 0) {
+        newConn(cqe->res);
+    } else if (cqe->res != -ECANCELED) {
+        FLOG_WARN("io_uring loop %d accept failed: %s", index_, strerror(-cqe->res));
+    }
+
+    if (!(cqe->flags & IORING_CQE_F_MORE) && running_) {
+        armAccept();
+    }
+}
+
+void UringLoop::onRecv(Conn *conn, struct io_uring_cqe *cqe) {
+    int res = cqe->res;
+    if (res > 0 && (cqe->flags & IORING_CQE_F_BUFFER)) {
+        int bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+        char *buff = buffs_ + static_cast<size_t>(bid) * buff_size_;
+        if (!conn->closing) {
+            conn->last_active = now_;
+            onData(conn, buff, static_cast<size_t>(res));
+        }
+        // 请求在回调中已经拷贝，缓冲立即还给内核
+        io_uring_buf_ring_add(buf_ring_, buff, buff_size_, bid, io_uring_buf_ring_mask(buff_count_), 0);
+        io_uring_buf_ring_advance(buf_ring_, 1);
+    }
+
+    if (cqe->flags & IORING_CQE_F_MORE) {
+        return;
+    }
+
+    --conn->inflight;
+    if (conn->closing) {
+        releaseConn(conn);
+    } else if (res > 0 || res == -ENOBUFS) {
+        // 内核结束了multishot(比如缓冲暂时用完)，重新投递
+        armRecv(conn);
+    } else {
+        if (res < 0 && res != -ECONNRESET) {
+            FLOG_WARN("client ip: %s, session_id: %" PRId64 " recv failed: %s", conn->client_ip,
+                      conn->session_id, strerror(-res));
+            __sync_fetch_and_add(&context_->socket_status->recv_error_count, 1);
+        }
+        closeConn(conn);
+    }
+}
+
+void UringLoop::onSend(Conn *conn, struct io_uring_cqe *cqe) {
+    --conn->inflight;
+
+    int res = cqe->res;
+    if (res < 0) {
+        if (!conn->closing) {
+            FLOG_WARN("client ip: %s, session_id: %" PRId64 " send failed: %s", conn->client_ip,
+                      conn->session_id, strerror(-res));
+            __sync_fetch_and_add(&context_->socket_status->send_error_count, 1);
+        }
+        closeConn(conn);
+        return;
+    }
+
+    conn->last_active = now_;
+    size_t sent = static_cast<size_t>(res);
+    size_t done = 0;
+    for (; done < conn->sending.size(); ++done) {
+        auto response = conn->sending[done];
+        size_t remain = response->buff_len - conn->sent_offset;
+        if (sent < remain) {
+            conn->sent_offset += sent;
+            break;
+        }
+        sent -= remain;
+        conn->sent_offset = 0;
+        finishResponse(response);
+    }
+    conn->sending.erase(conn->sending.begin(), conn->sending.begin() + done);
+
+    if (conn->closing) {
+        releaseConn(conn);
+    } else if (!conn->sending.empty() || !conn->pending.empty()) {
+        submitSend(conn);
+    }
+}
+
+void UringLoop::onWake(struct io_uring_cqe *cqe) {
+    {
+        std::lock_guard<std::mutex> lock(queue_mu_);
+        draining_.swap(queue_);
+        wake_pending_ = false;
+    }
+
+    for (auto response : draining_) {
+        auto it = conns_.find(response->session_id);
+        if (it == conns_.end() || it->second->closing) {
+            FLOG_DEBUG("not found session_id: %" PRId64, response->session_id);
+            dropResponse(response);
+            continue;
+        }
+        auto conn = it->second;
+        conn->pending.push_back(response);
+        if (!conn->dirty) {
+            conn->dirty = true;
+            dirty_conns_.push_back(conn);
+        }
+    }
+    draining_.clear();
+
+    if (running_) {
+        armWake();
+    }
+}
+
+// 和epoll实现一致：发送超过network_timeout没有完成，或者超过socket_keep_time没有收发，关闭连接
+void UringLoop::onTimer(struct io_uring_cqe *cqe) {
+    if (!running_) {
+        return;
+    }
+
+    auto status = context_->socket_status;
+    auto network_timeout = sf_config.socket_config.network_timeout;
+    auto keep_time = sf_config.socket_config.socket_keep_time;
+
+    std::vector<Conn *> expired;
+    for (auto &it : conns_) {
+        auto conn = it.second;
+        if (conn->closing) {
+            continue;
+        }
+        if (!conn->sending.empty()) {
+            if (network_timeout > 0 && now_ - conn->send_time >= network_timeout) {
+                FLOG_ERROR("client ip: %s, session_id: %" PRId64 " send timeout, pending: %lu",
+                           conn->client_ip, conn->session_id,
+                           conn->sending.size() + conn->pending.size());
+                __sync_fetch_and_add(&status->send_timeout_count, 1);
+                expired.push_back(conn);
+            }
+        } else if (keep_time > 0 && now_ - conn->last_active >= keep_time) {
+            FLOG_WARN("client ip: %s, session_id: %" PRId64 " recv timeout", conn->client_ip,
+                      conn->session_id);
+            __sync_fetch_and_add(&status->recv_timeout_count, 1);
+            expired.push_back(conn);
+        }
+    }
+    // closeConn可能释放连接并修改conns_，遍历结束后再关闭
+    for (auto conn : expired) {
+        closeConn(conn);
+    }
+
+    armTimer();
+}
+
+void UringLoop::onData(Conn *conn, const char *data, size_t len) {
+    ssize_t used = 0;
+    if (conn->partial.empty()) {
+        // 常见情况下一次收到的都是完整的请求，直接从接收缓冲分发
+        used = dispatch(conn, data, len);
+        if (used >= 0 && static_cast<size_t>(used) < len) {
+            conn->partial.assign(data + used, len - used);
+        }
+    } else {
+        conn->partial.append(data, len);
+        used = dispatch(conn, conn->partial.data(), conn->partial.size());
+        if (used > 0) {
+            conn->partial.erase(0, used);
+        }
+    }
+
+    if (used < 0) {
+        closeConn(conn);
+    }
+}
+
+ssize_t UringLoop::dispatch(Conn *conn, const char *data, size_t len) {
+    auto status = context_->socket_status;
+    size_t offset = 0;
+    while (len - offset >= static_cast<size_t>(header_size)) {
+        auto header = reinterpret_cast<const ds_proto_header_t *>(data + offset);
+        auto magic_number = buff2int(header->magic_number);
+        if (magic_number != DS_PROTO_MAGIC_NUMBER) {
+            FLOG_WARN("client ip: %s, magic number: %08X != %08X", conn->client_ip, magic_number,
+                      DS_PROTO_MAGIC_NUMBER);
+            __sync_fetch_and_add(&status->recv_error_count, 1);
+            return -1;
+        }
+
+        int64_t pkg_len = static_cast<int64_t>(buff2int(header->body_len)) + header_size;
+        if (pkg_len < header_size || pkg_len > sf_config.socket_config.max_pkg_size) {
+            FLOG_ERROR("client ip: %s, session_id: %" PRId64 ", pkg length: %" PRId64
+                       " > max pkg size: %d",
+                       conn->client_ip, conn->session_id, pkg_len,
+                       sf_config.socket_config.max_pkg_size);
+            __sync_fetch_and_add(&status->big_len_pkg_count, 1);
+            return -1;
+        }
+        if (len - offset < static_cast<size_t>(pkg_len)) {
+            break;
+        }
+
+        request_buff_t request;
+        memset(&request, 0, sizeof(request));
+        request.session_id = conn->session_id;
+        request.buff = const_cast<char *>(data + offset);
+        request.buff_len = static_cast<int32_t>(pkg_len);
+        context_->recv_callback(&request, context_->user_data);
+
+        __sync_fetch_and_add(&status->recv_pkg_count, 1);
+        __sync_fetch_and_add(&status->current_recv_pkg_count, 1);
+
+        offset += pkg_len;
+    }
+    return static_cast<ssize_t>(offset);
+}
+
+void UringLoop::newConn(int fd) {
+    auto status = context_->socket_status;
+    if (status->current_connections >=
+        static_cast<uint64_t>(sf_config.socket_config.max_connections)) {
+        FLOG_WARN("io_uring loop %d too many connections: %" PRIu64, index_,
+                  status->current_connections);
+        close(fd);
+        return;
+    }
+
+    auto conn = new Conn;
+    conn->fd = fd;
+    conn->last_active = now_;
+    conn->session_id = (++session_seed_ << kLoopBits) | index_;
+
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    if (getpeername(fd, reinterpret_cast<struct sockaddr *>(&addr), &addr_len) == 0) {
+        inet_ntop(AF_INET, &addr.sin_addr, conn->client_ip, sizeof(conn->client_ip));
+    }
+
+    conns_.emplace(conn->session_id, conn);
+    {
+        std::lock_guard<std::mutex> lock(session_mu_);
+        sessions_.insert(conn->session_id);
+    }
+    __sync_fetch_and_add(&status->current_connections, 1);
+
+    FLOG_DEBUG("accept ip: %s, fd: %d, session_id: %" PRId64, conn->client_ip, fd,
+               conn->session_id);
+
+    armRecv(conn);
+}
+
+void UringLoop::closeConn(Conn *conn) {
+    if (!conn->closing) {
+        FLOG_DEBUG("close ip: %s, fd: %d, session_id: %" PRId64, conn->client_ip, conn->fd,
+                   conn->session_id);
+
+        conn->closing = true;
+        {
+            std::lock_guard<std::mutex> lock(session_mu_);
+            sessions_.erase(conn->session_id);
+        }
+        __sync_fetch_and_sub(&context_->socket_status->current_connections, 1);
+
+        for (auto response : conn->pending) {
+            dropResponse(response);
+        }
+        conn->pending.clear();
+
+        // 让还在进行的recv和send尽快结束
+        shutdown(conn->fd, SHUT_RDWR);
+    }
+    releaseConn(conn);
+}
+
+void UringLoop::releaseConn(Conn *conn) {
+    if (conn->inflight > 0) {
+        return;
+    }
+
+    close(conn->fd);
+    for (auto response : conn->sending) {
+        dropResponse(response);
+    }
+    if (conn->dirty) {
+        for (auto it = dirty_conns_.begin(); it != dirty_conns_.end(); ++it) {
+            if (*it == conn) {
+                dirty_conns_.erase(it);
+                break;
+            }
+        }
+    }
+    conns_.erase(conn->session_id);
+    delete conn;
+}
+
+void UringLoop::finishResponse(response_buff_t *response) {
+    if (context_->send_callback != NULL) {
+        context_->send_callback(response, context_->user_data, 0);
+    }
+    delete_response_buff(response);
+    __sync_fetch_and_sub(&context_->socket_status->current_send_queue_size, 1);
+}
+
+void UringLoop::dropResponse(response_buff_t *response) {
+    delete_response_buff(response);
+    __sync_fetch_and_sub(&context_->socket_status->current_send_queue_size, 1);
+}
+
+UringSocketServer::UringSocketServer() = default;
+
+UringSocketServer::~UringSocketServer() { Stop(); }
+
+bool UringSocketServer::Supported() {
+    struct io_uring ring;
+    if (io_uring_queue_init(4, &ring, 0) != 0) {
+        return false;
+    }
+
+    // multishot recv和SEND_ZC都是6.0加入的，没有单独的特性位，用SEND_ZC判断
+    bool supported = false;
+    auto probe = io_uring_get_probe_ring(&ring);
+    if (probe != nullptr) {
+        supported = io_uring_opcode_supported(probe, IORING_OP_SEND_ZC);
+        io_uring_free_probe(probe);
+    }
+    io_uring_queue_exit(&ring);
+    return supported;
+}
+
+int UringSocketServer::Start() {
+    auto config = thread_info_.socket_config;
+    auto status = thread_info_.socket_status;
+
+    int num = config->event_recv_threads;
+    if (num <= 0) {
+        num = 1;
+    } else if (num > kMaxLoops) {
+        num = kMaxLoops;
+    }
+    // 接收、发送都在同一个线程，没有单独的accept和send线程
+    status->assigned_accept_threads = 0;
+    status->assigned_event_send_threads = 0;
+    status->assigned_event_recv_threads = num;
+
+    for (int i = 0; i < num; ++i) {
+        loops_.emplace_back(new UringLoop(this, i));
+        if (loops_.back()->Start() != 0) {
+            FLOG_ERROR("io_uring socket server start loop %d failed", i);
+            Stop();
+            return -1;
+        }
+    }
+
+    FLOG_INFO("io_uring socket server started, port: %d, threads: %d", config->port, num);
+    return 0;
+}
+
+void UringSocketServer::Stop() {
+    // 只停止线程，loops_在析构时释放，避免和worker线程的Send并发修改
+    for (auto &loop : loops_) {
+        loop->Stop();
+    }
+}
+
+UringLoop *UringSocketServer::getLoop(int64_t session_id) const {
+    auto index = static_cast<size_t>(session_id & (kMaxLoops - 1));
+    if (index >= loops_.size()) {
+        return nullptr;
+    }
+    return loops_[index].get();
+}
+
+int UringSocketServer::Send(response_buff_t *response) {
+    auto status = thread_info_.socket_status;
+    // deal task queue size sub one
+    __sync_fetch_and_sub(&status->current_recv_pkg_count, 1);
+    // 先加上，发送线程可能在Push返回前就已经发送完成
+    __sync_fetch_and_add(&status->current_send_queue_size, 1);
+
+    auto sid = response->session_id;
+    auto msgId = response->msg_id;
+    auto loop = getLoop(sid);
+    if (loop == nullptr || loop->Push(response) != 0) {
+        FLOG_ERROR("session: %" PRId64 " msgid: %" PRId64 " response fail", sid, msgId);
+        delete_response_buff(response);
+        __sync_fetch_and_sub(&status->current_send_queue_size, 1);
+        return -1;
+    }
+
+    FLOG_DEBUG("session: %" PRId64 " msgid: %" PRId64 " response succ,push ok.", sid, msgId);
+    return 0;
+}
+
+bool UringSocketServer::Closed(uint64_t session_id) {
+    auto loop = getLoop(static_cast<int64_t>(session_id));
+    return loop == nullptr || loop->Closed(static_cast<int64_t>(session_id));
+}
+
+sf_session_entry_t *UringSocketServer::lookup_session_entry(int64_t session_id) {
+    return nullptr;
+}
+
+}  // namespace common
+}  // namespace dataserver
+}  // namespace sharkstore
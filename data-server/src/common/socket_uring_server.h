@@ -0,0 +1,53 @@
+#ifndef FBASE_DATASERVER_COMMON_SOCKET_URING_SERVER_H_
+#define FBASE_DATASERVER_COMMON_SOCKET_URING_SERVER_H_
+
+#include <memory>
+#include <vector>
+
+#include "socket_server.h"
+
+namespace sharkstore {
+namespace dataserver {
+namespace common {
+
+class UringLoop;
+
+// 基于io_uring的服务端网络实现，对外接口和SocketServer一致，由配置选择
+// 每个event_recv线程一个ring，各自监听同一端口(SO_REUSEPORT)，连接的收发都在接收它的线程：
+//   multishot accept和recv，接收缓冲来自provided buffer ring，不需要每次重新投递；
+//   worker线程的应答放入连接所属线程的队列，该线程每轮合并后批量提交发送；
+//   每个ring上有一个定时器，按network_timeout和socket_keep_time关闭超时的连接；
+// 相比epoll实现省去了收发线程之间的通知，每个请求的系统调用和线程切换更少
+class UringSocketServer : public SocketServer {
+public:
+    UringSocketServer();
+    ~UringSocketServer();
+
+    UringSocketServer(const UringSocketServer &) = delete;
+    UringSocketServer &operator=(const UringSocketServer &) = delete;
+    UringSocketServer &operator=(const UringSocketServer &) volatile = delete;
+
+    // 当前内核是否支持需要的io_uring特性(multishot recv, provided buffer ring)
+    static bool Supported();
+
+    int Start() override;
+    void Stop() override;
+
+    int Send(response_buff_t *response) override;
+    bool Closed(uint64_t session_id) override;
+    // 不使用frame层的session表，总是返回nullptr
+    sf_session_entry_t *lookup_session_entry(int64_t session_id) override;
+
+private:
+    friend class UringLoop;
+
+    UringLoop *getLoop(int64_t session_id) const;
+
+private:
+    std::vector<std::unique_ptr<UringLoop>> loops_;
+};
+
+}  // namespace common
+}  // namespace dataserver
+}  // namespace sharkstore
+#endif  // FBASE_DATASERVER_COMMON_SOCKET_URING_SERVER_H_
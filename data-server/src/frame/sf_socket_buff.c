@@ -1,16 +1,37 @@
 #include "sf_socket_buff.h"
 
 #include <errno.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include <fastcommon/fast_mblock.h>
 #include <fastcommon/pthread_func.h>
 
 #include "sf_logger.h"
-static size_t sf_message_size = sizeof(sf_message_t);
+
+static struct fast_mblock_man response_mblock;
+static pthread_once_t response_mblock_once = PTHREAD_ONCE_INIT;
+static volatile int64_t response_alloc_count = 0;
+
+static void init_response_mblock(void) {
+    if (fast_mblock_init_ex1(&response_mblock, "response_buff", sizeof(sf_message_t),
+                             0, NULL, true) != 0) {
+        FLOG_ERROR("init response buff mblock fail");
+        abort();
+    }
+}
 
 response_buff_t *new_response_buff(int buff_size) {
-    response_buff_t *response = malloc(sf_message_size);
+    pthread_once(&response_mblock_once, init_response_mblock);
 
+    response_buff_t *response = fast_mblock_alloc_object(&response_mblock);
+    if (response == NULL) {
+        FLOG_ERROR("alloc response buff fail");
+        return NULL;
+    }
+    __sync_fetch_and_add(&response_alloc_count, 1);
+
+    response->buff = NULL;
     if (buff_size > 0) {
         response->buff = malloc(buff_size);
         if (response->buff == NULL) {
@@ -18,7 +39,7 @@ response_buff_t *new_response_buff(int buff_size) {
                        "errno: %d, error info: %s",
                        buff_size, errno, STRERROR(errno));
 
-            free(response);
+            fast_mblock_free_object(&response_mblock, response);
             return NULL;
         }
     }
@@ -33,6 +54,14 @@ response_buff_t *new_response_buff(int buff_size) {
 
 void delete_response_buff(response_buff_t *response) {
     free(response->buff);
-    free(response);
+    fast_mblock_free_object(&response_mblock, response);
+}
+
+void response_buff_stat(int64_t *alloc_count, int *used_count, int *total_count) {
+    pthread_once(&response_mblock_once, init_response_mblock);
+
+    *alloc_count = response_alloc_count;
+    *used_count = response_mblock.info.element_used_count;
+    *total_count = response_mblock.info.element_total_count;
 }
 
@@ -25,6 +25,10 @@ extern "C" {
 void delete_response_buff(response_buff_t *buff);
 response_buff_t *new_response_buff(int buff_size);
 
+// response_buff_t结构体从mblock池分配，buff仍然使用malloc
+// alloc_count: 累计分配次数; used_count: 正在使用; total_count: 池的容量
+void response_buff_stat(int64_t *alloc_count, int *used_count, int *total_count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -32,6 +32,8 @@ struct HistogramData {
     // zero-initialize new members since old Statistics::histogramData()
     // implementations won't write them.
     double max = 0.0;
+    uint64_t count = 0;
+    uint64_t sum = 0;
 };
 
 struct HistogramStat {
@@ -56,6 +58,8 @@ struct HistogramStat {
     inline uint64_t bucket_at(size_t b) const {
         return buckets_[b].load(std::memory_order_relaxed);
     }
+    // 第b个桶的上界(包含)，桶内的值在(BucketLimit(b-1), BucketLimit(b)]之间
+    static uint64_t BucketLimit(size_t b);
 
     double Median() const;
     double Percentile(double p) const;
@@ -102,6 +102,10 @@ namespace sharkstore
             return this->statusPtr_->GetFileSystemUsage(path, total, available);
         }
 
+        bool ISystemStatus::GetLoadAvg(LoadAvg &info) {
+            return this->statusPtr_->GetLoadAvg(info) == 0;
+        }
+
         //拆分GetProcessStats函数
         void ISystemStatus::GetMemStats(pid_t pid)
         {
@@ -33,6 +33,8 @@ public:
 
     bool GetFileSystemUsage(const char *path, uint64_t *total, uint64_t *available);
 
+    bool GetLoadAvg(LoadAvg &info);
+
 
 public:
     void PutTopData(PrintTag tag, uint32_t time);
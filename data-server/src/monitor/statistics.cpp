@@ -28,31 +28,138 @@ const char *HistogramTypeName(HistogramType type) {
             return "Store";
         case HistogramType::kRaft:
             return "Raft";
+        case HistogramType::kDecode:
+            return "Decode";
+        case HistogramType::kApply:
+            return "Apply";
+        case HistogramType::kSerialize:
+            return "Serialize";
         default:
             return "<unknown>";
     }
 }
 
-void Statistics::PushTime(HistogramType type, uint64_t time) {
-    histograms_[static_cast<uint32_t>(type)].Add(time);
+static std::atomic<uint64_t> next_statistics_id = {1};
+
+Statistics::Statistics() : id_(next_statistics_id.fetch_add(1)) {}
+
+Statistics::~Statistics() {
+    for (auto &it : shards_) {
+        delete it.second;
+    }
+}
+
+Statistics::Shard::~Shard() {
+    for (auto &f : funcs) {
+        delete f.load();
+    }
+}
+
+Statistics::Shard *Statistics::localShard() {
+    // 缓存当前线程最近使用的实例的分片，通常只有一个Statistics实例
+    struct LocalShard {
+        uint64_t owner = 0;
+        Shard *shard = nullptr;
+    };
+    thread_local LocalShard local;
+    if (local.owner != id_) {
+        local.shard = registerShard();
+        local.owner = id_;
+    }
+    return local.shard;
 }
 
-void Statistics::GetData(HistogramType type, HistogramData *data) {
+Statistics::Shard *Statistics::registerShard() {
     std::lock_guard<std::mutex> lock(aggregate_lock_);
-    histograms_[static_cast<uint32_t>(type)].Data(data);
+    auto &shard = shards_[std::this_thread::get_id()];
+    if (shard == nullptr) {
+        shard = new Shard;
+    }
+    return shard;
 }
 
-std::string Statistics::ToString(HistogramType type) const {
+void Statistics::PushTime(HistogramType type, uint64_t time, int func_id) {
+    auto shard = localShard();
+    shard->histograms[static_cast<uint32_t>(type)].Add(time);
+    if (func_id >= 0 && func_id < kMaxFuncID) {
+        auto &slot = shard->funcs[func_id];
+        auto funcs = slot.load(std::memory_order_relaxed);
+        if (funcs == nullptr) {
+            // 只有所属线程写，读取的线程通过acquire看到初始化好的对象
+            funcs = new FuncHistograms;
+            slot.store(funcs, std::memory_order_release);
+        }
+        funcs->histograms[static_cast<uint32_t>(type)].Add(time);
+    }
+}
+
+void Statistics::merge(HistogramType type, HistogramStat *result) const {
     std::lock_guard<std::mutex> lock(aggregate_lock_);
-    return histograms_[static_cast<uint32_t>(type)].ToString();
+    for (const auto &it : shards_) {
+        result->Merge(it.second->histograms[static_cast<uint32_t>(type)]);
+    }
+}
+
+bool Statistics::mergeFunc(int func_id, HistogramType type, HistogramStat *result) const {
+    if (func_id < 0 || func_id >= kMaxFuncID) return false;
+
+    bool found = false;
+    std::lock_guard<std::mutex> lock(aggregate_lock_);
+    for (const auto &it : shards_) {
+        auto funcs = it.second->funcs[func_id].load(std::memory_order_acquire);
+        if (funcs != nullptr) {
+            result->Merge(funcs->histograms[static_cast<uint32_t>(type)]);
+            found = true;
+        }
+    }
+    return found;
+}
+
+void Statistics::GetData(HistogramType type, HistogramData *data) const {
+    HistogramStat merged;
+    merge(type, &merged);
+    merged.Data(data);
+}
+
+bool Statistics::GetFuncData(int func_id, HistogramType type, HistogramData *data) const {
+    HistogramStat merged;
+    if (!mergeFunc(func_id, type, &merged)) {
+        return false;
+    }
+    merged.Data(data);
+    return true;
+}
+
+bool Statistics::GetFuncStat(int func_id, HistogramType type, HistogramStat *stat) const {
+    return mergeFunc(func_id, type, stat);
+}
+
+std::vector<int> Statistics::FuncIDs() const {
+    std::vector<int> ids;
+    std::lock_guard<std::mutex> lock(aggregate_lock_);
+    for (int i = 0; i < kMaxFuncID; ++i) {
+        for (const auto &it : shards_) {
+            if (it.second->funcs[i].load(std::memory_order_acquire) != nullptr) {
+                ids.push_back(i);
+                break;
+            }
+        }
+    }
+    return ids;
+}
+
+std::string Statistics::ToString(HistogramType type) const {
+    HistogramStat merged;
+    merge(type, &merged);
+    return merged.ToString();
 }
 
 std::string Statistics::ToString() const {
     std::string result;
 
-    std::lock_guard<std::mutex> lock(aggregate_lock_);
     for (uint32_t i = 0; i < kHistogramTypeNum; ++i) {
-        auto &h = histograms_[i];
+        HistogramStat h;
+        merge(static_cast<HistogramType>(i), &h);
         if (h.num() == 0) continue;
 
         char buffer[200] = {'\0'};
@@ -71,8 +178,10 @@ std::string Statistics::ToString() const {
 
 void Statistics::Reset() {
     std::lock_guard<std::mutex> lock(aggregate_lock_);
-    for (auto &h : histograms_) {
-        h.Clear();
+    for (auto &it : shards_) {
+        for (auto &h : it.second->histograms) {
+            h.Clear();
+        }
     }
 }
 
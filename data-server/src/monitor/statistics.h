@@ -13,17 +13,25 @@
 
 _Pragma("once");
 
+#include <atomic>
 #include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include "histogram.h"
 
 namespace sharkstore {
 namespace monitor {
 
+// 请求处理的各个阶段
 enum class HistogramType : uint32_t {
-    kQWait = 0,
-    kDeal,
-    kStore,
-    kRaft,
+    kQWait = 0,  // worker队列等待
+    kDeal,       // 从收到请求到应答发送完成
+    kStore,      // 读写存储
+    kRaft,       // raft从propose到commit(开始apply)
+    kDecode,     // 请求反序列化
+    kApply,      // raft apply到应答
+    kSerialize,  // 应答序列化
     kMax,
 };
 
@@ -31,20 +39,64 @@ const char *HistogramTypeName(HistogramType type);
 
 static constexpr uint32_t kHistogramTypeNum = static_cast<uint32_t>(HistogramType::kMax);
 
+// 记录时每个线程写自己的分片(thread local)，不加锁也没有原子的读改写；
+// 读取统计时合并所有线程的分片
 class Statistics {
 public:
-    void PushTime(HistogramType type, uint64_t time);
+    // 功能号(funcpb::FunctionID)的上限
+    static constexpr int kMaxFuncID = 2048;
 
-    void GetData(HistogramType type, HistogramData *data);
+    Statistics();
+    ~Statistics();
+
+    Statistics(const Statistics &) = delete;
+    Statistics &operator=(const Statistics &) = delete;
+
+    // func_id有效时同时计入该功能号的直方图
+    void PushTime(HistogramType type, uint64_t time, int func_id = -1);
+
+    void GetData(HistogramType type, HistogramData *data) const;
+    // 按功能号的统计，该功能号没有记录过返回false
+    bool GetFuncData(int func_id, HistogramType type, HistogramData *data) const;
+    // 同GetFuncData，返回合并后的直方图(含各个桶的计数)
+    bool GetFuncStat(int func_id, HistogramType type, HistogramStat *stat) const;
+    // 有过记录的功能号
+    std::vector<int> FuncIDs() const;
 
     std::string ToString(HistogramType type) const;
     std::string ToString() const;
 
+    // 只清空全局的直方图，按功能号的直方图从启动开始累计
+    // 与记录并发时可能丢失少量正在写入的值
     void Reset();
 
 private:
-    Histogram histograms_[kHistogramTypeNum];
+    struct FuncHistograms {
+        HistogramStat histograms[kHistogramTypeNum];
+    };
+
+    // 一个线程的分片，只由所属线程写
+    struct Shard {
+        HistogramStat histograms[kHistogramTypeNum];
+        // 按功能号索引，第一次记录时创建
+        std::atomic<FuncHistograms *> funcs[kMaxFuncID] = {};
+
+        ~Shard();
+    };
+
+    Shard *localShard();
+    Shard *registerShard();
+
+    void merge(HistogramType type, HistogramStat *result) const;
+    bool mergeFunc(int func_id, HistogramType type, HistogramStat *result) const;
+
+private:
+    // 区分不同的Statistics实例，不会重复使用
+    const uint64_t id_;
+
     mutable std::mutex aggregate_lock_;
+    // 线程退出后分片仍然保留(其中的统计还要计入)，新线程复用相同线程id的分片
+    std::unordered_map<std::thread::id, Shard *> shards_;
 };
 
 }  // namespace monitor
@@ -0,0 +1,167 @@
+#include "tracer.h"
+
+namespace sharkstore {
+namespace monitor {
+
+// 进行中的追踪超过这个时间(微秒)还没有结束(如follower上的日志被截断)，在满时清除
+static const int64_t kActiveExpireUs = 60 * 1000 * 1000;
+// 生成的trace_id中序号的位数，高位为节点id
+static const int kSeqBits = 48;
+
+void Tracer::SetOptions(uint64_t sample_interval, int64_t slow_threshold_us, size_t slow_capacity) {
+    sample_interval_ = sample_interval;
+    slow_threshold_ = slow_threshold_us;
+
+    std::lock_guard<std::mutex> lock(mu_);
+    if (slow_capacity != slow_capacity_) {
+        slow_capacity_ = slow_capacity;
+        slow_pos_ = 0;
+        std::vector<Trace>().swap(slow_traces_);
+    }
+}
+
+bool Tracer::addActive(Trace &&trace) {
+    if (active_.size() >= kMaxActive) {
+        auto expire = trace.begin - kActiveExpireUs;
+        for (auto it = active_.begin(); it != active_.end();) {
+            if (it->second.begin < expire) {
+                it = active_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (active_.size() >= kMaxActive) {
+            ++dropped_;
+            return false;
+        }
+    }
+    auto id = trace.trace_id;
+    return active_.emplace(id, std::move(trace)).second;
+}
+
+uint64_t Tracer::Start(uint64_t trace_id, uint64_t range_id, int func_id, int64_t begin) {
+    auto interval = sample_interval_.load();
+    if (interval == 0 || counter_.fetch_add(1) % interval != 0) {
+        return 0;
+    }
+
+    if (trace_id == 0) {
+        trace_id = (node_id_ << kSeqBits) | (++seq_ & ((1ULL << kSeqBits) - 1));
+    }
+
+    Trace trace;
+    trace.trace_id = trace_id;
+    trace.range_id = range_id;
+    trace.func_id = func_id;
+    trace.origin = true;
+    trace.begin = begin;
+    trace.spans.push_back(TraceSpan{"recv", 0, begin});
+
+    std::lock_guard<std::mutex> lock(mu_);
+    // 客户端使用了相同的trace_id，只追踪第一个
+    if (!addActive(std::move(trace))) {
+        return 0;
+    }
+    ++sampled_;
+    return trace_id;
+}
+
+void Tracer::Join(uint64_t trace_id, uint64_t range_id, int64_t time, uint64_t from) {
+    if (trace_id == 0) return;
+
+    Trace trace;
+    trace.trace_id = trace_id;
+    trace.range_id = range_id;
+    trace.origin = false;
+    trace.begin = time;
+    trace.spans.push_back(TraceSpan{"receive", from, time});
+
+    std::lock_guard<std::mutex> lock(mu_);
+    addActive(std::move(trace));
+}
+
+void Tracer::Record(uint64_t trace_id, const char *stage, int64_t time, uint64_t node) {
+    if (trace_id == 0) return;
+
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = active_.find(trace_id);
+    if (it != active_.end()) {
+        it->second.spans.push_back(TraceSpan{stage, node, time});
+    }
+}
+
+void Tracer::Finish(uint64_t trace_id, const char *stage, int64_t time) {
+    finish(trace_id, stage, time, false);
+}
+
+void Tracer::FinishFollower(uint64_t trace_id, const char *stage, int64_t time) {
+    finish(trace_id, stage, time, true);
+}
+
+void Tracer::finish(uint64_t trace_id, const char *stage, int64_t time, bool follower_only) {
+    if (trace_id == 0) return;
+
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = active_.find(trace_id);
+    if (it == active_.end() || (follower_only && it->second.origin)) {
+        return;
+    }
+
+    Trace trace = std::move(it->second);
+    active_.erase(it);
+    trace.spans.push_back(TraceSpan{stage, 0, time});
+    trace.end = time;
+    ++finished_;
+
+    if (slow_capacity_ == 0 || trace.Duration() < slow_threshold_.load()) {
+        return;
+    }
+    ++slow_;
+    if (slow_traces_.size() < slow_capacity_) {
+        slow_traces_.push_back(std::move(trace));
+    } else {
+        slow_traces_[slow_pos_] = std::move(trace);
+    }
+    slow_pos_ = (slow_pos_ + 1) % slow_capacity_;
+}
+
+std::vector<Trace> Tracer::GetSlowTraces() const {
+    std::vector<Trace> result;
+    std::lock_guard<std::mutex> lock(mu_);
+    result.reserve(slow_traces_.size());
+    // slow_pos_之前的是最新写入的
+    for (size_t i = 1; i <= slow_traces_.size(); ++i) {
+        auto idx = (slow_pos_ + slow_traces_.size() - i) % slow_traces_.size();
+        result.push_back(slow_traces_[idx]);
+    }
+    return result;
+}
+
+bool Tracer::GetTrace(uint64_t trace_id, Trace *trace) const {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = active_.find(trace_id);
+    if (it != active_.end()) {
+        *trace = it->second;
+        return true;
+    }
+    for (const auto &t : slow_traces_) {
+        if (t.trace_id == trace_id) {
+            *trace = t;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Tracer::GetStats(TracerStats *stats) const {
+    stats->sampled = sampled_;
+    stats->finished = finished_;
+    stats->slow = slow_;
+    stats->dropped = dropped_;
+
+    std::lock_guard<std::mutex> lock(mu_);
+    stats->active = active_.size();
+}
+
+}  // namespace monitor
+}  // namespace sharkstore
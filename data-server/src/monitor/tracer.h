@@ -0,0 +1,111 @@
+_Pragma("once");
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sharkstore {
+namespace monitor {
+
+// 请求处理某个阶段的时间点
+struct TraceSpan {
+    const char *stage;  // 阶段名称，须是常量字符串
+    uint64_t node;      // 复制相关的阶段为对端的节点id
+    int64_t time;       // 微秒
+};
+
+// 一个采样请求在本节点上的各阶段时间
+struct Trace {
+    uint64_t trace_id = 0;
+    uint64_t range_id = 0;
+    int func_id = -1;
+    // true: 本节点收到的请求(leader)；false: 通过raft日志复制过来的(follower)
+    bool origin = true;
+    int64_t begin = 0;
+    int64_t end = 0;
+    std::vector<TraceSpan> spans;
+
+    int64_t Duration() const { return end - begin; }
+};
+
+struct TracerStats {
+    uint64_t sampled = 0;   // 采样开始的请求数
+    uint64_t finished = 0;  // 完成的追踪数
+    uint64_t slow = 0;      // 超过阈值记录到慢请求环形缓冲的追踪数
+    uint64_t dropped = 0;   // 进行中的追踪过多时丢弃的
+    uint64_t active = 0;    // 进行中的追踪数
+};
+
+// 采样的请求追踪：每N个写请求采样一个，按trace_id记录各阶段的时间点，
+// trace_id随raft日志复制到follower，follower上记录复制、持久化和apply的时间。
+// 耗时超过阈值的追踪保存到固定大小的环形缓冲中，供admin接口查询。
+// 只有采样的请求会加锁，没有开启采样时Start只读一个原子变量
+class Tracer {
+public:
+    // 进行中的追踪个数上限
+    static constexpr size_t kMaxActive = 10000;
+
+    Tracer() = default;
+    ~Tracer() = default;
+
+    Tracer(const Tracer &) = delete;
+    Tracer &operator=(const Tracer &) = delete;
+
+    // 生成trace_id时使用节点id作为高位，避免不同节点生成的id冲突
+    void SetNodeID(uint64_t node_id) { node_id_ = node_id; }
+
+    // sample_interval为0时不采样；slow_capacity修改时清空已有的慢请求
+    void SetOptions(uint64_t sample_interval, int64_t slow_threshold_us, size_t slow_capacity);
+    uint64_t SampleInterval() const { return sample_interval_; }
+    int64_t SlowThreshold() const { return slow_threshold_; }
+
+    // 收到请求时调用，返回采样的trace_id，不采样返回0
+    // 请求头中trace_id为0时生成一个
+    uint64_t Start(uint64_t trace_id, uint64_t range_id, int func_id, int64_t begin);
+    // follower收到复制的日志时调用
+    void Join(uint64_t trace_id, uint64_t range_id, int64_t time, uint64_t from);
+
+    // 记录一个阶段，trace_id不在追踪中时忽略
+    void Record(uint64_t trace_id, const char *stage, int64_t time, uint64_t node = 0);
+
+    // 结束追踪，stage为最后一个阶段(如reply、timeout)
+    void Finish(uint64_t trace_id, const char *stage, int64_t time);
+    // 只结束follower上的追踪，leader上的追踪在应答时结束
+    void FinishFollower(uint64_t trace_id, const char *stage, int64_t time);
+
+    // 慢请求，最新的在前
+    std::vector<Trace> GetSlowTraces() const;
+    // 查找进行中的或者慢请求中的追踪
+    bool GetTrace(uint64_t trace_id, Trace *trace) const;
+
+    void GetStats(TracerStats *stats) const;
+
+private:
+    // 需要持有mu_
+    bool addActive(Trace &&trace);
+    void finish(uint64_t trace_id, const char *stage, int64_t time, bool follower_only);
+
+private:
+    uint64_t node_id_ = 0;
+    std::atomic<uint64_t> sample_interval_ = {0};
+    std::atomic<int64_t> slow_threshold_ = {0};
+    std::atomic<uint64_t> counter_ = {0};
+    std::atomic<uint64_t> seq_ = {0};
+
+    std::atomic<uint64_t> sampled_ = {0};
+    std::atomic<uint64_t> finished_ = {0};
+    std::atomic<uint64_t> slow_ = {0};
+    std::atomic<uint64_t> dropped_ = {0};
+
+    mutable std::mutex mu_;
+    std::unordered_map<uint64_t, Trace> active_;
+    // 慢请求的环形缓冲，slow_pos_为下一个写入的位置
+    std::vector<Trace> slow_traces_;
+    size_t slow_capacity_ = 0;
+    size_t slow_pos_ = 0;
+};
+
+}  // namespace monitor
+}  // namespace sharkstore
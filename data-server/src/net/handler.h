@@ -10,6 +10,7 @@ namespace net {
 class Session;
 
 struct Context {
+    uint64_t session_id = 0;
     std::weak_ptr<Session> session;
     std::string remote_addr;
     std::string local_addr;
@@ -18,6 +19,8 @@ struct Context {
 struct Message {
     Head head;
     std::vector<uint8_t> body;
+    // body already holds encoded frames (heads included), write it as is
+    bool encoded = false;
 };
 
 using MessagePtr = std::shared_ptr<Message>;
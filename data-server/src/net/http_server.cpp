@@ -0,0 +1,207 @@
+#include "http_server.h"
+
+#include <asio/buffers_iterator.hpp>
+#include <asio/read_until.hpp>
+#include <asio/streambuf.hpp>
+#include <asio/write.hpp>
+
+#include "frame/sf_logger.h"
+
+namespace sharkstore {
+namespace dataserver {
+namespace net {
+
+// max size of the request line and headers
+static const size_t kMaxRequestSize = 8192;
+// a request must be received within the timeout after accepted
+static const int kReadTimeoutMs = 5000;
+// wait before accepting again after an error, eg. EMFILE would fail again at once
+static const int kAcceptRetryMs = 100;
+
+static const char* statusText(int status) {
+    switch (status) {
+        case 200:
+            return "OK";
+        case 400:
+            return "Bad Request";
+        case 404:
+            return "Not Found";
+        case 405:
+            return "Method Not Allowed";
+        default:
+            return "Internal Server Error";
+    }
+}
+
+namespace {
+
+class HttpConnection : public std::enable_shared_from_this<HttpConnection> {
+public:
+    HttpConnection(asio::ip::tcp::socket socket, const HttpHandler& handler)
+        : socket_(std::move(socket)),
+          handler_(handler),
+          buffer_(kMaxRequestSize),
+          timer_(socket_.get_executor()) {}
+
+    void Start() {
+        auto self(shared_from_this());
+        timer_.expires_after(std::chrono::milliseconds(kReadTimeoutMs));
+        timer_.async_wait([self](const std::error_code& ec) {
+            if (!ec) {
+                std::error_code ignore;
+                self->socket_.close(ignore);
+            }
+        });
+
+        asio::async_read_until(socket_, buffer_, "\r\n\r\n",
+                               [self](const std::error_code& ec, std::size_t length) {
+                                   self->timer_.cancel();
+                                   if (ec) return;
+                                   self->handle(length);
+                               });
+    }
+
+private:
+    void handle(std::size_t length) {
+        std::string data(asio::buffers_begin(buffer_.data()),
+                         asio::buffers_begin(buffer_.data()) + length);
+        HttpRequest req;
+        HttpResponse resp;
+        if (!HttpServer::ParseRequest(data, &req)) {
+            resp.status = 400;
+        } else if (req.method != "GET" && req.method != "HEAD") {
+            resp.status = 405;
+        } else {
+            handler_(req, &resp);
+        }
+        if (resp.status != 200 && resp.body.empty()) {
+            resp.body = statusText(resp.status);
+            resp.body.push_back('\n');
+        }
+
+        response_ = "HTTP/1.1 " + std::to_string(resp.status) + " " + statusText(resp.status) +
+                    "\r\nContent-Type: " + resp.content_type +
+                    "\r\nContent-Length: " + std::to_string(resp.body.size()) +
+                    "\r\nConnection: close\r\n\r\n";
+        if (req.method != "HEAD") {
+            response_.append(resp.body);
+        }
+
+        auto self(shared_from_this());
+        asio::async_write(socket_, asio::buffer(response_),
+                          [self](const std::error_code& ec, std::size_t) {
+                              std::error_code ignore;
+                              self->socket_.shutdown(asio::ip::tcp::socket::shutdown_both, ignore);
+                              self->socket_.close(ignore);
+                          });
+    }
+
+private:
+    asio::ip::tcp::socket socket_;
+    HttpHandler handler_;
+    asio::streambuf buffer_;
+    asio::steady_timer timer_;
+    std::string response_;
+};
+
+}  // namespace
+
+HttpServer::HttpServer() : acceptor_(context_), accept_timer_(context_) {}
+
+HttpServer::~HttpServer() { Stop(); }
+
+Status HttpServer::ListenAndServe(const std::string& listen_ip, uint16_t listen_port,
+                                  const HttpHandler& handler) {
+    std::string bind_ip = listen_ip;
+    if (bind_ip.empty()) {
+        bind_ip = "0.0.0.0";
+    }
+    try {
+        asio::ip::tcp::endpoint endpoint(asio::ip::make_address(bind_ip), listen_port);
+        acceptor_.open(endpoint.protocol());
+        acceptor_.set_option(asio::ip::tcp::acceptor::reuse_address(true));
+        acceptor_.bind(endpoint);
+        acceptor_.listen(asio::socket_base::max_listen_connections);
+    } catch (std::exception& e) {
+        return Status(Status::kIOError, "listen", e.what());
+    }
+
+    handler_ = handler;
+
+    doAccept();
+    thr_.reset(new std::thread([this]() {
+        try {
+            context_.run();
+        } catch (std::exception& e) {
+            FLOG_ERROR("[Http] server stopped: %s", e.what());
+        }
+    }));
+
+    return Status::OK();
+}
+
+void HttpServer::Stop() {
+    if (stopped_) return;
+
+    stopped_ = true;
+
+    context_.stop();
+    if (thr_ && thr_->joinable()) {
+        thr_->join();
+    }
+    // the server thread has exited, no handler is running
+    std::error_code ignore;
+    acceptor_.close(ignore);
+}
+
+void HttpServer::doAccept() {
+    acceptor_.async_accept([this](const std::error_code& ec, asio::ip::tcp::socket socket) {
+        if (ec) {
+            if (ec == asio::error::operation_aborted) return;
+            FLOG_ERROR("[Http] accept error: %s", ec.message().c_str());
+            accept_timer_.expires_after(std::chrono::milliseconds(kAcceptRetryMs));
+            accept_timer_.async_wait([this](const std::error_code& err) {
+                if (!err) doAccept();
+            });
+            return;
+        }
+        std::make_shared<HttpConnection>(std::move(socket), handler_)->Start();
+        doAccept();
+    });
+}
+
+bool HttpServer::ParseRequest(const std::string& data, HttpRequest* req) {
+    // request line: METHOD SP request-target SP HTTP-version CRLF
+    auto line_end = data.find("\r\n");
+    if (line_end == std::string::npos) {
+        return false;
+    }
+    auto method_end = data.find(' ', 0);
+    if (method_end == std::string::npos || method_end == 0 || method_end >= line_end) {
+        return false;
+    }
+    auto target_end = data.find(' ', method_end + 1);
+    if (target_end == std::string::npos || target_end >= line_end ||
+        target_end == method_end + 1) {
+        return false;
+    }
+    if (data.compare(target_end + 1, 5, "HTTP/") != 0) {
+        return false;
+    }
+
+    req->method = data.substr(0, method_end);
+    auto target = data.substr(method_end + 1, target_end - method_end - 1);
+    auto pos = target.find('?');
+    if (pos == std::string::npos) {
+        req->path = target;
+        req->query.clear();
+    } else {
+        req->path = target.substr(0, pos);
+        req->query = target.substr(pos + 1);
+    }
+    return !req->path.empty() && req->path[0] == '/';
+}
+
+}  // namespace net
+}  // namespace dataserver
+}  // namespace sharkstore
@@ -0,0 +1,66 @@
+_Pragma("once");
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <asio/io_context.hpp>
+#include <asio/ip/tcp.hpp>
+#include <asio/steady_timer.hpp>
+
+#include "base/status.h"
+
+namespace sharkstore {
+namespace dataserver {
+namespace net {
+
+struct HttpRequest {
+    std::string method;
+    std::string path;   // without the query string
+    std::string query;
+};
+
+struct HttpResponse {
+    int status = 200;
+    std::string content_type = "text/plain; charset=utf-8";
+    std::string body;
+};
+
+using HttpHandler = std::function<void(const HttpRequest&, HttpResponse*)>;
+
+// A minimal HTTP/1.x server for plain text endpoints such as /metrics.
+// Every connection serves one request and is closed after the response;
+// handlers run in the single server thread.
+class HttpServer final {
+public:
+    HttpServer();
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    Status ListenAndServe(const std::string& listen_ip, uint16_t listen_port,
+                          const HttpHandler& handler);
+
+    void Stop();
+
+    // parse the request line, headers are ignored. false if malformed
+    static bool ParseRequest(const std::string& data, HttpRequest* req);
+
+private:
+    void doAccept();
+
+private:
+    HttpHandler handler_;
+    bool stopped_ = false;
+
+    asio::io_context context_;
+    asio::ip::tcp::acceptor acceptor_;
+    // delays the next accept after an error
+    asio::steady_timer accept_timer_;
+    std::unique_ptr<std::thread> thr_;
+};
+
+}  // namespace net
+}  // namespace dataserver
+}  // namespace sharkstore
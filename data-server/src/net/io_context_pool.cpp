@@ -1,12 +1,25 @@
 #include "io_context_pool.h"
 
+#include <errno.h>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
 #include "frame/sf_logger.h"
 
 namespace sharkstore {
 namespace dataserver {
 namespace net {
 
-IOContextPool::IOContextPool(size_t size) : pool_size_(size) {
+// the pool and loop index running in current thread
+static thread_local const IOContextPool* current_pool = nullptr;
+static thread_local int current_index = -1;
+
+IOContextPool::IOContextPool(size_t size, bool pin_cores, size_t cpu_offset)
+    : pool_size_(size), pin_cores_(pin_cores), cpu_offset_(cpu_offset) {
     for (size_t i = 0; i < size; ++i) {
         auto context = std::make_shared<asio::io_context>();
         auto guard = asio::make_work_guard(*context);
@@ -46,9 +59,41 @@ asio::io_context& IOContextPool::GetIOContext() {
     return *(io_contexts_[idx]);
 }
 
+int IOContextPool::CurrentIndex() const {
+    return current_pool == this ? current_index : -1;
+}
+
+void IOContextPool::pinCore(int i) {
+    auto cpus = std::thread::hardware_concurrency();
+    if (cpus == 0) return;
+
+    auto cpu = static_cast<int>((cpu_offset_ + i) % cpus);
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    if (ret != 0) {
+        FLOG_WARN("[Net] context pool loop-%d pin to cpu %d failed: %s", i, cpu, strerror(ret));
+        return;
+    }
+
+    // allocate from the numa node of the pinned cpu
+    if (syscall(SYS_set_mempolicy, MPOL_LOCAL, nullptr, 0) != 0) {
+        FLOG_WARN("[Net] context pool loop-%d set local mempolicy failed: %s", i,
+                  strerror(errno));
+    }
+    FLOG_INFO("[Net] context pool loop-%d pinned to cpu %d.", i, cpu);
+}
+
 void IOContextPool::runLoop(const std::shared_ptr<asio::io_context>& ctx, int i) {
     FLOG_INFO("[Net] context pool loop-%d start.", i);
 
+    current_pool = this;
+    current_index = i;
+    if (pin_cores_) {
+        pinCore(i);
+    }
+
     try {
         ctx->run();
     } catch (std::exception& e) {
@@ -14,7 +14,7 @@ namespace net {
 
 class IOContextPool final {
 public:
-    explicit IOContextPool(size_t size);
+    explicit IOContextPool(size_t size, bool pin_cores = false, size_t cpu_offset = 0);
     ~IOContextPool();
 
     IOContextPool(const IOContextPool&) = delete;
@@ -27,14 +27,21 @@ public:
 
     // must check Size()>0 before
     asio::io_context& GetIOContext();
+    asio::io_context& GetIOContext(size_t idx) { return *(io_contexts_[idx]); }
+
+    // index of the loop running in current thread, -1 if not in this pool
+    int CurrentIndex() const;
 
 private:
     void runLoop(const std::shared_ptr<asio::io_context>& ctx, int i);
+    void pinCore(int i);
 
 private:
     using WorkGuard = asio::executor_work_guard<asio::io_context::executor_type>;
 
     const size_t pool_size_ = 0;
+    const bool pin_cores_ = false;
+    const size_t cpu_offset_ = 0;
 
     std::vector<std::shared_ptr<asio::io_context>> io_contexts_;
     std::vector<WorkGuard> work_guards_;
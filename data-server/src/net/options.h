@@ -13,9 +13,35 @@ struct SessionOptions {
     size_t write_timeout_ms = 5000;
 
     // max pending writes per connection
-    // TODO: limit memory usage
     size_t write_queue_capacity = 2000;
 
+    // max pending write bytes per connection
+    size_t write_queue_bytes = 64 << 20;
+
+    // max pending write bytes of all connections
+    size_t total_write_bytes = 1024 << 20;
+
+    // when any of the write limits above is reached, the connection stops
+    // reading new requests until its pending writes drop below half of the
+    // limit (or the total drops below the limit)
+
+    // max bytes gathered into one write
+    size_t max_gather_bytes = 1 << 20;
+
+    // max requests in flight per ordered stream, reading pauses when a
+    // stream reaches it until it drops below half
+    // a zero value means no limit
+    size_t stream_window = 256;
+
+    // a request of an ordered stream without response after its head
+    // timeout (or this if the head has none) no longer holds back the
+    // responses behind it
+    size_t stream_timeout_ms = 3000;
+
+    // bytes a stream may write per round when several streams have
+    // responses ready (deficit round robin)
+    size_t stream_quantum = 64 << 10;
+
     // allowed max packet length when read
     size_t max_packet_length = 10 << 20;
 };
@@ -28,6 +54,11 @@ struct ServerOptions {
     // exceeded connections will be rejected
     size_t max_connections = 50000;
 
+    // pin the i-th io thread to cpu (cpu_offset + i) % cpus,
+    // and allocate its memory from the local numa node
+    bool pin_cores = false;
+    size_t cpu_offset = 0;
+
     // options about session
     SessionOptions session_opt;
 };
@@ -11,6 +11,7 @@ namespace net {
 void Head::SetResp(const Head& req) {
     func_id = req.func_id;
     msg_id = req.msg_id;
+    stream_hash = req.stream_hash;
     proto_type = req.proto_type;
     if (req.msg_type == kAdminRequestType) {
         msg_type = kAdminResponseType;
@@ -20,6 +20,11 @@ static const uint32_t kMaxBodyLength = 20 * 1024 * 1024;  // 20Mb
 
 static const uint16_t kHeartbeatFuncID = 0;
 
+// the lowest bit of stream_hash is the fast worker flag of data requests,
+// the other bits are the stream id. responses of a non-zero stream are
+// written in the order of its requests, stream 0 is unordered
+static const uint8_t kStreamShift = 1;
+
 struct Head {
     uint32_t magic = kMagic;
     uint16_t version = kCurrentVersion;
@@ -34,6 +39,8 @@ struct Head {
     // set from a request head, self is a response head
     void SetResp(const Head& req);
 
+    uint8_t StreamID() const { return stream_hash >> kStreamShift; }
+
     // encode to network byte order
     void Encode();
     // decode network byte order to host order
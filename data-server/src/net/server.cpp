@@ -12,7 +12,7 @@ namespace net {
 Server::Server(const ServerOptions& opt)
     : opt_(opt),
       acceptor_(context_),
-      context_pool_(new IOContextPool(opt.io_threads_num)) {}
+      context_pool_(new IOContextPool(opt.io_threads_num, opt.pin_cores, opt.cpu_offset)) {}
 
 Server::~Server() { Stop(); }
 
@@ -74,6 +74,12 @@ void Server::doAccept() {
     });
 }
 
+size_t Server::IOThreadsNum() const { return context_pool_->Size(); }
+
+asio::io_context& Server::GetIOContext(size_t idx) { return context_pool_->GetIOContext(idx); }
+
+int Server::CurrentThreadIndex() const { return context_pool_->CurrentIndex(); }
+
 asio::io_context& Server::getContext() {
     if (context_pool_->Size() > 0) {
         return context_pool_->GetIOContext();
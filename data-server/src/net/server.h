@@ -28,6 +28,12 @@ public:
 
     void Stop();
 
+    // io threads, the same index as CurrentThreadIndex()
+    size_t IOThreadsNum() const;
+    asio::io_context& GetIOContext(size_t idx);
+    // index of the io thread running in current thread, -1 if not an io thread
+    int CurrentThreadIndex() const;
+
 private:
     void doAccept();
     asio::io_context& getContext();
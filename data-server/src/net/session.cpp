@@ -1,9 +1,13 @@
 #include "session.h"
 
+#include <asio/dispatch.hpp>
 #include <asio/read.hpp>
 #include <asio/write.hpp>
 #include <asio/read_until.hpp>
 
+#include <string.h>
+#include <algorithm>
+
 #include "frame/sf_logger.h"
 
 namespace sharkstore {
@@ -11,10 +15,28 @@ namespace dataserver {
 namespace net {
 
 std::atomic<uint64_t> Session::total_count_ = {0};
+std::atomic<uint64_t> Session::id_seed_ = {0};
+std::atomic<uint64_t> Session::total_write_bytes_ = {0};
+
+// max messages gathered into one write
+static const size_t kMaxGatherMessages = 64;
+// recheck interval of a session paused by the total write limit
+static const int kResumeCheckMs = 5;
+// check interval of timed out requests of ordered streams
+static const int kStreamCheckMs = 100;
+
+static size_t messageBytes(const Message& msg) {
+    return msg.encoded ? msg.body.size() : kHeadSize + msg.body.size();
+}
 
 Session::Session(const SessionOptions& opt, const Handler & handler,
                  asio::ip::tcp::socket socket)
-    : opt_(opt), handler_(handler), socket_(std::move(socket)) {
+    : opt_(opt),
+      handler_(handler),
+      socket_(std::move(socket)),
+      id_num_(++id_seed_),
+      resume_timer_(socket_.get_executor()),
+      stream_timer_(socket_.get_executor()) {
     ++total_count_;
 }
 
@@ -40,6 +62,7 @@ bool Session::init() {
         return false;
     }
 
+    session_ctx_.session_id = id_num_;
     session_ctx_.session = shared_from_this();
     id_ = std::string("S[") + session_ctx_.remote_addr + "]";
 
@@ -65,8 +88,17 @@ void Session::doClose() {
     closed_ = true;
     asio::error_code ec;
     socket_.close(ec);
+    resume_timer_.cancel(ec);
+    stream_timer_.cancel(ec);
     (void)ec;
 
+    total_write_bytes_ -= write_bytes_;
+    write_bytes_ = 0;
+    write_count_ = 0;
+    streams_.clear();
+    active_streams_.clear();
+    window_stream_ = nullptr;
+
     session_ctx_.session.reset();
 
     FLOG_INFO("%s closed. ", id_.c_str());
@@ -105,7 +137,7 @@ void Session::readBody() {
             msg->head.SetResp(head_);
             Write(msg);
         }
-        readHead();
+        readNext();
         return;
     }
 
@@ -117,9 +149,10 @@ void Session::readBody() {
                              auto msg = NewMessage();
                              msg->head = head_;
                              msg->body = std::move(body_);
+                             addPending(head_);
                              handler_(session_ctx_, msg);
 
-                             readHead();
+                             readNext();
                          } else {
                              if (ec == asio::error::eof) {
                                  FLOG_INFO("%s read rpc body error: %s", id_.c_str(),
@@ -133,25 +166,279 @@ void Session::readBody() {
                      });
 }
 
+bool Session::writeLimited(bool resume) const {
+    // resume below half of the per session limits to avoid flapping
+    auto shift = resume ? 1 : 0;
+    return write_count_ >= (opt_.write_queue_capacity >> shift) ||
+           write_bytes_ >= (opt_.write_queue_bytes >> shift) ||
+           total_write_bytes_ >= opt_.total_write_bytes;
+}
+
+bool Session::streamLimited(bool resume) const {
+    // requests of one connection share a tcp stream, so a stream reaching
+    // its window can only be held back by pausing the whole connection
+    if (window_stream_ == nullptr) return false;
+    auto pending = window_stream_->pending.size();
+    if (!resume) return pending >= opt_.stream_window;
+    // a window of 1 would give a threshold of 0 that can never be undercut
+    return !(pending < std::max<size_t>(1, opt_.stream_window >> 1));
+}
+
+void Session::readNext() {
+    if (closed_) return;
+
+    if (last_stream_ != 0 && opt_.stream_window > 0 && window_stream_ == nullptr) {
+        auto& s = streams_[last_stream_];
+        if (s.pending.size() >= opt_.stream_window) {
+            window_stream_ = &s;
+        }
+    }
+
+    bool write_limited = writeLimited(false);
+    if (write_limited || streamLimited(false)) {
+        write_paused_ = write_paused_ || write_limited;
+        if (!read_paused_) {
+            read_paused_ = true;
+            FLOG_WARN("%s pause reading, pending writes: %lu, bytes: %lu, total bytes: %lu, "
+                      "stream window: %d",
+                      id_.c_str(), write_count_, write_bytes_, total_write_bytes_.load(),
+                      streamLimited(false));
+        }
+        // nothing of our own to wait for, only other sessions can release
+        // the total limit, check it later
+        if (write_count_ == 0 && write_limited) {
+            auto self(shared_from_this());
+            resume_timer_.expires_after(std::chrono::milliseconds(kResumeCheckMs));
+            resume_timer_.async_wait([this, self](std::error_code ec) {
+                if (!ec) checkResume();
+            });
+        }
+        return;
+    }
+
+    window_stream_ = nullptr;
+    write_paused_ = false;
+    if (read_paused_) {
+        read_paused_ = false;
+        FLOG_INFO("%s resume reading", id_.c_str());
+    }
+    readHead();
+}
+
+void Session::checkResume() {
+    if (!read_paused_ || closed_) return;
+
+    // only the limits reached when pausing need to drop below half
+    if (write_count_ == 0 && !streamLimited(true)) {
+        readNext();
+    } else if (!writeLimited(write_paused_) && !streamLimited(true)) {
+        window_stream_ = nullptr;
+        write_paused_ = false;
+        read_paused_ = false;
+        FLOG_INFO("%s resume reading", id_.c_str());
+        readHead();
+    }
+}
+
+void Session::addPending(const Head& head) {
+    last_stream_ = head.StreamID();
+    if (last_stream_ == 0 ||
+        (head.msg_type != kDataRequestType && head.msg_type != kAdminRequestType)) {
+        return;
+    }
+
+    Pending p;
+    p.msg_id = head.msg_id;
+    auto timeout = head.timeout > 0 ? head.timeout : opt_.stream_timeout_ms;
+    p.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+    streams_[last_stream_].pending.push_back(std::move(p));
+
+    if (!stream_timer_running_) {
+        stream_timer_running_ = true;
+        auto self(shared_from_this());
+        stream_timer_.expires_after(std::chrono::milliseconds(kStreamCheckMs));
+        stream_timer_.async_wait([this, self](std::error_code ec) {
+            stream_timer_running_ = false;
+            if (!ec && !closed_) checkStreams();
+        });
+    }
+}
+
+void Session::checkStreams() {
+    // the requests got no response in time (expired in the worker queue
+    // e.g.), don't let them hold back the later responses
+    auto now = std::chrono::steady_clock::now();
+    bool has_pending = false;
+    size_t skipped = 0;
+    for (auto& it : streams_) {
+        auto& s = it.second;
+        while (!s.pending.empty() && s.pending.front().resp == nullptr &&
+               s.pending.front().deadline <= now) {
+            s.pending.pop_front();
+            ++skipped;
+        }
+        flushStream(it.first, s);
+        has_pending = has_pending || !s.pending.empty();
+    }
+    if (skipped > 0) {
+        FLOG_WARN("%s skip %lu timed out requests of ordered streams", id_.c_str(), skipped);
+    }
+
+    if (writing_msgs_.empty() && !active_streams_.empty()) {
+        doWrite();
+    }
+    checkResume();
+
+    if (has_pending && !stream_timer_running_) {
+        stream_timer_running_ = true;
+        auto self(shared_from_this());
+        stream_timer_.expires_after(std::chrono::milliseconds(kStreamCheckMs));
+        stream_timer_.async_wait([this, self](std::error_code ec) {
+            stream_timer_running_ = false;
+            if (!ec && !closed_) checkStreams();
+        });
+    }
+}
+
+void Session::enqueue(const MessagePtr& msg) {
+    if (!msg->encoded) {
+        ++write_count_;
+        route(msg->head.StreamID(), msg->head.msg_id, msg);
+        return;
+    }
+
+    // an encoded message may hold frames of several requests
+    struct Frame {
+        size_t offset;
+        size_t length;
+        uint8_t stream;
+        uint64_t msg_id;
+    };
+    std::vector<Frame> frames;
+    bool ordered = false;
+    size_t offset = 0;
+    while (offset + kHeadSize <= msg->body.size()) {
+        Head head;
+        memcpy(&head, msg->body.data() + offset, kHeadSize);
+        head.Decode();
+        auto length = kHeadSize + static_cast<size_t>(head.body_length);
+        if (offset + length > msg->body.size()) break;
+        frames.push_back(Frame{offset, length, head.StreamID(), head.msg_id});
+        ordered = ordered || head.StreamID() != 0;
+        offset += length;
+    }
+
+    if (!ordered || offset != msg->body.size()) {
+        ++write_count_;
+        route(0, 0, msg);
+    } else if (frames.size() == 1) {
+        ++write_count_;
+        route(frames[0].stream, frames[0].msg_id, msg);
+    } else {
+        for (const auto& f : frames) {
+            auto frame = NewMessage();
+            frame->encoded = true;
+            frame->body.assign(msg->body.begin() + f.offset,
+                               msg->body.begin() + f.offset + f.length);
+            ++write_count_;
+            route(f.stream, f.msg_id, frame);
+        }
+    }
+}
+
+void Session::route(uint8_t stream, uint64_t msg_id, const MessagePtr& msg) {
+    auto& s = streams_[stream];
+    if (stream != 0) {
+        for (auto& p : s.pending) {
+            if (p.msg_id == msg_id && p.resp == nullptr) {
+                p.resp = msg;
+                flushStream(stream, s);
+                return;
+            }
+        }
+    }
+    // unordered, or no request waiting for it (a streaming response, or
+    // the request has timed out), write as is
+    pushReady(stream, s, msg);
+}
+
+void Session::pushReady(uint8_t stream, Stream& s, const MessagePtr& msg) {
+    s.ready.push_back(msg);
+    if (!s.active) {
+        s.active = true;
+        active_streams_.push_back(stream);
+    }
+}
+
+void Session::flushStream(uint8_t stream, Stream& s) {
+    while (!s.pending.empty() && s.pending.front().resp != nullptr) {
+        pushReady(stream, s, s.pending.front().resp);
+        s.pending.pop_front();
+    }
+}
+
 void Session::doWrite() {
     auto self(shared_from_this());
 
-    // prepare write buffer
-    auto msg = write_msgs_.front();
-    msg->head.body_length = static_cast<uint32_t>(msg->body.size());
-    msg->head.Encode();
-    std::vector<asio::const_buffer> buffers{
-        asio::buffer(&msg->head, sizeof(msg->head)),
-        asio::buffer(msg->body.data(), msg->body.size())
-    };
+    // gather ready messages into one write, streams take turns by deficit
+    // round robin so that a stream of large responses can't starve others
+    write_buffers_.clear();
+    writing_msgs_.clear();
+    size_t bytes = 0;
+    bool full = false;
+    while (!full && !active_streams_.empty()) {
+        auto id = active_streams_.front();
+        auto& s = streams_[id];
+        if (!s.in_turn) {
+            s.in_turn = true;
+            s.deficit += opt_.stream_quantum;
+        }
+        while (!s.ready.empty()) {
+            const auto& msg = s.ready.front();
+            auto size = messageBytes(*msg);
+            if (size > s.deficit) break;
+            if (writing_msgs_.size() >= kMaxGatherMessages ||
+                (!writing_msgs_.empty() && bytes + size > opt_.max_gather_bytes)) {
+                full = true;
+                break;
+            }
+            if (!msg->encoded) {
+                msg->head.body_length = static_cast<uint32_t>(msg->body.size());
+                msg->head.Encode();
+                write_buffers_.push_back(asio::buffer(&msg->head, sizeof(msg->head)));
+            }
+            write_buffers_.push_back(asio::buffer(msg->body.data(), msg->body.size()));
+            writing_msgs_.push_back(msg);
+            bytes += size;
+            s.deficit -= size;
+            s.ready.pop_front();
+        }
+        if (full) break;
+
+        // turn finished
+        s.in_turn = false;
+        active_streams_.pop_front();
+        if (s.ready.empty()) {
+            s.active = false;
+            s.deficit = 0;
+        } else {
+            active_streams_.push_back(id);
+        }
+    }
+
+    asio::async_write(socket_, write_buffers_,
+                      [this, self, bytes](std::error_code ec, std::size_t /*length*/) {
+                          if (closed_) return;
 
-    asio::async_write(socket_, buffers,
-                      [this, self](std::error_code ec, std::size_t /*length*/) {
                           if (!ec) {
-                              write_msgs_.pop_front();
-                              if (!write_msgs_.empty()) {
+                              write_count_ -= writing_msgs_.size();
+                              writing_msgs_.clear();
+                              write_bytes_ -= bytes;
+                              total_write_bytes_ -= bytes;
+                              if (!active_streams_.empty()) {
                                   doWrite();
                               }
+                              checkResume();
                           } else {
                               FLOG_ERROR("%s write message error: %s", id_.c_str(), ec.message().c_str());
                               doClose();
@@ -161,10 +448,16 @@ void Session::doWrite() {
 
 void Session::Write(const MessagePtr& msg) {
     auto self(shared_from_this());
-    asio::post(socket_.get_io_context(), [self, msg] {
-        bool write_in_progress = !self->write_msgs_.empty();
-        self->write_msgs_.push_back(msg);
-        if (!write_in_progress) {
+    // run inline if called from the session's own io thread
+    asio::dispatch(socket_.get_io_context(), [self, msg] {
+        if (self->closed_) return;
+
+        auto bytes = messageBytes(*msg);
+        self->write_bytes_ += bytes;
+        self->total_write_bytes_ += bytes;
+
+        self->enqueue(msg);
+        if (self->writing_msgs_.empty() && !self->active_streams_.empty()) {
             self->doWrite();
         }
     });
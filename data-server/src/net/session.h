@@ -1,8 +1,11 @@
 _Pragma("once");
 
+#include <chrono>
 #include <queue>
 #include <memory>
+#include <unordered_map>
 #include <asio/ip/tcp.hpp>
+#include <asio/steady_timer.hpp>
 #include <asio/streambuf.hpp>
 
 #include "handler.h"
@@ -25,6 +28,11 @@ public:
     Session& operator=(const Session&) = delete;
 
     static uint64_t TotalCount() { return total_count_; }
+    // pending write bytes of all sessions
+    static uint64_t TotalWriteBytes() { return total_write_bytes_; }
+
+    uint64_t Id() const { return id_num_; }
+    bool Closed() const { return closed_; }
 
     void Write(const MessagePtr& msg);
 
@@ -33,13 +41,45 @@ private:
     void doClose();
     void doWrite();
 
+    // read next request, or pause reading if write limits are reached
+    void readNext();
+    bool writeLimited(bool resume) const;
+    void checkResume();
+
     void readHead();
     void readBody();
 
+    // ordered streams
+    struct Pending {
+        uint64_t msg_id = 0;
+        std::chrono::steady_clock::time_point deadline;
+        MessagePtr resp;  // arrived before the former requests' responses
+    };
+
+    struct Stream {
+        std::deque<Pending> pending;   // requests in flight, in arrival order
+        std::deque<MessagePtr> ready;  // responses can be written, in order
+        size_t deficit = 0;            // bytes can write in current round
+        bool in_turn = false;
+        bool active = false;           // in active_streams_
+    };
+
+    void addPending(const Head& head);
+    // split encoded frames and queue them to their streams
+    void enqueue(const MessagePtr& msg);
+    void route(uint8_t stream, uint64_t msg_id, const MessagePtr& msg);
+    void pushReady(uint8_t stream, Stream& s, const MessagePtr& msg);
+    // move in order responses at the front of pending to ready
+    void flushStream(uint8_t stream, Stream& s);
+    void checkStreams();
+    bool streamLimited(bool resume) const;
+
 private:
 
     // all server's sessions count
     static std::atomic<uint64_t> total_count_;
+    static std::atomic<uint64_t> id_seed_;
+    static std::atomic<uint64_t> total_write_bytes_;
 
     const SessionOptions& opt_;
     const Handler& handler_;
@@ -47,13 +87,30 @@ private:
     asio::ip::tcp::socket socket_;
     Context session_ctx_;
     std::string id_;
+    const uint64_t id_num_;
 
     std::atomic<bool> closed_ = {false};
 
     Head head_;
     std::vector<uint8_t> body_;
 
-    std::deque<MessagePtr> write_msgs_;
+    // stream id -> stream, stream 0 holds unordered responses
+    std::unordered_map<uint8_t, Stream> streams_;
+    // streams have ready responses, scheduled round robin
+    std::deque<uint8_t> active_streams_;
+    size_t write_count_ = 0;     // pending messages, ready or waiting order
+    size_t write_bytes_ = 0;     // pending bytes
+    std::vector<MessagePtr> writing_msgs_;  // messages in the current write
+    std::vector<asio::const_buffer> write_buffers_;
+
+    uint8_t last_stream_ = 0;       // stream of the last read request
+    Stream* window_stream_ = nullptr;  // stream reached its window
+    bool stream_timer_running_ = false;
+    asio::steady_timer stream_timer_;
+
+    bool read_paused_ = false;
+    bool write_paused_ = false;  // paused by write limits
+    asio::steady_timer resume_timer_;
 };
 
 }  // namespace net
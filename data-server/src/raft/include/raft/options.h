@@ -1,7 +1,9 @@
 _Pragma("once");
 
 #include <chrono>
+#include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "raft/node_resolver.h"
@@ -10,6 +12,13 @@ _Pragma("once");
 namespace sharkstore {
 namespace raft {
 
+// raft日志记录和复制消息的压缩算法，需要编译时启用对应的库
+enum class CompressionType : uint8_t {
+    kNone = 0,
+    kLZ4 = 1,
+    kZstd = 2,
+};
+
 struct TransportOptions {
     // 进程内网络传输, 测试
     bool use_inprocess_transport = false;
@@ -29,6 +38,12 @@ struct TransportOptions {
     // 接收IO线程数量(Server端)
     size_t recv_io_threads = 4;
 
+    // 合并发往同一节点的消息时，单个网络包的最大字节数，0表示不合并
+    // 不能超过对端网络层允许的最大包大小(max_pkg_size)
+    // 旧版本节点不能解析合并的包，默认不合并，所有节点升级后再开启
+    // 开启后也只对已确认支持batch的对端节点合并(收到过对端新版本的包)，其余仍逐条发送
+    size_t max_batch_bytes = 0;
+
     Status Validate() const;
 };
 
@@ -84,6 +99,15 @@ struct RaftServerOptions {
 
     // 复制batch数量（按字节大小）
     uint64_t max_size_per_msg = 1024 * 1024;
+    // 复制batch的下限，实际大小根据ack往返时间在[min, max]之间自适应调整
+    // 不小于max_size_per_msg时大小固定
+    uint64_t min_size_per_msg = 64 * 1024;
+
+    // 单个副本复制pipeline量（按字节），0表示不限制
+    uint64_t max_inflight_bytes = 32 * 1024 * 1024;
+    // 节点所有raft group正在复制中的数据总量（按字节），在活跃的group之间公平分配
+    // 0表示不限制
+    uint64_t max_outbound_bytes = 512 * 1024 * 1024;
 
     // raft一致性线程数量
     uint8_t consensus_threads_num = 4;
@@ -97,6 +121,26 @@ struct RaftServerOptions {
     // apply队列长度
     size_t apply_queue_capacity = 100000;
 
+    // 每隔多久按各线程的忙碌时间把热点raft迁移到较闲的consensus/apply线程，0表示不迁移
+    // 默认不迁移
+    std::chrono::seconds thread_balance_interval = std::chrono::seconds(0);
+    // 最忙和最闲线程的忙碌时间之差超过统计周期的百分之多少时才迁移
+    unsigned thread_balance_threshold = 10;
+
+    // raft日志记录和发往对端的复制消息的压缩算法
+    // 对端不支持该算法时复制消息不压缩发送
+    CompressionType compression = CompressionType::kNone;
+    // 日志记录或者一个复制网络包超过多少字节才压缩
+    size_t compression_threshold = 4 * 1024;
+
+    // 创建各类线程(consensus、apply、transport、tick)之前以类别调用，返回的对象在该类线程创建完后释放
+    // 新线程继承创建者的cpu亲和性和内存策略，调用方可以借此按类别放置线程，为空时不处理
+    std::function<std::shared_ptr<void>(const std::string& kind)> thread_scope;
+
+    // 采样追踪：提交时带了trace_id的日志，在leader和follower上经过各阶段时调用
+    // 在consensus和apply线程中执行，需要尽快返回，为空时不追踪
+    std::function<void(const TraceEvent& event)> trace_recorder;
+
     TransportOptions transport_options;
     SnapshotOptions snapshot_options;
 
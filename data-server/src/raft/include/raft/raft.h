@@ -21,7 +21,8 @@ public:
 
     virtual Status TryToLeader() = 0;
 
-    virtual Status Submit(std::string& cmd) = 0;
+    // trace_id非0时该日志在leader和follower上的各阶段都会回调trace_recorder
+    virtual Status Submit(std::string& cmd, uint64_t trace_id = 0) = 0;
     virtual Status ChangeMemeber(const ConfChange& conf) = 0;
 
     virtual void GetStatus(RaftStatus* status) const = 0;
@@ -13,6 +13,14 @@ struct ServerStatus {
     uint64_t total_snap_applying = 0;
     uint64_t total_snap_sending = 0;
     uint64_t total_rafts_count = 0;
+
+    // 正在复制中（未收到ack）的字节数和有在途数据的raft数量
+    uint64_t outbound_bytes = 0;
+    uint64_t outbound_rafts = 0;
+
+    // consensus和apply线程队列中待处理的任务数
+    uint64_t consensus_queue_size = 0;
+    uint64_t apply_queue_size = 0;
 };
 
 struct ReplicaStatus {
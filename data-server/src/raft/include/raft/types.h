@@ -33,5 +33,29 @@ struct ConfChange {
     std::string ToString() const;
 };
 
+// 采样追踪的日志在raft中经过的阶段
+enum class TraceStage : char {
+    kAppend,    // leader追加到本地日志
+    kReceive,   // follower收到leader复制的日志
+    kPersist,   // 日志持久化完成
+    kSend,      // leader发送给follower
+    kAck,       // leader收到follower的确认
+    kCommit,    // 已提交，交给状态机
+    kApply,     // 开始应用
+    kApplied,   // 应用完成
+};
+
+const char* TraceStageName(TraceStage stage);
+
+struct TraceEvent {
+    uint64_t trace_id = 0;
+    uint64_t raft_id = 0;
+    TraceStage stage = TraceStage::kAppend;
+    // 相关的节点：kReceive为leader，kSend和kAck为follower，其他为0
+    uint64_t node = 0;
+    // 发生的时间，微秒
+    int64_t time = 0;
+};
+
 } /* namespace raft */
 } /* namespace sharkstore */
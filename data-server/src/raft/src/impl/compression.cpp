@@ -0,0 +1,174 @@
+#include "compression.h"
+
+#include <string.h>
+#include "base/byte_order.h"
+
+#ifdef SHARK_USE_LZ4
+#include <lz4.h>
+#endif
+#ifdef SHARK_USE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace sharkstore {
+namespace raft {
+namespace impl {
+
+#ifdef SHARK_USE_ZSTD
+// 复制和日志写入都在关键路径上，用较低的压缩级别换取速度
+static const int kZstdLevel = 1;
+#endif
+
+static inline uint8_t compressionBit(CompressionType type) {
+    return static_cast<uint8_t>(1U << static_cast<uint8_t>(type));
+}
+
+uint8_t SupportedCompressions() {
+    uint8_t types = compressionBit(CompressionType::kNone);
+#ifdef SHARK_USE_LZ4
+    types |= compressionBit(CompressionType::kLZ4);
+#endif
+#ifdef SHARK_USE_ZSTD
+    types |= compressionBit(CompressionType::kZstd);
+#endif
+    return types;
+}
+
+bool CompressionSupported(CompressionType type) {
+    return static_cast<uint8_t>(type) < 8 &&
+           (SupportedCompressions() & compressionBit(type)) != 0;
+}
+
+const char* CompressionName(CompressionType type) {
+    switch (type) {
+        case CompressionType::kNone:
+            return "none";
+        case CompressionType::kLZ4:
+            return "lz4";
+        case CompressionType::kZstd:
+            return "zstd";
+        default:
+            return "unknown";
+    }
+}
+
+bool Compress(CompressionType type, const char* data, size_t len, std::string* out) {
+    size_t cap = MaxCompressedLength(type, len);
+    if (cap == 0) return false;
+
+    const size_t origin = out->size();
+    out->resize(origin + cap);
+    size_t compressed = Compress(type, data, len, &(*out)[origin], cap);
+    out->resize(origin + compressed);
+    return compressed > 0;
+}
+
+size_t MaxCompressedLength(CompressionType type, size_t len) {
+    if (type == CompressionType::kNone || !CompressionSupported(type) ||
+        len <= kCompressHeaderSize || len > kMaxUncompressedSize) {
+        return 0;
+    }
+
+    switch (type) {
+#ifdef SHARK_USE_LZ4
+        case CompressionType::kLZ4: {
+            int bound = LZ4_compressBound(static_cast<int>(len));
+            return bound > 0 ? kCompressHeaderSize + static_cast<size_t>(bound) : 0;
+        }
+#endif
+#ifdef SHARK_USE_ZSTD
+        case CompressionType::kZstd:
+            return kCompressHeaderSize + ZSTD_compressBound(len);
+#endif
+        default:
+            return 0;
+    }
+}
+
+size_t Compress(CompressionType type, const char* data, size_t len, char* out, size_t cap) {
+    size_t bound = MaxCompressedLength(type, len);
+    if (bound == 0 || cap < bound) {
+        return 0;
+    }
+    bound -= kCompressHeaderSize;
+
+    size_t compressed = 0;
+    switch (type) {
+#ifdef SHARK_USE_LZ4
+        case CompressionType::kLZ4: {
+            int ret = LZ4_compress_default(data, out + kCompressHeaderSize,
+                                           static_cast<int>(len), static_cast<int>(bound));
+            if (ret > 0) compressed = static_cast<size_t>(ret);
+            break;
+        }
+#endif
+#ifdef SHARK_USE_ZSTD
+        case CompressionType::kZstd: {
+            size_t ret = ZSTD_compress(out + kCompressHeaderSize, bound, data, len, kZstdLevel);
+            if (!ZSTD_isError(ret)) compressed = ret;
+            break;
+        }
+#endif
+        default:
+            break;
+    }
+
+    // 压缩失败或者没有收益
+    if (compressed == 0 || compressed + kCompressHeaderSize >= len) {
+        return 0;
+    }
+
+    uint32_t raw_len = htobe32(static_cast<uint32_t>(len));
+    memcpy(out, &raw_len, sizeof(raw_len));
+    return kCompressHeaderSize + compressed;
+}
+
+Status Uncompress(CompressionType type, const char* data, size_t len,
+                  std::vector<char>* out) {
+    if (!CompressionSupported(type) || type == CompressionType::kNone) {
+        return Status(Status::kNotSupported, "uncompress", CompressionName(type));
+    }
+    if (len < kCompressHeaderSize) {
+        return Status(Status::kCorruption, "uncompress", "insufficient header size");
+    }
+
+    uint32_t raw_len = 0;
+    memcpy(&raw_len, data, sizeof(raw_len));
+    raw_len = be32toh(raw_len);
+    if (raw_len > kMaxUncompressedSize) {
+        return Status(Status::kCorruption, "uncompress invalid length",
+                      std::to_string(raw_len));
+    }
+    data += kCompressHeaderSize;
+    len -= kCompressHeaderSize;
+
+    out->resize(raw_len);
+    bool ok = false;
+    switch (type) {
+#ifdef SHARK_USE_LZ4
+        case CompressionType::kLZ4: {
+            int ret = LZ4_decompress_safe(data, out->data(), static_cast<int>(len),
+                                          static_cast<int>(raw_len));
+            ok = (ret >= 0 && static_cast<uint32_t>(ret) == raw_len);
+            break;
+        }
+#endif
+#ifdef SHARK_USE_ZSTD
+        case CompressionType::kZstd: {
+            size_t ret = ZSTD_decompress(out->data(), raw_len, data, len);
+            ok = (!ZSTD_isError(ret) && ret == raw_len);
+            break;
+        }
+#endif
+        default:
+            break;
+    }
+    if (!ok) {
+        return Status(Status::kCorruption, "uncompress", CompressionName(type));
+    }
+    return Status::OK();
+}
+
+} /* namespace impl */
+} /* namespace raft */
+} /* namespace sharkstore */
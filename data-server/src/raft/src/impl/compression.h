@@ -0,0 +1,44 @@
+_Pragma("once");
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "base/status.h"
+#include "raft/options.h"
+
+namespace sharkstore {
+namespace raft {
+namespace impl {
+
+// 压缩块格式：
+// | 原始长度(4字节大端) | 压缩数据 |
+static const size_t kCompressHeaderSize = sizeof(uint32_t);
+
+// 解压后的最大长度，防止数据损坏时分配过大的内存
+static const size_t kMaxUncompressedSize = 1024 * 1024 * 1024;
+
+// 本节点编译时支持的压缩算法，第n位表示CompressionType值为n的算法
+uint8_t SupportedCompressions();
+
+bool CompressionSupported(CompressionType type);
+
+const char* CompressionName(CompressionType type);
+
+// 压缩data，压缩块追加到out末尾
+// 不支持该算法或者压缩后没有变小时返回false，out保持不变
+bool Compress(CompressionType type, const char* data, size_t len, std::string* out);
+
+// 压缩块的最大长度，不支持该算法时返回0
+size_t MaxCompressedLength(CompressionType type, size_t len);
+
+// 同上，压缩块直接写到out，cap至少为MaxCompressedLength
+// 返回压缩块的长度，不支持该算法或者压缩后没有变小时返回0
+size_t Compress(CompressionType type, const char* data, size_t len, char* out, size_t cap);
+
+// 解压Compress生成的压缩块
+Status Uncompress(CompressionType type, const char* data, size_t len,
+                  std::vector<char>* out);
+
+} /* namespace impl */
+} /* namespace raft */
+} /* namespace sharkstore */
@@ -0,0 +1,102 @@
+#include "flow_control.h"
+
+#include <algorithm>
+
+namespace sharkstore {
+namespace raft {
+namespace impl {
+
+// 每隔多少个采样让最小往返时间向平滑值靠拢，适应网络路径的变化
+static const uint64_t kMinRTTWindow = 256;
+
+FlowBudget::FlowBudget(uint64_t capacity) : capacity_(capacity) {}
+
+bool FlowBudget::Allow(uint64_t group_used, uint64_t bytes) const {
+    // 每个group至少允许有一条在途消息，避免饿死
+    if (capacity_ == 0 || group_used == 0) {
+        return true;
+    }
+
+    uint64_t active = std::max<uint64_t>(active_groups_, 1);
+    uint64_t share = capacity_ / active;
+    if (group_used + bytes > share) {
+        return false;
+    }
+    return used_ + bytes <= capacity_;
+}
+
+void FlowBudget::Acquire(uint64_t group_used, uint64_t bytes) {
+    if (bytes == 0) return;
+    if (group_used == 0) {
+        ++active_groups_;
+    }
+    used_ += bytes;
+}
+
+void FlowBudget::Release(uint64_t group_used, uint64_t bytes) {
+    if (bytes == 0) return;
+    used_ -= bytes;
+    if (group_used == bytes) {
+        --active_groups_;
+    }
+}
+
+FlowGroup::~FlowGroup() {
+    if (used_ > 0) {
+        Release(used_);
+    }
+}
+
+bool FlowGroup::Allow(uint64_t bytes) const {
+    return budget_ == nullptr || budget_->Allow(used_, bytes);
+}
+
+void FlowGroup::Acquire(uint64_t bytes) {
+    if (budget_ != nullptr) {
+        budget_->Acquire(used_, bytes);
+    }
+    used_ += bytes;
+}
+
+void FlowGroup::Release(uint64_t bytes) {
+    bytes = std::min(bytes, used_);
+    if (budget_ != nullptr) {
+        budget_->Release(used_, bytes);
+    }
+    used_ -= bytes;
+}
+
+AdaptiveMsgSize::AdaptiveMsgSize(uint64_t min_size, uint64_t max_size)
+    : min_size_(std::min(min_size, max_size)), max_size_(max_size), size_(max_size) {}
+
+void AdaptiveMsgSize::OnAck(std::chrono::microseconds rtt) {
+    if (rtt.count() <= 0) {
+        rtt = std::chrono::microseconds(1);
+    }
+
+    if (samples_ == 0) {
+        srtt_ = rtt;
+        min_rtt_ = rtt;
+    } else {
+        srtt_ = (srtt_ * 7 + rtt) / 8;
+        min_rtt_ = std::min(min_rtt_, rtt);
+    }
+    if (++samples_ % kMinRTTWindow == 0) {
+        min_rtt_ = (min_rtt_ + srtt_) / 2;
+    }
+
+    if (srtt_ > min_rtt_ * 2) {
+        // 出现排队，每个往返时间最多减半一次
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_decrease_ >= srtt_) {
+            size_ = std::max(min_size_, size_ / 2);
+            last_decrease_ = now;
+        }
+    } else if (srtt_ * 4 < min_rtt_ * 5) {
+        size_ = std::min(max_size_, size_ + std::max<uint64_t>(size_ / 8, 1));
+    }
+}
+
+} /* namespace impl */
+} /* namespace raft */
+} /* namespace sharkstore */
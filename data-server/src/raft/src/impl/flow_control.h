@@ -0,0 +1,84 @@
+_Pragma("once");
+
+#include <atomic>
+#include <chrono>
+#include "raft_types.h"
+
+namespace sharkstore {
+namespace raft {
+namespace impl {
+
+// 节点级别的复制出口流量预算（按字节），所有raft group共享
+// 每个group最多占用 capacity / 活跃group数 的份额，保证少量大流量group不会饿死其他group
+class FlowBudget {
+public:
+    // capacity为0表示不限制
+    explicit FlowBudget(uint64_t capacity);
+    ~FlowBudget() = default;
+
+    FlowBudget(const FlowBudget&) = delete;
+    FlowBudget& operator=(const FlowBudget&) = delete;
+
+    // group当前已占用group_used字节，是否还允许再发送bytes字节
+    bool Allow(uint64_t group_used, uint64_t bytes) const;
+
+    void Acquire(uint64_t group_used, uint64_t bytes);
+    void Release(uint64_t group_used, uint64_t bytes);
+
+    uint64_t Capacity() const { return capacity_; }
+    uint64_t Used() const { return used_; }
+    uint64_t ActiveGroups() const { return active_groups_; }
+
+private:
+    const uint64_t capacity_ = 0;
+    std::atomic<uint64_t> used_ = {0};
+    std::atomic<uint64_t> active_groups_ = {0};
+};
+
+// 单个raft group在FlowBudget中的占用, 只在该group的consensus线程中访问
+class FlowGroup {
+public:
+    explicit FlowGroup(FlowBudget* budget) : budget_(budget) {}
+    ~FlowGroup();
+
+    FlowGroup(const FlowGroup&) = delete;
+    FlowGroup& operator=(const FlowGroup&) = delete;
+
+    bool Allow(uint64_t bytes) const;
+    void Acquire(uint64_t bytes);
+    void Release(uint64_t bytes);
+
+    uint64_t Used() const { return used_; }
+
+private:
+    FlowBudget* budget_ = nullptr;
+    uint64_t used_ = 0;
+};
+
+// 根据日志复制的ack往返时间调整单条复制消息的大小
+// 往返时间明显高于历史最小值时认为链路拥塞，减半；否则逐步增大
+class AdaptiveMsgSize {
+public:
+    AdaptiveMsgSize(uint64_t min_size, uint64_t max_size);
+    ~AdaptiveMsgSize() = default;
+
+    uint64_t Size() const { return size_; }
+
+    void OnAck(std::chrono::microseconds rtt);
+
+    std::chrono::microseconds SmoothedRTT() const { return srtt_; }
+
+private:
+    const uint64_t min_size_ = 0;
+    const uint64_t max_size_ = 0;
+    uint64_t size_ = 0;
+
+    std::chrono::microseconds srtt_{0};
+    std::chrono::microseconds min_rtt_{0};
+    uint64_t samples_ = 0;
+    TimePoint last_decrease_;
+};
+
+} /* namespace impl */
+} /* namespace raft */
+} /* namespace sharkstore */
@@ -0,0 +1,82 @@
+_Pragma("once");
+
+#include <atomic>
+#include <utility>
+
+namespace sharkstore {
+namespace raft {
+namespace impl {
+
+// 无锁多生产者单消费者队列（无界）
+// 生产者入队只需要一次原子交换，出队顺序与入队时交换的先后顺序严格一致
+// 生产者交换完还未链接上时，消费者暂时看不到它及其之后的元素
+template <class T>
+class MPSCQueue {
+public:
+    MPSCQueue() : head_(new Node), tail_(head_) {}
+
+    ~MPSCQueue() {
+        T value;
+        while (Pop(&value)) {
+        }
+        delete head_;
+    }
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    // 可以在任意线程调用
+    void Push(const T& value) { link(new Node(value)); }
+    void Push(T&& value) { link(new Node(std::move(value))); }
+
+    // 只能在消费者线程调用
+    bool Pop(T* value) {
+        Node* next = head_->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return false;
+        }
+        *value = std::move(next->value);
+        delete head_;
+        head_ = next;
+        return true;
+    }
+
+    // 只能在消费者线程调用，最多取出max个追加到out，返回取出的个数
+    template <class Container>
+    size_t PopMany(Container* out, size_t max) {
+        size_t count = 0;
+        T value;
+        while (count < max && Pop(&value)) {
+            out->push_back(std::move(value));
+            ++count;
+        }
+        return count;
+    }
+
+    // 只能在消费者线程调用
+    bool Empty() const { return head_->next.load(std::memory_order_acquire) == nullptr; }
+
+private:
+    struct Node {
+        Node() = default;
+        explicit Node(const T& v) : value(v) {}
+        explicit Node(T&& v) : value(std::move(v)) {}
+
+        std::atomic<Node*> next = {nullptr};
+        T value;
+    };
+
+    void link(Node* node) {
+        Node* prev = tail_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+private:
+    // head_指向已经取出的哨兵节点，只被消费者访问
+    Node* head_ = nullptr;
+    std::atomic<Node*> tail_;
+};
+
+} /* namespace impl */
+} /* namespace raft */
+} /* namespace sharkstore */
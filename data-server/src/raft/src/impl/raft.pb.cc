@@ -137,6 +137,7 @@ const ::google::protobuf::uint32 TableStruct::offsets[] GOOGLE_ATTRIBUTE_SECTION
   GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Entry, index_),
   GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Entry, term_),
   GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Entry, data_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(Entry, trace_id_),
   ~0u,  // no _has_bits_
   GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(HeartbeatContext, _internal_metadata_),
   ~0u,  // no _extensions_
@@ -214,14 +215,14 @@ static const ::google::protobuf::internal::MigrationSchema schemas[] GOOGLE_ATTR
   { 0, -1, sizeof(Peer)},
   { 8, -1, sizeof(ConfChange)},
   { 16, -1, sizeof(Entry)},
-  { 25, -1, sizeof(HeartbeatContext)},
-  { 31, -1, sizeof(SnapshotMeta)},
-  { 40, -1, sizeof(Snapshot)},
-  { 50, -1, sizeof(Message)},
-  { 68, -1, sizeof(HardState)},
-  { 76, -1, sizeof(TruncateMeta)},
-  { 83, -1, sizeof(IndexItem)},
-  { 91, -1, sizeof(LogIndex)},
+  { 26, -1, sizeof(HeartbeatContext)},
+  { 32, -1, sizeof(SnapshotMeta)},
+  { 41, -1, sizeof(Snapshot)},
+  { 51, -1, sizeof(Message)},
+  { 69, -1, sizeof(HardState)},
+  { 77, -1, sizeof(TruncateMeta)},
+  { 84, -1, sizeof(IndexItem)},
+  { 92, -1, sizeof(LogIndex)},
 };
 
 static ::google::protobuf::Message const * const file_default_instances[] = {
@@ -310,48 +311,49 @@ void AddDescriptorsImpl() {
       "id\030\003 \001(\004\"\201\001\n\nConfChange\0225\n\004type\030\001 \001(\0162\'."
       "sharkstore.raft.impl.pb.ConfChangeType\022+"
       "\n\004Peer\030\002 \001(\0132\035.sharkstore.raft.impl.pb.P"
-      "eer\022\017\n\007context\030\003 \001(\014\"d\n\005Entry\0220\n\004type\030\001 "
+      "eer\022\017\n\007context\030\003 \001(\014\"v\n\005Entry\0220\n\004type\030\001 "
       "\001(\0162\".sharkstore.raft.impl.pb.EntryType\022"
       "\r\n\005index\030\002 \001(\004\022\014\n\004term\030\003 \001(\004\022\014\n\004data\030\004 \001"
-      "(\014\"\037\n\020HeartbeatContext\022\013\n\003ids\030\001 \003(\004\"j\n\014S"
-      "napshotMeta\022\r\n\005index\030\001 \001(\004\022\014\n\004term\030\002 \001(\004"
-      "\022,\n\005peers\030\003 \003(\0132\035.sharkstore.raft.impl.p"
-      "b.Peer\022\017\n\007context\030\004 \001(\014\"x\n\010Snapshot\022\014\n\004u"
-      "uid\030\001 \001(\004\0223\n\004meta\030\002 \001(\0132%.sharkstore.raf"
-      "t.impl.pb.SnapshotMeta\022\r\n\005datas\030\003 \003(\014\022\r\n"
-      "\005final\030\004 \001(\010\022\013\n\003seq\030\005 \001(\003\"\354\002\n\007Message\0222\n"
-      "\004type\030\001 \001(\0162$.sharkstore.raft.impl.pb.Me"
-      "ssageType\022\n\n\002id\030\002 \001(\004\022\014\n\004from\030\003 \001(\004\022\n\n\002t"
-      "o\030\004 \001(\004\022\014\n\004term\030\005 \001(\004\022\016\n\006commit\030\006 \001(\004\022\020\n"
-      "\010log_term\030\010 \001(\004\022\021\n\tlog_index\030\t \001(\004\022/\n\007en"
-      "tries\030\n \003(\0132\036.sharkstore.raft.impl.pb.En"
-      "try\022\016\n\006reject\030\014 \001(\010\022\023\n\013reject_hint\030\r \001(\004"
-      "\0229\n\006hb_ctx\030\016 \001(\0132).sharkstore.raft.impl."
-      "pb.HeartbeatContext\0223\n\010snapshot\030\017 \001(\0132!."
-      "sharkstore.raft.impl.pb.Snapshot\"7\n\tHard"
-      "State\022\014\n\004term\030\001 \001(\004\022\016\n\006commit\030\002 \001(\004\022\014\n\004v"
-      "ote\030\003 \001(\004\"+\n\014TruncateMeta\022\r\n\005index\030\001 \001(\004"
-      "\022\014\n\004term\030\002 \001(\004\"8\n\tIndexItem\022\r\n\005index\030\001 \001"
-      "(\004\022\014\n\004term\030\002 \001(\004\022\016\n\006offset\030\003 \001(\r\"=\n\010LogI"
-      "ndex\0221\n\005items\030\001 \003(\0132\".sharkstore.raft.im"
-      "pl.pb.IndexItem*-\n\010PeerType\022\017\n\013PEER_NORM"
-      "AL\020\000\022\020\n\014PEER_LEARNER\020\001*P\n\016ConfChangeType"
-      "\022\021\n\rCONF_ADD_PEER\020\000\022\024\n\020CONF_REMOVE_PEER\020"
-      "\001\022\025\n\021CONF_PROMOTE_PEER\020\002*L\n\tEntryType\022\026\n"
-      "\022ENTRY_TYPE_INVALID\020\000\022\020\n\014ENTRY_NORMAL\020\001\022"
-      "\025\n\021ENTRY_CONF_CHANGE\020\002*\337\002\n\013MessageType\022\030"
-      "\n\024MESSAGE_TYPE_INVALID\020\000\022\032\n\026APPEND_ENTRI"
-      "ES_REQUEST\020\001\022\033\n\027APPEND_ENTRIES_RESPONSE\020"
-      "\002\022\020\n\014VOTE_REQUEST\020\003\022\021\n\rVOTE_RESPONSE\020\004\022\025"
-      "\n\021HEARTBEAT_REQUEST\020\005\022\026\n\022HEARTBEAT_RESPO"
-      "NSE\020\006\022\024\n\020SNAPSHOT_REQUEST\020\007\022\020\n\014SNAPSHOT_"
-      "ACK\020\t\022\021\n\rLOCAL_MSG_HUP\020\n\022\022\n\016LOCAL_MSG_PR"
-      "OP\020\013\022\022\n\016LOCAL_MSG_TICK\020\014\022\024\n\020PRE_VOTE_REQ"
-      "UEST\020\r\022\025\n\021PRE_VOTE_RESPONSE\020\016\022\031\n\025LOCAL_S"
-      "NAPSHOT_STATUS\020\017b\006proto3"
+      "(\014\022\020\n\010trace_id\030\005 \001(\004\"\037\n\020HeartbeatContext"
+      "\022\013\n\003ids\030\001 \003(\004\"j\n\014SnapshotMeta\022\r\n\005index\030\001"
+      " \001(\004\022\014\n\004term\030\002 \001(\004\022,\n\005peers\030\003 \003(\0132\035.shar"
+      "kstore.raft.impl.pb.Peer\022\017\n\007context\030\004 \001("
+      "\014\"x\n\010Snapshot\022\014\n\004uuid\030\001 \001(\004\0223\n\004meta\030\002 \001("
+      "\0132%.sharkstore.raft.impl.pb.SnapshotMeta"
+      "\022\r\n\005datas\030\003 \003(\014\022\r\n\005final\030\004 \001(\010\022\013\n\003seq\030\005 "
+      "\001(\003\"\354\002\n\007Message\0222\n\004type\030\001 \001(\0162$.sharksto"
+      "re.raft.impl.pb.MessageType\022\n\n\002id\030\002 \001(\004\022"
+      "\014\n\004from\030\003 \001(\004\022\n\n\002to\030\004 \001(\004\022\014\n\004term\030\005 \001(\004\022"
+      "\016\n\006commit\030\006 \001(\004\022\020\n\010log_term\030\010 \001(\004\022\021\n\tlog"
+      "_index\030\t \001(\004\022/\n\007entries\030\n \003(\0132\036.sharksto"
+      "re.raft.impl.pb.Entry\022\016\n\006reject\030\014 \001(\010\022\023\n"
+      "\013reject_hint\030\r \001(\004\0229\n\006hb_ctx\030\016 \001(\0132).sha"
+      "rkstore.raft.impl.pb.HeartbeatContext\0223\n"
+      "\010snapshot\030\017 \001(\0132!.sharkstore.raft.impl.p"
+      "b.Snapshot\"7\n\tHardState\022\014\n\004term\030\001 \001(\004\022\016\n"
+      "\006commit\030\002 \001(\004\022\014\n\004vote\030\003 \001(\004\"+\n\014TruncateM"
+      "eta\022\r\n\005index\030\001 \001(\004\022\014\n\004term\030\002 \001(\004\"8\n\tInde"
+      "xItem\022\r\n\005index\030\001 \001(\004\022\014\n\004term\030\002 \001(\004\022\016\n\006of"
+      "fset\030\003 \001(\r\"=\n\010LogIndex\0221\n\005items\030\001 \003(\0132\"."
+      "sharkstore.raft.impl.pb.IndexItem*-\n\010Pee"
+      "rType\022\017\n\013PEER_NORMAL\020\000\022\020\n\014PEER_LEARNER\020\001"
+      "*P\n\016ConfChangeType\022\021\n\rCONF_ADD_PEER\020\000\022\024\n"
+      "\020CONF_REMOVE_PEER\020\001\022\025\n\021CONF_PROMOTE_PEER"
+      "\020\002*L\n\tEntryType\022\026\n\022ENTRY_TYPE_INVALID\020\000\022"
+      "\020\n\014ENTRY_NORMAL\020\001\022\025\n\021ENTRY_CONF_CHANGE\020\002"
+      "*\337\002\n\013MessageType\022\030\n\024MESSAGE_TYPE_INVALID"
+      "\020\000\022\032\n\026APPEND_ENTRIES_REQUEST\020\001\022\033\n\027APPEND"
+      "_ENTRIES_RESPONSE\020\002\022\020\n\014VOTE_REQUEST\020\003\022\021\n"
+      "\rVOTE_RESPONSE\020\004\022\025\n\021HEARTBEAT_REQUEST\020\005\022"
+      "\026\n\022HEARTBEAT_RESPONSE\020\006\022\024\n\020SNAPSHOT_REQU"
+      "EST\020\007\022\020\n\014SNAPSHOT_ACK\020\t\022\021\n\rLOCAL_MSG_HUP"
+      "\020\n\022\022\n\016LOCAL_MSG_PROP\020\013\022\022\n\016LOCAL_MSG_TICK"
+      "\020\014\022\024\n\020PRE_VOTE_REQUEST\020\r\022\025\n\021PRE_VOTE_RES"
+      "PONSE\020\016\022\031\n\025LOCAL_SNAPSHOT_STATUS\020\017b\006prot"
+      "o3"
   };
   ::google::protobuf::DescriptorPool::InternalAddGeneratedFile(
-      descriptor, 1784);
+      descriptor, 1802);
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedFile(
     "raft.proto", &protobuf_RegisterTypes);
 }
@@ -1254,6 +1256,7 @@ const int Entry::kTypeFieldNumber;
 const int Entry::kIndexFieldNumber;
 const int Entry::kTermFieldNumber;
 const int Entry::kDataFieldNumber;
+const int Entry::kTraceIdFieldNumber;
 #endif  // !defined(_MSC_VER) || _MSC_VER >= 1900
 
 Entry::Entry()
@@ -1397,6 +1400,20 @@ bool Entry::MergePartialFromCodedStream(
         break;
       }
 
+      // uint64 trace_id = 5;
+      case 5: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(40u /* 40 & 0xFF */)) {
+
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint64, ::google::protobuf::internal::WireFormatLite::TYPE_UINT64>(
+                 input, &trace_id_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
       default: {
       handle_unusual:
         if (tag == 0) {
@@ -1445,6 +1462,11 @@ void Entry::SerializeWithCachedSizes(
       4, this->data(), output);
   }
 
+  // uint64 trace_id = 5;
+  if (this->trace_id() != 0) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt64(5, this->trace_id(), output);
+  }
+
   if ((_internal_metadata_.have_unknown_fields() &&  ::google::protobuf::internal::GetProto3PreserveUnknownsDefault())) {
     ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
         (::google::protobuf::internal::GetProto3PreserveUnknownsDefault()   ? _internal_metadata_.unknown_fields()   : _internal_metadata_.default_instance()), output);
@@ -1482,6 +1504,11 @@ void Entry::SerializeWithCachedSizes(
         4, this->data(), target);
   }
 
+  // uint64 trace_id = 5;
+  if (this->trace_id() != 0) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(5, this->trace_id(), target);
+  }
+
   if ((_internal_metadata_.have_unknown_fields() &&  ::google::protobuf::internal::GetProto3PreserveUnknownsDefault())) {
     target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
         (::google::protobuf::internal::GetProto3PreserveUnknownsDefault()   ? _internal_metadata_.unknown_fields()   : _internal_metadata_.default_instance()), target);
@@ -1520,6 +1547,13 @@ size_t Entry::ByteSizeLong() const {
         this->term());
   }
 
+  // uint64 trace_id = 5;
+  if (this->trace_id() != 0) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::UInt64Size(
+        this->trace_id());
+  }
+
   // .sharkstore.raft.impl.pb.EntryType type = 1;
   if (this->type() != 0) {
     total_size += 1 +
@@ -1565,6 +1599,9 @@ void Entry::MergeFrom(const Entry& from) {
   if (from.term() != 0) {
     set_term(from.term());
   }
+  if (from.trace_id() != 0) {
+    set_trace_id(from.trace_id());
+  }
   if (from.type() != 0) {
     set_type(from.type());
   }
@@ -1597,6 +1634,7 @@ void Entry::InternalSwap(Entry* other) {
   data_.Swap(&other->data_);
   swap(index_, other->index_);
   swap(term_, other->term_);
+  swap(trace_id_, other->trace_id_);
   swap(type_, other->type_);
   _internal_metadata_.Swap(&other->_internal_metadata_);
   swap(_cached_size_, other->_cached_size_);
@@ -1705,6 +1743,20 @@ void Entry::set_allocated_data(::std::string* data) {
   // @@protoc_insertion_point(field_set_allocated:sharkstore.raft.impl.pb.Entry.data)
 }
 
+// uint64 trace_id = 5;
+void Entry::clear_trace_id() {
+  trace_id_ = GOOGLE_ULONGLONG(0);
+}
+::google::protobuf::uint64 Entry::trace_id() const {
+  // @@protoc_insertion_point(field_get:sharkstore.raft.impl.pb.Entry.trace_id)
+  return trace_id_;
+}
+void Entry::set_trace_id(::google::protobuf::uint64 value) {
+  
+  trace_id_ = value;
+  // @@protoc_insertion_point(field_set:sharkstore.raft.impl.pb.Entry.trace_id)
+}
+
 #endif  // PROTOBUF_INLINE_NOT_IN_HEADERS
 
 // ===================================================================
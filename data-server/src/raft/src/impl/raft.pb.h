@@ -534,6 +534,12 @@ class Entry : public ::google::protobuf::Message /* @@protoc_insertion_point(cla
   ::google::protobuf::uint64 term() const;
   void set_term(::google::protobuf::uint64 value);
 
+  // uint64 trace_id = 5;
+  void clear_trace_id();
+  static const int kTraceIdFieldNumber = 5;
+  ::google::protobuf::uint64 trace_id() const;
+  void set_trace_id(::google::protobuf::uint64 value);
+
   // .sharkstore.raft.impl.pb.EntryType type = 1;
   void clear_type();
   static const int kTypeFieldNumber = 1;
@@ -547,6 +553,7 @@ class Entry : public ::google::protobuf::Message /* @@protoc_insertion_point(cla
   ::google::protobuf::internal::ArenaStringPtr data_;
   ::google::protobuf::uint64 index_;
   ::google::protobuf::uint64 term_;
+  ::google::protobuf::uint64 trace_id_;
   int type_;
   mutable int _cached_size_;
   friend struct protobuf_raft_2eproto::TableStruct;
@@ -1817,6 +1824,20 @@ inline void Entry::set_allocated_data(::std::string* data) {
   // @@protoc_insertion_point(field_set_allocated:sharkstore.raft.impl.pb.Entry.data)
 }
 
+// uint64 trace_id = 5;
+inline void Entry::clear_trace_id() {
+  trace_id_ = GOOGLE_ULONGLONG(0);
+}
+inline ::google::protobuf::uint64 Entry::trace_id() const {
+  // @@protoc_insertion_point(field_get:sharkstore.raft.impl.pb.Entry.trace_id)
+  return trace_id_;
+}
+inline void Entry::set_trace_id(::google::protobuf::uint64 value) {
+  
+  trace_id_ = value;
+  // @@protoc_insertion_point(field_set:sharkstore.raft.impl.pb.Entry.trace_id)
+}
+
 // -------------------------------------------------------------------
 
 // HeartbeatContext
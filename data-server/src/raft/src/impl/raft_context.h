@@ -1,5 +1,6 @@
 _Pragma("once");
 
+#include "flow_control.h"
 #include "snapshot/manager.h"
 #include "transport/transport.h"
 #include "work_thread.h"
@@ -13,6 +14,7 @@ struct RaftContext {
     WorkThread *apply_thread = nullptr;
     SnapshotManager *snapshot_manager = nullptr;
     transport::Transport *msg_sender = nullptr;
+    FlowBudget *flow_budget = nullptr;
 };
 
 } /* namespace impl */
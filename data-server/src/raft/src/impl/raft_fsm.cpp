@@ -14,12 +14,14 @@ namespace sharkstore {
 namespace raft {
 namespace impl {
 
-RaftFsm::RaftFsm(const RaftServerOptions& sops, const RaftOptions& ops)
+RaftFsm::RaftFsm(const RaftServerOptions& sops, const RaftOptions& ops,
+                 FlowBudget* flow_budget)
     : sops_(sops),
       rops_(ops),
       node_id_(sops.node_id),
       id_(ops.id),
-      sm_(ops.statemachine) {
+      sm_(ops.statemachine),
+      flow_group_(flow_budget) {
     auto s = start();
     if (!s.ok()) {
         throw RaftException(s);
@@ -116,6 +118,8 @@ Status RaftFsm::start() {
         ops.max_log_files = rops_.max_log_files;
         ops.allow_corrupt_startup = rops_.allow_log_corrupt;
         ops.initial_first_index = rops_.initial_first_index;
+        ops.compression = sops_.compression;
+        ops.compression_threshold = sops_.compression_threshold;
         storage_ = std::shared_ptr<storage::Storage>(
             new storage::DiskStorage(id_, rops_.storage_path, ops));
     }
@@ -450,6 +454,9 @@ Status RaftFsm::Persist(bool persist_hardstate) {
         } else {
             raft_log_->stableTo(ents.back()->index(), ents.back()->term());
         }
+        for (const auto& e : ents) {
+            trace(e, TraceStage::kPersist);
+        }
     }
     // 持久化HardState
     if (persist_hardstate) {
@@ -505,6 +512,20 @@ Status RaftFsm::TruncateLog(uint64_t index) {
 
 Status RaftFsm::DestroyLog(bool backup) { return storage_->Destroy(backup); }
 
+void RaftFsm::trace(const EntryPtr& e, TraceStage stage, uint64_t node) const {
+    if (e->trace_id() == 0 || !sops_.trace_recorder) return;
+
+    TraceEvent event;
+    event.trace_id = e->trace_id();
+    event.raft_id = id_;
+    event.stage = stage;
+    event.node = node;
+    event.time = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::system_clock::now().time_since_epoch())
+                     .count();
+    sops_.trace_recorder(event);
+}
+
 Status RaftFsm::smApply(const EntryPtr& entry) {
     Status s;
     switch (entry->type()) {
@@ -565,9 +586,18 @@ Status RaftFsm::applyConfChange(const EntryPtr& e) {
     return Status::OK();
 }
 
-std::unique_ptr<Replica> RaftFsm::newReplica(const Peer& peer, bool is_leader) const {
+std::unique_ptr<Replica> RaftFsm::newReplica(const Peer& peer, bool is_leader) {
     if (is_leader) {
-        auto r = std::unique_ptr<Replica>(new Replica(peer, sops_.max_inflight_msgs));
+        ReplicaFlowOptions flow_ops;
+        flow_ops.max_inflight_msgs = sops_.max_inflight_msgs;
+        flow_ops.max_inflight_bytes = sops_.max_inflight_bytes;
+        flow_ops.min_size_per_msg = sops_.min_size_per_msg;
+        flow_ops.max_size_per_msg = sops_.max_size_per_msg;
+        // 本节点自己的副本不需要发送
+        if (peer.node_id != node_id_) {
+            flow_ops.flow = &flow_group_;
+        }
+        auto r = std::unique_ptr<Replica>(new Replica(peer, flow_ops));
         auto lasti = raft_log_->lastIndex();
         r->set_next(lasti + 1);
         if (peer.node_id == node_id_) {
@@ -728,6 +758,7 @@ void RaftFsm::reset(uint64_t term, bool is_leader) {
     heartbeat_elapsed_ = 0;
     votes_.clear();
     pending_conf_ = false;
+    tracing_.clear();
 
     abortSendSnap();
     abortApplySnap();
@@ -5,6 +5,7 @@ _Pragma("once");
 
 #include "raft/options.h"
 #include "raft/status.h"
+#include "flow_control.h"
 #include "raft_log.h"
 #include "raft_types.h"
 #include "replica.h"
@@ -19,7 +20,8 @@ class ApplySnapTask;
 
 class RaftFsm {
 public:
-    RaftFsm(const RaftServerOptions& sops, const RaftOptions& ops);
+    RaftFsm(const RaftServerOptions& sops, const RaftOptions& ops,
+            FlowBudget* flow_budget = nullptr);
     ~RaftFsm() = default;
 
     RaftFsm(const RaftFsm&) = delete;
@@ -42,6 +44,9 @@ public:
     Status TruncateLog(uint64_t index);
     Status DestroyLog(bool backup);
 
+    // 带trace_id的日志回调trace_recorder，可以在apply线程中调用
+    void trace(const EntryPtr& e, TraceStage stage, uint64_t node = 0) const;
+
 private:
     static int numOfPendingConf(const std::vector<EntryPtr>& ents);
     static void takeEntries(MessagePtr& msg, std::vector<EntryPtr>& ents);
@@ -60,7 +65,7 @@ private:
 
     bool hasReplica(uint64_t node) const;
     Replica* getReplica(uint64_t node) const;
-    std::unique_ptr<Replica> newReplica(const Peer& peer, bool is_leader) const;
+    std::unique_ptr<Replica> newReplica(const Peer& peer, bool is_leader);
     void traverseReplicas(const std::function<void(uint64_t, Replica&)>& f) const;
 
     void addPeer(const Peer& peer);
@@ -91,6 +96,8 @@ private:
     void appendEntry(const std::vector<EntryPtr>& ents);
     std::shared_ptr<SendSnapTask> newSendSnapTask(uint64_t to, uint64_t* snap_index);
     void checkCaughtUp();
+    // follower的match从from推进到to，记录其间采样日志的确认
+    void traceAck(uint64_t node, uint64_t from, uint64_t to);
 
 private:
     void becomeCandidate();
@@ -131,6 +138,8 @@ private:
     std::unique_ptr<RaftLog> raft_log_;
 
     std::map<uint64_t, bool> votes_;
+    // 需要在replicas之前构造，replicas析构时归还占用的流量预算
+    FlowGroup flow_group_;
     std::map<uint64_t, std::unique_ptr<Replica>> replicas_;  // normal replicas
     std::map<uint64_t, std::unique_ptr<Replica>> learners_;  // learner replicas
 
@@ -141,6 +150,9 @@ private:
     std::function<void(MessagePtr&)> step_func_;
     std::function<void()> tick_func_;
 
+    // leader上已追加未提交的采样日志，index -> trace_id
+    std::map<uint64_t, uint64_t> tracing_;
+
     std::vector<MessagePtr> sending_msgs_;
     std::shared_ptr<SendSnapTask> sending_snap_;
 
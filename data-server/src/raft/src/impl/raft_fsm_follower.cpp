@@ -114,6 +114,9 @@ void RaftFsm::handleAppendEntries(MessagePtr& msg) {
     uint64_t last_index = 0;
     if (raft_log_->maybeAppend(msg->log_index(), msg->log_term(), msg->commit(), ents,
                                &last_index)) {
+        for (const auto& e : ents) {
+            trace(e, TraceStage::kReceive, msg->from());
+        }
         resp_msg->set_log_index(last_index);
         resp_msg->set_commit(raft_log_->committed());
         send(resp_msg);
@@ -65,6 +65,10 @@ void RaftFsm::stepLeader(MessagePtr& msg) {
                     }
                     pending_conf_ = true;
                 }
+                if (entry->trace_id() != 0) {
+                    trace(entry, TraceStage::kAppend);
+                    tracing_.emplace(entry->index(), entry->trace_id());
+                }
             }
             appendEntry(ents);
             bcastAppend();
@@ -97,14 +101,16 @@ void RaftFsm::stepLeader(MessagePtr& msg) {
                     sendAppend(msg->from(), pr);
                 }
             } else {
-                bool old_paused = pr.isPaused();
+                bool old_paused = pr.isPaused() || pr.flowLimited();
+                uint64_t old_match = pr.match();
                 if (pr.maybeUpdate(msg->log_index(), msg->commit())) {
+                    traceAck(msg->from(), old_match, pr.match());
                     switch (pr.state()) {
                         case ReplicaState::kProbe:
                             pr.becomeReplicate();
                             break;
                         case ReplicaState::kReplicate:
-                            pr.inflight().freeTo(msg->log_index());
+                            pr.freeInflightTo(msg->log_index());
                             break;
                         case ReplicaState::kSnapshot:
                             if (pr.needSnapshotAbort()) {
@@ -222,6 +228,10 @@ bool RaftFsm::maybeCommit() {
 
     uint64_t mid = matches[quorum() - 1];
     bool is_commit = raft_log_->maybeCommit(mid, term_);
+    if (is_commit && !tracing_.empty()) {
+        // 已提交的不再记录确认，提交时间在交给状态机时记录
+        tracing_.erase(tracing_.begin(), tracing_.upper_bound(raft_log_->committed()));
+    }
     if (state_ == FsmState::kLeader) {
         auto it = replicas_.find(node_id_);
         if (it != replicas_.end()) {
@@ -257,7 +267,7 @@ void RaftFsm::sendAppend(uint64_t to, Replica& pr) {
     uint64_t fi = raft_log_->firstIndex();
     if (pr.next() >= fi) {
         ts = raft_log_->term(pr.next() - 1, &term);
-        es = raft_log_->entries(pr.next(), sops_.max_size_per_msg, &ents);
+        es = raft_log_->entries(pr.next(), pr.maxMsgSize(), &ents);
     }
 
     // 需要发快照
@@ -276,6 +286,24 @@ void RaftFsm::sendAppend(uint64_t to, Replica& pr) {
             pr.becomeSnapshot(snap_index);
         }
     } else {
+        uint64_t bytes = 0;
+        if (pr.state() == ReplicaState::kReplicate && !ents.empty()) {
+            for (const auto& e : ents) {
+                bytes += e->data().size();
+            }
+            // 节点流量预算不足，只同步commit位置，等收到ack释放预算后再发送日志
+            if (!flow_group_.Allow(bytes)) {
+                pr.set_flow_limited(true);
+                if (pr.committed() >= raft_log_->committed()) {
+                    return;
+                }
+                ents.clear();
+                bytes = 0;
+            } else {
+                pr.set_flow_limited(false);
+            }
+        }
+
         MessagePtr msg(new pb::Message);
         msg->set_type(pb::APPEND_ENTRIES_REQUEST);
         msg->set_to(to);
@@ -283,13 +311,18 @@ void RaftFsm::sendAppend(uint64_t to, Replica& pr) {
         msg->set_log_term(term);            // prev log term
         msg->set_commit(raft_log_->committed());
         putEntries(msg, ents);
+        if (!tracing_.empty()) {
+            for (const auto& e : ents) {
+                trace(e, TraceStage::kSend, to);
+            }
+        }
 
         if (msg->entries_size() > 0) {
             switch (pr.state()) {
                 case ReplicaState::kReplicate: {
                     uint64_t last = msg->entries(msg->entries_size() - 1).index();
                     pr.update(last);
-                    pr.inflight().add(last);
+                    pr.inflight().add(last, bytes);
                     break;
                 }
                 case ReplicaState::kProbe:
@@ -306,6 +339,22 @@ void RaftFsm::sendAppend(uint64_t to, Replica& pr) {
     }
 }
 
+void RaftFsm::traceAck(uint64_t node, uint64_t from, uint64_t to) {
+    if (tracing_.empty() || to <= from || !sops_.trace_recorder) return;
+
+    TraceEvent event;
+    event.raft_id = id_;
+    event.stage = TraceStage::kAck;
+    event.node = node;
+    event.time = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::system_clock::now().time_since_epoch())
+                     .count();
+    for (auto it = tracing_.upper_bound(from); it != tracing_.end() && it->first <= to; ++it) {
+        event.trace_id = it->second;
+        sops_.trace_recorder(event);
+    }
+}
+
 void RaftFsm::appendEntry(const std::vector<EntryPtr>& ents) {
     LOG_DEBUG("raft[%llu] append log entry. index: %llu, size: %d", id_, ents[0]->index(),
               ents.size());
@@ -17,7 +17,12 @@ namespace impl {
 
 RaftImpl::RaftImpl(const RaftServerOptions& sops, const RaftOptions& ops,
                    const RaftContext& ctx)
-    : sops_(sops), ops_(ops), ctx_(ctx), fsm_(new RaftFsm(sops, ops)) {
+    : sops_(sops),
+      ops_(ops),
+      ctx_(ctx),
+      home_(ctx.consensus_thread),
+      apply_thread_(ctx.apply_thread),
+      fsm_(new RaftFsm(sops, ops, ctx.flow_budget)) {
     initPublish();
 }
 
@@ -44,31 +49,61 @@ Status RaftImpl::TryToLeader() {
     return Status::OK();
 }
 
-void RaftImpl::post(const std::function<void()>& f) {
+Work RaftImpl::newWork() {
     Work w;
     w.owner = ops_.id;
     w.stopped = &stopped_;
+    w.home = &home_;
+    w.busy = &consensus_busy_;
+    return w;
+}
+
+void RaftImpl::post(const std::function<void()>& f) {
+    Work w = newWork();
     w.f0 = f;
-    ctx_.consensus_thread->post(w);
+    WorkHomeGuard guard(&home_);
+    guard.thread()->post(w);
 }
 
 bool RaftImpl::tryPost(const std::function<void()>& f) {
-    Work w;
-    w.owner = ops_.id;
-    w.stopped = &stopped_;
+    Work w = newWork();
     w.f0 = f;
-    return ctx_.consensus_thread->tryPost(w);
+    WorkHomeGuard guard(&home_);
+    return guard.thread()->tryPost(w);
 }
 
-Status RaftImpl::Submit(std::string& cmd) {
+void RaftImpl::MoveConsensusThread(WorkThread* t) {
+    assert(t != nullptr);
+    if (t == home_.thread || moving_.exchange(true)) return;
+
+    // 迁移完成、被拒绝或者work因raft删除、线程停止没有执行时，最后一个holder释放，清除moving_
+    auto self = shared_from_this();
+    std::shared_ptr<void> holder(nullptr, [self](void*) { self->moving_ = false; });
+
+    // 作为一个普通work在当前线程执行，此时没有其他线程在执行本raft
+    post([self, t, holder] {
+        if (WorkThread::Current()->migrate(&self->home_, t, holder)) {
+            LOG_INFO("raft[%llu] move consensus thread", self->ops_.id);
+        }
+    });
+}
+
+void RaftImpl::MoveApplyThread(WorkThread* t) {
+    assert(t != nullptr);
+    if (t == apply_thread_) return;
+    next_apply_thread_ = t;
+}
+
+Status RaftImpl::Submit(std::string& cmd, uint64_t trace_id) {
     if (stopped_) {
         return Status(Status::kShutdownInProgress, "raft is removed",
                       std::to_string(ops_.id));
     }
 
-    if (ctx_.consensus_thread->submit(
-            ops_.id, &stopped_,
-            std::bind(&RaftImpl::Step, shared_from_this(), std::placeholders::_1), cmd)) {
+    Work w = newWork();
+    w.f1 = std::bind(&RaftImpl::Step, shared_from_this(), std::placeholders::_1);
+    WorkHomeGuard guard(&home_);
+    if (guard.thread()->submit(w, cmd, trace_id)) {
         return Status::OK();
     } else {
         return Status(Status::kBusy);
@@ -159,8 +194,9 @@ void RaftImpl::Step(MessagePtr msg) {
 }
 
 void RaftImpl::sendMessages() {
-    for (auto m : ready_.msgs) {
-        ctx_.msg_sender->SendMessage(m);
+    // 交给consensus线程暂存，同一轮里发往同一节点的消息会合并发送
+    for (auto& m : ready_.msgs) {
+        WorkThread::Current()->sendMessage(m);
     }
 }
 
@@ -209,7 +245,16 @@ void RaftImpl::applySnapshot() {
 // 应用
 void RaftImpl::apply() {
     const auto& ents = ready_.committed_entries;
+    if (!ents.empty() && next_apply_thread_ != nullptr) {
+        if (apply_pending_ > 0) {
+            // 等旧apply线程执行完已投递的work再切换，暂不应用，下一轮重新取出
+            return;
+        }
+        LOG_INFO("raft[%llu] move apply thread", ops_.id);
+        apply_thread_ = next_apply_thread_.exchange(nullptr);
+    }
     for (const auto& e : ents) {
+        fsm_->trace(e, TraceStage::kCommit);
         if (e->type() == pb::ENTRY_CONF_CHANGE) {
             auto s = fsm_->applyConfChange(e);
             if (!s.ok()) {
@@ -224,12 +269,14 @@ void RaftImpl::apply() {
             smApply(e);
         } else {
             // 异步应用
-            assert(ctx_.apply_thread != nullptr);
+            assert(apply_thread_ != nullptr);
             Work w;
             w.owner = ops_.id;
             w.stopped = &stopped_;
+            w.busy = &apply_busy_;
             w.f0 = std::bind(&RaftImpl::smApply, shared_from_this(), e);
-            ctx_.apply_thread->waitPost(w);
+            ++apply_pending_;
+            apply_thread_.load()->waitPost(w);
         }
     }
     if (!ents.empty()) {
@@ -326,11 +373,16 @@ void RaftImpl::ReportSnapApplyResult(const SnapContext& ctx, const SnapResult& r
 }
 
 void RaftImpl::smApply(const EntryPtr& e) {
+    fsm_->trace(e, TraceStage::kApply);
     auto s = fsm_->smApply(e);
     if (!s.ok()) {
         throw RaftException(std::string("statemachine apply entry[") +
                             std::to_string(e->index()) + "] error: " + s.ToString());
     }
+    fsm_->trace(e, TraceStage::kApplied);
+    if (!sops_.apply_in_place) {
+        --apply_pending_;
+    }
 }
 
 void RaftImpl::Stop() { stopped_ = true; }
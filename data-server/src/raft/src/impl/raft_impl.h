@@ -31,7 +31,7 @@ public:
 
     Status TryToLeader() override;
 
-    Status Submit(std::string& cmd) override;
+    Status Submit(std::string& cmd, uint64_t trace_id = 0) override;
     Status ChangeMemeber(const ConfChange& conf) override;
 
     bool IsLeader() const override { return sops_.node_id == bulletin_board_.Leader(); }
@@ -60,9 +60,24 @@ public:
     void ReportSnapSendResult(const SnapContext& ctx, const SnapResult& result);
     void ReportSnapApplyResult(const SnapContext& ctx, const SnapResult& result);
 
+    WorkThread* ConsensusThread() const { return home_.thread; }
+    WorkThread* ApplyThread() const { return apply_thread_; }
+
+    // 在consensus/apply线程中累计的执行时间（纳秒）
+    uint64_t ConsensusBusy() const { return consensus_busy_; }
+    uint64_t ApplyBusy() const { return apply_busy_; }
+
+    // 迁移到其他consensus线程，在旧线程上两次Step之间切换
+    void MoveConsensusThread(WorkThread* t);
+    // 是否有尚未完成的迁移
+    bool IsMoving() const { return moving_ || next_apply_thread_ != nullptr; }
+    // 迁移到其他apply线程，等已投递到旧线程的apply都执行完后再切换，保证应用顺序
+    void MoveApplyThread(WorkThread* t);
+
 private:
     void initPublish();
 
+    Work newWork();
     void post(const std::function<void()>& f);
     bool tryPost(const std::function<void()>& f);
 
@@ -85,6 +100,15 @@ private:
 
     std::atomic<bool> stopped_ = {false};
 
+    WorkHome home_;
+    // 从发起consensus线程迁移到新线程恢复执行之前为true
+    std::atomic<bool> moving_ = {false};
+    std::atomic<WorkThread*> apply_thread_;
+    std::atomic<WorkThread*> next_apply_thread_ = {nullptr};
+    std::atomic<uint64_t> apply_pending_ = {0};
+    std::atomic<uint64_t> consensus_busy_ = {0};
+    std::atomic<uint64_t> apply_busy_ = {0};
+
     BulletinBoard bulletin_board_;
 
     std::unique_ptr<RaftFsm> fsm_;
@@ -7,48 +7,82 @@ namespace sharkstore {
 namespace raft {
 namespace impl {
 
-Inflight::Inflight(int max) : capacity_(max), buffer_(max) {}
+Inflight::Inflight(int max, uint64_t max_bytes, FlowGroup* flow)
+    : capacity_(max), max_bytes_(max_bytes), flow_(flow), buffer_(max) {}
 
-void Inflight::add(uint64_t index) {
-    if (full()) {
+Inflight::~Inflight() { reset(); }
+
+void Inflight::add(uint64_t index, uint64_t bytes) {
+    if (count_ == capacity_) {
         throw RaftException("inflight.add cannot add into a full inflights.");
     }
 
     int idx = (start_ + count_) % capacity_;
-    buffer_[idx] = index;
+    buffer_[idx].index = index;
+    buffer_[idx].bytes = bytes;
+    buffer_[idx].sent = std::chrono::steady_clock::now();
     ++count_;
+
+    bytes_ += bytes;
+    if (flow_ != nullptr) flow_->Acquire(bytes);
 }
 
-void Inflight::freeTo(uint64_t index) {
-    if (0 == count_ || index < buffer_[start_]) {
+void Inflight::freeTo(uint64_t index, TimePoint* last_sent) {
+    if (0 == count_ || index < buffer_[start_].index) {
         return;
     }
     int i = 0, idx = start_;
+    uint64_t freed = 0;
     for (; i < count_; ++i) {
-        if (index < buffer_[idx]) {
+        if (index < buffer_[idx].index) {
             break;
         }
+        freed += buffer_[idx].bytes;
+        if (last_sent != nullptr) *last_sent = buffer_[idx].sent;
         ++idx;
         idx %= capacity_;
     }
     count_ -= i;
     start_ = idx;
+
+    bytes_ -= freed;
+    if (flow_ != nullptr) flow_->Release(freed);
 }
 
-void Inflight::freeFirstOne() { freeTo(buffer_[start_]); }
+void Inflight::freeFirstOne() { freeTo(buffer_[start_].index); }
 
-bool Inflight::full() const { return count_ == capacity_; }
+bool Inflight::full() const {
+    return count_ == capacity_ || (max_bytes_ > 0 && bytes_ >= max_bytes_);
+}
 
 void Inflight::reset() {
     count_ = 0;
     start_ = 0;
+
+    if (flow_ != nullptr) flow_->Release(bytes_);
+    bytes_ = 0;
 }
 
 Replica::Replica(const Peer& peer, int max_inflight)
-    : peer_(peer), inflight_(max_inflight) {}
+    : peer_(peer), inflight_(max_inflight), msg_size_(0, 0) {}
+
+Replica::Replica(const Peer& peer, const ReplicaFlowOptions& opts)
+    : peer_(peer),
+      inflight_(opts.max_inflight_msgs, opts.max_inflight_bytes, opts.flow),
+      msg_size_(opts.min_size_per_msg, opts.max_size_per_msg) {}
+
+void Replica::freeInflightTo(uint64_t index) {
+    TimePoint sent;
+    inflight_.freeTo(index, &sent);
+    if (sent != TimePoint()) {
+        msg_size_.OnAck(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - sent));
+    }
+}
 
 void Replica::resetState(ReplicaState state) {
     paused_ = false;
+    flow_limited_ = false;
     pendingSnap_ = 0;
     state_ = state;
     inflight_.reset();
@@ -1,5 +1,6 @@
 _Pragma("once");
 
+#include "flow_control.h"
 #include "raft.pb.h"
 #include "raft_types.h"
 
@@ -9,27 +10,56 @@ namespace impl {
 
 class Inflight {
 public:
-    explicit Inflight(int max);
+    // max_bytes为0表示不按字节限制
+    // flow不为空时在途字节同时计入节点级别的流量预算
+    explicit Inflight(int max, uint64_t max_bytes = 0, FlowGroup* flow = nullptr);
+    ~Inflight();
 
     Inflight(const Inflight&) = delete;
     Inflight& operator=(const Inflight&) = delete;
 
-    void add(uint64_t index);
-    void freeTo(uint64_t index);
+    void add(uint64_t index, uint64_t bytes = 0);
+    // last_sent不为空时，返回释放的最后一条消息的发送时间
+    void freeTo(uint64_t index, TimePoint* last_sent = nullptr);
     void freeFirstOne();
     bool full() const;
     void reset();
 
+    uint64_t bytes() const { return bytes_; }
+
 private:
-    const int capacity_ = 0;        // 循环buffer的大小
-    std::vector<uint64_t> buffer_;  // 循环buffer
+    struct Slot {
+        uint64_t index = 0;
+        uint64_t bytes = 0;
+        TimePoint sent;
+    };
+
+    const int capacity_ = 0;      // 循环buffer的大小
+    const uint64_t max_bytes_ = 0;
+    FlowGroup* flow_ = nullptr;
+    std::vector<Slot> buffer_;    // 循环buffer
     int start_ = 0;
     int count_ = 0;
+    uint64_t bytes_ = 0;
+};
+
+// leader端副本复制的流控参数
+struct ReplicaFlowOptions {
+    int max_inflight_msgs = 0;
+    uint64_t max_inflight_bytes = 0;
+
+    // 按ack往返时间在[min, max]之间调整单条复制消息的大小
+    // 两者相等时大小固定
+    uint64_t min_size_per_msg = 0;
+    uint64_t max_size_per_msg = 0;
+
+    FlowGroup* flow = nullptr;
 };
 
 class Replica {
 public:
     explicit Replica(const Peer& peer, int max_inflight = 0);
+    Replica(const Peer& peer, const ReplicaFlowOptions& opts);
     ~Replica() = default;
 
     Replica(const Replica&) = delete;
@@ -39,6 +69,15 @@ public:
     bool is_learner() const { return peer_.type == PeerType::kLearner; }
 
     Inflight& inflight() { return inflight_; }
+    // 释放index之前的在途消息，并用ack往返时间调整消息大小
+    void freeInflightTo(uint64_t index);
+
+    // 单条复制消息的最大字节数
+    uint64_t maxMsgSize() const { return msg_size_.Size(); }
+
+    // 因为节点流量预算不足而暂停发送
+    bool flowLimited() const { return flow_limited_; }
+    void set_flow_limited(bool limited) { flow_limited_ = limited; }
 
     uint64_t next() const { return next_; }
     void set_next(uint64_t next) { next_ = next; }
@@ -77,8 +116,10 @@ private:
     Peer peer_;
     ReplicaState state_{ReplicaState::kProbe};
     Inflight inflight_;
+    AdaptiveMsgSize msg_size_;
 
     bool paused_ = false;
+    bool flow_limited_ = false;
     uint64_t inactive_ticks_ = 0;
 
     uint64_t match_ = 0;
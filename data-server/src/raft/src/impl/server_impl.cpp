@@ -1,11 +1,14 @@
 #include "server_impl.h"
 
+#include <algorithm>
 #include <thread>
 
+#include "flow_control.h"
 #include "logger.h"
 #include "raft_exception.h"
 #include "raft_impl.h"
 #include "snapshot/manager.h"
+#include "thread_balancer.h"
 #include "transport/fast_transport.h"
 #include "transport/inprocess_transport.h"
 #include "transport/transport.h"
@@ -36,35 +39,57 @@ Status RaftServerImpl::Start() {
         return status;
     }
 
+    flow_budget_.reset(new FlowBudget(ops_.max_outbound_bytes));
+
+    // 创建transport, raft工作线程通过它合并发送消息
+    if (ops_.transport_options.use_inprocess_transport) {
+        transport_.reset(new transport::InProcessTransport(ops_.node_id));
+    } else {
+        transport_.reset(new transport::FastTransport(ops_.transport_options.resolver,
+                                                  ops_.transport_options.send_io_threads,
+                                                  ops_.transport_options.recv_io_threads,
+                                                  ops_.transport_options.max_batch_bytes,
+                                                  ops_.compression,
+                                                  ops_.compression_threshold));
+    }
+
+    // 各类线程在对应的scope内创建
+    auto thread_scope = [this](const char* kind) -> std::shared_ptr<void> {
+        return ops_.thread_scope ? ops_.thread_scope(kind) : nullptr;
+    };
+
     // 初始化raft工作线程池
-    for (int i = 0; i < ops_.consensus_threads_num; ++i) {
-        auto t = new WorkThread(this, ops_.consensus_queue_capacity,
-                                std::string("raft-worker:") + std::to_string(i));
-        consensus_threads_.push_back(t);
+    {
+        auto scope = thread_scope("consensus");
+        for (int i = 0; i < ops_.consensus_threads_num; ++i) {
+            auto t = new WorkThread(this, ops_.consensus_queue_capacity,
+                                    std::string("raft-worker:") + std::to_string(i),
+                                    transport_.get());
+            consensus_threads_.push_back(t);
+        }
     }
     LOG_INFO("raft[server] %d consensus threads start. queue capacity=%d",
              ops_.consensus_threads_num, ops_.consensus_queue_capacity);
 
     // 初始化apply工作线程池
-    for (int i = 0; i < ops_.apply_threads_num; ++i) {
-        auto t = new WorkThread(this, ops_.apply_queue_capacity,
-                                std::string("raft-apply:") + std::to_string(i));
-        apply_threads_.push_back(t);
+    {
+        auto scope = thread_scope("apply");
+        for (int i = 0; i < ops_.apply_threads_num; ++i) {
+            auto t = new WorkThread(this, ops_.apply_queue_capacity,
+                                    std::string("raft-apply:") + std::to_string(i));
+            apply_threads_.push_back(t);
+        }
     }
     LOG_INFO("raft[server] %d apply threads start. queue capacity=%d",
              ops_.apply_threads_num, ops_.apply_queue_capacity);
 
     // start transport
-    if (ops_.transport_options.use_inprocess_transport) {
-        transport_.reset(new transport::InProcessTransport(ops_.node_id));
-    } else {
-        transport_.reset(new transport::FastTransport(ops_.transport_options.resolver,
-                                                  ops_.transport_options.send_io_threads,
-                                                  ops_.transport_options.recv_io_threads));
+    {
+        auto scope = thread_scope("transport");
+        status = transport_->Start(
+            ops_.transport_options.listen_ip, ops_.transport_options.listen_port,
+            std::bind(&RaftServerImpl::onMessage, this, std::placeholders::_1));
     }
-    status = transport_->Start(
-        ops_.transport_options.listen_ip, ops_.transport_options.listen_port,
-        std::bind(&RaftServerImpl::onMessage, this, std::placeholders::_1));
     if (!status.ok()) {
         return status;
     }
@@ -74,8 +99,11 @@ Status RaftServerImpl::Start() {
     snapshot_manager_.reset(new SnapshotManager(ops_.snapshot_options));
 
     running_ = true;
-    tick_thr_.reset(new std::thread([this]() {
-        tickRoutine(); }));
+    {
+        auto scope = thread_scope("tick");
+        tick_thr_.reset(new std::thread([this]() {
+            tickRoutine(); }));
+    }
 
     return Status::OK();
 }
@@ -129,9 +157,10 @@ Status RaftServerImpl::CreateRaft(const RaftOptions& ops, std::shared_ptr<Raft>*
     RaftContext ctx;
     ctx.msg_sender = transport_.get();
     ctx.snapshot_manager = snapshot_manager_.get();
-    ctx.consensus_thread = consensus_threads_[counter % consensus_threads_.size()];
+    ctx.flow_budget = flow_budget_.get();
+    ctx.consensus_thread = pickThread(consensus_threads_, &consensus_load_, counter);
     if (!ops_.apply_in_place) {
-        ctx.apply_thread = apply_threads_[counter % apply_threads_.size()];
+        ctx.apply_thread = pickThread(apply_threads_, &apply_load_, counter);
     }
 
     std::shared_ptr<RaftImpl> r;
@@ -236,6 +265,14 @@ void RaftServerImpl::GetStatus(ServerStatus* status) const {
     status->total_snap_sending = snapshot_manager_->SendingCount();
     status->total_snap_applying = snapshot_manager_->ApplyingCount();
     status->total_rafts_count  = raftSize();
+    status->outbound_bytes = flow_budget_->Used();
+    status->outbound_rafts = flow_budget_->ActiveGroups();
+    for (auto t : consensus_threads_) {
+        status->consensus_queue_size += static_cast<uint64_t>(t->size());
+    }
+    for (auto t : apply_threads_) {
+        status->apply_queue_size += static_cast<uint64_t>(t->size());
+    }
 }
 
 void RaftServerImpl::onMessage(MessagePtr& msg) {
@@ -327,6 +364,99 @@ void RaftServerImpl::sendHeartbeat(const RaftMapType& rafts) {
     }
 }
 
+WorkThread* RaftServerImpl::pickThread(const std::vector<WorkThread*>& threads,
+                                       PoolLoad* load, uint64_t counter) {
+    std::lock_guard<std::mutex> lock(loads_mu_);
+    if (load->recent.size() != threads.size()) {
+        load->recent.assign(threads.size(), 0);
+    }
+    size_t idx = PickThread(load->recent, counter);
+    // 按平均负载预估新raft的开销，避免一个周期内新建的raft都放到同一个线程
+    load->recent[idx] += load->group_avg;
+    return threads[idx];
+}
+
+void RaftServerImpl::balanceThreads(const RaftMapType& rafts) {
+    if (ops_.thread_balance_interval.count() <= 0) return;
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_balance_ < ops_.thread_balance_interval) return;
+    bool first = last_balance_.time_since_epoch().count() == 0;
+    uint64_t elapsed_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_balance_)
+            .count();
+    last_balance_ = now;
+
+    // 第一次只记录基准值
+    if (first) elapsed_ns = 0;
+    balancePool(consensus_threads_, &consensus_load_, rafts, false, elapsed_ns);
+    if (!ops_.apply_in_place) {
+        balancePool(apply_threads_, &apply_load_, rafts, true, elapsed_ns);
+    }
+}
+
+void RaftServerImpl::balancePool(const std::vector<WorkThread*>& threads,
+                                 PoolLoad* load, const RaftMapType& rafts, bool apply,
+                                 uint64_t elapsed_ns) {
+    const size_t n = threads.size();
+    std::unordered_map<WorkThread*, size_t> index;
+    std::vector<uint64_t> recent(n, 0);
+    load->thread_total.resize(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        index.emplace(threads[i], i);
+        uint64_t total = threads[i]->busyNanos();
+        recent[i] = total - load->thread_total[i];
+        load->thread_total[i] = total;
+    }
+
+    std::vector<GroupLoad> groups;
+    std::unordered_map<uint64_t, uint64_t> group_total;
+    uint64_t group_sum = 0;
+    for (auto& kv : rafts) {
+        auto& r = kv.second;
+        uint64_t total = apply ? r->ApplyBusy() : r->ConsensusBusy();
+        auto thr = apply ? r->ApplyThread() : r->ConsensusThread();
+        group_total.emplace(kv.first, total);
+
+        auto it = load->group_total.find(kv.first);
+        uint64_t prev = it == load->group_total.end() ? total : it->second;
+        auto idx = index.find(thr);
+        // 上一次迁移还没完成的不参与
+        if (idx == index.end() || r->IsMoving()) continue;
+
+        GroupLoad g;
+        g.id = kv.first;
+        g.thread = idx->second;
+        g.busy = total - prev;
+        group_sum += g.busy;
+        groups.push_back(g);
+    }
+    load->group_total.swap(group_total);
+
+    {
+        std::lock_guard<std::mutex> lock(loads_mu_);
+        load->recent = recent;
+        load->group_avg = std::max<uint64_t>(group_sum / std::max<size_t>(groups.size(), 1), 1);
+    }
+
+    if (elapsed_ns == 0) return;
+
+    uint64_t min_gap = elapsed_ns / 100 * ops_.thread_balance_threshold;
+    auto plans = PlanMigrations(recent, groups, min_gap, n / 2 + 1);
+    for (const auto& m : plans) {
+        auto it = rafts.find(m.id);
+        assert(it != rafts.end());
+        LOG_INFO("raft[%llu] move from %s thread %lu(busy %llums) to %lu(busy %llums)",
+                 m.id, apply ? "apply" : "consensus", m.from, recent[m.from] / 1000000,
+                 m.to, recent[m.to] / 1000000);
+        if (apply) {
+            it->second->MoveApplyThread(threads[m.to]);
+        } else {
+            it->second->MoveConsensusThread(threads[m.to]);
+        }
+    }
+}
+
 void RaftServerImpl::stepTick(const RaftMapType& rafts) {
     assert(tick_msg_->type() == pb::LOCAL_MSG_TICK);
     for (auto& r : rafts) {
@@ -345,6 +475,7 @@ void RaftServerImpl::tickRoutine() {
         }
         sendHeartbeat(rafts);
         stepTick(rafts);
+        balanceThreads(rafts);
         printMetrics();
     }
 }
@@ -366,6 +497,19 @@ void RaftServerImpl::printMetrics() {
         consensus_metrics += "]";
         LOG_INFO("raft[metric] consensus queue size: %s", consensus_metrics.c_str());
 
+        if (ops_.thread_balance_interval.count() > 0) {
+            std::string busy_metrics = "[";
+            std::lock_guard<std::mutex> lock(loads_mu_);
+            for (size_t i = 0; i < consensus_load_.recent.size(); ++i) {
+                busy_metrics += std::to_string(consensus_load_.recent[i] / 1000000);
+                if (i != consensus_load_.recent.size() - 1) {
+                    busy_metrics += ", ";
+                }
+            }
+            busy_metrics += "]";
+            LOG_INFO("raft[metric] consensus threads busy(ms): %s", busy_metrics.c_str());
+        }
+
         // print apply queue size
         if (!ops_.apply_in_place) {
             std::string apply_metrics = "[";
@@ -1,6 +1,7 @@
 _Pragma("once");
 
 #include <atomic>
+#include <mutex>
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
@@ -16,6 +17,7 @@ namespace impl {
 class RaftImpl;
 class WorkThread;
 class SnapshotManager;
+class FlowBudget;
 
 namespace transport {
 class Transport;
@@ -52,6 +54,23 @@ private:
     void onHeartbeatReq(MessagePtr& msg);
     void onHeartbeatResp(MessagePtr& msg);
 
+    // 一组工作线程（consensus或apply）的负载统计，只在tick线程中更新
+    struct PoolLoad {
+        // 上次统计时各线程和各raft的累计忙碌时间
+        std::vector<uint64_t> thread_total;
+        std::unordered_map<uint64_t, uint64_t> group_total;
+        // 上个统计周期各线程的忙碌时间，新建raft时也会读取（受loads_mu_保护）
+        std::vector<uint64_t> recent;
+        // 上个统计周期平均每个raft的忙碌时间
+        uint64_t group_avg = 1;
+    };
+
+    WorkThread* pickThread(const std::vector<WorkThread*>& threads, PoolLoad* load,
+                           uint64_t counter);
+    void balanceThreads(const RaftMapType& rafts);
+    void balancePool(const std::vector<WorkThread*>& threads, PoolLoad* load,
+                     const RaftMapType& rafts, bool apply, uint64_t elapsed_ns);
+
     void stepTick(const RaftMapType& rafts);
     void printMetrics();
     void tickRoutine();
@@ -67,10 +86,16 @@ private:
 
     std::unique_ptr<transport::Transport> transport_;
     std::unique_ptr<SnapshotManager> snapshot_manager_;
+    std::unique_ptr<FlowBudget> flow_budget_;
 
     std::vector<WorkThread*> consensus_threads_;
     std::vector<WorkThread*> apply_threads_;
 
+    PoolLoad consensus_load_;
+    PoolLoad apply_load_;
+    std::mutex loads_mu_;
+    std::chrono::steady_clock::time_point last_balance_;
+
     MessagePtr tick_msg_;
     // TODO: more tick threads or put ticks into consensus_threads
     std::unique_ptr<std::thread> tick_thr_;
@@ -7,6 +7,7 @@
 #include <fstream>
 #include "base/util.h"
 
+#include "../compression.h"
 #include "../logger.h"
 #include "log_index.h"
 
@@ -17,11 +18,14 @@ namespace storage {
 
 static const size_t kLogWriteBufSize = 1024 * 16;
 
-LogFile::LogFile(const std::string& path, uint64_t seq, uint64_t index, bool readonly) :
+LogFile::LogFile(const std::string& path, uint64_t seq, uint64_t index, bool readonly,
+                 CompressionType compression, size_t compression_threshold) :
     seq_(seq),
     index_(index),
     file_path_(makeFilePath(path, seq, index)),
-    readonly_(readonly) {
+    readonly_(readonly),
+    compression_(compression),
+    compression_threshold_(compression_threshold) {
     if (!readonly_) {
         write_buf_.resize(kLogWriteBufSize);
     }
@@ -128,7 +132,7 @@ Status LogFile::Get(uint64_t index, EntryPtr* e) const {
     std::vector<char> payload;
     auto s = readRecord(offset, &rec, &payload);
     if (!s.ok()) return s;
-    if (rec.type != RecordType::kLogEntry) {
+    if (rec.Type() != RecordType::kLogEntry) {
         return Status(Status::kCorruption, "read log entry", "invalid record type");
     }
 
@@ -258,7 +262,7 @@ Status LogFile::traverse(uint32_t& offset) {
                           "read record at offset " + std::to_string(offset),
                           s.ToString());
         }
-        if (rec.type == RecordType::kLogEntry) {
+        if (rec.Type() == RecordType::kLogEntry) {
             impl::pb::Entry e;
             if (!e.ParseFromArray(payload.data(), static_cast<int>(payload.size()))) {
                 return Status(Status::kCorruption,
@@ -276,7 +280,7 @@ Status LogFile::traverse(uint32_t& offset) {
             } else {
                 log_index_.Append(e.index(), e.term(), offset);
             }
-        } else if (rec.type == RecordType::kIndex) {
+        } else if (rec.Type() == RecordType::kIndex) {
             log_index_.Clear();
             auto s = loadIndexes();
             if (s.ok()) {
@@ -294,7 +298,8 @@ Status LogFile::traverse(uint32_t& offset) {
                 std::string("invalid record type at offset") + std::to_string(offset),
                 std::to_string(rec.type));
         }
-        offset += (sizeof(Record) + payload.size());
+        // payload可能是解压后的数据，按文件中的记录长度前进
+        offset += (sizeof(Record) + rec.size);
     }
     return Status::OK();
 }
@@ -413,21 +418,44 @@ Status LogFile::readRecord(off_t offset, Record* rec, std::vector<char>* payload
                       std::to_string(ret));
     }
 
+    if (rec->Compression() != CompressionType::kNone) {
+        std::vector<char> compressed;
+        compressed.swap(*payload);
+        auto s = Uncompress(rec->Compression(), compressed.data(), compressed.size(),
+                            payload);
+        if (!s.ok()) {
+            return Status(Status::kCorruption, "uncompress log record payload",
+                          s.ToString());
+        }
+    }
+
     return Status::OK();
 }
 
 Status LogFile::writeRecord(RecordType type, const ::google::protobuf::Message& msg) {
     uint32_t size = static_cast<uint32_t>(msg.ByteSizeLong());
-    std::vector<char> buf;
+    std::string buf;
     buf.resize(size + sizeof(Record));
-    Record* rec = (Record*)(buf.data());
-    rec->type = type;
+    if (!msg.SerializeToArray(&buf[sizeof(Record)], size)) {
+        return Status(Status::kCorruption, "serialize log record", "pb return false");
+    }
+
+    // 超过阈值的payload压缩后写入，压缩没有收益则保持原样
+    CompressionType compression = CompressionType::kNone;
+    if (compression_ != CompressionType::kNone && size >= compression_threshold_) {
+        std::string compressed(sizeof(Record), '\0');
+        if (Compress(compression_, &buf[sizeof(Record)], size, &compressed)) {
+            compression = compression_;
+            size = static_cast<uint32_t>(compressed.size() - sizeof(Record));
+            buf.swap(compressed);
+        }
+    }
+
+    Record* rec = (Record*)(&buf[0]);
+    rec->SetType(type, compression);
     rec->crc = 0;
     rec->size = size;
     rec->Encode();
-    if (!msg.SerializeToArray(rec->payload, size)) {
-        return Status(Status::kCorruption, "serialize log record", "pb return false");
-    }
 
     auto ret = ::fwrite(buf.data(), buf.size(), 1, writer_);
     if (ret != 1) {
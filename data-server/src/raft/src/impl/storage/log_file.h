@@ -17,7 +17,9 @@ class LogIndex;
 
 class LogFile {
 public:
-    LogFile(const std::string& path, uint64_t seq, uint64_t index, bool readonly = false);
+    LogFile(const std::string& path, uint64_t seq, uint64_t index, bool readonly = false,
+            CompressionType compression = CompressionType::kNone,
+            size_t compression_threshold = 0);
     virtual ~LogFile();
 
     LogFile(const LogFile&) = delete;
@@ -60,6 +62,7 @@ private:
 
     Status readFooter(uint32_t* index_ofset) const;
     Status writeFooter(uint32_t index_offset);
+    // 读取offset处的记录，压缩的payload解压后返回, rec->size仍为文件中的长度
     Status readRecord(off_t offset, Record* rec, std::vector<char>* payload) const;
     Status writeRecord(RecordType type, const ::google::protobuf::Message& msg);
 
@@ -68,6 +71,8 @@ private:
     const uint64_t index_ = 0;  // 日志文件起始index
     const std::string file_path_;
     const bool readonly_ = false;
+    const CompressionType compression_ = CompressionType::kNone;
+    const size_t compression_threshold_ = 0;
 
     int fd_ = -1;
     off_t file_size_ = 0;
@@ -85,6 +85,10 @@ Status Footer::Validate() const {
         return Status(Status::kCorruption, "invalid log footer",
                       std::string("magic: ") + formatMagic(magic));
     }
+    if (version > kLogCurrentVersion) {
+        return Status(Status::kNotSupported, "unsupported log version",
+                      std::to_string(version));
+    }
     if (index_offset == 0) {
         return Status(Status::kCorruption, "invalid log footer index offset",
                       std::to_string(index_offset));
@@ -99,7 +103,7 @@ void Record::Encode() {
 
 void Record::Decode() {
     size = be32toh(size);
-    crc = be32toh(size);
+    crc = be32toh(crc);
 }
 
 } /* namespace storage */
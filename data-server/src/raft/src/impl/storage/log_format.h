@@ -3,6 +3,7 @@ _Pragma("once");
 #include <stdint.h>
 #include <string>
 #include "base/status.h"
+#include "raft/options.h"
 
 namespace sharkstore {
 namespace raft {
@@ -13,7 +14,8 @@ namespace storage {
 // 如0000000000000003-0000000000000012.log,
 // 前缀为十六进制的文件序号和起始日志offset)
 
-static const uint16_t kLogCurrentVersion = 1;
+// 版本2: Record头部的type字节携带payload的压缩算法
+static const uint16_t kLogCurrentVersion = 2;
 static const char* kLogFileMagic = "\x99\xA3\xB8\xDE";
 
 std::string makeLogFileName(uint64_t seq, uint64_t index);
@@ -37,12 +39,22 @@ struct Footer {
 
 enum RecordType : uint8_t { kLogEntry = 1, kIndex };
 
+// type字节的低4位为RecordType，高4位为payload的压缩算法(CompressionType)
+// 压缩的payload格式见compression.h，size为压缩后的长度
 struct Record {
-    RecordType type = kLogEntry;
+    uint8_t type = kLogEntry;
     uint32_t size = 0;
     uint32_t crc = 0;
     char payload[0];
 
+    RecordType Type() const { return static_cast<RecordType>(type & 0x0F); }
+    CompressionType Compression() const {
+        return static_cast<CompressionType>(type >> 4);
+    }
+    void SetType(RecordType t, CompressionType c = CompressionType::kNone) {
+        type = static_cast<uint8_t>(t) | static_cast<uint8_t>(static_cast<uint8_t>(c) << 4);
+    }
+
     // convert to big-endian when write to file
     void Encode();
     // conver to host-endian when read from file
@@ -10,9 +10,9 @@ LogIndex::LogIndex() {}
 LogIndex::~LogIndex() {}
 
 Status LogIndex::ParseFrom(const Record& rec, const std::vector<char>& payload) {
-    if (rec.type != RecordType::kIndex) {
+    if (rec.Type() != RecordType::kIndex) {
         return Status(Status::kCorruption, "invalid log index record type",
-                      std::to_string(rec.type));
+                      std::to_string(rec.Type()));
     }
 
     pb::LogIndex idx;
@@ -168,6 +168,11 @@ Status DiskStorage::listLogs(std::map<uint64_t, uint64_t>* logs) {
     return Status::OK();
 }
 
+LogFile* DiskStorage::newLogFile(uint64_t seq, uint64_t index) const {
+    return new LogFile(path_, seq, index, ops_.readonly, ops_.compression,
+                       ops_.compression_threshold);
+}
+
 Status DiskStorage::openLogs() {
     std::map<uint64_t, uint64_t> logs;
     auto s = listLogs(&logs);
@@ -179,7 +184,7 @@ Status DiskStorage::openLogs() {
         if (ops_.readonly) {
             return Status(Status::kCorruption, "open logs", "no log file");
         }
-        auto f = new LogFile(path_, 1, trunc_meta_.index() + 1);
+        auto f = newLogFile(1, trunc_meta_.index() + 1);
         s = f->Open(ops_.allow_corrupt_startup);
         if (!s.ok()) {
             return s;
@@ -188,7 +193,7 @@ Status DiskStorage::openLogs() {
     } else {
         size_t count = 0;
         for (auto it = logs.begin(); it != logs.end(); ++it) {
-            auto f = new LogFile(path_, it->first, it->second, ops_.readonly);
+            auto f = newLogFile(it->first, it->second);
             s = f->Open(ops_.allow_corrupt_startup, count == logs.size() - 1);
             if (!s.ok()) {
                 return s;
@@ -243,7 +248,7 @@ Status DiskStorage::tryRotate() {
         if (!s.ok()) {
             return s;
         }
-        auto newf = new LogFile(path_, f->Seq() + 1, last_index_ + 1);
+        auto newf = newLogFile(f->Seq() + 1, last_index_ + 1);
         s = newf->Open(false);
         if (!s.ok()) {
             return s;
@@ -473,7 +478,7 @@ Status DiskStorage::truncateAll() {
     }
     log_files_.clear();
 
-    LogFile* f = new LogFile(path_, 1, trunc_meta_.index() + 1);
+    LogFile* f = newLogFile(1, trunc_meta_.index() + 1);
     s = f->Open(false);
     if (!s.ok()) {
         return s;
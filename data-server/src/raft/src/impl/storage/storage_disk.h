@@ -1,6 +1,7 @@
 _Pragma("once");
 
 #include <atomic>
+#include "raft/options.h"
 #include "meta_file.h"
 #include "storage.h"
 
@@ -31,6 +32,10 @@ public:
 
         // 只读模式打开
         bool readonly = false;
+
+        // 新写入的日志记录超过compression_threshold字节时按compression压缩
+        CompressionType compression = CompressionType::kNone;
+        size_t compression_threshold = 0;
     };
 
     DiskStorage(uint64_t id, const std::string& path, const Options& ops);
@@ -75,6 +80,7 @@ private:
     Status initDir();
     Status initMeta();
     Status listLogs(std::map<uint64_t, uint64_t>* logs);
+    LogFile* newLogFile(uint64_t seq, uint64_t index) const;
     Status openLogs();
     Status closeLogs();
 
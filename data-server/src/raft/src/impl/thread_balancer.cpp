@@ -0,0 +1,70 @@
+#include "thread_balancer.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace sharkstore {
+namespace raft {
+namespace impl {
+
+std::vector<Migration> PlanMigrations(std::vector<uint64_t> thread_busy,
+                                      const std::vector<GroupLoad>& groups,
+                                      uint64_t min_gap, size_t max_moves) {
+    std::vector<Migration> result;
+    if (thread_busy.size() < 2) return result;
+
+    std::unordered_set<uint64_t> moved;
+    while (result.size() < max_moves) {
+        auto hot = std::max_element(thread_busy.begin(), thread_busy.end()) -
+                   thread_busy.begin();
+        auto cold = std::min_element(thread_busy.begin(), thread_busy.end()) -
+                    thread_busy.begin();
+        uint64_t gap = thread_busy[hot] - thread_busy[cold];
+        if (hot == cold || gap <= min_gap) break;
+
+        // 迁移负载为g的group后两个线程的差距变为|gap - 2g|, g越接近gap/2越好
+        const GroupLoad* best = nullptr;
+        uint64_t best_score = 0;
+        for (const auto& g : groups) {
+            if (g.thread != static_cast<size_t>(hot) || g.busy == 0 ||
+                g.busy >= gap || moved.count(g.id) > 0) {
+                continue;
+            }
+            uint64_t score = std::min(g.busy, gap - g.busy);
+            // 迁移后差距至少要缩小min_gap，避免来回迁移负载很小的group
+            if (score * 2 < min_gap) continue;
+            if (best == nullptr || score > best_score) {
+                best = &g;
+                best_score = score;
+            }
+        }
+        if (best == nullptr) break;
+
+        Migration m;
+        m.id = best->id;
+        m.from = hot;
+        m.to = cold;
+        result.push_back(m);
+        moved.insert(best->id);
+
+        thread_busy[hot] -= best->busy;
+        thread_busy[cold] += best->busy;
+    }
+    return result;
+}
+
+size_t PickThread(const std::vector<uint64_t>& thread_busy, size_t start) {
+    size_t n = thread_busy.size();
+    size_t pick = start % n;
+    for (size_t i = 1; i < n; ++i) {
+        size_t idx = (start + i) % n;
+        if (thread_busy[idx] < thread_busy[pick]) {
+            pick = idx;
+        }
+    }
+    return pick;
+}
+
+} /* namespace impl */
+} /* namespace raft */
+} /* namespace sharkstore */
@@ -0,0 +1,37 @@
+_Pragma("once");
+
+#include <cstdint>
+#include <vector>
+
+namespace sharkstore {
+namespace raft {
+namespace impl {
+
+// raft group在一个统计周期内的负载
+struct GroupLoad {
+    uint64_t id = 0;
+    size_t thread = 0;  // 当前所在线程下标
+    uint64_t busy = 0;  // 周期内的忙碌时间（纳秒）
+};
+
+// 把group从from线程迁移到to线程
+struct Migration {
+    uint64_t id = 0;
+    size_t from = 0;
+    size_t to = 0;
+};
+
+// 根据上一个周期各线程和各group的忙碌时间选出需要迁移的group
+// 每次从最忙的线程挑一个负载最接近两者差值一半的group迁到最闲的线程，
+// 直到最忙和最闲线程的差距不超过min_gap或者已经选出max_moves个
+// 每个group在一轮里最多迁移一次，收益太小（差距缩小不到min_gap）的迁移会被忽略
+std::vector<Migration> PlanMigrations(std::vector<uint64_t> thread_busy,
+                                      const std::vector<GroupLoad>& groups,
+                                      uint64_t min_gap, size_t max_moves);
+
+// 选择新建group放置的线程：上个周期最闲的线程，负载相同时从start开始轮转
+size_t PickThread(const std::vector<uint64_t>& thread_busy, size_t start);
+
+} /* namespace impl */
+} /* namespace raft */
+} /* namespace sharkstore */
@@ -1,17 +1,43 @@
 #include "fast_client.h"
 
+#include <map>
 #include <mutex>
 #include "common/ds_proto.h"
 #include "frame/sf_logger.h"
 
+#include "../compression.h"
+#include "fast_protocol.h"
+
 namespace sharkstore {
 namespace raft {
 namespace impl {
 namespace transport {
 
+static void fillHeader(ds_header_t *header, int64_t msg_id, uint16_t func_id,
+                       size_t body_len) {
+    memset(header, 0, sizeof(ds_header_t));
+    header->magic_number = DS_PROTO_MAGIC_NUMBER;
+    header->body_len = body_len;
+    header->msg_id = msg_id;
+    // 告知对端本节点支持解压的算法
+    header->version = kRaftProtoVersion;
+    header->flags = static_cast<char>(SupportedCompressions());
+    header->msg_type = DS_PROTO_FID_RPC_RESP;
+    header->func_id = func_id;
+    header->proto_type = 1;
+}
+
 FastClient::FastClient(const sf_socket_thread_config_t &cfg,
-                       const std::shared_ptr<NodeResolver> &resolver)
-    : config_(cfg), resolver_(resolver), msg_id_(1) {
+                       const std::shared_ptr<NodeResolver> &resolver,
+                       size_t max_batch_bytes, CompressionType compression,
+                       size_t compression_threshold, const PeerCompressions *peers)
+    : config_(cfg),
+      resolver_(resolver),
+      max_batch_bytes_(max_batch_bytes),
+      compression_(compression),
+      compression_threshold_(compression_threshold),
+      peers_(peers),
+      msg_id_(1) {
     memset(&status_, 0, sizeof(status_));
 }
 
@@ -49,6 +75,7 @@ void FastClient::SendMessage(MessagePtr &msg) {
         FLOG_ERROR(
             "raft[FastClient] invalid target node(0), type: %s, id: %lu, term: %lu",
             pb::MessageType_Name(msg->type()).c_str(), msg->id(), msg->term());
+        return;
     }
 
     int64_t sid = getSession(msg->to());
@@ -59,6 +86,68 @@ void FastClient::SendMessage(MessagePtr &msg) {
     }
 }
 
+void FastClient::SendMessages(std::vector<MessagePtr> &msgs) {
+    if (msgs.size() == 1) {
+        sendBatches(msgs[0]->to(), msgs);
+        return;
+    }
+
+    // 按目标节点分组，组内保持原有顺序
+    std::map<uint64_t, std::vector<MessagePtr>> groups;
+    for (auto &msg : msgs) {
+        groups[msg->to()].push_back(msg);
+    }
+    for (auto &group : groups) {
+        sendBatches(group.first, group.second);
+    }
+}
+
+void FastClient::sendBatches(uint64_t to, const std::vector<MessagePtr> &msgs) {
+    if (to == 0) {
+        FLOG_ERROR("raft[FastClient] invalid target node(0), batch size: %lu",
+                   msgs.size());
+        return;
+    }
+
+    int64_t sid = getSession(to);
+    if (sid <= 0) {
+        FLOG_ERROR("raft[FastClient] could not get a connection to %lu", to);
+        return;
+    }
+
+    // 旧版本节点只能解析单条消息的包，滚动升级时收到对端新版本的包之前不合并
+    size_t max_batch_bytes = peers_->BatchSupported(to) ? max_batch_bytes_ : 0;
+
+    size_t begin = 0;
+    while (begin < msgs.size()) {
+        // 按max_batch_bytes切分，单条超过上限的消息单独发送(为0时不合并)
+        size_t end = begin;
+        size_t body_len = kBatchLengthSize;
+        while (end < msgs.size()) {
+            size_t msg_len = kBatchLengthSize + msgs[end]->ByteSizeLong();
+            if (end > begin && body_len + msg_len > max_batch_bytes) {
+                break;
+            }
+            body_len += msg_len;
+            ++end;
+        }
+
+        // 对端支持时压缩较大的包，不合并时单条消息同样压缩
+        bool compress = compression_ != CompressionType::kNone &&
+                        body_len >= compression_threshold_ &&
+                        peers_->Supported(to, compression_);
+        if (compress && sendCompressed(sid, to, msgs, begin, end, body_len)) {
+            // sent
+        } else if (end - begin == 1) {
+            MessagePtr msg = msgs[begin];
+            send(sid, msg);
+        } else {
+            sendBatch(sid, to, msgs, begin, end, body_len);
+        }
+        begin = end;
+    }
+}
+
 int64_t FastClient::getSession(uint64_t to) {
     {
         sharkstore::shared_lock<sharkstore::shared_mutex> locker(mu_);
@@ -112,13 +201,7 @@ void FastClient::send(int64_t sid, MessagePtr &msg) {
 
     // 填充头部
     ds_header_t header;
-    header.magic_number = DS_PROTO_MAGIC_NUMBER;
-    header.body_len = body_len;
-    header.msg_id = msg_id_.fetch_add(1);
-    header.version = DS_PROTO_VERSION_CURRENT;
-    header.msg_type = DS_PROTO_FID_RPC_RESP;
-    header.func_id = 100;
-    header.proto_type = 1;
+    fillHeader(&header, msg_id_.fetch_add(1), kRaftMessageFuncId, body_len);
     ds_serialize_header(&header, (ds_proto_header_t *)(response->buff));
 
     response->session_id = sid;
@@ -136,7 +219,69 @@ void FastClient::send(int64_t sid, MessagePtr &msg) {
     }
 }
 
+void FastClient::sendBatch(int64_t sid, uint64_t to, const std::vector<MessagePtr> &msgs,
+                           size_t begin, size_t end, size_t body_len) {
+    size_t data_len = sizeof(ds_proto_header_t) + body_len;
+
+    response_buff_t *response = new_response_buff(data_len);
+
+    ds_header_t header;
+    fillHeader(&header, msg_id_.fetch_add(1), kRaftBatchFuncId, body_len);
+    ds_serialize_header(&header, (ds_proto_header_t *)(response->buff));
+
+    response->session_id = sid;
+    response->buff_len = data_len;
+
+    if (EncodeBatch(msgs, begin, end, response->buff + sizeof(ds_proto_header_t),
+                    body_len)) {
+        int ret = dataserver::common::SocketBase::Send(response);
+        if (ret != 0) {
+            FLOG_ERROR("raft[FastClient] send batch(%lu) to %lu failed. ret=%d, sid=%ld",
+                       end - begin, to, ret, sid);
+            removeSession(to);
+        }
+    } else {
+        FLOG_ERROR("raft[FastClient] encode batch(%lu) to %lu failed.", end - begin, to);
+        delete_response_buff(response);
+    }
+}
+
+bool FastClient::sendCompressed(int64_t sid, uint64_t to,
+                                const std::vector<MessagePtr> &msgs, size_t begin,
+                                size_t end, size_t body_len) {
+    // 直接压缩到发送缓冲区，省去压缩结果的拷贝
+    size_t max_len = MaxCompressedBatchSize(compression_, body_len);
+    if (max_len == 0) {
+        return false;
+    }
+    response_buff_t *response = new_response_buff(sizeof(ds_proto_header_t) + max_len);
+    size_t body_size = EncodeCompressedBatch(compression_, msgs, begin, end, body_len,
+                                             response->buff + sizeof(ds_proto_header_t),
+                                             max_len);
+    if (body_size == 0) {
+        delete_response_buff(response);
+        return false;
+    }
+    size_t data_len = sizeof(ds_proto_header_t) + body_size;
+
+    ds_header_t header;
+    fillHeader(&header, msg_id_.fetch_add(1), kRaftCompressedBatchFuncId, body_size);
+    ds_serialize_header(&header, (ds_proto_header_t *)(response->buff));
+
+    response->session_id = sid;
+    response->buff_len = data_len;
+
+    int ret = dataserver::common::SocketBase::Send(response);
+    if (ret != 0) {
+        FLOG_ERROR(
+            "raft[FastClient] send compressed batch(%lu) to %lu failed. ret=%d, sid=%ld",
+            end - begin, to, ret, sid);
+        removeSession(to);
+    }
+    return true;
+}
+
 } /* namespace transport */
 } /* namespace impl */
 } /* namespace raft */
-} /* namespace sharkstore */
\ No newline at end of file
+} /* namespace sharkstore */
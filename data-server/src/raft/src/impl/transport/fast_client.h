@@ -5,6 +5,7 @@ _Pragma("once");
 #include "base/status.h"
 #include "common/socket_base.h"
 #include "raft/node_resolver.h"
+#include "raft/options.h"
 
 #include "../raft_types.h"
 
@@ -13,10 +14,14 @@ namespace raft {
 namespace impl {
 namespace transport {
 
+class PeerCompressions;
+
 class FastClient : public dataserver::common::SocketBase {
 public:
     FastClient(const sf_socket_thread_config_t& cfg,
-               const std::shared_ptr<NodeResolver>& resolver);
+               const std::shared_ptr<NodeResolver>& resolver,
+               size_t max_batch_bytes, CompressionType compression,
+               size_t compression_threshold, const PeerCompressions* peers);
     ~FastClient();
 
     FastClient(const FastClient&) = delete;
@@ -27,16 +32,30 @@ public:
 
     void SendMessage(MessagePtr& msg);
 
+    // 按目标节点合并发送
+    void SendMessages(std::vector<MessagePtr>& msgs);
+
 private:
     int64_t getSession(uint64_t to);
     void removeSession(uint64_t to);
 
     void send(int64_t sid, MessagePtr& msg);
+    // 把msgs[begin, end)合并成一个包发送
+    void sendBatch(int64_t sid, uint64_t to, const std::vector<MessagePtr>& msgs,
+                   size_t begin, size_t end, size_t body_len);
+    // 压缩后发送msgs[begin, end)，压缩没有收益时返回false
+    bool sendCompressed(int64_t sid, uint64_t to, const std::vector<MessagePtr>& msgs,
+                        size_t begin, size_t end, size_t body_len);
+    void sendBatches(uint64_t to, const std::vector<MessagePtr>& msgs);
 
 private:
     sf_socket_thread_config_t config_;
     sf_socket_status_t status_;
     std::shared_ptr<NodeResolver> resolver_;
+    const size_t max_batch_bytes_ = 0;
+    const CompressionType compression_ = CompressionType::kNone;
+    const size_t compression_threshold_ = 0;
+    const PeerCompressions* peers_ = nullptr;
 
     std::atomic<int64_t> msg_id_;
 
@@ -9,6 +9,9 @@
 #include "base/util.h"
 #include "common/ds_proto.h"
 
+#include "../compression.h"
+#include "fast_protocol.h"
+
 namespace sharkstore {
 namespace raft {
 namespace impl {
@@ -61,9 +64,10 @@ Status FastConnection::Send(MessagePtr& msg) {
     header.body_len = body_len;
     static std::atomic<uint64_t> msgid(1);
     header.msg_id = msgid.fetch_add(1);
-    header.version = DS_PROTO_VERSION_CURRENT;
+    header.version = kRaftProtoVersion;
+    header.flags = static_cast<char>(SupportedCompressions());
     header.msg_type = DS_PROTO_FID_RPC_RESP;
-    header.func_id = 100;
+    header.func_id = kRaftMessageFuncId;
     header.proto_type = 1;
     ds_serialize_header(&header, (ds_proto_header_t*)(buf));
 
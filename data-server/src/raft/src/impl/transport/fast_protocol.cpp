@@ -0,0 +1,141 @@
+#include "fast_protocol.h"
+
+#include <string.h>
+#include <memory>
+#include <mutex>
+#include "base/byte_order.h"
+
+#include "../compression.h"
+
+namespace sharkstore {
+namespace raft {
+namespace impl {
+namespace transport {
+
+static void putUint32(char* buf, uint32_t value) {
+    value = htobe32(value);
+    memcpy(buf, &value, sizeof(value));
+}
+
+static uint32_t getUint32(const char* buf) {
+    uint32_t value = 0;
+    memcpy(&value, buf, sizeof(value));
+    return be32toh(value);
+}
+
+size_t BatchEncodedSize(const std::vector<MessagePtr>& msgs, size_t begin,
+                        size_t end) {
+    size_t total = kBatchLengthSize;
+    for (size_t i = begin; i < end; ++i) {
+        total += kBatchLengthSize + msgs[i]->ByteSizeLong();
+    }
+    return total;
+}
+
+bool EncodeBatch(const std::vector<MessagePtr>& msgs, size_t begin, size_t end,
+                 char* buf, size_t len) {
+    if (len < kBatchLengthSize) return false;
+
+    putUint32(buf, static_cast<uint32_t>(end - begin));
+    size_t offset = kBatchLengthSize;
+    for (size_t i = begin; i < end; ++i) {
+        // 调用方计算包体长度时已经调用过ByteSizeLong
+        size_t msg_len = static_cast<size_t>(msgs[i]->GetCachedSize());
+        if (offset + kBatchLengthSize + msg_len > len) {
+            return false;
+        }
+        putUint32(buf + offset, static_cast<uint32_t>(msg_len));
+        offset += kBatchLengthSize;
+        if (!msgs[i]->SerializeToArray(buf + offset, static_cast<int>(msg_len))) {
+            return false;
+        }
+        offset += msg_len;
+    }
+    return offset == len;
+}
+
+bool DecodeBatch(const char* buf, size_t len, std::vector<MessagePtr>* msgs) {
+    if (len < kBatchLengthSize) return false;
+
+    uint32_t count = getUint32(buf);
+    size_t offset = kBatchLengthSize;
+    msgs->reserve(msgs->size() + count);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (offset + kBatchLengthSize > len) return false;
+        size_t msg_len = getUint32(buf + offset);
+        offset += kBatchLengthSize;
+        if (offset + msg_len > len) return false;
+
+        MessagePtr msg(new pb::Message);
+        if (!msg->ParseFromArray(buf + offset, static_cast<int>(msg_len))) {
+            return false;
+        }
+        msgs->push_back(std::move(msg));
+        offset += msg_len;
+    }
+    return offset == len;
+}
+
+size_t MaxCompressedBatchSize(CompressionType type, size_t body_len) {
+    size_t max_len = MaxCompressedLength(type, body_len);
+    return max_len > 0 ? 1 + max_len : 0;
+}
+
+size_t EncodeCompressedBatch(CompressionType type, const std::vector<MessagePtr>& msgs,
+                             size_t begin, size_t end, size_t body_len, char* buf,
+                             size_t len) {
+    if (len < 1) return 0;
+
+    std::unique_ptr<char[]> raw(new char[body_len]);
+    if (!EncodeBatch(msgs, begin, end, raw.get(), body_len)) {
+        return 0;
+    }
+
+    buf[0] = static_cast<char>(type);
+    size_t compressed = Compress(type, raw.get(), body_len, buf + 1, len - 1);
+    return compressed > 0 ? 1 + compressed : 0;
+}
+
+bool DecodeCompressedBatch(const char* buf, size_t len, std::vector<MessagePtr>* msgs) {
+    if (len < 1) return false;
+
+    std::vector<char> raw;
+    auto type = static_cast<CompressionType>(buf[0]);
+    if (!Uncompress(type, buf + 1, len - 1, &raw).ok()) {
+        return false;
+    }
+    return DecodeBatch(raw.data(), raw.size(), msgs);
+}
+
+void PeerCompressions::Update(uint64_t node, short version, uint8_t flags) {
+    // 旧版本节点(包括降级后的节点)都不支持
+    uint8_t supported = (version == kRaftProtoVersion) ? flags : 0;
+    {
+        sharkstore::shared_lock<sharkstore::shared_mutex> locker(mu_);
+        auto it = supported_.find(node);
+        if (it != supported_.end() && it->second == supported) {
+            return;
+        }
+    }
+    std::unique_lock<sharkstore::shared_mutex> locker(mu_);
+    supported_[node] = supported;
+}
+
+bool PeerCompressions::Supported(uint64_t node, CompressionType type) const {
+    sharkstore::shared_lock<sharkstore::shared_mutex> locker(mu_);
+    auto it = supported_.find(node);
+    if (it == supported_.end()) {
+        return false;
+    }
+    return (it->second & (1U << static_cast<uint8_t>(type))) != 0;
+}
+
+bool PeerCompressions::BatchSupported(uint64_t node) const {
+    // kRaftProtoVersion的节点flags中总是带有kNone，且都能解析batch包
+    return Supported(node, CompressionType::kNone);
+}
+
+} /* namespace transport */
+} /* namespace impl */
+} /* namespace raft */
+} /* namespace sharkstore */
@@ -0,0 +1,84 @@
+_Pragma("once");
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "base/shared_mutex.h"
+#include "raft/options.h"
+#include "../raft_types.h"
+
+namespace sharkstore {
+namespace raft {
+namespace impl {
+namespace transport {
+
+// 包头func_id: 单条raft消息
+static const uint16_t kRaftMessageFuncId = 100;
+// 包头func_id: 合并发往同一节点的多条raft消息
+static const uint16_t kRaftBatchFuncId = 101;
+// 包头func_id: 压缩的batch，只发给支持该压缩算法的节点
+static const uint16_t kRaftCompressedBatchFuncId = 102;
+
+// raft包头的version，此时flags为发送方支持解压的算法(SupportedCompressions)
+// 旧版本节点填的是DS_PROTO_VERSION_CURRENT，且flags未初始化，不能作为依据
+static const short kRaftProtoVersion = 18;
+
+// batch包体格式：
+// | count(4) | len(4) | message | len(4) | message | ...
+// 整数均为大端
+static const size_t kBatchLengthSize = sizeof(uint32_t);
+
+// 计算batch编码后的包体长度
+size_t BatchEncodedSize(const std::vector<MessagePtr>& msgs, size_t begin,
+                        size_t end);
+
+// 把msgs[begin, end)编码到buf, buf长度由BatchEncodedSize得到
+// (依赖ByteSizeLong缓存的大小, 调用前须已计算过每条消息的长度)
+bool EncodeBatch(const std::vector<MessagePtr>& msgs, size_t begin, size_t end,
+                 char* buf, size_t len);
+
+// 解码batch包体
+bool DecodeBatch(const char* buf, size_t len, std::vector<MessagePtr>* msgs);
+
+// 压缩batch包体格式：
+// | 压缩算法(1) | 压缩块(见compression.h)，解压后为batch包体 |
+//
+// 压缩batch包体的最大长度，不支持该算法时返回0
+size_t MaxCompressedBatchSize(CompressionType type, size_t body_len);
+
+// 把msgs[begin, end)编码成batch(长度为body_len)后直接压缩到buf，
+// buf长度至少为MaxCompressedBatchSize。返回写入的长度，压缩没有收益时返回0
+size_t EncodeCompressedBatch(CompressionType type, const std::vector<MessagePtr>& msgs,
+                             size_t begin, size_t end, size_t body_len, char* buf,
+                             size_t len);
+
+// 解码压缩batch包体
+bool DecodeCompressedBatch(const char* buf, size_t len, std::vector<MessagePtr>* msgs);
+
+// 记录各个对端节点支持解压的算法，从收到的对端raft包头中获知
+class PeerCompressions {
+public:
+    PeerCompressions() = default;
+    ~PeerCompressions() = default;
+
+    PeerCompressions(const PeerCompressions&) = delete;
+    PeerCompressions& operator=(const PeerCompressions&) = delete;
+
+    // 收到node发来的包，version和flags为包头中的字段
+    void Update(uint64_t node, short version, uint8_t flags);
+
+    // 没有收到过对端的包时认为不支持
+    bool Supported(uint64_t node, CompressionType type) const;
+
+    // 对端是否能解析batch包(kRaftBatchFuncId)，同样以收到过kRaftProtoVersion的包为准
+    bool BatchSupported(uint64_t node) const;
+
+private:
+    std::unordered_map<uint64_t, uint8_t> supported_;
+    mutable sharkstore::shared_mutex mu_;
+};
+
+} /* namespace transport */
+} /* namespace impl */
+} /* namespace raft */
+} /* namespace sharkstore */
@@ -3,14 +3,16 @@
 #include "common/ds_proto.h"
 #include "frame/sf_logger.h"
 
+#include "fast_protocol.h"
+
 namespace sharkstore {
 namespace raft {
 namespace impl {
 namespace transport {
 
 FastServer::FastServer(const sf_socket_thread_config_t& config,
-                       const MessageHandler& handler)
-    : config_(config), handler_(handler) {
+                       const MessageHandler& handler, PeerCompressions* peers)
+    : config_(config), handler_(handler), peers_(peers) {
     memset(&status_, 0, sizeof(status_));
 }
 
@@ -56,16 +58,42 @@ void FastServer::handleTask(request_buff_t* task) {
     ds_proto_header_t* proto_header = (ds_proto_header_t*)(task->buff);
     ds_unserialize_header(proto_header, &header);
 
-    if (header.body_len > 0) {
-        MessagePtr msg(new pb::Message);
-        bool ret =
-            msg->ParseFromArray(task->buff + sizeof(ds_proto_header_t), header.body_len);
-        if (ret) {
-            handler_(msg);
-        } else {
-            FLOG_ERROR("raft[FastServer] prase protobuf message failed.");
+    if (header.body_len <= 0) {
+        return;
+    }
+
+    const char* body = task->buff + sizeof(ds_proto_header_t);
+    size_t body_len = static_cast<size_t>(header.body_len);
+    std::vector<MessagePtr> msgs;
+    bool ret = false;
+    switch (header.func_id) {
+        case kRaftBatchFuncId:
+            ret = DecodeBatch(body, body_len, &msgs);
+            break;
+        case kRaftCompressedBatchFuncId:
+            ret = DecodeCompressedBatch(body, body_len, &msgs);
+            break;
+        default: {
+            MessagePtr msg(new pb::Message);
+            ret = msg->ParseFromArray(body, header.body_len);
+            if (ret) msgs.push_back(std::move(msg));
+            break;
         }
     }
+    if (!ret) {
+        FLOG_ERROR("raft[FastServer] decode message failed. func_id: %d",
+                   static_cast<int>(header.func_id));
+        return;
+    }
+
+    if (!msgs.empty()) {
+        // 同一个包里的消息都来自同一个节点
+        peers_->Update(msgs[0]->from(), header.version,
+                       static_cast<uint8_t>(header.flags));
+    }
+    for (auto& msg : msgs) {
+        handler_(msg);
+    }
 }
 
 void FastServer::sendDoneCallback(response_buff_t* task, int err) {
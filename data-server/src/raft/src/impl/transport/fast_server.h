@@ -8,10 +8,13 @@ namespace raft {
 namespace impl {
 namespace transport {
 
+class PeerCompressions;
+
 class FastServer : public dataserver::common::SocketBase {
 public:
+    // peers: 记录对端支持的压缩算法
     FastServer(const sf_socket_thread_config_t& config,
-               const MessageHandler& handler);
+               const MessageHandler& handler, PeerCompressions* peers);
     ~FastServer();
 
     FastServer(const FastServer&) = delete;
@@ -31,6 +34,7 @@ private:
     sf_socket_thread_config_t config_;
     sf_socket_status_t status_;
     MessageHandler handler_;
+    PeerCompressions* peers_ = nullptr;
 };
 
 } /* namespace transport */
@@ -2,6 +2,7 @@
 
 #include "fast_client.h"
 #include "fast_connection.h"
+#include "fast_protocol.h"
 #include "fast_server.h"
 
 namespace sharkstore {
@@ -10,13 +11,20 @@ namespace impl {
 namespace transport {
 
 FastTransport::FastTransport(const std::shared_ptr<NodeResolver>& resolver,
-                             size_t send_threads, size_t recv_threads)
+                             size_t send_threads, size_t recv_threads,
+                             size_t max_batch_bytes, CompressionType compression,
+                             size_t compression_threshold)
     : resolver_(resolver),
-      recv_threads_num_(recv_threads) {}
+      recv_threads_num_(recv_threads),
+      max_batch_bytes_(max_batch_bytes),
+      compression_(compression),
+      compression_threshold_(compression_threshold),
+      peers_(new PeerCompressions) {}
 
 FastTransport::~FastTransport() {
     delete server_;
     delete client_;
+    delete peers_;
 }
 
 Status FastTransport::Start(const std::string& listen_ip, uint16_t listen_port,
@@ -33,14 +41,15 @@ Status FastTransport::Start(const std::string& listen_ip, uint16_t listen_port,
     srv_config.port = listen_port;
 
     strcpy(srv_config.thread_name_prefix, "raft");
-    server_ = new FastServer(srv_config, handler);
+    server_ = new FastServer(srv_config, handler, peers_);
 
     // new client
     sf_socket_thread_config_t cli_config;
     memset(&cli_config, 0, sizeof(cli_config));
     cli_config.event_send_threads = 1;
     strcpy(cli_config.thread_name_prefix, "raft");
-    client_ = new FastClient(cli_config, resolver_);
+    client_ = new FastClient(cli_config, resolver_, max_batch_bytes_, compression_,
+                             compression_threshold_, peers_);
 
     auto s = server_->Initialize();
     if (!s.ok()) {
@@ -56,6 +65,10 @@ void FastTransport::Shutdown() {
 
 void FastTransport::SendMessage(MessagePtr& msg) { client_->SendMessage(msg); }
 
+void FastTransport::SendMessages(std::vector<MessagePtr>& msgs) {
+    client_->SendMessages(msgs);
+}
+
 Status FastTransport::GetConnection(uint64_t to,
                                     std::shared_ptr<Connection>* conn) {
     std::string ip;
@@ -2,6 +2,7 @@ _Pragma("once");
 
 #include "common/socket_server.h"
 #include "raft/node_resolver.h"
+#include "raft/options.h"
 
 #include "transport.h"
 
@@ -12,11 +13,15 @@ namespace transport {
 
 class FastServer;
 class FastClient;
+class PeerCompressions;
 
 class FastTransport : public Transport {
 public:
     FastTransport(const std::shared_ptr<NodeResolver>& resolver,
-                  size_t send_threads_num, size_t recv_threads_num);
+                  size_t send_threads_num, size_t recv_threads_num,
+                  size_t max_batch_bytes,
+                  CompressionType compression = CompressionType::kNone,
+                  size_t compression_threshold = 0);
     ~FastTransport();
 
     Status Start(const std::string& listen_ip, uint16_t listen_port,
@@ -25,6 +30,7 @@ public:
     void Shutdown() override;
 
     void SendMessage(MessagePtr& msg) override;
+    void SendMessages(std::vector<MessagePtr>& msgs) override;
 
     Status GetConnection(uint64_t to,
                          std::shared_ptr<Connection>* conn) override;
@@ -32,7 +38,11 @@ public:
 private:
     std::shared_ptr<NodeResolver> resolver_;
     const size_t recv_threads_num_ = 0;
+    const size_t max_batch_bytes_ = 0;
+    const CompressionType compression_ = CompressionType::kNone;
+    const size_t compression_threshold_ = 0;
 
+    PeerCompressions* peers_ = nullptr;
     FastServer* server_ = nullptr;
     FastClient* client_ = nullptr;
 };
@@ -1,6 +1,7 @@
 _Pragma("once");
 
 #include <functional>
+#include <vector>
 #include "base/status.h"
 #include "../raft_types.h"
 
@@ -39,6 +40,13 @@ public:
 
     virtual void SendMessage(MessagePtr& msg) = 0;
 
+    // 批量发送，实现可以把发往同一节点的消息合并成一个网络包
+    virtual void SendMessages(std::vector<MessagePtr>& msgs) {
+        for (auto& msg : msgs) {
+            SendMessage(msg);
+        }
+    }
+
     // 需要单独建立一个连接用来发快照
     virtual Status GetConnection(uint64_t to, std::shared_ptr<Connection>* conn) = 0;
 };
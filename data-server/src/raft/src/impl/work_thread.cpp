@@ -1,18 +1,20 @@
 #include "work_thread.h"
 
 #include <assert.h>
+#include <chrono>
 #include <thread>
 #include "base/util.h"
 #include "logger.h"
 #include "raft_exception.h"
 #include "server_impl.h"
+#include "transport/transport.h"
 
 namespace sharkstore {
 namespace raft {
 namespace impl {
 
 void Work::Do() {
-    if (!(*stopped)) {
+    if (stopped == nullptr || !(*stopped)) {
         if (msg == nullptr) {
             f0();
         } else {
@@ -22,8 +24,8 @@ void Work::Do() {
 }
 
 WorkThread::WorkThread(RaftServerImpl* server, size_t queue_capcity,
-                       const std::string& name)
-    : server_(server), capacity_(queue_capcity), running_(true) {
+                       const std::string& name, transport::Transport* sender)
+    : server_(server), capacity_(queue_capcity), running_(true), sender_(sender) {
     assert(server_ != nullptr);
     assert(capacity_ > 0);
 
@@ -34,80 +36,64 @@ WorkThread::WorkThread(RaftServerImpl* server, size_t queue_capcity,
 
 WorkThread::~WorkThread() { shutdown(); }
 
-bool WorkThread::submit(uint64_t owner, std::atomic<bool>* stopped,
-                        const std::function<void(MessagePtr&)>& f1,
-                        std::string& cmd) {
+bool WorkThread::submit(const Work& tmpl, std::string& cmd, uint64_t trace_id) {
+    // 先单独入队，由工作线程在取出的一批work里合并同一个owner相邻的提案
     MessagePtr msg(new pb::Message);
     msg->set_type(pb::LOCAL_MSG_PROP);
+    auto entry = msg->add_entries();
+    entry->set_type(pb::ENTRY_NORMAL);
+    entry->set_trace_id(trace_id);
+    entry->mutable_data()->swap(cmd);
 
-    bool notify = false;
-    {
-        std::lock_guard<std::mutex> lock(mu_);
-        if (!running_) return false;
-
-        auto it = batch_pos_.find(owner);
-        if (it != batch_pos_.end() &&
-            it->second->entries_size() < kMaxBatchSize) {
-            // 可以合并
-            auto entry = it->second->add_entries();
-            entry->set_type(pb::ENTRY_NORMAL);
-            entry->mutable_data()->swap(cmd);
-        } else if (queue_.size() >= capacity_) {
-            return false;
-        } else {
-            // 不能合并，new一个
-            auto entry = msg->add_entries();
-            entry->set_type(pb::ENTRY_NORMAL);
-            entry->mutable_data()->swap(cmd);
-            Work w;
-            w.owner = owner;
-            w.stopped = stopped;
-            w.f1 = f1;
-            w.msg = msg;
-            queue_.push(w);
-            batch_pos_[owner] = msg;
-            notify = true;
-        }
-    }
-    if (notify) {
-        cv_.notify_one();
+    Work w = tmpl;
+    w.msg = msg;
+    if (!tryPost(w)) {
+        // 入队失败, 还给调用方
+        entry->mutable_data()->swap(cmd);
+        return false;
     }
     return true;
 }
 
 bool WorkThread::tryPost(const Work& w) {
-    {
-        std::lock_guard<std::mutex> lock(mu_);
-        if (!running_) return false;
-        if (queue_.size() >= capacity_) {
-            return false;
-        } else {
-            queue_.push(w);
-        }
+    if (!running_) return false;
+    if (size_.fetch_add(1) >= capacity_) {
+        --size_;
+        return false;
     }
-    cv_.notify_one();
+    enqueue(w);
     return true;
 }
 
 void WorkThread::post(const Work& w) {
-    {
-        std::lock_guard<std::mutex> lock(mu_);
-        if (!running_) return;
-        queue_.push(w);
-    }
-    cv_.notify_one();
+    if (!running_) return;
+    ++size_;
+    enqueue(w);
 }
 
 void WorkThread::waitPost(const Work& w) {
-    std::unique_lock<std::mutex> lock(mu_);
-    while (queue_.size() >= capacity_ && running_) {
-        cv_.wait(lock);
+    size_t size = size_;
+    while (running_) {
+        if (size >= capacity_) {
+            // 队列满，等待工作线程取走一批
+            std::unique_lock<std::mutex> lock(mu_);
+            ++full_waiters_;
+            not_full_.wait(lock, [this] { return size_ < capacity_ || !running_; });
+            --full_waiters_;
+            size = size_;
+        } else if (size_.compare_exchange_weak(size, size + 1)) {
+            enqueue(w);
+            return;
+        }
     }
+}
 
-    if (running_) {
-        queue_.push(w);
-        lock.unlock();
-        cv_.notify_one();
+void WorkThread::enqueue(const Work& w) {
+    queue_.Push(w);
+    // 工作线程可能正在等待，需要唤醒
+    if (sleeping_) {
+        std::lock_guard<std::mutex> lock(mu_);
+        not_empty_.notify_one();
     }
 }
 
@@ -117,58 +103,186 @@ void WorkThread::shutdown() {
         if (!running_) return;
         running_ = false;
     }
-    cv_.notify_one();
+    not_empty_.notify_one();
+    not_full_.notify_all();
     thr_->join();
 }
 
-bool WorkThread::pull(Work* w) {
-    std::unique_lock<std::mutex> lock(mu_);
+size_t WorkThread::drain(std::vector<Work>* batch) {
+    batch->clear();
+    size_t n = queue_.PopMany(batch, kMaxBatchSize);
+    if (n > 0) {
+        size_ -= n;
+        if (full_waiters_ > 0) {
+            // 通知队列已经不再满了
+            std::lock_guard<std::mutex> lock(mu_);
+            not_full_.notify_all();
+        }
+    }
+    return n;
+}
 
-    while (queue_.empty() && running_) {
-        cv_.wait(lock);
+bool WorkThread::wait() {
+    sleeping_ = true;
+    {
+        std::unique_lock<std::mutex> lock(mu_);
+        not_empty_.wait(lock, [this] { return size_ > 0 || !running_; });
     }
-    if (!running_) return false;
-    *w = queue_.front();
-    queue_.pop();
-
-    if (w->msg != nullptr && w->msg->type() == pb::LOCAL_MSG_PROP) {
-        assert(w->owner != 0);
-        auto it = batch_pos_.find(w->owner);
-        if (it != batch_pos_.end() && it->second == w->msg) {
-            assert(it->second->type() == pb::LOCAL_MSG_PROP);
-            batch_pos_.erase(it);
-        }
+    sleeping_ = false;
+    if (queue_.Empty()) {
+        // 生产者已经占了位置但还没有链接到队列上
+        std::this_thread::yield();
     }
+    return running_;
+}
 
-    lock.unlock();
-    cv_.notify_one();  // 通知队列已经不再满了
-    return true;
+void WorkThread::mergeProposals(std::vector<Work>* batch) {
+    // 把同一个owner相邻（中间没有该owner的其他work）的提案合并成一条消息
+    merge_pos_.clear();
+    size_t pos = 0;
+    for (size_t i = 0; i < batch->size(); ++i) {
+        auto& w = (*batch)[i];
+        bool is_prop = w.msg != nullptr && w.msg->type() == pb::LOCAL_MSG_PROP;
+        if (w.owner != 0) {
+            auto it = merge_pos_.find(w.owner);
+            if (is_prop && it != merge_pos_.end()) {
+                auto& target = (*batch)[it->second].msg;
+                if (target->entries_size() + w.msg->entries_size() <= kMaxBatchSize) {
+                    for (auto& e : *w.msg->mutable_entries()) {
+                        target->add_entries()->Swap(&e);
+                    }
+                    continue;
+                }
+            }
+            if (is_prop) {
+                merge_pos_[w.owner] = pos;
+            } else if (it != merge_pos_.end()) {
+                merge_pos_.erase(it);
+            }
+        }
+        if (pos != i) {
+            (*batch)[pos] = std::move(w);
+        }
+        ++pos;
+    }
+    batch->resize(pos);
 }
 
+static thread_local WorkThread* current_thread = nullptr;
+
+WorkThread* WorkThread::Current() { return current_thread; }
+
 void WorkThread::run() {
-    while (true) {
-        Work work;
-        if (pull(&work)) {
-            try {
-                work.Do();
-            } catch (RaftException& e) {
-                assert(work.owner > 0);
-                LOG_ERROR("raft[%llu] throw an exception: %s. removed.",
-                          work.owner, e.what());
-                server_->RemoveRaft(work.owner);
+    current_thread = this;
+    std::vector<Work> batch;
+    batch.reserve(kMaxBatchSize);
+    while (running_) {
+        if (drain(&batch) == 0) {
+            // 队列已空，先把本轮暂存的消息发出去再等待
+            flushMessages();
+            if (!wait()) {
+                // shutdown
+                return;
             }
-        } else {
-            // shutdown
-            return;
+            continue;
         }
+
+        mergeProposals(&batch);
+        for (auto& work : batch) {
+            if (work.home != nullptr && work.home->from != this) {
+                auto home = work.home->thread.load();
+                if (home != this) {
+                    // 不应该出现，转发给owner当前所在的线程
+                    home->post(work);
+                    continue;
+                }
+                if (work.home->from != nullptr) {
+                    // 旧线程还没执行完迁移前的work，先暂存
+                    work.home->parked.push_back(std::move(work));
+                    continue;
+                }
+            }
+            execute(work);
+        }
+
+        // 每处理一批发送一次，避免队列一直不空时消息延迟过大
+        flushMessages();
     }
 }
 
-int WorkThread::size() const {
-    std::lock_guard<std::mutex> lock(mu_);
-    return queue_.size();
+void WorkThread::execute(Work& work) {
+    auto start = std::chrono::steady_clock::now();
+    ++depth_;
+    try {
+        work.Do();
+    } catch (RaftException& e) {
+        assert(work.owner > 0);
+        LOG_ERROR("raft[%llu] throw an exception: %s. removed.",
+                  work.owner, e.what());
+        server_->RemoveRaft(work.owner);
+    }
+    --depth_;
+    uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+    // resume里嵌套执行的work已经算在外层
+    if (depth_ == 0) {
+        busy_ns_ += elapsed;
+    }
+    if (work.busy != nullptr) {
+        *work.busy += elapsed;
+    }
 }
 
+bool WorkThread::migrate(WorkHome* home, WorkThread* to,
+                         const std::shared_ptr<void>& holder) {
+    assert(Current() == this);
+    if (to == this || home->thread != this || home->from != nullptr) {
+        return false;
+    }
+
+    home->from = this;
+    home->thread = to;
+    // 等待已经选定本线程的投递完成，之后本线程队列里不会再有该owner的新work
+    while (home->posting > 0) {
+        std::this_thread::yield();
+    }
+
+    // 标记之前都是迁移前投递的work，由本线程执行完后再通知新线程
+    Work marker;
+    marker.f0 = [home, to, holder] {
+        Work w;
+        w.f0 = [home, to, holder] { to->resume(home); };
+        to->post(w);
+    };
+    post(marker);
+    return true;
+}
+
+void WorkThread::resume(WorkHome* home) {
+    assert(home->thread == this);
+    home->from = nullptr;
+
+    std::vector<Work> parked;
+    parked.swap(home->parked);
+    for (auto& w : parked) {
+        execute(w);
+    }
+}
+
+void WorkThread::sendMessage(const MessagePtr& msg) {
+    assert(sender_ != nullptr);
+    outbox_.push_back(msg);
+}
+
+void WorkThread::flushMessages() {
+    if (outbox_.empty()) return;
+    sender_->SendMessages(outbox_);
+    outbox_.clear();
+}
+
+int WorkThread::size() const { return static_cast<int>(size_.load()); }
+
 } /* namespace impl */
 } /* namespace raft */
 } /* namespace sharkstore */
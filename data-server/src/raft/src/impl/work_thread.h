@@ -4,10 +4,11 @@ _Pragma("once");
 #include <condition_variable>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <functional>
 #include <unordered_map>
+#include <vector>
+#include "mpsc_queue.h"
 #include "raft_types.h"
 
 namespace sharkstore {
@@ -17,11 +18,22 @@ namespace impl {
 class RaftImpl;
 class RaftServerImpl;
 
+namespace transport {
+class Transport;
+}
+
 static const int kMaxBatchSize = 64;
 
+class WorkThread;
+struct WorkHome;
+
 struct Work {
     uint64_t owner = 0;
     std::atomic<bool>* stopped = nullptr;
+    // owner所在的线程，为空表示owner不会被迁移
+    WorkHome* home = nullptr;
+    // 累加执行耗时（纳秒）
+    std::atomic<uint64_t>* busy = nullptr;
 
     std::function<void()> f0;
 
@@ -31,17 +43,52 @@ struct Work {
     void Do();
 };
 
+// owner（一个raft）所在的工作线程，owner可以在两次work之间迁移到其他线程
+// 迁移时新投递的work立即切到新线程，旧线程执行完迁移前已经投递的work后，
+// 新线程再按顺序执行期间暂存的work，保证同一个owner的work既不并发也不乱序
+struct WorkHome {
+    explicit WorkHome(WorkThread* t) : thread(t) {}
+
+    WorkHome(const WorkHome&) = delete;
+    WorkHome& operator=(const WorkHome&) = delete;
+
+    std::atomic<WorkThread*> thread;
+    // 正在向thread投递work的调用方数量
+    std::atomic<int> posting = {0};
+    // 迁移中的旧线程，迁移完成后为空
+    std::atomic<WorkThread*> from = {nullptr};
+    // 迁移完成前新线程收到的work，只在新线程内访问
+    std::vector<Work> parked;
+};
+
+// 投递work期间持有，迁移据此等待已经选定旧线程的投递完成
+class WorkHomeGuard {
+public:
+    explicit WorkHomeGuard(WorkHome* home) : home_(home) { ++home_->posting; }
+    ~WorkHomeGuard() { --home_->posting; }
+
+    WorkHomeGuard(const WorkHomeGuard&) = delete;
+    WorkHomeGuard& operator=(const WorkHomeGuard&) = delete;
+
+    WorkThread* thread() const { return home_->thread; }
+
+private:
+    WorkHome* home_ = nullptr;
+};
+
 class WorkThread {
 public:
     WorkThread(RaftServerImpl* server, size_t queue_capcity,
-               const std::string& name = "raft-worker");
+               const std::string& name = "raft-worker",
+               transport::Transport* sender = nullptr);
     ~WorkThread();
 
     WorkThread(const WorkThread&) = delete;
     WorkThread& operator=(const WorkThread&) = delete;
 
-    bool submit(uint64_t owner, std::atomic<bool>* stopped,
-                const std::function<void(MessagePtr&)>& f1, std::string& cmd);
+    // 提交一条用户命令，工作线程会把同一批里同一个owner相邻的提案合并成一条消息
+    // w需要设置owner、stopped和f1等字段，入队失败时cmd保持不变
+    bool submit(const Work& w, std::string& cmd, uint64_t trace_id);
 
     bool tryPost(const Work& w);
     void post(const Work& w);
@@ -49,21 +96,60 @@ public:
     void shutdown();
     int size() const;
 
+    // 线程累计执行work的时间（纳秒）
+    uint64_t busyNanos() const { return busy_ns_; }
+
+    // 只能在本线程内调用(即在home所属owner的Work里)
+    // 把owner迁移到to线程，holder保证迁移完成前home不被释放
+    // 新线程恢复执行owner的work后释放holder，to线程已停止时迁移中止，同样释放
+    // 已经在to线程上或者上一次迁移还未完成时返回false
+    bool migrate(WorkHome* home, WorkThread* to, const std::shared_ptr<void>& holder);
+
+    // 当前线程所在的WorkThread，不是工作线程时返回nullptr
+    static WorkThread* Current();
+
+    // 只能在本线程内调用(即在Work里)
+    // 暂存待发送的消息, 本轮队列处理完后按目标节点合并发送
+    void sendMessage(const MessagePtr& msg);
+
 private:
-    bool pull(Work* w);
+    void enqueue(const Work& w);
+    size_t drain(std::vector<Work>* batch);
+    bool wait();
+    void mergeProposals(std::vector<Work>* batch);
+
     void run();
+    void execute(Work& work);
+    void resume(WorkHome* home);
+
+    void flushMessages();
 
 private:
     RaftServerImpl* server_ = nullptr;
     const size_t capacity_ = 0;
 
     std::unique_ptr<std::thread> thr_;
-    bool running_ = false;
-    std::queue<Work> queue_;
-    // 记录每个range最近一条LOCAL_MSG_PROP消息，便于batch合并
-    std::unordered_map<uint64_t, MessagePtr> batch_pos_;
-    mutable std::mutex mu_;
-    std::condition_variable cv_;
+    std::atomic<bool> running_ = {false};
+
+    MPSCQueue<Work> queue_;
+    // 已入队（包括已占位还未链接）的work数量
+    std::atomic<size_t> size_ = {0};
+
+    // 只在队列空（工作线程等待）或者满（waitPost等待）时使用
+    std::mutex mu_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::atomic<bool> sleeping_ = {false};
+    std::atomic<int> full_waiters_ = {0};
+
+    // 合并提案时记录每个owner在本批中可以合并的提案位置，只在工作线程内访问
+    std::unordered_map<uint64_t, size_t> merge_pos_;
+
+    transport::Transport* sender_ = nullptr;
+    std::vector<MessagePtr> outbox_;
+
+    std::atomic<uint64_t> busy_ns_ = {0};
+    int depth_ = 0;
 };
 
 } /* namespace impl */
@@ -1,5 +1,7 @@
 #include "raft/options.h"
 
+#include "impl/compression.h"
+
 namespace sharkstore {
 namespace raft {
 
@@ -56,6 +58,17 @@ Status RaftServerOptions::Validate() const {
         }
     }
 
+    if (thread_balance_interval.count() > 0 &&
+        (thread_balance_threshold == 0 || thread_balance_threshold >= 100)) {
+        return Status(Status::kInvalidArgument, "raft server options",
+                      "thread balance threshold");
+    }
+
+    if (!impl::CompressionSupported(compression)) {
+        return Status(Status::kNotSupported, "raft server options",
+                      std::string("compression ") + impl::CompressionName(compression));
+    }
+
     if (heartbeat_tick == 0) {
         return Status(Status::kInvalidArgument, "raft server options", "heartbeat tick");
     }
@@ -71,6 +84,10 @@ Status RaftServerOptions::Validate() const {
         return Status(Status::kInvalidArgument, "raft server options",
                       "max size per msg");
     }
+    if (min_size_per_msg == 0) {
+        return Status(Status::kInvalidArgument, "raft server options",
+                      "min size per msg");
+    }
 
     if (consensus_threads_num == 0) {
         return Status(Status::kInvalidArgument, "raft server options",
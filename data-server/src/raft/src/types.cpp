@@ -16,6 +16,29 @@ std::string PeerTypeName(PeerType type) {
     }
 }
 
+const char* TraceStageName(TraceStage stage) {
+    switch (stage) {
+        case TraceStage::kAppend:
+            return "append";
+        case TraceStage::kReceive:
+            return "receive";
+        case TraceStage::kPersist:
+            return "persist";
+        case TraceStage::kSend:
+            return "send";
+        case TraceStage::kAck:
+            return "ack";
+        case TraceStage::kCommit:
+            return "commit";
+        case TraceStage::kApply:
+            return "apply";
+        case TraceStage::kApplied:
+            return "applied";
+        default:
+            return "unknown";
+    }
+}
+
 std::string Peer::ToString() const {
     std::ostringstream ss;
     ss << "{";
@@ -1,8 +1,10 @@
 #include <unistd.h>
-#include <cassert>
+#include <cstdlib>
 #include <iostream>
 #include <thread>
 #include <functional>
+#include <map>
+#include <set>
 
 #include "number_statemachine.h"
 #include "raft/raft.h"
@@ -11,6 +13,16 @@
 using namespace sharkstore;
 using namespace sharkstore::raft;
 
+// assert在NDEBUG(release)下不生效，检查失败时打印位置并退出
+#define CHECK(expr)                                                             \
+    do {                                                                        \
+        if (!(expr)) {                                                          \
+            std::cerr << __FILE__ << ":" << __LINE__ << " check failed: " #expr \
+                      << std::endl;                                             \
+            std::abort();                                                       \
+        }                                                                       \
+    } while (0)
+
 static const size_t kNodeNum = 5;
 
 std::condition_variable g_cv;
@@ -18,17 +30,28 @@ std::mutex g_mu;
 size_t g_finish_count = 0;
 std::vector<Peer> g_peers;
 
+// 每隔多少个提交带一个trace_id(等于提交的数字)
+static const int kTraceInterval = 1000;
+
 void run_node(uint64_t node_id) {
+    // 本节点上采样日志经过的阶段
+    std::mutex trace_mu;
+    std::map<uint64_t, std::set<std::string>> trace_stages;
+
     RaftServerOptions ops;
     ops.node_id = node_id;
     ops.tick_interval = std::chrono::milliseconds(100);
     ops.election_tick = 5;
     ops.transport_options.use_inprocess_transport = true;
+    ops.trace_recorder = [&](const TraceEvent& event) {
+        std::lock_guard<std::mutex> lock(trace_mu);
+        trace_stages[event.trace_id].insert(TraceStageName(event.stage));
+    };
 
     auto rs = CreateRaftServer(ops);
-    assert(rs);
+    CHECK(rs);
     auto s = rs->Start();
-    assert(s.ok());
+    CHECK(s.ok());
 
     auto sm = std::make_shared<raft::test::NumberStateMachine>(node_id);
 
@@ -41,7 +64,7 @@ void run_node(uint64_t node_id) {
     std::shared_ptr<Raft> r;
     s = rs->CreateRaft(rops, &r);
     std::cout << s.ToString() << std::endl;
-    assert(s.ok());
+    CHECK(s.ok());
 
     while (true) {
         uint64_t leader;
@@ -58,17 +81,30 @@ void run_node(uint64_t node_id) {
     if (r->IsLeader()) {
         for (int i = 1; i <= reqs_count; ++i) {
             std::string cmd = std::to_string(i);
-            s = r->Submit(cmd);
-            assert(s.ok());
+            s = r->Submit(cmd, i % kTraceInterval == 0 ? i : 0);
+            CHECK(s.ok());
         }
     }
 
     s = sm->WaitNumber(reqs_count);
-    assert(s.ok());
+    CHECK(s.ok());
 
     std::cout << "[NODE" << node_id << "]"
               << " wait number return: " << s.ToString() << std::endl;
 
+    // 先启动的节点通过复制收到日志，检查采样日志的各阶段
+    if (node_id <= kNodeNum - 2) {
+        std::set<std::string> expected;
+        if (r->IsLeader()) {
+            expected = {"append", "persist", "send", "ack", "commit", "apply", "applied"};
+        } else {
+            expected = {"receive", "persist", "commit", "apply", "applied"};
+        }
+        std::lock_guard<std::mutex> lock(trace_mu);
+        CHECK(trace_stages[kTraceInterval] == expected);
+        CHECK(trace_stages.count(kTraceInterval + 1) == 0);
+    }
+
     r->Truncate(3);
 
     // 本节点任务完成
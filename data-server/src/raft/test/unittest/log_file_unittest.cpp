@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include "base/util.h"
+#include "raft/src/impl/compression.h"
 #include "raft/src/impl/storage/log_file.h"
 #include "test_util.h"
 
@@ -15,6 +16,7 @@ using namespace sharkstore::raft::impl;
 using namespace sharkstore::raft::impl::testutil;
 using namespace sharkstore::raft::impl::storage;
 using sharkstore::Status;
+using sharkstore::raft::CompressionType;
 using sharkstore::randomInt;
 
 class LogFileTest : public ::testing::Test {
@@ -172,4 +174,70 @@ TEST_F(LogFileTest, Recover) {
     }
 }
 
+TEST(LogFileCompression, AppendAndRecover) {
+    for (auto type : {CompressionType::kLZ4, CompressionType::kZstd}) {
+        if (!CompressionSupported(type)) continue;
+
+        char path[] = "/tmp/sharkstore_raft_log_test_XXXXXX";
+        char* tmp = mkdtemp(path);
+        ASSERT_TRUE(tmp != NULL);
+        std::string dir = tmp;
+
+        // 一半可压缩的大日志，一半低于阈值的小日志
+        std::vector<EntryPtr> entries;
+        for (uint64_t i = 1; i <= 20; ++i) {
+            auto e = RandomEntry(i, 10);
+            if (i % 2 == 0) {
+                e->set_data(std::string(4096, static_cast<char>('a' + i % 26)));
+            }
+            entries.push_back(e);
+        }
+
+        std::unique_ptr<LogFile> f(new LogFile(dir, 1, 1, false, type, 256));
+        auto s = f->Open(false);
+        ASSERT_TRUE(s.ok()) << s.ToString();
+        for (const auto& e : entries) {
+            s = f->Append(e);
+            ASSERT_TRUE(s.ok()) << s.ToString();
+        }
+        s = f->Flush();
+        ASSERT_TRUE(s.ok()) << s.ToString();
+        ASSERT_LT(f->FileSize(), 10 * 4096) << CompressionName(type);
+
+        auto check = [&entries](LogFile* lf) {
+            ASSERT_EQ(lf->LastIndex(), entries.size());
+            for (uint64_t i = 1; i <= entries.size(); ++i) {
+                EntryPtr e;
+                auto s = lf->Get(i, &e);
+                ASSERT_TRUE(s.ok()) << s.ToString();
+                s = Equal(e, entries[i - 1]);
+                ASSERT_TRUE(s.ok()) << s.ToString();
+            }
+        };
+        check(f.get());
+
+        // 遍历恢复，不开启压缩也能读
+        f.reset(new LogFile(dir, 1, 1));
+        s = f->Open(false, true);
+        ASSERT_TRUE(s.ok()) << s.ToString();
+        check(f.get());
+        f.reset();
+
+        // 写入索引后加载
+        f.reset(new LogFile(dir, 1, 1, false, type, 256));
+        s = f->Open(false, true);
+        ASSERT_TRUE(s.ok()) << s.ToString();
+        s = f->Rotate();
+        ASSERT_TRUE(s.ok()) << s.ToString();
+        f.reset(new LogFile(dir, 1, 1));
+        s = f->Open(false, false);
+        ASSERT_TRUE(s.ok()) << s.ToString();
+        check(f.get());
+
+        s = f->Destroy();
+        ASSERT_TRUE(s.ok()) << s.ToString();
+        std::remove(dir.c_str());
+    }
+}
+
 }  // namespace
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "raft/src/impl/mpsc_queue.h"
+
+int main(int argc, char* argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace {
+
+using namespace sharkstore::raft::impl;
+
+TEST(MPSCQueue, Basic) {
+    MPSCQueue<int> q;
+    int v = 0;
+    ASSERT_TRUE(q.Empty());
+    ASSERT_FALSE(q.Pop(&v));
+
+    for (int i = 0; i < 10; ++i) {
+        q.Push(i);
+    }
+    ASSERT_FALSE(q.Empty());
+    ASSERT_TRUE(q.Pop(&v));
+    ASSERT_EQ(v, 0);
+
+    std::vector<int> out;
+    ASSERT_EQ(q.PopMany(&out, 5), 5U);
+    ASSERT_EQ(out, std::vector<int>({1, 2, 3, 4, 5}));
+    ASSERT_EQ(q.PopMany(&out, 100), 4U);
+    ASSERT_EQ(out.size(), 9U);
+    ASSERT_EQ(out.back(), 9);
+    ASSERT_TRUE(q.Empty());
+
+    // 析构时释放未取出的元素
+    MPSCQueue<std::shared_ptr<int>> q2;
+    auto p = std::make_shared<int>(1);
+    q2.Push(p);
+    q2.Push(p);
+    ASSERT_EQ(p.use_count(), 3);
+}
+
+TEST(MPSCQueue, MultiProducer) {
+    const int kProducers = 4;
+    const int kCount = 100000;
+
+    MPSCQueue<std::pair<int, int>> q;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&q, p] {
+            for (int i = 0; i < kCount; ++i) {
+                q.Push(std::make_pair(p, i));
+            }
+        });
+    }
+
+    // 每个生产者的元素保持入队顺序
+    std::vector<int> next(kProducers, 0);
+    int total = 0;
+    std::vector<std::pair<int, int>> batch;
+    while (total < kProducers * kCount) {
+        batch.clear();
+        if (q.PopMany(&batch, 64) == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (const auto& item : batch) {
+            ASSERT_EQ(item.second, next[item.first]);
+            ++next[item.first];
+        }
+        total += static_cast<int>(batch.size());
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    ASSERT_TRUE(q.Empty());
+}
+
+} /* namespace  */
@@ -122,4 +122,86 @@ TEST(Replica, Inflight) {
     ASSERT_TRUE(inflight.full());
 }
 
+TEST(Replica, InflightBytes) {
+    FlowBudget budget(0);
+    FlowGroup group(&budget);
+    Inflight inflight(100, 1000, &group);
+    inflight.add(1, 400);
+    ASSERT_FALSE(inflight.full());
+    inflight.add(2, 600);
+    ASSERT_TRUE(inflight.full());
+    ASSERT_EQ(inflight.bytes(), 1000);
+    ASSERT_EQ(group.Used(), 1000);
+    ASSERT_EQ(budget.Used(), 1000);
+    ASSERT_EQ(budget.ActiveGroups(), 1);
+
+    inflight.freeTo(1);
+    ASSERT_FALSE(inflight.full());
+    ASSERT_EQ(inflight.bytes(), 600);
+    ASSERT_EQ(budget.Used(), 600);
+
+    inflight.reset();
+    ASSERT_EQ(inflight.bytes(), 0);
+    ASSERT_EQ(budget.Used(), 0);
+    ASSERT_EQ(budget.ActiveGroups(), 0);
+
+    {
+        Inflight other(10, 0, &group);
+        other.add(10, 123);
+        ASSERT_EQ(budget.Used(), 123);
+    }
+    // released on destruction
+    ASSERT_EQ(budget.Used(), 0);
+}
+
+TEST(Replica, FlowBudget) {
+    FlowBudget budget(1000);
+    FlowGroup g1(&budget), g2(&budget);
+
+    // the first message of a group is always allowed
+    ASSERT_TRUE(g1.Allow(2000));
+    g1.Acquire(800);
+    ASSERT_TRUE(g1.Allow(200));
+    ASSERT_FALSE(g1.Allow(201));
+
+    // another group becomes active, shares are halved
+    ASSERT_TRUE(g2.Allow(100));
+    g2.Acquire(100);
+    ASSERT_EQ(budget.ActiveGroups(), 2);
+    ASSERT_FALSE(g1.Allow(1));
+    ASSERT_TRUE(g2.Allow(100));
+    ASSERT_FALSE(g2.Allow(101));
+
+    g1.Release(800);
+    ASSERT_EQ(budget.ActiveGroups(), 1);
+    ASSERT_TRUE(g2.Allow(900));
+    ASSERT_FALSE(g2.Allow(901));
+}
+
+TEST(Replica, AdaptiveMsgSize) {
+    AdaptiveMsgSize size(1024, 1024 * 1024);
+    ASSERT_EQ(size.Size(), 1024 * 1024);
+
+    for (int i = 0; i < 10; ++i) {
+        size.OnAck(std::chrono::microseconds(100));
+    }
+    ASSERT_EQ(size.Size(), 1024 * 1024);
+
+    // rtt rises a lot, size shrinks
+    size.OnAck(std::chrono::microseconds(10000));
+    ASSERT_EQ(size.Size(), 512 * 1024);
+
+    // shrinks to the lower bound at most
+    for (int i = 0; i < 1000; ++i) {
+        size.OnAck(std::chrono::microseconds(100000));
+    }
+    ASSERT_GE(size.Size(), 1024);
+
+    // grows back when the rtt recovers
+    for (int i = 0; i < 2000; ++i) {
+        size.OnAck(std::chrono::microseconds(100));
+    }
+    ASSERT_EQ(size.Size(), 1024 * 1024);
+}
+
 }  // namespace
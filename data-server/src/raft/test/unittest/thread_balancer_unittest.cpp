@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include "raft/src/impl/thread_balancer.h"
+
+int main(int argc, char* argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace {
+
+using namespace sharkstore::raft::impl;
+
+GroupLoad makeGroup(uint64_t id, size_t thread, uint64_t busy) {
+    GroupLoad g;
+    g.id = id;
+    g.thread = thread;
+    g.busy = busy;
+    return g;
+}
+
+TEST(ThreadBalancer, Balanced) {
+    std::vector<uint64_t> threads = {100, 95, 105};
+    std::vector<GroupLoad> groups = {makeGroup(1, 0, 100), makeGroup(2, 1, 95),
+                                     makeGroup(3, 2, 105)};
+    ASSERT_TRUE(PlanMigrations(threads, groups, 20, 4).empty());
+}
+
+TEST(ThreadBalancer, MoveHot) {
+    // 两个热点group挤在线程0上
+    std::vector<uint64_t> threads = {200, 10, 0};
+    std::vector<GroupLoad> groups = {makeGroup(1, 0, 100), makeGroup(2, 0, 90),
+                                     makeGroup(3, 0, 10), makeGroup(4, 1, 10)};
+    auto plans = PlanMigrations(threads, groups, 20, 1);
+    ASSERT_EQ(plans.size(), 1U);
+    ASSERT_EQ(plans[0].id, 1U);
+    ASSERT_EQ(plans[0].from, 0U);
+    ASSERT_EQ(plans[0].to, 2U);
+}
+
+TEST(ThreadBalancer, SingleGroup) {
+    // 线程上只有一个group时迁移不会带来改善
+    std::vector<uint64_t> threads = {200, 0};
+    std::vector<GroupLoad> groups = {makeGroup(1, 0, 200)};
+    ASSERT_TRUE(PlanMigrations(threads, groups, 20, 4).empty());
+}
+
+TEST(ThreadBalancer, MaxMoves) {
+    std::vector<uint64_t> threads = {400, 0, 0, 0};
+    std::vector<GroupLoad> groups;
+    for (uint64_t i = 1; i <= 8; ++i) {
+        groups.push_back(makeGroup(i, 0, 50));
+    }
+    auto plans = PlanMigrations(threads, groups, 10, 2);
+    ASSERT_EQ(plans.size(), 2U);
+    ASSERT_NE(plans[0].id, plans[1].id);
+    ASSERT_NE(plans[0].to, plans[1].to);
+
+    plans = PlanMigrations(threads, groups, 10, 100);
+    std::vector<uint64_t> result = threads;
+    for (const auto& m : plans) {
+        result[m.from] -= 50;
+        result[m.to] += 50;
+    }
+    for (auto busy : result) {
+        ASSERT_EQ(busy, 100U);
+    }
+}
+
+TEST(ThreadBalancer, PickThread) {
+    std::vector<uint64_t> threads = {0, 0, 0};
+    ASSERT_EQ(PickThread(threads, 0), 0U);
+    ASSERT_EQ(PickThread(threads, 4), 1U);
+
+    threads = {30, 10, 20};
+    ASSERT_EQ(PickThread(threads, 0), 1U);
+    ASSERT_EQ(PickThread(threads, 2), 1U);
+}
+
+} /* namespace  */
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include "base/util.h"
+#include "raft/src/impl/compression.h"
+#include "raft/src/impl/transport/fast_protocol.h"
+#include "test_util.h"
+
+int main(int argc, char* argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace {
+
+using namespace sharkstore;
+using namespace sharkstore::raft;
+using namespace sharkstore::raft::impl;
+using namespace sharkstore::raft::impl::transport;
+using namespace sharkstore::raft::impl::testutil;
+
+MessagePtr randomMessage(uint64_t id) {
+    MessagePtr msg(new pb::Message);
+    msg->set_type(pb::APPEND_ENTRIES_REQUEST);
+    msg->set_id(id);
+    msg->set_from(1);
+    msg->set_to(2);
+    msg->set_term(randomInt());
+    msg->set_commit(randomInt());
+    int n = randomInt() % 5;
+    for (int i = 0; i < n; ++i) {
+        auto e = RandomEntry(i + 1, randomInt() % 200);
+        msg->add_entries()->CopyFrom(*e);
+    }
+    return msg;
+}
+
+TEST(TransportBatch, Coding) {
+    std::vector<MessagePtr> msgs;
+    for (uint64_t i = 1; i <= 50; ++i) {
+        msgs.push_back(randomMessage(i));
+    }
+
+    size_t begin = 3, end = 40;
+    size_t len = BatchEncodedSize(msgs, begin, end);
+    std::vector<char> buf(len);
+    ASSERT_TRUE(EncodeBatch(msgs, begin, end, buf.data(), len));
+
+    std::vector<MessagePtr> decoded;
+    ASSERT_TRUE(DecodeBatch(buf.data(), len, &decoded));
+    ASSERT_EQ(decoded.size(), end - begin);
+    for (size_t i = 0; i < decoded.size(); ++i) {
+        ASSERT_EQ(decoded[i]->SerializeAsString(), msgs[begin + i]->SerializeAsString());
+    }
+
+    // truncated
+    decoded.clear();
+    ASSERT_FALSE(DecodeBatch(buf.data(), len - 1, &decoded));
+
+    // buffer too small
+    ASSERT_FALSE(EncodeBatch(msgs, begin, end, buf.data(), len - 1));
+}
+
+TEST(TransportBatch, Empty) {
+    std::vector<MessagePtr> msgs;
+    size_t len = BatchEncodedSize(msgs, 0, 0);
+    ASSERT_EQ(len, kBatchLengthSize);
+    std::vector<char> buf(len);
+    ASSERT_TRUE(EncodeBatch(msgs, 0, 0, buf.data(), len));
+
+    std::vector<MessagePtr> decoded;
+    ASSERT_TRUE(DecodeBatch(buf.data(), len, &decoded));
+    ASSERT_TRUE(decoded.empty());
+}
+
+TEST(TransportBatch, Compressed) {
+    std::vector<MessagePtr> msgs;
+    for (uint64_t i = 1; i <= 20; ++i) {
+        auto msg = randomMessage(i);
+        auto e = msg->add_entries();
+        e->set_index(i);
+        e->set_data(std::string(1024, 'x'));
+        msgs.push_back(msg);
+    }
+
+    for (auto type : {CompressionType::kLZ4, CompressionType::kZstd}) {
+        size_t len = BatchEncodedSize(msgs, 0, msgs.size());
+        size_t max_len = MaxCompressedBatchSize(type, len);
+        if (!CompressionSupported(type)) {
+            ASSERT_EQ(max_len, 0U);
+            continue;
+        }
+        ASSERT_GT(max_len, len);
+        std::vector<char> body(max_len);
+        size_t body_len =
+            EncodeCompressedBatch(type, msgs, 0, msgs.size(), len, body.data(), body.size());
+        ASSERT_GT(body_len, 0U);
+        ASSERT_LT(body_len, len);
+
+        std::vector<MessagePtr> decoded;
+        ASSERT_TRUE(DecodeCompressedBatch(body.data(), body_len, &decoded));
+        ASSERT_EQ(decoded.size(), msgs.size());
+        for (size_t i = 0; i < decoded.size(); ++i) {
+            ASSERT_EQ(decoded[i]->SerializeAsString(), msgs[i]->SerializeAsString());
+        }
+
+        // corrupted
+        decoded.clear();
+        ASSERT_FALSE(DecodeCompressedBatch(body.data(), body_len / 2, &decoded));
+
+        // 单条消息(不合并时)同样压缩
+        len = BatchEncodedSize(msgs, 5, 6);
+        body.resize(MaxCompressedBatchSize(type, len));
+        body_len = EncodeCompressedBatch(type, msgs, 5, 6, len, body.data(), body.size());
+        ASSERT_GT(body_len, 0U);
+        ASSERT_LT(body_len, len);
+        decoded.clear();
+        ASSERT_TRUE(DecodeCompressedBatch(body.data(), body_len, &decoded));
+        ASSERT_EQ(decoded.size(), 1U);
+        ASSERT_EQ(decoded[0]->SerializeAsString(), msgs[5]->SerializeAsString());
+
+        // 缓冲区不够
+        ASSERT_EQ(EncodeCompressedBatch(type, msgs, 5, 6, len, body.data(), body.size() - 1),
+                  0U);
+
+        // 没有压缩收益
+        std::vector<MessagePtr> small{randomMessage(100)};
+        small[0]->clear_entries();
+        len = BatchEncodedSize(small, 0, 1);
+        body.resize(MaxCompressedBatchSize(type, len));
+        ASSERT_EQ(EncodeCompressedBatch(type, small, 0, 1, len, body.data(), body.size()), 0U);
+    }
+
+    // 未知的压缩算法
+    std::string bad(16, '\x0f');
+    std::vector<MessagePtr> decoded;
+    ASSERT_FALSE(DecodeCompressedBatch(bad.data(), bad.size(), &decoded));
+}
+
+TEST(TransportBatch, PeerCompressions) {
+    PeerCompressions peers;
+    ASSERT_FALSE(peers.Supported(1, CompressionType::kLZ4));
+    ASSERT_FALSE(peers.BatchSupported(1));
+
+    uint8_t flags = (1U << static_cast<uint8_t>(CompressionType::kNone)) |
+                    (1U << static_cast<uint8_t>(CompressionType::kLZ4));
+    peers.Update(1, kRaftProtoVersion, flags);
+    ASSERT_TRUE(peers.Supported(1, CompressionType::kLZ4));
+    ASSERT_FALSE(peers.Supported(1, CompressionType::kZstd));
+    ASSERT_FALSE(peers.Supported(2, CompressionType::kLZ4));
+    ASSERT_TRUE(peers.BatchSupported(1));
+    ASSERT_FALSE(peers.BatchSupported(2));
+
+    // 旧版本节点的flags不可信，也不能解析batch包
+    peers.Update(1, kRaftProtoVersion - 1, 0xff);
+    ASSERT_FALSE(peers.Supported(1, CompressionType::kLZ4));
+    ASSERT_FALSE(peers.BatchSupported(1));
+}
+
+} /* namespace  */
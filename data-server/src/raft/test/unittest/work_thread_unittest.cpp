@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "raft/options.h"
+#include "raft/src/impl/server_impl.h"
+#include "raft/src/impl/work_thread.h"
+
+int main(int argc, char* argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace {
+
+using namespace sharkstore::raft;
+using namespace sharkstore::raft::impl;
+
+// 记录一个owner的work的执行顺序、所在线程和并发情况
+struct Recorder {
+    std::mutex mu;
+    std::vector<int> order;
+    std::vector<WorkThread*> threads;
+    std::atomic<int> running = {0};
+    std::atomic<bool> overlapped = {false};
+
+    void record(int i) {
+        if (++running != 1) overlapped = true;
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            order.push_back(i);
+            threads.push_back(WorkThread::Current());
+        }
+        --running;
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mu);
+        return order.size();
+    }
+};
+
+bool waitFor(const std::function<bool()>& pred) {
+    for (int i = 0; i < 500; ++i) {
+        if (pred()) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return pred();
+}
+
+void postTo(WorkHome* home, const std::function<void()>& f) {
+    Work w;
+    w.owner = 1;
+    w.home = home;
+    w.f0 = f;
+    WorkHomeGuard guard(home);
+    guard.thread()->post(w);
+}
+
+// 释放时置位，用于确认holder在各种结束路径上都被释放
+std::shared_ptr<void> newHolder(std::atomic<bool>* released) {
+    return std::shared_ptr<void>(nullptr, [released](void*) { *released = true; });
+}
+
+TEST(WorkThread, MigrateOrder) {
+    RaftServerImpl server((RaftServerOptions()));
+    WorkThread a(&server, 10000, "test-a");
+    WorkThread b(&server, 10000, "test-b");
+    WorkHome home(&a);
+    Recorder rec;
+    std::atomic<bool> released = {false};
+    auto holder = newHolder(&released);
+
+    const int kWorks = 2000;
+    const int kMigrateAt = 500;
+    auto post = [&](int i) {
+        postTo(&home, [&rec, &home, &b, holder, i] {
+            rec.record(i);
+            if (i == kMigrateAt) {
+                ASSERT_TRUE(WorkThread::Current()->migrate(&home, &b, holder));
+                // 旧线程还在执行时，新投递的work只能在新线程暂存
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+        });
+    };
+    for (int i = 0; i < kWorks / 2; ++i) {
+        post(i);
+    }
+    // 迁移开始后投递的work直接进入新线程
+    ASSERT_TRUE(waitFor([&] { return home.thread.load() == &b; }));
+    for (int i = kWorks / 2; i < kWorks; ++i) {
+        post(i);
+    }
+    holder.reset();
+
+    ASSERT_TRUE(waitFor([&] { return rec.size() == static_cast<size_t>(kWorks); }));
+    ASSERT_TRUE(waitFor([&] { return released.load(); }));
+    ASSERT_FALSE(rec.overlapped);
+    ASSERT_EQ(home.thread.load(), &b);
+    ASSERT_EQ(home.from.load(), nullptr);
+
+    // 顺序不变，迁移之前在旧线程，切到新线程后不再回到旧线程
+    bool moved = false;
+    for (int i = 0; i < kWorks; ++i) {
+        ASSERT_EQ(rec.order[i], i);
+        if (i <= kMigrateAt) {
+            ASSERT_EQ(rec.threads[i], &a);
+        } else if (i >= kWorks / 2) {
+            ASSERT_EQ(rec.threads[i], &b);
+        }
+        if (rec.threads[i] == &b) moved = true;
+        if (moved) {
+            ASSERT_EQ(rec.threads[i], &b) << i;
+        }
+    }
+    ASSERT_TRUE(moved);
+    ASSERT_EQ(rec.threads.back(), &b);
+}
+
+TEST(WorkThread, MigrateConcurrentPost) {
+    RaftServerImpl server((RaftServerOptions()));
+    WorkThread a(&server, 100000, "test-a");
+    WorkThread b(&server, 100000, "test-b");
+    WorkHome home(&a);
+    Recorder rec;
+
+    // 多个生产者并发投递，同时来回迁移，同一个owner的work不能并发执行
+    const int kProducers = 4;
+    const int kWorks = 5000;
+    std::atomic<int> migrations = {0};
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p] {
+            for (int i = 0; i < kWorks; ++i) {
+                postTo(&home, [&, i] {
+                    rec.record(i);
+                    if (i % 500 == 0) {
+                        auto cur = WorkThread::Current();
+                        auto to = cur == &a ? &b : &a;
+                        if (cur->migrate(&home, to, nullptr)) ++migrations;
+                    }
+                });
+            }
+        });
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+
+    ASSERT_TRUE(waitFor([&] { return rec.size() == static_cast<size_t>(kProducers * kWorks); }));
+    ASSERT_FALSE(rec.overlapped);
+    ASSERT_GT(migrations.load(), 0);
+    ASSERT_TRUE(waitFor([&] { return home.from.load() == nullptr; }));
+}
+
+TEST(WorkThread, MigrateReject) {
+    RaftServerImpl server((RaftServerOptions()));
+    WorkThread a(&server, 100, "test-a");
+    WorkThread b(&server, 100, "test-b");
+    WorkHome home(&a);
+    std::atomic<bool> released = {false};
+    auto holder = newHolder(&released);
+
+    std::atomic<int> step = {0};
+    postTo(&home, [&home, &a, &b, &step, holder] {
+        auto cur = WorkThread::Current();
+        // 已经在目标线程上
+        EXPECT_FALSE(cur->migrate(&home, &a, holder));
+        EXPECT_TRUE(cur->migrate(&home, &b, holder));
+        // 上一次迁移还未完成
+        EXPECT_FALSE(cur->migrate(&home, &a, holder));
+        ++step;
+    });
+    holder.reset();
+
+    ASSERT_TRUE(waitFor([&] { return step == 1 && released.load(); }));
+    ASSERT_EQ(home.thread.load(), &b);
+    ASSERT_EQ(home.from.load(), nullptr);
+}
+
+TEST(WorkThread, MigrateAbort) {
+    RaftServerImpl server((RaftServerOptions()));
+    WorkThread a(&server, 100, "test-a");
+    WorkThread b(&server, 100, "test-b");
+    b.shutdown();
+    WorkHome home(&a);
+    std::atomic<bool> released = {false};
+    auto holder = newHolder(&released);
+
+    // 目标线程已经停止，恢复work投递不出去，迁移中止也要释放holder
+    std::atomic<bool> migrated = {false};
+    postTo(&home, [&home, &b, &migrated, holder] {
+        migrated = WorkThread::Current()->migrate(&home, &b, holder);
+    });
+    holder.reset();
+
+    ASSERT_TRUE(waitFor([&] { return released.load(); }));
+    ASSERT_TRUE(migrated);
+
+    // 被丢弃的work同样释放holder
+    released = false;
+    holder = newHolder(&released);
+    postTo(&home, [holder] {});
+    holder.reset();
+    ASSERT_TRUE(released);
+}
+
+} /* namespace  */
@@ -38,7 +38,8 @@ void Range::Delete(common::ProtoMessage *msg, kvrpcpb::DsDeleteRequest &req) {
     errorpb::Error *err = nullptr;
 
     auto btime = get_micro_second();
-    context_->Statistics()->PushTime(HistogramType::kQWait, btime - msg->begin_time);
+    context_->Statistics()->PushTime(HistogramType::kQWait, btime - msg->begin_time,
+                                     msg->header.func_id);
 
     RANGE_LOG_DEBUG("Delete begin");
 
@@ -120,7 +121,8 @@ Status Range::ApplyDelete(const raft_cmdpb::Command &cmd) {
         }
 
         ret = store_->DeleteRows(req, &affected_keys);
-        context_->Statistics()->PushTime(HistogramType::kStore, get_micro_second() - btime);
+        context_->Statistics()->PushTime(HistogramType::kStore, get_micro_second() - btime,
+                                         funcpb::kFuncDelete);
 
         if (!ret.ok()) {
             RANGE_LOG_ERROR("ApplyDelete failed, code:%d, msg:%s", ret.code(),
@@ -12,7 +12,8 @@ void Range::Insert(common::ProtoMessage *msg, kvrpcpb::DsInsertRequest &req) {
     errorpb::Error *err = nullptr;
 
     auto btime = get_micro_second();
-    context_->Statistics()->PushTime(HistogramType::kQWait, btime - msg->begin_time);
+    context_->Statistics()->PushTime(HistogramType::kQWait, btime - msg->begin_time,
+                                     msg->header.func_id);
 
     RANGE_LOG_DEBUG("Insert begin");
 
@@ -68,7 +69,7 @@ Status Range::ApplyInsert(const raft_cmdpb::Command &cmd) {
 
         ret = store_->Insert(req, &affected_keys);
         auto etime = get_micro_second();
-        context_->Statistics()->PushTime(HistogramType::kStore, etime - btime);
+        context_->Statistics()->PushTime(HistogramType::kStore, etime - btime, funcpb::kFuncInsert);
 
         if (!ret.ok()) {
             RANGE_LOG_ERROR("ApplyInsert failed, code:%d, msg:%s", ret.code(),
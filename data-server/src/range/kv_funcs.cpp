@@ -14,7 +14,7 @@ using namespace sharkstore::monitor;
 
 void Range::KVSet(common::ProtoMessage *msg, kvrpcpb::DsKvSetRequest &req) {
     context_->Statistics()->PushTime(HistogramType::kQWait,
-            get_micro_second() - msg->begin_time);
+            get_micro_second() - msg->begin_time, msg->header.func_id);
 
     if (!CheckWriteable()) {
         auto resp = new kvrpcpb::DsKvSetResponse;
@@ -85,7 +85,8 @@ Status Range::ApplyKVSet(const raft_cmdpb::Command &cmd) {
             }
         }
         ret = store_->Put(req.kv().key(), req.kv().value());
-        context_->Statistics()->PushTime(HistogramType::kStore, get_micro_second() - btime);
+        context_->Statistics()->PushTime(HistogramType::kStore, get_micro_second() - btime,
+                                         funcpb::kFuncKvSet);
 
         if (cmd.cmd_id().node_id() == node_id_) {
             auto len = req.kv().key().size() + req.kv().value().size();
@@ -106,7 +107,7 @@ Status Range::ApplyKVSet(const raft_cmdpb::Command &cmd) {
 
 void Range::KVGet(common::ProtoMessage *msg, kvrpcpb::DsKvGetRequest &req) {
     context_->Statistics()->PushTime(HistogramType::kQWait,
-                                   get_micro_second() - msg->begin_time);
+                                   get_micro_second() - msg->begin_time, msg->header.func_id);
 
     errorpb::Error *err = nullptr;
     auto ds_resp = new kvrpcpb::DsKvGetResponse;
@@ -129,7 +130,7 @@ void Range::KVGet(common::ProtoMessage *msg, kvrpcpb::DsKvGetRequest &req) {
         auto ret = store_->Get(req.req().key(), resp->mutable_value());
 
         context_->Statistics()->PushTime(HistogramType::kStore,
-                                       get_micro_second() - btime);
+                                       get_micro_second() - btime, msg->header.func_id);
 
         resp->set_code(static_cast<int>(ret.code()));
     } while (false);
@@ -142,7 +143,7 @@ void Range::KVBatchSet(common::ProtoMessage *msg,
                        kvrpcpb::DsKvBatchSetRequest &req) {
     Status ret;
     context_->Statistics()->PushTime(HistogramType::kQWait,
-                                   get_micro_second() - msg->begin_time);
+                                   get_micro_second() - msg->begin_time, msg->header.func_id);
 
     if (!CheckWriteable()) {
         auto resp = new kvrpcpb::DsKvBatchSetResponse;
@@ -221,7 +222,7 @@ Status Range::ApplyKVBatchSet(const raft_cmdpb::Command &cmd) {
 
         ret = store_->BatchSet(keyValues);
         context_->Statistics()->PushTime(HistogramType::kStore,
-                                       get_micro_second() - btime);
+                                       get_micro_second() - btime, funcpb::kFuncKvBatchSet);
 
         if (!ret.ok()) {
             RANGE_LOG_ERROR("ApplyKVBatchSet failed, code:%d, msg:%s", ret.code(),
@@ -249,7 +250,7 @@ Status Range::ApplyKVBatchSet(const raft_cmdpb::Command &cmd) {
 void Range::KVBatchGet(common::ProtoMessage *msg,
                        kvrpcpb::DsKvBatchGetRequest &req) {
     context_->Statistics()->PushTime(HistogramType::kQWait,
-                                   get_micro_second() - msg->begin_time);
+                                   get_micro_second() - msg->begin_time, msg->header.func_id);
 
     errorpb::Error *err = nullptr;
     auto ds_resp = new kvrpcpb::DsKvBatchGetResponse;
@@ -275,7 +276,7 @@ void Range::KVBatchGet(common::ProtoMessage *msg,
         }
     }
 
-    context_->Statistics()->PushTime(HistogramType::kStore, total_time);
+    context_->Statistics()->PushTime(HistogramType::kStore, total_time, msg->header.func_id);
 
     common::SetResponseHeader(req.header(), header, err);
     context_->SocketSession()->Send(msg, ds_resp);
@@ -284,7 +285,7 @@ void Range::KVBatchGet(common::ProtoMessage *msg,
 void Range::KVDelete(common::ProtoMessage *msg,
                      kvrpcpb::DsKvDeleteRequest &req) {
     context_->Statistics()->PushTime(HistogramType::kQWait,
-                                   get_micro_second() - msg->begin_time);
+                                   get_micro_second() - msg->begin_time, msg->header.func_id);
 
     if (!CheckWriteable()) {
         auto resp = new kvrpcpb::DsKvDeleteResponse;
@@ -336,7 +337,7 @@ Status Range::ApplyKVDelete(const raft_cmdpb::Command &cmd) {
 
         ret = store_->Delete(req.key());
         context_->Statistics()->PushTime(HistogramType::kStore,
-                                       get_micro_second() - btime);
+                                       get_micro_second() - btime, funcpb::kFuncKvDel);
 
         if (!ret.ok()) {
             RANGE_LOG_ERROR("ApplyKVDelete failed, code:%d, msg:%s", ret.code(),
@@ -358,7 +359,7 @@ Status Range::ApplyKVDelete(const raft_cmdpb::Command &cmd) {
 void Range::KVBatchDelete(common::ProtoMessage *msg,
                           kvrpcpb::DsKvBatchDeleteRequest &req) {
     context_->Statistics()->PushTime(HistogramType::kQWait,
-                                   get_micro_second() - msg->begin_time);
+                                   get_micro_second() - msg->begin_time, msg->header.func_id);
     errorpb::Error *err = nullptr;
 
     if (!CheckWriteable()) {
@@ -435,7 +436,7 @@ Status Range::ApplyKVBatchDelete(const raft_cmdpb::Command &cmd) {
 
         ret = store_->BatchDelete(delKeys);
         context_->Statistics()->PushTime(HistogramType::kStore,
-                                       get_micro_second() - btime);
+                                       get_micro_second() - btime, funcpb::kFuncKvBatchDel);
 
         if (!ret.ok()) {
             RANGE_LOG_ERROR("ApplyKVBatchDelete failed, code:%d, msg:%s", ret.code(),
@@ -459,7 +460,7 @@ Status Range::ApplyKVBatchDelete(const raft_cmdpb::Command &cmd) {
 void Range::KVRangeDelete(common::ProtoMessage *msg,
                           kvrpcpb::DsKvRangeDeleteRequest &req) {
     context_->Statistics()->PushTime(HistogramType::kQWait,
-                                   get_micro_second() - msg->begin_time);
+                                   get_micro_second() - msg->begin_time, msg->header.func_id);
 
     if (!CheckWriteable()) {
         auto resp = new kvrpcpb::DsKvRangeDeleteResponse;
@@ -539,7 +540,7 @@ Status Range::ApplyKVRangeDelete(const raft_cmdpb::Command &cmd) {
         }
 
         context_->Statistics()->PushTime(HistogramType::kStore,
-                                       get_micro_second() - btime);
+                                       get_micro_second() - btime, funcpb::kFuncKvRangeDel);
     } while (false);
 
     if (cmd.cmd_id().node_id() == node_id_) {
@@ -557,7 +558,7 @@ Status Range::ApplyKVRangeDelete(const raft_cmdpb::Command &cmd) {
 
 void Range::KVScan(common::ProtoMessage *msg, kvrpcpb::DsKvScanRequest &req) {
     context_->Statistics()->PushTime(HistogramType::kQWait,
-                                   get_micro_second() - msg->begin_time);
+                                   get_micro_second() - msg->begin_time, msg->header.func_id);
 
     errorpb::Error *err = nullptr;
     auto ds_resp = new kvrpcpb::DsKvScanResponse;
@@ -90,7 +90,8 @@ bool Range::LockQuery(const std::string &key, kvrpcpb::LockValue* lock_value) {
 void Range::Lock(common::ProtoMessage *msg, kvrpcpb::DsLockRequest &req) {
     RANGE_LOG_DEBUG("lock request: %s", req.DebugString().c_str());
 
-    context_->Statistics()->PushTime(HistogramType::kQWait, get_micro_second() - msg->begin_time);
+    context_->Statistics()->PushTime(HistogramType::kQWait, get_micro_second() - msg->begin_time,
+                                     msg->header.func_id);
 
     std::string encode_key;
     lock::EncodeKey(&encode_key, meta_.GetTableID(), req.req().key());
@@ -176,7 +177,8 @@ Status Range::ApplyLock(const raft_cmdpb::Command &cmd, uint64_t raftIdx) {
 
         lock::EncodeValue(&value_buf, version, req.value(), extend);
         ret = store_->Put(encode_key, value_buf);
-        context_->Statistics()->PushTime(HistogramType::kStore, get_micro_second() - btime);
+        context_->Statistics()->PushTime(HistogramType::kStore, get_micro_second() - btime,
+                                         funcpb::kFuncLock);
         if (!ret.ok()) {
             RANGE_LOG_ERROR("ApplyLock failed, code:%d, msg:%s", ret.code(), ret.ToString().c_str());
             resp->mutable_resp()->set_code(LOCK_STORE_FAILED);
@@ -203,7 +205,8 @@ Status Range::ApplyLock(const raft_cmdpb::Command &cmd, uint64_t raftIdx) {
 void Range::LockUpdate(common::ProtoMessage *msg, kvrpcpb::DsLockUpdateRequest &req) {
     RANGE_LOG_DEBUG("lock update: %s", req.DebugString().c_str());
 
-    context_->Statistics()->PushTime(HistogramType::kQWait, get_micro_second() - msg->begin_time);
+    context_->Statistics()->PushTime(HistogramType::kQWait, get_micro_second() - msg->begin_time,
+                                     msg->header.func_id);
 
     std::string encode_key;
     lock::EncodeKey(&encode_key, meta_.GetTableID(), req.req().key());
@@ -299,7 +302,8 @@ Status Range::ApplyLockUpdate(const raft_cmdpb::Command &cmd) {
 
         auto btime = get_micro_second();
         ret = store_->Put(encode_key, value_buf);
-        context_->Statistics()->PushTime(HistogramType::kStore, get_micro_second() - btime);
+        context_->Statistics()->PushTime(HistogramType::kStore, get_micro_second() - btime,
+                                         funcpb::kFuncLockUpdate);
         if (!ret.ok()) {
             RANGE_LOG_ERROR("ApplyLockUpdate failed, code:%d, msg:%s", ret.code(),
                        ret.ToString().c_str());
@@ -327,7 +331,8 @@ Status Range::ApplyLockUpdate(const raft_cmdpb::Command &cmd) {
 void Range::Unlock(common::ProtoMessage *msg, kvrpcpb::DsUnlockRequest &req) {
     RANGE_LOG_DEBUG("unlock: %s", req.DebugString().c_str());
 
-    context_->Statistics()->PushTime(HistogramType::kQWait, get_micro_second() - msg->begin_time);
+    context_->Statistics()->PushTime(HistogramType::kQWait, get_micro_second() - msg->begin_time,
+                                     msg->header.func_id);
 
     std::string encode_key;
     lock::EncodeKey(&encode_key, meta_.GetTableID(), req.req().key());
@@ -398,7 +403,8 @@ Status Range::ApplyUnlock(const raft_cmdpb::Command &cmd) {
         }
         auto btime = get_micro_second();
         ret = store_->Delete(encode_key);
-        context_->Statistics()->PushTime(HistogramType::kStore, get_micro_second() - btime);
+        context_->Statistics()->PushTime(HistogramType::kStore, get_micro_second() - btime,
+                                         funcpb::kFuncUnlock);
         if (!ret.ok()) {
             RANGE_LOG_ERROR("ApplyUnlock failed, code:%d, msg:%s", ret.code(),
                        ret.ToString().c_str());
@@ -436,7 +442,8 @@ void Range::UnlockForce(common::ProtoMessage *msg,
                         kvrpcpb::DsUnlockForceRequest &req) {
     RANGE_LOG_DEBUG("unlock force: %s", req.DebugString().c_str());
 
-    context_->Statistics()->PushTime(HistogramType::kQWait, get_micro_second() - msg->begin_time);
+    context_->Statistics()->PushTime(HistogramType::kQWait, get_micro_second() - msg->begin_time,
+                                     msg->header.func_id);
 
     std::string encode_key;
     lock::EncodeKey(&encode_key, meta_.GetTableID(), req.req().key());
@@ -497,7 +504,8 @@ Status Range::ApplyUnlockForce(const raft_cmdpb::Command &cmd) {
 
         auto btime = get_micro_second();
         ret = store_->Delete(encode_key);
-        context_->Statistics()->PushTime(HistogramType::kStore, get_micro_second() - btime);
+        context_->Statistics()->PushTime(HistogramType::kStore, get_micro_second() - btime,
+                                         funcpb::kFuncUnlockForce);
         if (!ret.ok()) {
             RANGE_LOG_ERROR("ApplyForceUnlock failed, code:%d, msg:%s", ret.code(), ret.ToString().c_str());
             resp->mutable_resp()->set_code(LOCK_STORE_FAILED);
@@ -593,7 +601,8 @@ void Range::LockWatch(common::ProtoMessage *msg, watchpb::DsWatchRequest& req) {
 
 void Range::LockScan(common::ProtoMessage *msg, kvrpcpb::DsLockScanRequest &req) {
     FLOG_DEBUG("lock scan: %s", req.DebugString().c_str());
-    context_->Statistics()->PushTime(HistogramType::kQWait, get_micro_second() - msg->begin_time);
+    context_->Statistics()->PushTime(HistogramType::kQWait, get_micro_second() - msg->begin_time,
+                                     msg->header.func_id);
 
     errorpb::Error *err = nullptr;
     auto ds_resp = new kvrpcpb::DsLockScanResponse;
@@ -25,6 +25,7 @@ Range::Range(RangeContext* context, const metapb::Range &meta) :
 	id_(meta.id()),
 	start_key_(meta.start_key()),
 	meta_(meta),
+	notify_log_(ds_config.watch_config.notify_queue_size),
 	store_(new storage::Store(meta, context->DBInstance())) {
     eventBuffer = new watch::CEventBuffer(ds_config.watch_config.buffer_map_size,
                                         ds_config.watch_config.buffer_queue_size);
@@ -275,13 +276,13 @@ Status Range::Apply(const std::string &cmd, uint64_t index) {
     return Status::OK();
 }
 
-Status Range::Submit(const raft_cmdpb::Command &cmd) {
+Status Range::Submit(const raft_cmdpb::Command &cmd, uint64_t trace_id) {
     if (is_leader_) {
         std::string str_cmd = std::move(cmd.SerializeAsString());
         if (str_cmd.empty()) {
             return Status(Status::kCorruption, "protobuf serialize failed", "");
         }
-        return raft_->Submit(str_cmd);
+        return raft_->Submit(str_cmd, trace_id);
         // return Apply(cmd,0);
     } else {
         return Status(Status::kNotLeader, "Not Leader", "");
@@ -297,18 +298,32 @@ Status Range::SubmitCmd(common::ProtoMessage *msg, const kvrpcpb::RequestHeader&
     auto epoch = new metapb::RangeEpoch(header.range_epoch());
     cmd.set_allocated_verify_epoch(epoch);
 
+    // 采样追踪，收到请求和worker开始处理的时间从msg中取
+    uint64_t trace_id = 0;
+    auto tracer = context_->Statistics()->GetTracer();
+    if (tracer != nullptr) {
+        trace_id = tracer->Start(header.trace_id(), id_, msg->header.func_id, msg->begin_time);
+        if (trace_id != 0) {
+            tracer->Record(trace_id, "dequeue", msg->deal_time);
+            tracer->Record(trace_id, "propose", get_micro_second());
+        }
+    }
+
     // add to queue
-    auto seq = submit_queue_.Add(header, cmd.cmd_type(), msg);
+    auto seq = submit_queue_.Add(header, cmd.cmd_type(), msg, trace_id);
     cmd.mutable_cmd_id()->set_node_id(node_id_);
     cmd.mutable_cmd_id()->set_seq(seq);
 
-    auto ret = Submit(cmd);
+    auto ret = Submit(cmd, trace_id);
     if (!ret.ok()) {
         auto ctx = submit_queue_.Remove(seq);
         if (ctx) {
             // submit失败，会发送错误，msg将由session释放
             ctx->ClearMsg();
         }
+        if (trace_id != 0) {
+            tracer->Finish(trace_id, "submit_failed", get_micro_second());
+        }
     }
     return ret;
 }
@@ -549,6 +564,10 @@ void Range::ClearExpiredContext() {
     for (auto seq: expired_seqs) {
         auto ctx = submit_queue_.Remove(seq);
         if (ctx) {
+            if (ctx->SampledTraceID() != 0) {
+                context_->Statistics()->GetTracer()->Finish(ctx->SampledTraceID(), "timeout",
+                                                            get_micro_second());
+            }
             ctx->SendTimeout(context_->SocketSession());
         }
     }
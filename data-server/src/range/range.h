@@ -30,6 +30,7 @@ _Pragma("once");
 #include "server/run_status.h"
 #include "watch/watch_event_buffer.h"
 #include "watch/watcher.h"
+#include "watch/watch_notifier.h"
 
 #include "meta_keeper.h"
 #include "context.h"
@@ -129,6 +130,8 @@ public:
     watch::CEventBuffer *getEventBuffer() {
         return  eventBuffer;
     }
+    // 等待通知线程处理的事件数
+    size_t GetNotifyBacklog() const { return notify_log_.Size(); }
 public:
     kvrpcpb::KvRawGetResponse *RawGetResp(const std::string &key);
     kvrpcpb::SelectResponse *SelectResp(const kvrpcpb::DsSelectRequest &req);
@@ -150,7 +153,8 @@ private:
     bool DeleteTry(common::ProtoMessage *msg, kvrpcpb::DsDeleteRequest &req);
     
 private:
-    Status Submit(const raft_cmdpb::Command &cmd);
+    // trace_id不为0时随raft日志复制，在各节点上追踪
+    Status Submit(const raft_cmdpb::Command &cmd, uint64_t trace_id = 0);
 
     Status SubmitCmd(common::ProtoMessage *msg, const kvrpcpb::RequestHeader& header,
                      const std::function<void(raft_cmdpb::Command &cmd)> &init);
@@ -211,8 +215,17 @@ private:
     void ReplySubmit(const raft_cmdpb::Command& cmd, R *resp, errorpb::Error *err, int64_t apply_time) {
         auto ctx = submit_queue_.Remove(cmd.cmd_id().seq());
         if (ctx != nullptr) {
-            context_->Statistics()->PushTime(monitor::HistogramType::kRaft, apply_time - ctx->CreateTime());
+            // apply_time为开始apply的时间：propose到commit计入kRaft，apply到应答计入kApply
+            auto func_id = ctx->Msg() != nullptr ? ctx->Msg()->header.func_id : -1;
+            context_->Statistics()->PushTime(monitor::HistogramType::kRaft,
+                                             apply_time - ctx->CreateTime(), func_id);
+            context_->Statistics()->PushTime(monitor::HistogramType::kApply,
+                                             get_micro_second() - apply_time, func_id);
             ctx->CheckExecuteTime(id_, kTimeTakeWarnThresoldUSec);
+            if (ctx->SampledTraceID() != 0) {
+                context_->Statistics()->GetTracer()->Finish(ctx->SampledTraceID(), "reply",
+                                                            get_micro_second());
+            }
             ctx->Reply(context_->SocketSession(), resp, err);
         } else {
             RANGE_LOG_WARN("Apply cmd id %" PRIu64 " not found", cmd.cmd_id().seq());
@@ -237,6 +250,8 @@ public:
     // get private member
 public:
     bool valid() { return valid_; }
+    uint64_t GetID() const { return id_; }
+    bool IsLeader() const { return is_leader_; }
     metapb::Range options() const { return meta_.Get(); }
     bool EpochIsEqual(const metapb::Range &meta) {
         return EpochIsEqual(meta.range_epoch());
@@ -245,6 +260,7 @@ public:
     void GetReplica(metapb::Replica *rep);
     uint64_t GetSplitRangeID() const { return split_range_id_; }
     size_t GetSubmitQueueSize() const { return submit_queue_.Size(); }
+    void GetMetricTotal(storage::MetricTotal *total) const { store_->GetMetricTotal(total); }
 
     void setLeaderFlag(bool flag) {
         is_leader_ = flag;
@@ -274,13 +290,22 @@ private:
 private:
     friend class ::sharkstore::test::helper::RangeTestFixture;
 
+    // 发布watch事件，开启异步通知时只写入事件日志，由通知线程匹配和发送
     int32_t WatchNotify(const watchpb::EventType evtType, const watchpb::WatchKeyValue& kv, const int64_t &version, std::string &errMsg, bool prefix = false);
+    void drainNotify(watch::WatchNotifier *notifier);
+    int32_t NotifyWatchers(const watchpb::EventType evtType, const watchpb::WatchKeyValue& kv, const int64_t &version, std::string &errMsg, bool prefix);
+    // 事件日志溢出后按db和事件缓存的当前状态通知range内的所有watcher，version为丢弃事件的最大版本
+    void reloadWatchers(int64_t version);
+    // 加载prefix watcher版本之后的事件：先从事件缓存，缓存不能覆盖时从db加载全量
+    // *body为<通知内容, 其中事件的最大版本>，没有变化时通知内容为空
+    int32_t loadPrefixNotify(watch::Watcher &watcher, const std::string &hashKey, const watchpb::EventType &evtType,
+                             std::string *matchBuf, std::pair<watch::NotifyBody, int64_t> *body);
     int32_t loadFromDb(const watchpb::EventType &evtType,
                        const std::string &fromKey,
                        const std::string &endKey,
                        const int64_t &startVersion,
                        watchpb::DsWatchResponse *dsResp);
-    int32_t SendNotify( watch::WatcherPtr& w, watchpb::DsWatchResponse *ds_resp, bool prefix = false);
+    int32_t SendNotify( watch::WatcherPtr& w, const watch::NotifyBody& body, bool prefix = false);
 
 private:
     static const int kTimeTakeWarnThresoldUSec = 500000;
@@ -305,6 +330,7 @@ private:
     uint64_t split_range_id_ = 0;
 
     watch::CEventBuffer *eventBuffer = nullptr;
+    watch::NotifyLog notify_log_;
     SubmitQueue submit_queue_;
 
     std::unique_ptr<storage::Store> store_;
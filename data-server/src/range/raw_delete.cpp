@@ -39,7 +39,8 @@ void Range::RawDelete(common::ProtoMessage *msg, kvrpcpb::DsKvRawDeleteRequest &
     errorpb::Error *err = nullptr;
 
     auto btime = get_micro_second();
-    context_->Statistics()->PushTime(HistogramType::kQWait, btime - msg->begin_time);
+    context_->Statistics()->PushTime(HistogramType::kQWait, btime - msg->begin_time,
+                                     msg->header.func_id);
 
     RANGE_LOG_DEBUG("RawDelete begin");
 
@@ -110,7 +111,7 @@ Status Range::ApplyRawDelete(const raft_cmdpb::Command &cmd) {
 
         ret = store_->Delete(req.key());
         context_->Statistics()->PushTime(HistogramType::kStore,
-                                       get_micro_second() - btime);
+                                       get_micro_second() - btime, funcpb::kFuncRawDelete);
 
         if (!ret.ok()) {
             RANGE_LOG_ERROR("ApplyRawDelete failed, code:%d, msg:%s", ret.code(),
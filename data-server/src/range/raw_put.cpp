@@ -36,7 +36,8 @@ void Range::RawPut(common::ProtoMessage *msg, kvrpcpb::DsKvRawPutRequest &req) {
     errorpb::Error *err = nullptr;
 
     auto btime = get_micro_second();
-    context_->Statistics()->PushTime(HistogramType::kQWait, btime - msg->begin_time);
+    context_->Statistics()->PushTime(HistogramType::kQWait, btime - msg->begin_time,
+                                     msg->header.func_id);
 
     RANGE_LOG_DEBUG("RawPut begin");
 
@@ -108,7 +109,7 @@ Status Range::ApplyRawPut(const raft_cmdpb::Command &cmd) {
 
         ret = store_->Put(req.key(), req.value());
         context_->Statistics()->PushTime(HistogramType::kStore,
-                                       get_micro_second() - btime);
+                                       get_micro_second() - btime, funcpb::kFuncRawPut);
 
         if (!ret.ok()) {
             RANGE_LOG_ERROR("ApplyRawPut failed, code:%d, msg:%s", ret.code(),
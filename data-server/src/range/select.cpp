@@ -41,7 +41,8 @@ void Range::Select(common::ProtoMessage *msg, kvrpcpb::DsSelectRequest &req) {
     errorpb::Error *err = nullptr;
 
     auto btime = get_micro_second();
-    context_->Statistics()->PushTime(HistogramType::kQWait, btime - msg->begin_time);
+    context_->Statistics()->PushTime(HistogramType::kQWait, btime - msg->begin_time,
+                                     msg->header.func_id);
 
     auto ds_resp = new kvrpcpb::DsSelectResponse;
     auto header = ds_resp->mutable_header();
@@ -87,7 +88,7 @@ void Range::Select(common::ProtoMessage *msg, kvrpcpb::DsSelectRequest &req) {
         auto btime = get_micro_second();
         auto ret = store_->Select(req.req(), resp);
         auto etime = get_micro_second();
-        context_->Statistics()->PushTime(HistogramType::kStore, etime - btime);
+        context_->Statistics()->PushTime(HistogramType::kStore, etime - btime, msg->header.func_id);
 
         if (etime - msg->begin_time > kTimeTakeWarnThresoldUSec) {
             RANGE_LOG_WARN("select takes too long(%" PRId64 " ms), sid=%" PRId64 ", msgid=%" PRId64,
@@ -1,6 +1,7 @@
 _Pragma("once");
 
 #include "monitor/statistics.h"
+#include "monitor/tracer.h"
 
 namespace sharkstore {
 namespace dataserver {
@@ -11,12 +12,16 @@ public:
     RangeStats() = default;
     virtual ~RangeStats() = default;
 
-    virtual void PushTime(monitor::HistogramType type, int64_t time) {}
+    // func_id为请求的功能号，用来按功能号分别统计
+    virtual void PushTime(monitor::HistogramType type, int64_t time, int func_id = -1) {}
     virtual void IncrSplitCount() {}
     virtual void DecrSplitCount() {}
 
     // leader变更时，上报当前range是否是leader，用来统计节点leader情况
     virtual void ReportLeader(uint64_t range_id, bool is_leader) {}
+
+    // 请求追踪，返回nullptr表示不追踪
+    virtual monitor::Tracer* GetTracer() { return nullptr; }
 };
 
 }  // namespace range
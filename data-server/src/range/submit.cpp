@@ -1,5 +1,8 @@
 #include "submit.h"
 
+#include <assert.h>
+
+#include "common/object_pool.h"
 #include "frame/sf_logger.h"
 #include "frame/sf_util.h"
 #include "proto/gen/funcpb.pb.h"
@@ -8,10 +11,25 @@ namespace sharkstore {
 namespace dataserver {
 namespace range {
 
+static common::ObjectPool *submitContextPool() {
+    static auto pool = common::ObjectPool::Create("submit_context", sizeof(SubmitContext));
+    return pool;
+}
+
+void *SubmitContext::operator new(size_t size) {
+    assert(size == sizeof(SubmitContext));
+    return submitContextPool()->Alloc();
+}
+
+void SubmitContext::operator delete(void *p) {
+    submitContextPool()->Free(p);
+}
+
 SubmitContext::SubmitContext(const kvrpcpb::RequestHeader &req_header,
-        raft_cmdpb::CmdType type, common::ProtoMessage *msg) :
+        raft_cmdpb::CmdType type, common::ProtoMessage *msg, uint64_t sampled_trace_id) :
     cluster_id_(req_header.cluster_id()),
     trace_id_(req_header.trace_id()),
+    sampled_trace_id_(sampled_trace_id),
     create_time_(get_micro_second()),
     type_(type),
     msg_(msg) {
@@ -72,8 +90,9 @@ uint64_t SubmitQueue::GetSeq() {
 }
 
 uint64_t SubmitQueue::Add(const kvrpcpb::RequestHeader& req_header,
-             raft_cmdpb::CmdType type, common::ProtoMessage *msg) {
-    SubmitContextPtr ctx(new SubmitContext(req_header, type, msg));
+             raft_cmdpb::CmdType type, common::ProtoMessage *msg,
+             uint64_t sampled_trace_id) {
+    SubmitContextPtr ctx(new SubmitContext(req_header, type, msg, sampled_trace_id));
 
     std::lock_guard<std::mutex> lock(mu_);
     ctx_map_.emplace(++seq_, std::move(ctx));
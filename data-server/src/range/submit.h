@@ -18,7 +18,7 @@ namespace range {
 class SubmitContext {
 public:
     SubmitContext(const kvrpcpb::RequestHeader &req_header,
-            raft_cmdpb::CmdType type, common::ProtoMessage *msg);
+            raft_cmdpb::CmdType type, common::ProtoMessage *msg, uint64_t sampled_trace_id = 0);
 
     ~SubmitContext();
 
@@ -29,6 +29,8 @@ public:
     void ClearMsg() { msg_ = nullptr; }
     int64_t CreateTime() const { return create_time_; }
     raft_cmdpb::CmdType Type() const { return type_; }
+    // 被采样追踪时的trace_id，否则为0
+    uint64_t SampledTraceID() const { return sampled_trace_id_; }
 
     template <class ResponseT>
     void Reply(common::SocketSession* session, ResponseT* resp, errorpb::Error *err = nullptr) {
@@ -49,10 +51,15 @@ public:
 
     void CheckExecuteTime(uint64_t rangeID, int64_t thresold_usecs);
 
+    // 每个写请求一个，从对象池分配
+    static void *operator new(size_t size);
+    static void operator delete(void *p);
+
 private:
     // save for set response header lately
     uint64_t cluster_id_ = 0;
     uint64_t trace_id_ = 0;
+    uint64_t sampled_trace_id_ = 0;
 
     int64_t create_time_ = 0;
     raft_cmdpb::CmdType type_;
@@ -71,7 +78,8 @@ public:
     uint64_t GetSeq();
 
     uint64_t Add(const kvrpcpb::RequestHeader& req_header,
-                 raft_cmdpb::CmdType type, common::ProtoMessage *msg);
+                 raft_cmdpb::CmdType type, common::ProtoMessage *msg,
+                 uint64_t sampled_trace_id = 0);
 
     std::unique_ptr<SubmitContext> Remove(uint64_t seq_id);
 
@@ -12,7 +12,8 @@ void Range::Update(common::ProtoMessage *msg, kvrpcpb::DsUpdateRequest &req) {
     errorpb::Error *err = nullptr;
 
     auto btime = get_micro_second();
-    context_->Statistics()->PushTime(HistogramType::kQWait, btime - msg->begin_time);
+    context_->Statistics()->PushTime(HistogramType::kQWait, btime - msg->begin_time,
+                                     msg->header.func_id);
 
     RANGE_LOG_DEBUG("Update begin");
 
@@ -71,7 +72,7 @@ Status Range::ApplyUpdate(const raft_cmdpb::Command &cmd) {
 
         ret = store_->Update(req, &affected_keys, &update_bytes);
         auto etime = get_micro_second();
-        context_->Statistics()->PushTime(HistogramType::kStore, etime - btime);
+        context_->Statistics()->PushTime(HistogramType::kStore, etime - btime, funcpb::kFuncUpdate);
 
         if (!ret.ok()) {
             RANGE_LOG_ERROR("ApplyUpdate failed, code:%d, msg:%s", ret.code(),
@@ -47,8 +47,8 @@ public:
 
     static bool GetHashKey(watch::WatcherPtr pWatcher, bool prefix, const int64_t &tableId, std::string *encodeKey) {
 
-        auto hashKeys = pWatcher->GetKeys(prefix);
-        watch::Watcher::EncodeKey(encodeKey, tableId, hashKeys);
+        // watcher创建时已经编码好key，tableId与watcher的相同
+        *encodeKey = pWatcher->GetEncodeKey(prefix);
 
         return true;
     }
@@ -3,10 +3,17 @@
 #include "watch.h"
 #include "monitor/statistics.h"
 
+#include <algorithm>
+#include <deque>
+#include <map>
+
 namespace sharkstore {
 namespace dataserver {
 namespace range {
 
+// 流式watch追平db版本后重新注册的最大尝试次数
+static const int kStreamWatchRetry = 3;
+
 Status Range::GetAndResp( watch::WatcherPtr pWatcher, const watchpb::WatchCreateRequest& req, const std::string &dbKey, const bool &prefix,
                           int64_t &version, watchpb::DsWatchResponse *dsResp) {
 
@@ -29,10 +36,11 @@ Status Range::GetAndResp( watch::WatcherPtr pWatcher, const watchpb::WatchCreate
         auto watcherServer = context_->WatchServer();
         auto ws = watcherServer->GetWatcherSet_(hashKey);
 
-        auto result = ws->loadFromDb(store_.get(), watchpb::PUT, dbKey, dbKeyEnd, version, meta_.GetTableID(), dsResp);
-        if (result.first <= 0) {
-            delete dsResp;
-            dsResp = nullptr;
+        // dsResp由调用方发送，这里不能释放
+        dsResp->mutable_resp()->set_watchid(pWatcher->GetWatcherId());
+        ws->loadFromDb(store_.get(), watchpb::PUT, dbKey, dbKeyEnd, version, meta_.GetTableID(), dsResp);
+        for (const auto& evt : dsResp->resp().events()) {
+            version = std::max(version, evt.kv().version());
         }
 
     } else {
@@ -61,6 +69,7 @@ Status Range::GetAndResp( watch::WatcherPtr pWatcher, const watchpb::WatchCreate
             userKv->set_value(userValue);
             userKv->set_version(dbVersion);
             userKv->set_tableid(meta_.GetTableID());
+            evt->set_allocated_kv(userKv);
 
             version = dbVersion;
 
@@ -85,7 +94,8 @@ void Range::WatchGet(common::ProtoMessage *msg, watchpb::DsWatchRequest &req) {
     errorpb::Error *err = nullptr;
 
     auto btime = get_micro_second();
-    context_->Statistics()->PushTime(monitor::HistogramType::kQWait, btime - msg->begin_time);
+    context_->Statistics()->PushTime(monitor::HistogramType::kQWait, btime - msg->begin_time,
+                                     msg->header.func_id);
 
 
     auto ds_resp = new watchpb::DsWatchResponse;
@@ -138,12 +148,6 @@ void Range::WatchGet(common::ProtoMessage *msg, watchpb::DsWatchRequest &req) {
 
     //to do add watch
     auto watch_server = context_->WatchServer();
-    std::vector<watch::WatcherKey*> keys;
-
-    for (auto i = 0; i < tmpKv.key_size(); i++) {
-        keys.push_back(new watch::WatcherKey(tmpKv.key(i)));
-    }
-
     watch::WatchType watchType = watch::WATCH_KEY;
     if(prefix) {
         watchType = watch::WATCH_PREFIX;
@@ -151,11 +155,30 @@ void Range::WatchGet(common::ProtoMessage *msg, watchpb::DsWatchRequest &req) {
 
     //int64_t expireTime = (req.req().longpull() > 0)?getticks() + req.req().longpull():msg->expire_time;
     int64_t expireTime = (req.req().longpull() > 0)?get_micro_second() + req.req().longpull()*1000:msg->expire_time*1000;
-    auto w_ptr = std::make_shared<watch::Watcher>(watchType, meta_.GetTableID(), keys, clientVersion, expireTime, msg);
-    // free keys
-    for (auto k: keys) {
-        delete k;
+    auto w_ptr = std::make_shared<watch::Watcher>(watchType, meta_.GetTableID(), tmpKv.key(), clientVersion, expireTime, msg);
+    w_ptr->SetCoalescer(watch_server->Coalescer());
+
+    if (req.req().cancel()) {
+        // 取消流式watch：按key和watchId找到本session推送中的watcher，发送最后一帧后结束
+        auto stream_ptr = watch_server->CancelWatcher(w_ptr, req.req().watchid());
+        if (stream_ptr != nullptr) {
+            auto final_resp = new watchpb::DsWatchResponse;
+            final_resp->mutable_resp()->set_code(Status::kOk);
+            final_resp->mutable_resp()->set_watchid(stream_ptr->GetWatcherId());
+            final_resp->mutable_resp()->set_canceled(true);
+            stream_ptr->Close(final_resp);
+        }
+        RANGE_LOG_DEBUG("WatchGet cancel watch_id: %" PRId64 " found: %d",
+                        req.req().watchid(), stream_ptr != nullptr);
+
+        ds_resp->mutable_resp()->set_code(stream_ptr != nullptr ? Status::kOk : Status::kNotFound);
+        ds_resp->mutable_resp()->set_watchid(req.req().watchid());
+        w_ptr->Send(ds_resp);
+        return;
     }
+    w_ptr->SetStream(req.req().stream());
+    // 注册前分配watchId，推送的第一帧（追平或确认）即可带给client，用于取消
+    watch_server->AssignWatcherId(w_ptr);
 
     watch::WatchCode wcode;
     if(prefix) {
@@ -168,15 +191,17 @@ void Range::WatchGet(common::ProtoMessage *msg, watchpb::DsWatchRequest &req) {
 //            FLOG_ERROR("NextComparableBytes error.");
 //            return;
 //        }
-        auto hashKey = w_ptr->GetKeys();
-        std::string encode_key("");
-        w_ptr->EncodeKey(&encode_key, w_ptr->GetTableId(), w_ptr->GetKeys());
+        auto encode_key = w_ptr->GetEncodeKey();
 
-        std::vector<watch::CEventBufferValue> vecUpdKeys;
+        watch::EventSnapshot vecUpdKeys;
 
 
         auto retPair = eventBuffer->loadFromBuffer(encode_key, clientVersion, vecUpdKeys);
         int32_t memCnt(retPair.first);
+        auto coalescer = watch_server->Coalescer();
+        if (memCnt > 0 && coalescer != nullptr && coalescer->Squash()) {
+            memCnt -= static_cast<int32_t>(coalescer->SquashEvents(&vecUpdKeys));
+        }
         auto verScope = retPair.second;
         RANGE_LOG_DEBUG("loadFromBuffer key:%s hit count[%" PRId32 "] version scope:%" PRId32 "---%" PRId32 " client_version:%" PRId64 ,
                         EncodeToHexString(encode_key).c_str(), memCnt, verScope.first, verScope.second, clientVersion);
@@ -184,21 +209,31 @@ void Range::WatchGet(common::ProtoMessage *msg, watchpb::DsWatchRequest &req) {
         if(memCnt > 0) {
             auto resp = ds_resp->mutable_resp();
             resp->set_code(Status::kOk);
+            resp->set_watchid(w_ptr->GetWatcherId());
             resp->set_scope(watchpb::RESPONSE_PART);
 
             for (auto j = 0; j < memCnt; j++) {
                 auto evt = resp->add_events();
 
-                for (decltype(vecUpdKeys[j].key().size()) k = 0; k < vecUpdKeys[j].key().size(); k++) {
-                    evt->mutable_kv()->add_key(vecUpdKeys[j].key(k));
+                const auto &updKey = *vecUpdKeys[j];
+                for (decltype(updKey.key().size()) k = 0; k < updKey.key().size(); k++) {
+                    evt->mutable_kv()->add_key(updKey.key(k));
                 }
-                evt->mutable_kv()->set_value(vecUpdKeys[j].value());
-                evt->mutable_kv()->set_version(vecUpdKeys[j].version());
-                evt->set_type(vecUpdKeys[j].type());
+                evt->mutable_kv()->set_value(updKey.value());
+                evt->mutable_kv()->set_version(updKey.version());
+                evt->set_type(updKey.type());
             }
 
+            if (!w_ptr->IsStream()) {
+                w_ptr->Send(ds_resp);
+                return;
+            }
+            // 流式watch先推送缓存中的事件，再从最新版本开始注册
+            w_ptr->AdvanceVersion(vecUpdKeys[memCnt - 1]->version());
             w_ptr->Send(ds_resp);
-            return;
+            ds_resp = new watchpb::DsWatchResponse;
+            w_ptr->setBufferFlag(0);
+            wcode = watch_server->AddPrefixWatcher(w_ptr, store_.get());
         } else {
             w_ptr->setBufferFlag(memCnt);
             wcode = watch_server->AddPrefixWatcher(w_ptr, store_.get());
@@ -208,15 +243,47 @@ void Range::WatchGet(common::ProtoMessage *msg, watchpb::DsWatchRequest &req) {
     }
 
     if(watch::WATCH_OK == wcode) {
+        if (w_ptr->IsStream()) {
+            // 注册时没有推送过帧，发送确认帧告知watchId
+            ds_resp->mutable_resp()->set_code(Status::kOk);
+            ds_resp->mutable_resp()->set_watchid(w_ptr->GetWatcherId());
+            w_ptr->Ack(ds_resp);
+            return;
+        }
         delete ds_resp;
         return;
     } else if(watch::WATCH_WATCHER_NOT_NEED == wcode) {
         auto btime = get_micro_second();
         //to do get from db again
         GetAndResp(w_ptr, req.req(), dbKey, prefix, dbVersion, ds_resp);
-        context_->Statistics()->PushTime(monitor::HistogramType::kQWait,
-                                       get_micro_second() - btime);
-        w_ptr->Send(ds_resp);
+        context_->Statistics()->PushTime(monitor::HistogramType::kStore,
+                                       get_micro_second() - btime, msg->header.func_id);
+        if (!w_ptr->IsStream()) {
+            w_ptr->Send(ds_resp);
+            return;
+        }
+
+        // 流式watch推送db中的最新值后按该版本重新注册，期间仍有更新则重试
+        for (int retry = 0; retry < kStreamWatchRetry; ++retry) {
+            w_ptr->AdvanceVersion(dbVersion);
+            w_ptr->Send(ds_resp);
+            ds_resp = nullptr;
+            wcode = prefix ? watch_server->AddPrefixWatcher(w_ptr, store_.get())
+                           : watch_server->AddKeyWatcher(w_ptr, store_.get());
+            if (wcode != watch::WATCH_WATCHER_NOT_NEED) {
+                break;
+            }
+            ds_resp = new watchpb::DsWatchResponse;
+            GetAndResp(w_ptr, req.req(), dbKey, prefix, dbVersion, ds_resp);
+        }
+        if (wcode != watch::WATCH_OK) {
+            RANGE_LOG_WARN("stream watcher register failed(%d), close it.", static_cast<int>(wcode));
+            if (ds_resp == nullptr) {
+                ds_resp = new watchpb::DsWatchResponse;
+                ds_resp->mutable_resp()->set_code(Status::kUnknown);
+            }
+            w_ptr->Close(ds_resp);
+        }
         return;
     } else {
         RANGE_LOG_ERROR("add watcher exception(%d).", static_cast<int>(wcode));
@@ -229,7 +296,8 @@ void Range::PureGet(common::ProtoMessage *msg, watchpb::DsKvWatchGetMultiRequest
     errorpb::Error *err = nullptr;
 
     auto btime = get_micro_second();
-    context_->Statistics()->PushTime(monitor::HistogramType::kQWait, btime - msg->begin_time);
+    context_->Statistics()->PushTime(monitor::HistogramType::kQWait, btime - msg->begin_time,
+                                     msg->header.func_id);
 
     auto ds_resp = new watchpb::DsKvWatchGetMultiResponse;
     auto header = ds_resp->mutable_header();
@@ -339,7 +407,8 @@ void Range::PureGet(common::ProtoMessage *msg, watchpb::DsKvWatchGetMultiRequest
             RANGE_LOG_DEBUG("PureGet code:%d msg:%s ", ret.code(), ret.ToString().data());
             code = ret.code();
         }
-        context_->Statistics()->PushTime(monitor::HistogramType::kQWait, get_micro_second() - btime);
+        context_->Statistics()->PushTime(monitor::HistogramType::kStore, get_micro_second() - btime,
+                                         msg->header.func_id);
 
         resp->set_code(static_cast<int32_t>(code));
     } while (false);
@@ -359,7 +428,8 @@ void Range::WatchPut(common::ProtoMessage *msg, watchpb::DsKvWatchPutRequest &re
     //auto extPtr{std::make_shared<std::string>("")};
 
     auto btime = get_micro_second();
-    context_->Statistics()->PushTime(monitor::HistogramType::kQWait, btime - msg->begin_time);
+    context_->Statistics()->PushTime(monitor::HistogramType::kQWait, btime - msg->begin_time,
+                                     msg->header.func_id);
 
     RANGE_LOG_DEBUG("WatchPut begin msgid: %" PRId64 " session_id: %" PRId64, msg->header.msg_id, msg->session_id);
 
@@ -451,7 +521,8 @@ void Range::WatchDel(common::ProtoMessage *msg, watchpb::DsKvWatchDeleteRequest
     //auto extPtr = std::make_shared<std::string>();
 
     auto btime = get_micro_second();
-    context_->Statistics()->PushTime(monitor::HistogramType::kQWait, btime - msg->begin_time);
+    context_->Statistics()->PushTime(monitor::HistogramType::kQWait, btime - msg->begin_time,
+                                     msg->header.func_id);
 
     RANGE_LOG_DEBUG("WatchDel begin, msgid: %" PRId64 " session_id: %" PRId64, msg->header.msg_id, msg->session_id);
 
@@ -620,8 +691,8 @@ Status Range::ApplyWatchPut(const raft_cmdpb::Command &cmd, uint64_t raftIdx) {
         //save to db
         auto btime = get_micro_second();
         ret = store_->Put(dbKey, dbValue);
-        context_->Statistics()->PushTime(monitor::HistogramType::kQWait,
-                                       get_micro_second() - btime);
+        context_->Statistics()->PushTime(monitor::HistogramType::kStore,
+                                       get_micro_second() - btime, funcpb::kFuncWatchPut);
 
 
         if (!ret.ok()) {
@@ -779,8 +850,8 @@ Status Range::ApplyWatchDel(const raft_cmdpb::Command &cmd, uint64_t raftIdx) {
 
         auto btime = get_micro_second();
         ret = store_->Delete(it);
-        context_->Statistics()->PushTime(monitor::HistogramType::kQWait,
-                                       get_micro_second() - btime);
+        context_->Statistics()->PushTime(monitor::HistogramType::kStore,
+                                       get_micro_second() - btime, funcpb::kFuncWatchDel);
 
         if (cmd.cmd_id().node_id() == node_id_ && delKeys[keySize-1] == it) {
             //FLOG_DEBUG("Delete:%s del key:%s---last key:%s", ret.ToString().c_str(), EncodeToHexString(it).c_str(), EncodeToHexString(delKeys[keySize-1]).c_str());
@@ -836,6 +907,16 @@ Status Range::ApplyWatchDel(const raft_cmdpb::Command &cmd, uint64_t raftIdx) {
     return ret;
 }
 
+// 事件key的前几个分量是否跟prefix watcher的key完全相同
+// 按watcher的分量数编码事件key后与watcher的编码key比较，buf由调用方复用
+static bool matchWatcherPrefix(const watch::Watcher &w, const watch::CEventBufferValue &evt, std::string *buf) {
+    if (evt.key_size() < static_cast<int32_t>(w.GetKeyCount())) {
+        return false;
+    }
+    watch::Watcher::EncodeKey(buf, w.GetTableId(), evt.key(), w.GetKeyCount());
+    return *buf == w.GetFullEncodeKey();
+}
+
 int32_t Range::WatchNotify(const watchpb::EventType evtType, const watchpb::WatchKeyValue& kv, const int64_t &version, std::string &errMsg, bool prefix) {
 
     if(kv.key_size() == 0) {
@@ -843,11 +924,79 @@ int32_t Range::WatchNotify(const watchpb::EventType evtType, const watchpb::Watc
         return -1;
     }
 
+    //事件缓存在apply线程写入，prefix watcher通知时从缓存加载
+    if(prefix || kv.key_size() > 1) {
+        std::string hashKey;
+        watch::Watcher::EncodeKey(&hashKey, meta_.GetTableID(), kv.key(), 1);
+
+        auto value = std::make_shared<const watch::CEventBufferValue>(kv, evtType, version);
+        if (!eventBuffer->enQueue(hashKey, std::move(value))) {
+            FLOG_ERROR("load delete event kv to buffer error.");
+        }
+    }
+
+    auto notifier = context_->WatchServer()->Notifier();
+    if (notifier == nullptr) {
+        return NotifyWatchers(evtType, kv, version, errMsg, prefix);
+    }
+
+    watch::NotifyEvent event;
+    event.type = evtType;
+    event.kv = kv;
+    event.version = version;
+    event.prefix = prefix;
+    event.publish_time = get_micro_second();
+
+    bool schedule = false;
+    if (!notify_log_.Push(std::move(event), &schedule)) {
+        //日志已满时丢弃事件，通知线程处理完已有事件后重新加载range内的watcher
+        notifier->OnOverflow();
+    }
+    notifier->OnPublish(notify_log_.Size());
+
+    if (schedule) {
+        auto self = shared_from_this();
+        notifier->Post(id_, [self, notifier] { self->drainNotify(notifier); });
+    }
+    return 0;
+}
+
+void Range::drainNotify(watch::WatchNotifier *notifier) {
+    std::deque<watch::NotifyEvent> events;
+    int64_t reload_version = 0;
+    if (!notify_log_.PopAll(&events, &reload_version)) {
+        return;
+    }
+
+    for (const auto &event : events) {
+        notifier->OnNotify(get_micro_second() - event.publish_time);
+
+        std::string errMsg;
+        auto retCnt = NotifyWatchers(event.type, event.kv, event.version, errMsg, event.prefix);
+        if (retCnt < 0) {
+            RANGE_LOG_ERROR("NotifyWatchers failed, ret:%d, msg:%s", retCnt, errMsg.c_str());
+        }
+    }
+    if (reload_version > 0) {
+        notifier->OnReload();
+        reloadWatchers(reload_version);
+    }
+
+    //处理完一批后重新排队，让同一线程上的其他range有机会执行
+    auto self = shared_from_this();
+    notifier->Post(id_, [self, notifier] { self->drainNotify(notifier); });
+}
+
+int32_t Range::NotifyWatchers(const watchpb::EventType evtType, const watchpb::WatchKeyValue& kv, const int64_t &version, std::string &errMsg, bool prefix) {
+
+    if(kv.key_size() == 0) {
+        errMsg.assign("WatchNotify--key is empty.");
+        return -1;
+    }
+
     std::vector<watch::WatcherPtr> vecNotifyWatcher;
     std::vector<watch::WatcherPtr> vecPrefixNotifyWatcher;
 
-    //continue to get prefix key
-    std::vector<std::string *> decodeKeys;
     std::string hashKey("");
     std::string dbKey("");
 
@@ -856,39 +1005,15 @@ int32_t Range::WatchNotify(const watchpb::EventType evtType, const watchpb::Watc
         hasPrefix = true;
     }
 
-    for(auto it : kv.key()) {
-        decodeKeys.emplace_back(std::move(new std::string(it)));
-        //only push the first key
-        break;
-    }
-
-    watch::Watcher::EncodeKey(&hashKey, meta_.GetTableID(), decodeKeys);
+    //hash key只编码第一个分量，完整key的前缀就是hash key
+    watch::Watcher::EncodeKey(&dbKey, meta_.GetTableID(), kv.key());
     if(hasPrefix) {
-        int16_t tmpCnt{0};
-        for(auto it : kv.key()) {
-            ++tmpCnt;
-            if(tmpCnt == 1) continue;
-            //to do skip the first element
-            decodeKeys.emplace_back(std::move(new std::string(it)));
-        }
-        watch::Watcher::EncodeKey(&dbKey, meta_.GetTableID(), decodeKeys);
-
+        watch::Watcher::EncodeKey(&hashKey, meta_.GetTableID(), kv.key(), 1);
     } else {
-        dbKey = hashKey;
-    }
-
-    for(auto it : decodeKeys) {
-        delete it;
+        hashKey = dbKey;
     }
 
     FLOG_DEBUG("WatchNotify haskkey:%s  key:%s version:%" PRId64, EncodeToHexString(hashKey).c_str(), EncodeToHexString(dbKey).c_str(), version);
-    if(hasPrefix) {
-        auto value = std::make_shared<watch::CEventBufferValue>(kv, evtType, version);
-
-        if (!eventBuffer->enQueue(hashKey, value.get())) {
-            FLOG_ERROR("load delete event kv to buffer error.");
-        }
-    }
 
     auto dbValue = kv.value();
     int64_t currDbVersion{version};
@@ -899,120 +1024,256 @@ int32_t Range::WatchNotify(const watchpb::EventType evtType, const watchpb::Watc
     //start to send user kv to client
     int32_t watchCnt = vecNotifyWatcher.size();
     FLOG_DEBUG("single key notify:%" PRId32 " key:%s", watchCnt, EncodeToHexString(dbKey).c_str());
-    for(auto i = 0; i < watchCnt; i++) {
-        auto dsResp = new watchpb::DsWatchResponse;
-        auto resp = dsResp->mutable_resp();
-        auto evt = resp->add_events();
-        evt->set_allocated_kv(new  watchpb::WatchKeyValue(kv));
+    if (watchCnt > 0) {
+        //所有watcher的通知内容相同，只序列化一次
+        watchpb::DsWatchResponse dsResp;
+        auto evt = dsResp.mutable_resp()->add_events();
+        evt->mutable_kv()->CopyFrom(kv);
         evt->mutable_kv()->set_version(currDbVersion);
         evt->set_type(evtType);
 
-        SendNotify(vecNotifyWatcher[i], dsResp);
+        auto body = watch::Watcher::SerializeNotify(dsResp);
+        for(auto i = 0; i < watchCnt; i++) {
+            //流式watch只推送比已推送版本新的事件
+            auto &w = vecNotifyWatcher[i];
+            if (w->IsStream() && !w->AdvanceVersion(currDbVersion)) {
+                continue;
+            }
+            SendNotify(w, body);
+        }
     }
 
     if(hasPrefix) {
-        //watch_server->GetPrefixWatchers(evtType, vecPrefixNotifyWatcher, hashKey, dbKey, currDbVersion);
-        watch_server->GetPrefixWatchers(evtType, vecPrefixNotifyWatcher, hashKey, hashKey, currDbVersion);
+        //按完整key查找，任意层级的前缀watcher都会命中
+        watch_server->GetPrefixWatchers(evtType, vecPrefixNotifyWatcher, hashKey, dbKey, currDbVersion);
 
         watchCnt = vecPrefixNotifyWatcher.size();
         FLOG_DEBUG("prefix key notify:%" PRId32 " key:%s", watchCnt, EncodeToHexString(dbKey).c_str());
 
+        //相同前缀、相同起始版本的watcher通知内容相同，只生成和序列化一次
+        //value: <通知内容, 其中事件的最大版本>
+        std::map<std::pair<std::string, int64_t>, std::pair<watch::NotifyBody, int64_t>> prefixBodies;
+        std::string matchBuf;
+        auto sendPrefixNotify = [this](watch::WatcherPtr &w, const std::pair<watch::NotifyBody, int64_t> &body) {
+            if (body.first == nullptr) return;
+            if (w->IsStream() && !w->AdvanceVersion(body.second)) return;
+            SendNotify(w, body.first, true);
+        };
+
         for( auto i = 0; i < watchCnt; i++) {
 
             int64_t startVersion(vecPrefixNotifyWatcher[i]->getKeyVersion());
-            auto dsResp = new watchpb::DsWatchResponse;
 
-            std::vector<watch::CEventBufferValue> vecUpdKeys;
-            vecUpdKeys.clear();
+            auto &watcher = *vecPrefixNotifyWatcher[i];
+            const auto &watcherKey = watcher.GetFullEncodeKey();
 
-            auto retPair = eventBuffer->loadFromBuffer(hashKey, startVersion, vecUpdKeys);
+            auto bodyKey = std::make_pair(watcherKey, startVersion);
+            auto itBody = prefixBodies.find(bodyKey);
+            if (itBody != prefixBodies.end()) {
+                sendPrefixNotify(vecPrefixNotifyWatcher[i], itBody->second);
+                continue;
+            }
 
-            int32_t memCnt(retPair.first);
-            auto verScope = retPair.second;
-            RANGE_LOG_DEBUG("loadFromBuffer key:%s hit count[%" PRId32 "] version scope:%" PRId32 "---%" PRId32 " client_version:%" PRId64 ,
-                            EncodeToHexString(hashKey).c_str(), memCnt, verScope.first, verScope.second, startVersion);
+            std::pair<watch::NotifyBody, int64_t> body(nullptr, 0);
+            if (loadPrefixNotify(watcher, hashKey, evtType, &matchBuf, &body) != 0) {
+                return -1;
+            }
+            prefixBodies.emplace(bodyKey, body);
 
-            if (0 == memCnt) {
-                FLOG_ERROR("doudbt no changing, notify %d/%"
-                                   PRId32
-                                   " key:%s", i+1, watchCnt, EncodeToHexString(dbKey).c_str());
+            sendPrefixNotify(vecPrefixNotifyWatcher[i], body);
 
-                delete dsResp;
-                dsResp = nullptr;
+        }
+    }
 
-            } else if (memCnt > 0) {
-                FLOG_DEBUG("notify %d/%"
-                                   PRId32
-                                   " loadFromBuffer key:%s  hit count:%"
-                                   PRId32, i+1, watchCnt, EncodeToHexString(dbKey).c_str(), memCnt);
+    return watchCnt;
+}
 
+int32_t Range::loadPrefixNotify(watch::Watcher &watcher, const std::string &hashKey, const watchpb::EventType &evtType,
+                                std::string *matchBuf, std::pair<watch::NotifyBody, int64_t> *body) {
+    int64_t startVersion(watcher.getKeyVersion());
+    const auto &watcherKey = watcher.GetFullEncodeKey();
+    auto watch_server = context_->WatchServer();
 
-                auto resp = dsResp->mutable_resp();
-                resp->set_code(Status::kOk);
-                resp->set_scope(watchpb::RESPONSE_PART);
+    auto dsResp = new watchpb::DsWatchResponse;
 
-                for (auto j = 0; j < memCnt; j++) {
-                    auto evt = resp->add_events();
+    watch::EventSnapshot vecUpdKeys;
 
-                    for (decltype(vecUpdKeys[j].key().size()) k = 0; k < vecUpdKeys[j].key().size(); k++) {
-                        evt->mutable_kv()->add_key(vecUpdKeys[j].key(k));
-                    }
-                    evt->mutable_kv()->set_value(vecUpdKeys[j].value());
-                    evt->mutable_kv()->set_version(vecUpdKeys[j].version());
-                    evt->set_type(vecUpdKeys[j].type());
+    auto retPair = eventBuffer->loadFromBuffer(hashKey, startVersion, vecUpdKeys);
 
-                }
+    //buffer按第一个分量分组，多层前缀的watcher需要再过滤一次
+    int32_t memCnt(retPair.first);
+    if (memCnt > 0 && watcher.GetKeyCount() > 1) {
+        auto last = std::remove_if(vecUpdKeys.begin(), vecUpdKeys.begin() + memCnt,
+                                   [&watcher, matchBuf](const watch::EventValuePtr &evt) {
+                                       return !matchWatcherPrefix(watcher, *evt, matchBuf);
+                                   });
+        memCnt = static_cast<int32_t>(last - vecUpdKeys.begin());
+    }
+    auto coalescer = watch_server->Coalescer();
+    if (memCnt > 0 && coalescer != nullptr && coalescer->Squash()) {
+        vecUpdKeys.resize(memCnt);
+        memCnt -= static_cast<int32_t>(coalescer->SquashEvents(&vecUpdKeys));
+    }
+    auto verScope = retPair.second;
+    RANGE_LOG_DEBUG("loadFromBuffer key:%s hit count[%" PRId32 "] version scope:%" PRId32 "---%" PRId32 " client_version:%" PRId64 ,
+                    EncodeToHexString(hashKey).c_str(), memCnt, verScope.first, verScope.second, startVersion);
 
-            } else {
+    if (0 == memCnt) {
+        FLOG_ERROR("doudbt no changing, notify watch_id:%" PRIu64 " key:%s",
+                   watcher.GetWatcherId(), EncodeToHexString(watcherKey).c_str());
 
-                //get all from db
-                FLOG_INFO("overlimit version in memory,get from db now. notify %d/%"
-                                  PRId32
-                                  " key:%s version:%"
-                                  PRId64,
-                          i+1, watchCnt, EncodeToHexString(dbKey).c_str(), startVersion);
-                //use iterator
-                std::string dbKeyEnd{""};
-                dbKeyEnd.assign(dbKey);
-                if( 0 != WatchEncodeAndDecode::NextComparableBytes(dbKey.data(), dbKey.length(), dbKeyEnd)) {
-                    //to do set error message
-                    FLOG_ERROR("NextComparableBytes error.");
-                    return -1;
-                }
-                //RANGE_LOG_DEBUG("WatchNotify key scope %s---%s", EncodeToHexString(dbKey).c_str(), EncodeToHexString(dbKeyEnd).c_str());
-                auto watcherServer = context_->WatchServer();
-                auto ws = watcherServer->GetWatcherSet_(hashKey);
-
-                auto result = ws->loadFromDb(store_.get(), evtType, dbKey, dbKeyEnd, startVersion, meta_.GetTableID(), dsResp);
-                if(result.first <= 0) {
-                    delete dsResp;
-                    dsResp = nullptr;
-                }
+        delete dsResp;
+        dsResp = nullptr;
 
-                //scopeFlag = 1;
-                FLOG_DEBUG("notify %d/%" PRId32 " load from db, db-count:%" PRId32 " key:%s ", i+1, watchCnt, result.first, EncodeToHexString(dbKey).c_str());
+    } else if (memCnt > 0) {
+        FLOG_DEBUG("notify watch_id:%" PRIu64 " loadFromBuffer key:%s  hit count:%" PRId32,
+                   watcher.GetWatcherId(), EncodeToHexString(watcherKey).c_str(), memCnt);
 
-            }
 
-            if (hasPrefix && watchCnt > 0 && dsResp != nullptr) {
-                SendNotify(vecPrefixNotifyWatcher[i], dsResp, true);
+        auto resp = dsResp->mutable_resp();
+        resp->set_code(Status::kOk);
+        resp->set_scope(watchpb::RESPONSE_PART);
+
+        for (auto j = 0; j < memCnt; j++) {
+            auto evt = resp->add_events();
+
+            const auto &updKey = *vecUpdKeys[j];
+            for (decltype(updKey.key().size()) k = 0; k < updKey.key().size(); k++) {
+                evt->mutable_kv()->add_key(updKey.key(k));
             }
+            evt->mutable_kv()->set_value(updKey.value());
+            evt->mutable_kv()->set_version(updKey.version());
+            evt->set_type(updKey.type());
+
+        }
+
+    } else {
+
+        //get all from db
+        FLOG_INFO("overlimit version in memory,get from db now. notify watch_id:%" PRIu64 " key:%s version:%" PRId64,
+                  watcher.GetWatcherId(), EncodeToHexString(watcherKey).c_str(), startVersion);
+        //use iterator, 范围为watcher的前缀
+        std::string dbKeyEnd{""};
+        dbKeyEnd.assign(watcherKey);
+        if( 0 != WatchEncodeAndDecode::NextComparableBytes(watcherKey.data(), watcherKey.length(), dbKeyEnd)) {
+            //to do set error message
+            FLOG_ERROR("NextComparableBytes error.");
+            delete dsResp;
+            return -1;
+        }
+        auto ws = watch_server->GetWatcherSet_(hashKey);
 
+        auto result = ws->loadFromDb(store_.get(), evtType, watcherKey, dbKeyEnd, startVersion, meta_.GetTableID(), dsResp);
+        if(result.first <= 0) {
+            delete dsResp;
+            dsResp = nullptr;
         }
+
+        FLOG_DEBUG("notify watch_id:%" PRIu64 " load from db, db-count:%" PRId32 " key:%s ",
+                   watcher.GetWatcherId(), result.first, EncodeToHexString(watcherKey).c_str());
+
     }
 
-    return watchCnt;
+    if (dsResp != nullptr) {
+        for (const auto &evt : dsResp->resp().events()) {
+            body->second = std::max(body->second, evt.kv().version());
+        }
+        body->first = watch::Watcher::SerializeNotify(*dsResp);
+        delete dsResp;
+    }
+    return 0;
 }
 
-int32_t Range::SendNotify( watch::WatcherPtr& w, watchpb::DsWatchResponse *ds_resp, bool prefix)
+void Range::reloadWatchers(int64_t version) {
+    std::vector<watch::WatcherPtr> keyWatchers;
+    std::vector<watch::WatcherPtr> prefixWatchers;
+    auto watch_server = context_->WatchServer();
+    watch_server->GetRangeWatchers(meta_.GetStartKey(), meta_.GetEndKey(), &keyWatchers, &prefixWatchers);
+
+    RANGE_LOG_WARN("notify log overflowed, reload watchers, key:%" PRIu64 " prefix:%" PRIu64 " version:%" PRId64,
+                   static_cast<uint64_t>(keyWatchers.size()), static_cast<uint64_t>(prefixWatchers.size()), version);
+
+    //key watcher：按db中的当前值补发，key不存在时发送删除事件，版本取丢弃事件的最大版本
+    std::sort(keyWatchers.begin(), keyWatchers.end(), [](const watch::WatcherPtr &a, const watch::WatcherPtr &b) {
+        return a->GetFullEncodeKey() < b->GetFullEncodeKey();
+    });
+    for (size_t i = 0; i < keyWatchers.size();) {
+        auto dbKey = keyWatchers[i]->GetFullEncodeKey();
+        size_t end = i + 1;
+        while (end < keyWatchers.size() && keyWatchers[end]->GetFullEncodeKey() == dbKey) {
+            ++end;
+        }
+
+        std::string dbValue;
+        auto ret = store_->Get(dbKey, &dbValue);
+        if (!ret.ok() && ret.code() != Status::kNotFound) {
+            RANGE_LOG_ERROR("reload watchers get key:%s error:%s", EncodeToHexString(dbKey).c_str(), ret.ToString().c_str());
+            i = end;
+            continue;
+        }
+
+        watchpb::DsWatchResponse dsResp;
+        auto evt = dsResp.mutable_resp()->add_events();
+        if (ret.ok()) {
+            errorpb::Error err;
+            if (Status::kOk != WatchEncodeAndDecode::DecodeKv(funcpb::kFuncPureGet, meta_.GetTableID(), evt->mutable_kv(),
+                                                              dbKey, dbValue, &err)) {
+                RANGE_LOG_ERROR("reload watchers decode key:%s error", EncodeToHexString(dbKey).c_str());
+                i = end;
+                continue;
+            }
+            evt->set_type(watchpb::PUT);
+        } else {
+            std::vector<std::string *> vecKeys;
+            watch::Watcher::DecodeKey(vecKeys, dbKey);
+            for (auto itKey : vecKeys) {
+                evt->mutable_kv()->add_key(*itKey);
+                delete itKey;
+            }
+            evt->mutable_kv()->set_version(version);
+            evt->set_type(watchpb::DELETE);
+        }
+        auto currVersion = evt->kv().version();
+
+        watch::NotifyBody body;
+        for (; i < end; ++i) {
+            auto &w = keyWatchers[i];
+            //只通知比watcher版本新的变化；key不存在且watcher没见过它时没有变化
+            if (currVersion <= w->getKeyVersion()) continue;
+            if (!ret.ok() && w->getKeyVersion() == 0) continue;
+            if (w->IsStream() && !w->AdvanceVersion(currVersion)) continue;
+            if (body == nullptr) {
+                body = watch::Watcher::SerializeNotify(dsResp);
+            }
+            SendNotify(w, body);
+        }
+    }
+
+    //prefix watcher：从watcher的版本开始按缓存补发，缓存不能覆盖时从db加载全量
+    std::string hashKey;
+    std::string matchBuf;
+    for (auto &w : prefixWatchers) {
+        hashKey = w->GetEncodeKey();
+        std::pair<watch::NotifyBody, int64_t> body(nullptr, 0);
+        if (loadPrefixNotify(*w, hashKey, watchpb::PUT, &matchBuf, &body) != 0 || body.first == nullptr) {
+            continue;
+        }
+        if (w->IsStream() && !w->AdvanceVersion(body.second)) continue;
+        SendNotify(w, body.first, true);
+    }
+}
+
+int32_t Range::SendNotify( watch::WatcherPtr& w, const watch::NotifyBody& body, bool prefix)
 {
     auto watch_server = context_->WatchServer();
-    auto resp = ds_resp->mutable_resp();
     auto w_id = w->GetWatcherId();
 
-    resp->set_watchid(w_id);
+    w->Send(body, watch_server->Coalescer());
 
-    w->Send(ds_resp);
+    //流式watch保持注册，直到取消或者超时
+    if (w->IsStream()) {
+        return watch::WATCH_OK;
+    }
 
     //delete watch
     watch::WatchCode del_ret = watch::WATCH_OK;
@@ -27,6 +27,7 @@
 
 #include "server.h"
 #include "range_context_impl.h"
+#include "thread_placement.h"
 
 namespace sharkstore {
 namespace dataserver {
@@ -72,7 +73,10 @@ int RangeServer::Init(ContextServer *context) {
     range_context_.reset(new RangeContextImpl(context_));
 
     // 初始化WatchServer
-    watch_server_ = new watch::WatchServer(ds_config.watch_config.watcher_set_size);
+    watch_server_ = new watch::WatchServer(ds_config.watch_config.watcher_set_size,
+                                           ds_config.watch_config.notify_threads,
+                                           ds_config.watch_config.coalesce_window_ms,
+                                           ds_config.watch_config.coalesce_squash != 0);
 
     std::vector<metapb::Range> range_metas;
     ret = meta_store_->GetAllRange(&range_metas);
@@ -270,6 +274,9 @@ int RangeServer::OpenDB() {
     rocksdb::Options ops;
     buildDBOptions(ops);
 
+    // rocksdb的后台线程在打开db时创建
+    ThreadPlacement::Scope scope(ThreadPlacement::kRocksdb);
+
     if (ds_config.rocksdb_config.storage_type == 0){
         if (ds_config.rocksdb_config.ttl == 0) {
             auto ret = rocksdb::DB::Open(ops, db_path, &db_);
@@ -474,7 +481,7 @@ void RangeServer::DealTask(common::ProtoMessage *msg) {
 
 void RangeServer::CreateRange(common::ProtoMessage *msg) {
     schpb::CreateRangeRequest req;
-    if (!common::GetMessage(msg->body.data(), msg->body.size(), &req)) {
+    if (!common::GetMessage(msg->BodyData(), msg->BodySize(), &req)) {
         FLOG_ERROR("deserialize create range request failed");
         return context_->socket_session->Send(msg, nullptr);
     }
@@ -566,7 +573,7 @@ Status RangeServer::CreateRange(const metapb::Range &range, uint64_t leader,
 
 void RangeServer::DeleteRange(common::ProtoMessage *msg) {
     schpb::DeleteRangeRequest req;
-    if (!common::GetMessage(msg->body.data(), msg->body.size(), &req)) {
+    if (!common::GetMessage(msg->BodyData(), msg->BodySize(), &req)) {
         FLOG_ERROR("deserialize delete range request failed");
         return context_->socket_session->Send(msg, nullptr);
     }
@@ -623,7 +630,7 @@ Status RangeServer::DeleteRange(uint64_t range_id, uint64_t peer_id) {
 
 void RangeServer::OfflineRange(common::ProtoMessage *msg) {
     schpb::OfflineRangeRequest req;
-    if (!common::GetMessage(msg->body.data(), msg->body.size(), &req)) {
+    if (!common::GetMessage(msg->BodyData(), msg->BodySize(), &req)) {
         FLOG_ERROR("deserialize offline range request failed");
         return context_->socket_session->Send(msg, nullptr);
     }
@@ -691,7 +698,7 @@ int RangeServer::CloseRange(uint64_t range_id) {
 
 void RangeServer::ReplaceRange(common::ProtoMessage *msg) {
     schpb::ReplaceRangeRequest req;
-    if (!common::GetMessage(msg->body.data(), msg->body.size(), &req)) {
+    if (!common::GetMessage(msg->BodyData(), msg->BodySize(), &req)) {
         FLOG_ERROR("deserialize replace range request failed");
         return context_->socket_session->Send(msg, nullptr);
     }
@@ -720,7 +727,7 @@ void RangeServer::ReplaceRange(common::ProtoMessage *msg) {
 
 void RangeServer::TransferLeader(common::ProtoMessage *msg) {
     schpb::TransferRangeLeaderRequest req;
-    if (!common::GetMessage(msg->body.data(), msg->body.size(), &req)) {
+    if (!common::GetMessage(msg->BodyData(), msg->BodySize(), &req)) {
         FLOG_ERROR("deserialize transfer leader request failed");
         return context_->socket_session->Send(msg, nullptr);
     }
@@ -741,7 +748,7 @@ void RangeServer::TransferLeader(common::ProtoMessage *msg) {
 void RangeServer::GetPeerInfo(common::ProtoMessage *msg) {
     schpb::GetPeerInfoRequest req;
 
-    if (!common::GetMessage(msg->body.data(), msg->body.size(), &req)) {
+    if (!common::GetMessage(msg->BodyData(), msg->BodySize(), &req)) {
         FLOG_ERROR("deserialize transfer leader request failed");
         return context_->socket_session->Send(msg, nullptr);
     }
@@ -774,7 +781,7 @@ void RangeServer::GetPeerInfo(common::ProtoMessage *msg) {
 void RangeServer::SetLogLevel(common::ProtoMessage *msg) {
     schpb::SetNodeLogLevelRequest req;
 
-    if (!common::GetMessage(msg->body.data(), msg->body.size(), &req)) {
+    if (!common::GetMessage(msg->BodyData(), msg->BodySize(), &req)) {
         FLOG_ERROR("deserialize transfer leader request failed");
         return context_->socket_session->Send(msg, nullptr);
     }
@@ -792,6 +799,16 @@ size_t RangeServer::GetRangesSize() const {
     return ranges_.size();
 }
 
+std::vector<std::shared_ptr<range::Range>> RangeServer::GetRanges() const {
+    std::vector<std::shared_ptr<range::Range>> ranges;
+    sharkstore::shared_lock<sharkstore::shared_mutex> lock(rw_lock_);
+    ranges.reserve(ranges_.size());
+    for (const auto &it : ranges_) {
+        ranges.push_back(it.second);
+    }
+    return ranges;
+}
+
 std::shared_ptr<range::Range> RangeServer::Find(uint64_t range_id) {
     sharkstore::shared_lock<sharkstore::shared_mutex> lock(rw_lock_);
 
@@ -926,12 +943,15 @@ template <class RequestT, class ResponseT>
 std::shared_ptr<range::Range> RangeServer::CheckAndDecodeRequest(
     const char *func_name, RequestT &request, ResponseT *&respone,
     common::ProtoMessage *msg) {
-    if (!common::GetMessage(msg->body.data(), msg->body.size(),
+    auto btime = get_micro_second();
+    if (!common::GetMessage(msg->BodyData(), msg->BodySize(),
                                               &request)) {
         FLOG_ERROR("deserialize %s request failed", func_name);
         context_->socket_session->Send(msg, nullptr);
         return nullptr;
     }
+    context_->run_status->PushTime(monitor::HistogramType::kDecode,
+                                   get_micro_second() - btime, msg->header.func_id);
 
     FLOG_DEBUG("%s called. req: %s", func_name, request.DebugString().c_str());
 
@@ -47,6 +47,7 @@ public:
 
     size_t GetRangesSize() const;
     std::shared_ptr<range::Range> Find(uint64_t range_id);
+    std::vector<std::shared_ptr<range::Range>> GetRanges() const;
 
     void OnNodeHeartbeatResp(const mspb::NodeHeartbeatResponse &) override;
     void OnRangeHeartbeatResp(const mspb::RangeHeartbeatResponse &) override;
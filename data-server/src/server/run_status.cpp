@@ -21,6 +21,11 @@ namespace server {
 
 int RunStatus::Init(ContextServer *context) {
     context_ = context;
+
+    tracer_.SetNodeID(context->node_id);
+    tracer_.SetOptions(ds_config.trace_config.sample_interval,
+                       ds_config.trace_config.slow_threshold_ms * 1000,
+                       ds_config.trace_config.slow_log_size);
     return 0;
 }
 
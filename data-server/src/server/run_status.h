@@ -11,6 +11,7 @@
 #include "monitor/isystemstatus.h"
 #include "monitor/syscommon.h"
 #include "monitor/statistics.h"
+#include "monitor/tracer.h"
 #include "range/stats.h"
 
 #include "context_server.h"
@@ -37,9 +38,12 @@ public:
     int Start();
     void Stop();
 
-    void PushTime(monitor::HistogramType type, int64_t time) override {
-        if (time > 0) statistics_.PushTime(type, static_cast<uint64_t>(time));
+    void PushTime(monitor::HistogramType type, int64_t time, int func_id = -1) override {
+        if (time >= 0) statistics_.PushTime(type, static_cast<uint64_t>(time), func_id);
     }
+    const monitor::Statistics &GetStatistics() const { return statistics_; }
+    monitor::ISystemStatus *GetSystemStatus() { return &system_status_; }
+    monitor::Tracer *GetTracer() override { return &tracer_; }
 
     bool GetFilesystemUsage(FileSystemUsage* usage);
     uint64_t GetFilesystemUsedPercent() const { return fs_usage_percent_.load();}
@@ -62,6 +66,7 @@ private:
 
     monitor::ISystemStatus system_status_;
     monitor::Statistics statistics_;
+    monitor::Tracer tracer_;
 
     std::atomic<uint64_t> fs_usage_percent_ = {0};
     std::atomic<uint64_t> split_count_ = {0};
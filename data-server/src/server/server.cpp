@@ -13,6 +13,7 @@
 #include "raft_logger.h"
 #include "range_server.h"
 #include "run_status.h"
+#include "thread_placement.h"
 #include "version.h"
 #include "worker.h"
 
@@ -28,6 +29,10 @@ DataServer::DataServer() {
     context_->run_status = new RunStatus;
     context_->range_server = new RangeServer;
     context_->socket_session = new common::SocketSessionImpl;
+    common::SocketSessionImpl::SetSerializeObserver([](int func_id, int64_t take_time) {
+        DataServer::Instance().context_server()->run_status->PushTime(
+            monitor::HistogramType::kSerialize, take_time, func_id);
+    });
 
     // create master worker
     std::vector<std::string> ms_addrs;
@@ -41,6 +46,7 @@ DataServer::DataServer() {
 }
 
 DataServer::~DataServer() {
+    common::SocketSessionImpl::SetSerializeObserver(nullptr);
     delete context_->worker;
     delete context_->master_worker;
     delete context_->run_status;
@@ -66,12 +72,41 @@ bool DataServer::startRaftServer() {
     ops.apply_queue_capacity = ds_config.raft_config.apply_queue;
     ops.tick_interval = std::chrono::milliseconds(ds_config.raft_config.tick_interval_ms);
     ops.max_size_per_msg = ds_config.raft_config.max_msg_size;
+    ops.min_size_per_msg = ds_config.raft_config.min_msg_size;
+    ops.max_inflight_bytes = ds_config.raft_config.max_inflight_bytes;
+    ops.max_outbound_bytes = ds_config.raft_config.max_outbound_bytes;
+    ops.thread_balance_interval =
+        std::chrono::seconds(ds_config.raft_config.thread_balance_interval);
+    ops.thread_balance_threshold =
+        static_cast<unsigned>(ds_config.raft_config.thread_balance_threshold);
+    ops.compression = static_cast<raft::CompressionType>(ds_config.raft_config.compression);
+    ops.compression_threshold = ds_config.raft_config.compression_threshold;
 
     ops.transport_options.listen_port = static_cast<uint16_t>(ds_config.raft_config.port);
     ops.transport_options.send_io_threads = ds_config.raft_config.transport_send_threads;
     ops.transport_options.recv_io_threads = ds_config.raft_config.transport_recv_threads;
+    ops.transport_options.max_batch_bytes = ds_config.raft_config.transport_batch_bytes;
     ops.transport_options.resolver =
         std::make_shared<NodeAddress>(context_->master_worker);
+    ops.thread_scope = [](const std::string &kind) -> std::shared_ptr<void> {
+        return std::make_shared<ThreadPlacement::Scope>("raft_" + kind);
+    };
+    // leader上的请求追踪在收到请求时开始，应答时结束；follower收到日志时开始，apply完成时结束
+    auto tracer = context_->run_status->GetTracer();
+    ops.trace_recorder = [tracer](const raft::TraceEvent &event) {
+        switch (event.stage) {
+            case raft::TraceStage::kReceive:
+                tracer->Join(event.trace_id, event.raft_id, event.time, event.node);
+                break;
+            case raft::TraceStage::kApplied:
+                tracer->FinishFollower(event.trace_id, raft::TraceStageName(event.stage),
+                                       event.time);
+                break;
+            default:
+                tracer->Record(event.trace_id, raft::TraceStageName(event.stage), event.time,
+                               event.node);
+        }
+    };
 
     auto rs = raft::CreateRaftServer(ops);
     context_->raft_server = rs.release();
@@ -89,6 +124,14 @@ int DataServer::Init() {
     std::string version = GetGitDescribe();
     FLOG_INFO("Version: %s", version.c_str());
 
+    // 先放置主线程，之后没有单独配置的线程都继承主线程的放置
+    auto ps = ThreadPlacement::Instance().Init();
+    if (!ps.ok()) {
+        FLOG_ERROR("load thread affinity failed. %s", ps.ToString().c_str());
+        return -1;
+    }
+    ThreadPlacement::Instance().Apply(ThreadPlacement::kDefault);
+
     // GetNodeId from master server
     bool clearup = false;
     uint64_t node_id = 0;
@@ -0,0 +1,191 @@
+#include "shard_server.h"
+
+#include <algorithm>
+#include <thread>
+
+#include <asio/post.hpp>
+
+#include "common/ds_config.h"
+#include "frame/sf_logger.h"
+#include "frame/sf_util.h"
+#include "net/server.h"
+#include "net/session.h"
+
+namespace sharkstore {
+namespace dataserver {
+namespace server {
+
+static const size_t kSessionShards = 16;
+
+ShardServer::ShardServer(const DealFunc &deal) : deal_(deal) {
+    for (size_t i = 0; i < kSessionShards; ++i) {
+        session_shards_.emplace_back(new SessionShard);
+    }
+}
+
+ShardServer::~ShardServer() { Stop(); }
+
+int ShardServer::Start() {
+    auto config = thread_info_.socket_config;
+
+    shard_num_ = ds_config.net_config.shard_threads;
+    if (shard_num_ == 0) {
+        shard_num_ = std::thread::hardware_concurrency();
+    }
+    if (shard_num_ == 0) {
+        shard_num_ = 1;
+    }
+
+    net::ServerOptions opt;
+    opt.io_threads_num = shard_num_;
+    opt.max_connections = sf_config.socket_config.max_connections;
+    opt.pin_cores = ds_config.net_config.shard_pin_cores;
+    opt.cpu_offset = ds_config.net_config.shard_cpu_offset;
+    opt.session_opt.max_packet_length = sf_config.socket_config.max_pkg_size;
+    opt.session_opt.stream_window = static_cast<size_t>(ds_config.net_config.stream_window);
+    opt.session_opt.stream_timeout_ms = static_cast<size_t>(ds_config.task_timeout);
+
+    thread_info_.socket_status->assigned_accept_threads = 1;
+    thread_info_.socket_status->assigned_event_recv_threads = static_cast<int>(shard_num_);
+    thread_info_.socket_status->assigned_event_send_threads = 0;
+
+    server_.reset(new net::Server(opt));
+    auto s = server_->ListenAndServe(config->ip_addr, static_cast<uint16_t>(config->port),
+                                     [this](const net::Context &ctx, const net::MessagePtr &msg) {
+                                         onMessage(ctx, msg);
+                                     });
+    if (!s.ok()) {
+        FLOG_ERROR("shard server listen on %s:%d failed: %s", config->ip_addr, config->port,
+                   s.ToString().c_str());
+        return -1;
+    }
+
+    FLOG_INFO("shard server started, port: %d, shards: %zu, pin cores: %d", config->port,
+              shard_num_, ds_config.net_config.shard_pin_cores);
+    return 0;
+}
+
+void ShardServer::Stop() {
+    if (server_) {
+        server_->Stop();
+    }
+}
+
+bool ShardServer::InShardThread() const {
+    return server_ && server_->CurrentThreadIndex() >= 0;
+}
+
+void ShardServer::onMessage(const net::Context &ctx, const net::MessagePtr &msg) {
+    addSession(ctx);
+
+    auto task = new common::ProtoMessage;
+    auto &head = msg->head;
+    task->header.magic_number = static_cast<int>(head.magic);
+    task->header.version = static_cast<short>(head.version);
+    task->header.msg_type = static_cast<short>(head.msg_type);
+    task->header.func_id = static_cast<short>(head.func_id);
+    task->header.msg_id = static_cast<int64_t>(head.msg_id);
+    task->header.flags = static_cast<char>(head.stream_hash);
+    task->header.proto_type = static_cast<char>(head.proto_type);
+    task->header.time_out = static_cast<int>(head.timeout);
+    task->header.body_len = static_cast<int>(head.body_length);
+    // 请求内容直接引用session读到的缓冲，解析前不再拷贝
+    task->SetBodyRef(msg, reinterpret_cast<const char *>(msg->body.data()), msg->body.size());
+
+    task->session_id = static_cast<int64_t>(ctx.session_id);
+    task->begin_time = get_micro_second();
+    task->expire_time = getticks();
+    if (task->header.time_out > 0) {
+        task->expire_time += task->header.time_out;
+    } else {
+        task->expire_time += ds_config.task_timeout;
+    }
+
+    auto status = thread_info_.socket_status;
+    __sync_fetch_and_add(&status->recv_pkg_count, 1);
+    __sync_fetch_and_add(&status->current_recv_pkg_count, 1);
+
+    uint64_t range_id = 0;
+    if (task->header.func_id != 0 &&
+        common::PeekRangeId(task->BodyData(), task->BodySize(), &range_id)) {
+        auto owner = ShardOf(range_id);
+        auto current = server_->CurrentThreadIndex();
+        if (current >= 0 && owner != static_cast<size_t>(current)) {
+            ++forwarded_;
+            asio::post(server_->GetIOContext(owner), [this, task] { deal_(task); });
+            return;
+        }
+    }
+    deal_(task);
+}
+
+void ShardServer::addSession(const net::Context &ctx) {
+    auto &shard = *session_shards_[ctx.session_id % kSessionShards];
+    std::lock_guard<std::mutex> lock(shard.mu);
+    if (shard.sessions.find(ctx.session_id) != shard.sessions.end()) {
+        return;
+    }
+
+    if (shard.sessions.size() >= shard.sweep_size) {
+        for (auto it = shard.sessions.begin(); it != shard.sessions.end();) {
+            if (it->second.expired()) {
+                it = shard.sessions.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        shard.sweep_size = std::max<size_t>(1024, shard.sessions.size() * 2);
+    }
+    shard.sessions.emplace(ctx.session_id, ctx.session);
+}
+
+std::shared_ptr<net::Session> ShardServer::getSession(uint64_t session_id) {
+    auto &shard = *session_shards_[session_id % kSessionShards];
+    std::lock_guard<std::mutex> lock(shard.mu);
+    auto it = shard.sessions.find(session_id);
+    if (it == shard.sessions.end()) {
+        return nullptr;
+    }
+    auto session = it->second.lock();
+    if (session == nullptr) {
+        shard.sessions.erase(it);
+    }
+    return session;
+}
+
+int ShardServer::Send(response_buff_t *response) {
+    auto status = thread_info_.socket_status;
+    // deal task queue size sub one
+    __sync_fetch_and_sub(&status->current_recv_pkg_count, 1);
+
+    auto sid = response->session_id;
+    auto msgId = response->msg_id;
+    auto session = getSession(static_cast<uint64_t>(sid));
+    if (session == nullptr || session->Closed()) {
+        FLOG_DEBUG("not found session_id: %" PRId64 ", msgid: %" PRId64, sid, msgId);
+        delete_response_buff(response);
+        return -1;
+    }
+
+    // response中已经是编码好的应答帧，可能有多个
+    auto msg = net::NewMessage();
+    msg->encoded = true;
+    msg->body.assign(response->buff, response->buff + response->buff_len);
+
+    if (thread_info_.send_callback != NULL) {
+        thread_info_.send_callback(response, thread_info_.user_data, 0);
+    }
+    delete_response_buff(response);
+
+    session->Write(msg);
+    return 0;
+}
+
+bool ShardServer::Closed(uint64_t session_id) {
+    auto session = getSession(session_id);
+    return session == nullptr || session->Closed();
+}
+
+}  // namespace server
+}  // namespace dataserver
+}  // namespace sharkstore
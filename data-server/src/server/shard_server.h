@@ -0,0 +1,76 @@
+_Pragma("once");
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "common/socket_message.h"
+#include "common/socket_server.h"
+#include "net/handler.h"
+
+namespace sharkstore {
+namespace dataserver {
+
+namespace net {
+class Server;
+}
+
+namespace server {
+
+// 每个核一个asio io线程的数据面(thread-per-core)
+// 每个io线程负责range_id % 线程数 等于自己编号的range：
+//   请求在连接所在的io线程解码，属于本线程的直接交给deal执行，不经过worker队列；
+//   属于其他线程的投递到所属线程执行，只有这种请求有一次线程切换；
+//   应答在连接所在的io线程直接写socket
+// range本身是线程安全的，分片只是为了局部性，取不到range_id的请求在当前线程执行
+class ShardServer : public common::SocketServer {
+public:
+    using DealFunc = std::function<void(common::ProtoMessage *)>;
+
+    explicit ShardServer(const DealFunc &deal);
+    ~ShardServer();
+
+    ShardServer(const ShardServer &) = delete;
+    ShardServer &operator=(const ShardServer &) = delete;
+    ShardServer &operator=(const ShardServer &) volatile = delete;
+
+    int Start() override;
+    void Stop() override;
+
+    int Send(response_buff_t *response) override;
+    bool Closed(uint64_t session_id) override;
+    // 不使用frame层的session表，总是返回nullptr
+    sf_session_entry_t *lookup_session_entry(int64_t session_id) override { return nullptr; }
+
+    // 当前线程是否是分片io线程
+    bool InShardThread() const;
+    size_t ShardOf(uint64_t range_id) const { return range_id % shard_num_; }
+
+    uint64_t ForwardedCount() const { return forwarded_; }
+
+private:
+    void onMessage(const net::Context &ctx, const net::MessagePtr &msg);
+    void addSession(const net::Context &ctx);
+    std::shared_ptr<net::Session> getSession(uint64_t session_id);
+
+private:
+    struct SessionShard {
+        std::mutex mu;
+        std::unordered_map<uint64_t, std::weak_ptr<net::Session>> sessions;
+        size_t sweep_size = 1024;  // 超过该数量时清理已经关闭的连接
+    };
+
+    DealFunc deal_;
+    size_t shard_num_ = 1;
+    std::unique_ptr<net::Server> server_;
+    std::vector<std::unique_ptr<SessionShard>> session_shards_;
+
+    std::atomic<uint64_t> forwarded_ = {0};
+};
+
+}  // namespace server
+}  // namespace dataserver
+}  // namespace sharkstore
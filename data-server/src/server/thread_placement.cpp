@@ -0,0 +1,323 @@
+#include "thread_placement.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include "common/ds_config.h"
+#include "frame/sf_logger.h"
+
+namespace sharkstore {
+namespace dataserver {
+namespace server {
+
+const char* const ThreadPlacement::kDefault = "default";
+const char* const ThreadPlacement::kSocket = "socket";
+const char* const ThreadPlacement::kFastWorker = "fast_worker";
+const char* const ThreadPlacement::kSlowWorker = "slow_worker";
+const char* const ThreadPlacement::kRaftConsensus = "raft_consensus";
+const char* const ThreadPlacement::kRaftApply = "raft_apply";
+const char* const ThreadPlacement::kRaftTransport = "raft_transport";
+const char* const ThreadPlacement::kRaftTick = "raft_tick";
+const char* const ThreadPlacement::kRocksdb = "rocksdb";
+
+static std::string trim(const std::string& str) {
+    auto begin = str.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    auto end = str.find_last_not_of(" \t\r\n");
+    return str.substr(begin, end - begin + 1);
+}
+
+// 解析"0-3,8,10-11"格式的编号列表，结果排序去重
+static bool parseIdList(const std::string& str, std::vector<int>* ids) {
+    std::set<int> result;
+    std::stringstream ss(str);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        item = trim(item);
+        if (item.empty()) continue;
+        char* end = nullptr;
+        auto first = strtol(item.c_str(), &end, 10);
+        auto last = first;
+        if (end == item.c_str() || first < 0) return false;
+        if (*end == '-') {
+            auto p = end + 1;
+            last = strtol(p, &end, 10);
+            if (end == p || last < first) return false;
+        }
+        if (*end != '\0' || last >= CPU_SETSIZE) return false;
+        for (auto i = first; i <= last; ++i) {
+            result.insert(static_cast<int>(i));
+        }
+    }
+    ids->assign(result.begin(), result.end());
+    return true;
+}
+
+std::string FormatCpuList(const std::vector<int>& cpus) {
+    std::string result;
+    for (size_t i = 0; i < cpus.size();) {
+        auto j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) ++j;
+        if (!result.empty()) result.push_back(',');
+        result += std::to_string(cpus[i]);
+        if (j > i) {
+            result.push_back('-');
+            result += std::to_string(cpus[j]);
+        }
+        i = j + 1;
+    }
+    return result;
+}
+
+std::map<int, std::vector<int>> ThreadPlacement::NumaTopology() {
+    std::map<int, std::vector<int>> topology;
+    auto dir = opendir("/sys/devices/system/node");
+    if (dir != nullptr) {
+        struct dirent* ent = nullptr;
+        while ((ent = readdir(dir)) != nullptr) {
+            int node = 0;
+            if (sscanf(ent->d_name, "node%d", &node) != 1) continue;
+            std::ifstream in(std::string("/sys/devices/system/node/") + ent->d_name + "/cpulist");
+            std::string line;
+            std::vector<int> cpus;
+            if (std::getline(in, line) && parseIdList(trim(line), &cpus)) {
+                topology[node] = std::move(cpus);
+            }
+        }
+        closedir(dir);
+    }
+
+    // 没有numa信息时作为一个节点
+    if (topology.empty()) {
+        auto num = std::max(1u, std::thread::hardware_concurrency());
+        auto& cpus = topology[0];
+        for (unsigned i = 0; i < num; ++i) {
+            cpus.push_back(static_cast<int>(i));
+        }
+    }
+    return topology;
+}
+
+Status ParseCpuPlacement(const std::string& str, CpuPlacement* placement) {
+    placement->config = trim(str);
+    placement->cpus.clear();
+    placement->nodes.clear();
+    if (placement->config.empty()) {
+        return Status::OK();
+    }
+
+    auto topology = ThreadPlacement::NumaTopology();
+    std::set<int> cpus, nodes;
+    if (placement->config.compare(0, 5, "node:") == 0) {
+        std::vector<int> ids;
+        if (!parseIdList(placement->config.substr(5), &ids) || ids.empty()) {
+            return Status(Status::kInvalidArgument, "numa node list", placement->config);
+        }
+        for (auto id : ids) {
+            auto it = topology.find(id);
+            if (it == topology.end()) {
+                return Status(Status::kInvalidArgument, "numa node not exist", std::to_string(id));
+            }
+            cpus.insert(it->second.begin(), it->second.end());
+            nodes.insert(id);
+        }
+    } else {
+        std::vector<int> ids;
+        if (!parseIdList(placement->config, &ids) || ids.empty()) {
+            return Status(Status::kInvalidArgument, "cpu list", placement->config);
+        }
+        for (auto id : ids) {
+            bool found = false;
+            for (const auto& node : topology) {
+                if (std::binary_search(node.second.begin(), node.second.end(), id)) {
+                    nodes.insert(node.first);
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                return Status(Status::kInvalidArgument, "cpu not exist", std::to_string(id));
+            }
+            cpus.insert(id);
+        }
+    }
+    placement->cpus.assign(cpus.begin(), cpus.end());
+    placement->nodes.assign(nodes.begin(), nodes.end());
+    return Status::OK();
+}
+
+ThreadPlacement& ThreadPlacement::Instance() {
+    static ThreadPlacement instance;
+    return instance;
+}
+
+ThreadPlacement::ThreadPlacement() {
+    for (auto name : {kDefault, kSocket, kFastWorker, kSlowWorker, kRaftConsensus, kRaftApply,
+                      kRaftTransport, kRaftTick, kRocksdb}) {
+        PoolInfo info;
+        info.name = name;
+        pools_.push_back(std::move(info));
+    }
+}
+
+Status ThreadPlacement::Init() {
+    const auto& cfg = ds_config.affinity_config;
+    const std::map<std::string, const char*> configs = {
+        {kDefault, cfg.default_cpus},         {kSocket, cfg.socket},
+        {kFastWorker, cfg.fast_worker},       {kSlowWorker, cfg.slow_worker},
+        {kRaftConsensus, cfg.raft_consensus}, {kRaftApply, cfg.raft_apply},
+        {kRaftTransport, cfg.raft_transport}, {kRaftTick, cfg.raft_tick},
+        {kRocksdb, cfg.rocksdb},
+    };
+
+    std::lock_guard<std::mutex> lock(mu_);
+    for (auto& pool : pools_) {
+        auto s = ParseCpuPlacement(configs.at(pool.name), &pool.placement);
+        if (!s.ok()) {
+            return Status(Status::kInvalidArgument, "affinity " + pool.name, s.ToString());
+        }
+        if (!pool.placement.Empty()) {
+            FLOG_INFO("thread pool %s placed on cpus %s, numa nodes %s", pool.name.c_str(),
+                      FormatCpuList(pool.placement.cpus).c_str(),
+                      FormatCpuList(pool.placement.nodes).c_str());
+        }
+    }
+    return Status::OK();
+}
+
+const CpuPlacement& ThreadPlacement::Get(const std::string& pool) const {
+    for (const auto& info : pools_) {
+        if (info.name == pool) {
+            return info.placement;
+        }
+    }
+    return empty_;
+}
+
+Status ThreadPlacement::Apply(const std::string& pool) {
+    const auto& placement = Get(pool);
+    if (placement.Empty()) {
+        return Status::OK();
+    }
+
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (auto cpu : placement.cpus) {
+        CPU_SET(cpu, &cpu_set);
+    }
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    if (ret != 0) {
+        auto s = Status(Status::kIOError, "set affinity " + pool, strerror(ret));
+        FLOG_WARN("thread pool %s: %s", pool.c_str(), s.ToString().c_str());
+        record(pool, s);
+        return s;
+    }
+
+    // 只会在集合内的cpu上运行，本地分配即从集合所在的numa节点分配
+    if (syscall(SYS_set_mempolicy, MPOL_LOCAL, nullptr, 0) != 0) {
+        FLOG_WARN("thread pool %s set local mempolicy failed: %s", pool.c_str(), strerror(errno));
+    }
+    record(pool, Status::OK());
+    return Status::OK();
+}
+
+void ThreadPlacement::record(const std::string& pool, const Status& s) {
+    std::lock_guard<std::mutex> lock(mu_);
+    for (auto& info : pools_) {
+        if (info.name == pool) {
+            if (s.ok()) {
+                ++info.applied;
+            } else {
+                info.error = s.ToString();
+            }
+            return;
+        }
+    }
+}
+
+std::vector<ThreadPlacement::PoolInfo> ThreadPlacement::GetPools() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return pools_;
+}
+
+std::vector<ThreadPlacement::ThreadGroup> ThreadPlacement::GetThreads() {
+    std::map<std::pair<std::string, std::string>, int> groups;
+    auto dir = opendir("/proc/self/task");
+    if (dir != nullptr) {
+        struct dirent* ent = nullptr;
+        while ((ent = readdir(dir)) != nullptr) {
+            if (ent->d_name[0] == '.') continue;
+            auto path = std::string("/proc/self/task/") + ent->d_name;
+
+            std::string name, cpus, line;
+            std::ifstream comm(path + "/comm");
+            std::getline(comm, name);
+            // fast_worker:3 -> fast_worker
+            auto pos = name.find_last_not_of("0123456789");
+            if (pos != std::string::npos && pos + 1 < name.size()) {
+                name.resize(pos + 1);
+                if (name.back() == ':' || name.back() == '-' || name.back() == '_') name.pop_back();
+            }
+
+            std::ifstream status(path + "/status");
+            while (std::getline(status, line)) {
+                if (line.compare(0, 18, "Cpus_allowed_list:") == 0) {
+                    cpus = trim(line.substr(18));
+                    break;
+                }
+            }
+            ++groups[std::make_pair(name, cpus)];
+        }
+        closedir(dir);
+    }
+
+    std::vector<ThreadGroup> result;
+    for (const auto& g : groups) {
+        ThreadGroup group;
+        group.name = g.first.first;
+        group.cpus = g.first.second;
+        group.count = g.second;
+        result.push_back(std::move(group));
+    }
+    return result;
+}
+
+ThreadPlacement::Scope::Scope(const std::string& pool) {
+    auto& placement = ThreadPlacement::Instance().Get(pool);
+    if (placement.Empty()) {
+        return;
+    }
+
+    CPU_ZERO(&saved_cpus_);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(saved_cpus_), &saved_cpus_) != 0) {
+        return;
+    }
+    memset(saved_nodes_, 0, sizeof(saved_nodes_));
+    saved_policy_ok_ = syscall(SYS_get_mempolicy, &saved_policy_, saved_nodes_,
+                               sizeof(saved_nodes_) * 8, nullptr, 0) == 0;
+    applied_ = ThreadPlacement::Instance().Apply(pool).ok();
+}
+
+ThreadPlacement::Scope::~Scope() {
+    if (!applied_) {
+        return;
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(saved_cpus_), &saved_cpus_);
+    if (saved_policy_ok_) {
+        syscall(SYS_set_mempolicy, saved_policy_, saved_nodes_, sizeof(saved_nodes_) * 8);
+    }
+}
+
+}  // namespace server
+}  // namespace dataserver
+}  // namespace sharkstore
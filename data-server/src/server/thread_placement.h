@@ -0,0 +1,106 @@
+_Pragma("once");
+
+#include <sched.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "base/status.h"
+
+namespace sharkstore {
+namespace dataserver {
+namespace server {
+
+// 线程池的放置：可以运行的cpu集合，以及这些cpu所在的numa节点
+struct CpuPlacement {
+    std::string config;      // 配置的原始字符串
+    std::vector<int> cpus;   // 空表示不绑定
+    std::vector<int> nodes;
+
+    bool Empty() const { return cpus.empty(); }
+};
+
+// 解析cpu集合配置，格式为cpu列表"0-7,16-23"，或numa节点"node:0"、"node:0,1"(节点上的所有cpu)
+Status ParseCpuPlacement(const std::string& str, CpuPlacement* placement);
+
+// 格式化成"0-7,16-23"的形式
+std::string FormatCpuList(const std::vector<int>& cpus);
+
+// 各线程池的cpu和numa放置
+// 新建的线程继承创建者的cpu亲和性和内存分配策略，因此创建某个线程池之前把当前线程放到该池的cpu上，
+// 创建完再恢复，这样frame的C线程、raft transport和rocksdb的后台线程也能按池放置；
+// 线程的内存使用本地分配策略(MPOL_LOCAL)，从运行所在cpu的numa节点分配
+class ThreadPlacement {
+public:
+    // 线程池名称，和配置文件[affinity]中的配置项一致
+    static const char* const kDefault;  // 主线程，以及其他没有单独配置的线程
+    static const char* const kSocket;
+    static const char* const kFastWorker;
+    static const char* const kSlowWorker;
+    static const char* const kRaftConsensus;
+    static const char* const kRaftApply;
+    static const char* const kRaftTransport;
+    static const char* const kRaftTick;
+    static const char* const kRocksdb;
+
+    static ThreadPlacement& Instance();
+
+    // 从ds_config加载各线程池的配置
+    Status Init();
+
+    const CpuPlacement& Get(const std::string& pool) const;
+
+    // 把当前线程放到pool配置的cpu上，pool没有配置时不做处理
+    Status Apply(const std::string& pool);
+
+    // 在作用域内把当前线程放到pool的cpu上，期间创建的线程都属于该池，析构时恢复
+    class Scope {
+    public:
+        explicit Scope(const std::string& pool);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        bool applied_ = false;
+        bool saved_policy_ok_ = false;
+        cpu_set_t saved_cpus_;
+        int saved_policy_ = 0;
+        unsigned long saved_nodes_[16];
+    };
+
+    struct PoolInfo {
+        std::string name;
+        CpuPlacement placement;
+        uint64_t applied = 0;  // 成功放置的次数
+        std::string error;     // 最近一次放置失败的原因
+    };
+    std::vector<PoolInfo> GetPools() const;
+
+    // 机器的numa拓扑，节点id -> 节点上的cpu
+    static std::map<int, std::vector<int>> NumaTopology();
+
+    // 进程当前所有线程实际的cpu亲和性，按线程名(去掉末尾编号)和cpu集合分组计数
+    struct ThreadGroup {
+        std::string name;
+        std::string cpus;
+        int count = 0;
+    };
+    static std::vector<ThreadGroup> GetThreads();
+
+private:
+    ThreadPlacement();
+
+    void record(const std::string& pool, const Status& s);
+
+private:
+    mutable std::mutex mu_;
+    std::vector<PoolInfo> pools_;
+    CpuPlacement empty_;
+};
+
+}  // namespace server
+}  // namespace dataserver
+}  // namespace sharkstore
@@ -6,6 +6,9 @@
 #include "base/util.h"
 #include "common/ds_config.h"
 #include "common/ds_proto.h"
+#ifdef SHARK_USE_IO_URING
+#include "common/socket_uring_server.h"
+#endif
 #include "frame/sf_config.h"
 #include "frame/sf_logger.h"
 #include "frame/sf_util.h"
@@ -14,6 +17,7 @@
 #include "callback.h"
 #include "run_status.h"
 #include "server.h"
+#include "thread_placement.h"
 
 namespace sharkstore {
 namespace dataserver {
@@ -24,13 +28,33 @@ int Worker::Init(ContextServer *context) {
 
     strcpy(ds_config.worker_config.thread_name_prefix, "work");
 
-    if (socket_server_.Init(&ds_config.worker_config, &worker_status_) != 0) {
+    if (ds_config.net_config.backend == 2) {
+        shard_server_ = new ShardServer([this](common::ProtoMessage *task) { Push(task); });
+        socket_server_.reset(shard_server_);
+        FLOG_INFO("Worker use shard per core net backend");
+    } else if (ds_config.net_config.backend == 1) {
+#ifdef SHARK_USE_IO_URING
+        if (common::UringSocketServer::Supported()) {
+            socket_server_.reset(new common::UringSocketServer);
+            FLOG_INFO("Worker use io_uring net backend");
+        } else {
+            FLOG_WARN("io_uring is not supported by kernel, use epoll net backend");
+        }
+#else
+        FLOG_WARN("io_uring net backend is not compiled in, use epoll net backend");
+#endif
+    }
+    if (!socket_server_) {
+        socket_server_.reset(new common::SocketServer);
+    }
+
+    if (socket_server_->Init(&ds_config.worker_config, &worker_status_) != 0) {
         FLOG_ERROR("Worker Init error ...");
         return -1;
     }
 
-    socket_server_.set_recv_done(ds_worker_deal_callback);
-    socket_server_.set_send_done(ds_send_done_callback);
+    socket_server_->set_recv_done(ds_worker_deal_callback);
+    socket_server_->set_send_done(ds_send_done_callback);
 
     context_ = context;
 
@@ -72,7 +96,10 @@ int Worker::Start() {
     FLOG_INFO("Worker Start begin ...");
 
     // start fast worker
-    StartWorker(fast_worker_, fast_queue_, ds_config.fast_worker_num);
+    {
+        ThreadPlacement::Scope scope(ThreadPlacement::kFastWorker);
+        StartWorker(fast_worker_, fast_queue_, ds_config.fast_worker_num);
+    }
 
     int i = 0;
     char fast_name[32] = {'\0'};
@@ -82,7 +109,10 @@ int Worker::Start() {
         AnnotateThread(handle, fast_name);
     }
     // start slow worker
-    StartWorker(slow_worker_, slow_queue_, ds_config.slow_worker_num);
+    {
+        ThreadPlacement::Scope scope(ThreadPlacement::kSlowWorker);
+        StartWorker(slow_worker_, slow_queue_, ds_config.slow_worker_num);
+    }
 
     char slow_name[32] = {'\0'};
     i = 0;
@@ -92,7 +122,12 @@ int Worker::Start() {
         AnnotateThread(handle, slow_name);
     }
 
-    if (socket_server_.Start() != 0) {
+    int ret = 0;
+    {
+        ThreadPlacement::Scope scope(ThreadPlacement::kSocket);
+        ret = socket_server_->Start();
+    }
+    if (ret != 0) {
         FLOG_ERROR("Worker Start error ...");
         return -1;
     }
@@ -104,7 +139,7 @@ int Worker::Start() {
 void Worker::Stop() {
     FLOG_INFO("Worker Stop begin ...");
 
-    socket_server_.Stop();
+    socket_server_->Stop();
 
     auto size = fast_worker_.size();
     for (decltype(size) i = 0; i < size; i++) {
@@ -128,11 +163,11 @@ void Worker::Stop() {
 
 void Worker::Push(common::ProtoMessage *task) {
     sf_session_entry_t *entry;
-    task->socket = &socket_server_;
+    task->socket = socket_server_.get();
 
     if (task->header.func_id == 0) {  // funcpb::FunctionID::kFuncHeartbeat = 0
         entry = task->socket->lookup_session_entry(task->session_id);
-        if (entry == nullptr) {
+        if (entry != nullptr) {
             FLOG_DEBUG("Heartbeat ip: %s, session_id %" PRIu64,
                        entry->rtask->client_ip, task->session_id);
         } else {
@@ -142,13 +177,28 @@ void Worker::Push(common::ProtoMessage *task) {
         return;
     }
 
+    // 分片模式下请求已经在range所属的io线程，快请求直接执行，不经过worker队列
+    if (shard_server_ != nullptr && !isSlow(task) && shard_server_->InShardThread()) {
+        DealTask(task);
+        return;
+    }
+
+    // 同一连接上同一stream的请求总是进同一个队列，按到达顺序执行
+    uint64_t seed = 0;
+    auto stream = DS_PROTO_STREAM_ID(task->header.flags);
+    if (stream != 0) {
+        seed = static_cast<uint64_t>(task->session_id) * 131 + stream;
+    } else {
+        seed = ++slot_seed_;
+    }
+
     if (isSlow(task)) {
-        auto slot = ++slot_seed_ % ds_config.slow_worker_num;
+        auto slot = seed % ds_config.slow_worker_num;
         auto mq = slow_queue_.msg_queue[slot];
         lk_queue_push(mq, task);
         ++slow_queue_.all_msg_size;
     } else {
-        auto slot = ++slot_seed_ % ds_config.fast_worker_num;
+        auto slot = seed % ds_config.fast_worker_num;
         auto mq = fast_queue_.msg_queue[slot];
         lk_queue_push(mq, task);
         ++fast_queue_.all_msg_size;
@@ -162,6 +212,7 @@ void Worker::DealTask(common::ProtoMessage *task) {
         return;
     }
 
+    task->deal_time = get_micro_second();
     DataServer::Instance().DealTask(task);
 }
 
@@ -2,6 +2,7 @@
 #define __WORKER_H__
 
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
@@ -15,6 +16,7 @@
 #include "lk_queue/lk_queue.h"
 
 #include "context_server.h"
+#include "shard_server.h"
 
 namespace sharkstore {
 namespace dataserver {
@@ -76,7 +78,9 @@ private:
     HashQueue fast_queue_;
     HashQueue slow_queue_;
 
-    common::SocketServer socket_server_;
+    std::unique_ptr<common::SocketServer> socket_server_;
+    // 分片模式下同socket_server_，否则为nullptr
+    ShardServer *shard_server_ = nullptr;
 
     sf_socket_status_t worker_status_ = {0};
 
@@ -41,11 +41,7 @@ static uint64_t calculateOps(uint64_t val, uint64_t elapsed_ms) {
 
 void Metric::Reset() {
     last_collect_ = std::chrono::steady_clock::now();
-
-    keys_read_counter_ = 0;
-    keys_write_counter_ = 0;
-    bytes_read_counter_ = 0;
-    bytes_write_counter_ = 0;
+    GetTotal(&last_total_);
 }
 
 void Metric::Collect(MetricStat* stat) {
@@ -57,20 +53,34 @@ void Metric::Collect(MetricStat* stat) {
                           .count();
     if (elasped_ms <= 0) return;
 
+    MetricTotal total;
+    GetTotal(&total);
     stat->keys_read_per_sec =
-        calculateOps(keys_read_counter_.exchange(0), elasped_ms);
+        calculateOps(total.keys_read - last_total_.keys_read, elasped_ms);
     stat->keys_write_per_sec =
-        calculateOps(keys_write_counter_.exchange(0), elasped_ms);
+        calculateOps(total.keys_write - last_total_.keys_write, elasped_ms);
     stat->bytes_read_per_sec =
-        calculateOps(bytes_read_counter_.exchange(0), elasped_ms);
+        calculateOps(total.bytes_read - last_total_.bytes_read, elasped_ms);
     stat->bytes_write_per_sec =
-        calculateOps(bytes_write_counter_.exchange(0), elasped_ms);
+        calculateOps(total.bytes_write - last_total_.bytes_write, elasped_ms);
 
+    last_total_ = total;
     last_collect_ = now;
 }
 
+void Metric::GetTotal(MetricTotal* total) const {
+    assert(total != nullptr);
+
+    total->keys_read = keys_read_counter_.load(std::memory_order_relaxed);
+    total->keys_write = keys_write_counter_.load(std::memory_order_relaxed);
+    total->bytes_read = bytes_read_counter_.load(std::memory_order_relaxed);
+    total->bytes_write = bytes_write_counter_.load(std::memory_order_relaxed);
+}
+
 void Metric::CollectAll(MetricStat* stat) { g_metric.Collect(stat); }
 
+void Metric::GetTotalAll(MetricTotal* total) { g_metric.GetTotal(total); }
+
 }  // namespace storage
 }  // namespace dataserver
 }  // namespace sharkstore
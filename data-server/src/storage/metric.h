@@ -17,6 +17,14 @@ struct MetricStat {
     std::string ToString() const;
 };
 
+// counters accumulated since start
+struct MetricTotal {
+    uint64_t keys_read = 0;
+    uint64_t keys_write = 0;
+    uint64_t bytes_read = 0;
+    uint64_t bytes_write = 0;
+};
+
 class Metric {
 public:
     Metric();
@@ -25,13 +33,18 @@ public:
     void AddRead(uint64_t keys, uint64_t bytes);
     void AddWrite(uint64_t keys, uint64_t bytes);
 
+    // reset the rate calculation, totals are kept
     void Reset();
 
     // should only called by one thread
     void Collect(MetricStat* stat);
 
+    // monotonic totals, safe to call from any thread
+    void GetTotal(MetricTotal* total) const;
+
     // collect gobal metric
     static void CollectAll(MetricStat* stat);
+    static void GetTotalAll(MetricTotal* total);
 
 private:
     using TimePoint = std::chrono::time_point<std::chrono::steady_clock>;
@@ -41,6 +54,8 @@ private:
     std::atomic<uint64_t> bytes_read_counter_{0};
     std::atomic<uint64_t> bytes_write_counter_{0};
 
+    // counters at the last collect, used to calculate rates
+    MetricTotal last_total_;
     TimePoint last_collect_;
 };
 
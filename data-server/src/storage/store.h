@@ -56,6 +56,7 @@ public:
 
     void ResetMetric() { metric_.Reset(); }
     void CollectMetric(MetricStat* stat) { metric_.Collect(stat); }
+    void GetMetricTotal(MetricTotal* total) const { metric_.GetTotal(total); }
 
     // 统计存储实际大小，并且根据split_size返回中间key
     Status StatSize(uint64_t split_size, range::SplitKeyMode mode,
@@ -0,0 +1,269 @@
+_Pragma("once");
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace sharkstore {
+namespace dataserver {
+namespace watch {
+
+/**
+ * 单写多读的事件环
+ *
+ * 槽位按写入序号(seq % capacity)定位，指向一个写入后不再修改的节点：写入序号、版本号和事件的shared_ptr。
+ * 写线程先推进head_让出最旧的槽位，再把新节点发布到槽位，最后发布tail_。
+ * 读线程不加锁：按序号取节点，节点的序号和要取的不一致说明槽位已被覆盖，本次快照作废；
+ * 只复制事件的shared_ptr(引用计数的原子加)，不复制事件本身。
+ *
+ * 被替换下来的节点不能立即释放，读线程可能正在读它。回收按纪元进行：
+ * 读线程进入时在当前纪元(奇偶)的读者计数上加一，退出时减一；
+ * 写线程每次写入后检查上一纪元的读者计数，为0时回收上一纪元替换下来的节点(放回空闲链表复用)并进入下一纪元。
+ * 写线程从不等待读线程，读线程停留过久只是推迟回收。
+ *
+ * T需要提供 int64_t version() const，且写入的版本单调递增
+ */
+template <class T>
+class EventRing {
+public:
+    typedef std::shared_ptr<const T> ValuePtr;
+
+    explicit EventRing(uint32_t capacity)
+        : capacity_(capacity > 0 ? capacity : 1), slots_(new std::atomic<Node*>[capacity_]) {
+        for (uint32_t i = 0; i < capacity_; ++i) {
+            slots_[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    // 析构时不能再有读线程
+    ~EventRing() {
+        for (uint32_t i = 0; i < capacity_; ++i) {
+            delete slots_[i].load(std::memory_order_relaxed);
+        }
+        for (auto& nodes : retired_) {
+            for (auto node : nodes) {
+                delete node;
+            }
+        }
+        for (auto node : free_) {
+            delete node;
+        }
+    }
+
+    EventRing(const EventRing&) = delete;
+    EventRing& operator=(const EventRing&) = delete;
+
+    // 只允许一个写线程
+    void Push(ValuePtr value) {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_relaxed) >= capacity_) {
+            head_.store(tail - capacity_ + 1, std::memory_order_release);
+        }
+
+        Node* node = nullptr;
+        if (free_.empty()) {
+            node = new Node;
+        } else {
+            node = free_.back();
+            free_.pop_back();
+        }
+        node->seq = tail;
+        node->version = value->version();
+        node->value = std::move(value);
+
+        auto& slot = slots_[tail % capacity_];
+        auto old = slot.load(std::memory_order_relaxed);
+        slot.store(node, std::memory_order_release);
+        tail_.store(tail + 1, std::memory_order_release);
+
+        if (old != nullptr) {
+            retired_[epoch_.load(std::memory_order_relaxed) & 1].push_back(old);
+        }
+        reclaim();
+    }
+
+    // 只允许写线程调用
+    void Clear() {
+        head_.store(tail_.load(std::memory_order_relaxed), std::memory_order_release);
+    }
+
+    /**
+     * 把版本大于version的事件追加到result
+     * 返回值 -1: 环为空或version早于环内最旧的事件  0: 没有新的事件  >0: 追加的事件个数
+     * lower/upper返回环内的版本范围
+     */
+    int32_t Snapshot(int64_t version, std::vector<ValuePtr>* result,
+                     int64_t* lower = nullptr, int64_t* upper = nullptr) const {
+        if (lower != nullptr) *lower = 0;
+        if (upper != nullptr) *upper = 0;
+
+        ReadGuard guard(this);
+        auto tail = tail_.load(std::memory_order_acquire);
+        auto head = head_.load(std::memory_order_acquire);
+        if (head >= tail) {
+            return -1;
+        }
+
+        auto first = nodeAt(head);
+        auto last = nodeAt(tail - 1);
+        if (first == nullptr || last == nullptr) {
+            // 读取期间被写线程覆盖
+            return -1;
+        }
+        if (lower != nullptr) *lower = first->version;
+        if (upper != nullptr) *upper = last->version;
+
+        if (version >= last->version) {
+            return 0;
+        }
+        if (version < first->version) {
+            return -1;
+        }
+
+        // 第一个版本大于version的位置
+        auto from = head, to = tail - 1;
+        while (from < to) {
+            auto mid = from + (to - from) / 2;
+            auto node = nodeAt(mid);
+            if (node == nullptr) {
+                return -1;
+            }
+            if (node->version <= version) {
+                from = mid + 1;
+            } else {
+                to = mid;
+            }
+        }
+
+        auto origin = result->size();
+        result->reserve(origin + (tail - from));
+        for (auto seq = from; seq < tail; ++seq) {
+            auto node = nodeAt(seq);
+            if (node == nullptr) {
+                result->resize(origin);
+                return -1;
+            }
+            result->push_back(node->value);
+        }
+        return static_cast<int32_t>(tail - from);
+    }
+
+    int64_t LowerVersion() const {
+        ReadGuard guard(this);
+        while (true) {
+            auto tail = tail_.load(std::memory_order_acquire);
+            auto head = head_.load(std::memory_order_acquire);
+            if (head >= tail) {
+                return 0;
+            }
+            // 被覆盖时head_已经推进，重新读取
+            auto node = nodeAt(head);
+            if (node != nullptr) {
+                return node->version;
+            }
+        }
+    }
+
+    int64_t UpperVersion() const {
+        ReadGuard guard(this);
+        while (true) {
+            auto tail = tail_.load(std::memory_order_acquire);
+            auto head = head_.load(std::memory_order_acquire);
+            if (head >= tail) {
+                return 0;
+            }
+            auto node = nodeAt(tail - 1);
+            if (node != nullptr) {
+                return node->version;
+            }
+        }
+    }
+
+    uint32_t Length() const {
+        auto tail = tail_.load(std::memory_order_acquire);
+        auto head = head_.load(std::memory_order_acquire);
+        return head < tail ? static_cast<uint32_t>(tail - head) : 0;
+    }
+
+    bool Empty() const { return Length() == 0; }
+    uint32_t Capacity() const { return capacity_; }
+
+private:
+    struct Node {
+        uint64_t seq = 0;
+        int64_t version = 0;
+        ValuePtr value;
+    };
+
+    // 两个读者计数隔开一个cache line，读线程在两个纪元的计数上互不干扰
+    struct ReaderCount {
+        std::atomic<int64_t> count = {0};
+        char pad[64 - sizeof(std::atomic<int64_t>)];
+    };
+
+    // 读线程在持有期间访问的节点不会被回收
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const EventRing* ring) : ring_(ring) {
+            while (true) {
+                epoch_ = ring_->epoch_.load();
+                ring_->readers_[epoch_ & 1].count.fetch_add(1);
+                // 加计数之前写线程已经进入下一纪元，这个计数可能已被检查过
+                if (ring_->epoch_.load() == epoch_) {
+                    break;
+                }
+                ring_->readers_[epoch_ & 1].count.fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        ~ReadGuard() { ring_->readers_[epoch_ & 1].count.fetch_sub(1, std::memory_order_release); }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+    private:
+        const EventRing* ring_;
+        uint64_t epoch_ = 0;
+    };
+
+    // 序号seq的节点，槽位已被覆盖时返回nullptr，只能在ReadGuard内调用
+    const Node* nodeAt(uint64_t seq) const {
+        auto node = slots_[seq % capacity_].load(std::memory_order_acquire);
+        return (node != nullptr && node->seq == seq) ? node : nullptr;
+    }
+
+    // 上一纪元没有读者时，回收上一纪元替换下来的节点并进入下一纪元
+    // 当前纪元的读者可能还持有本纪元替换下来的节点，留到下一次
+    void reclaim() {
+        auto epoch = epoch_.load(std::memory_order_relaxed);
+        auto& prev = retired_[(epoch + 1) & 1];
+        if (readers_[(epoch + 1) & 1].count.load() != 0) {
+            return;
+        }
+        for (auto node : prev) {
+            node->value.reset();
+            free_.push_back(node);
+        }
+        prev.clear();
+        epoch_.store(epoch + 1);
+    }
+
+private:
+    const uint32_t capacity_;
+    std::unique_ptr<std::atomic<Node*>[]> slots_;
+
+    std::atomic<uint64_t> head_ = {0};
+    std::atomic<uint64_t> tail_ = {0};
+
+    std::atomic<uint64_t> epoch_ = {0};
+    mutable ReaderCount readers_[2];
+
+    // 只有写线程访问
+    std::vector<Node*> retired_[2];
+    std::vector<Node*> free_;
+};
+
+}  // namespace watch
+}  // namespace dataserver
+}  // namespace sharkstore
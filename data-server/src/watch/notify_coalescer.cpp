@@ -0,0 +1,174 @@
+#include "notify_coalescer.h"
+
+#include <string.h>
+#include <set>
+#include <vector>
+
+#include "base/util.h"
+#include "common/socket_session_impl.h"
+#include "frame/sf_logger.h"
+
+namespace sharkstore {
+namespace dataserver {
+namespace watch {
+
+// 单个session合并的数据超过该值立即发送
+static const size_t kMaxBatchBytes = 1024 * 1024;
+
+NotifyCoalescer::NotifyCoalescer(int window_ms, bool squash)
+    : window_ms_(window_ms), squash_(squash) {
+    flush_thread_ = std::thread([this] { run(); });
+    AnnotateThread(flush_thread_.native_handle(), "watch_coalesce");
+    FLOG_INFO("watch notify coalescer started, window: %d ms, squash: %d", window_ms_, squash_);
+}
+
+NotifyCoalescer::~NotifyCoalescer() {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        running_ = false;
+    }
+    cond_.notify_one();
+    flush_thread_.join();
+
+    // 等待中的应答(包括超时、取消的结束帧)不能丢，停止前全部发出
+    Flush();
+}
+
+void NotifyCoalescer::Add(common::ProtoMessage* msg, const std::string& body, const std::string& tail,
+                          bool stream) {
+    ++frames_;
+
+    Batch full;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = batches_.find(msg->session_id);
+        if (it == batches_.end()) {
+            it = batches_.emplace(msg->session_id, Batch()).first;
+            auto& batch = it->second;
+            batch.socket = msg->socket;
+            batch.session_id = msg->session_id;
+            batch.msg_id = msg->header.msg_id;
+            batch.begin_time = msg->begin_time;
+            batch.expire_time = msg->expire_time;
+            deadlines_.emplace_back(getticks() + window_ms_, msg->session_id);
+            if (deadlines_.size() == 1) {
+                cond_.notify_one();
+            }
+        }
+
+        auto& batch = it->second;
+        common::SocketSessionImpl::AppendResponse(msg, body, tail, &batch.data);
+        ++batch.frames;
+        if (!stream) ++batch.requests;
+        if (batch.data.size() >= kMaxBatchBytes) {
+            full = std::move(batch);
+            batches_.erase(it);
+        }
+    }
+    delete msg;
+
+    if (full.frames > 0) {
+        send(full);
+    }
+}
+
+void NotifyCoalescer::Flush() {
+    std::map<int64_t, Batch> batches;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        batches.swap(batches_);
+        deadlines_.clear();
+    }
+    for (auto& it : batches) {
+        send(it.second);
+    }
+}
+
+void NotifyCoalescer::run() {
+    std::vector<Batch> ready;
+    std::unique_lock<std::mutex> lock(mu_);
+    while (running_) {
+        if (deadlines_.empty()) {
+            cond_.wait(lock);
+            continue;
+        }
+
+        auto now = getticks();
+        auto deadline = deadlines_.front().first;
+        if (deadline > now) {
+            cond_.wait_for(lock, std::chrono::milliseconds(deadline - now));
+            continue;
+        }
+
+        while (!deadlines_.empty() && deadlines_.front().first <= now) {
+            // 已经因为数据过多提前发送的session找不到
+            auto it = batches_.find(deadlines_.front().second);
+            if (it != batches_.end()) {
+                ready.push_back(std::move(it->second));
+                batches_.erase(it);
+            }
+            deadlines_.pop_front();
+        }
+
+        lock.unlock();
+        for (auto& batch : ready) {
+            send(batch);
+        }
+        ready.clear();
+        lock.lock();
+    }
+}
+
+void NotifyCoalescer::send(Batch& batch) {
+    auto response = new_response_buff(static_cast<int>(batch.data.size()));
+    memcpy(response->buff, batch.data.data(), batch.data.size());
+    response->session_id = batch.session_id;
+    response->msg_id = batch.msg_id;
+    response->begin_time = batch.begin_time;
+    response->expire_time = batch.expire_time;
+    response->buff_len = static_cast<int32_t>(batch.data.size());
+
+    ++batches_sent_;
+    FLOG_DEBUG("watch notify coalesced, session_id: %" PRId64 " frames: %d bytes: %zu",
+               batch.session_id, batch.frames, batch.data.size());
+
+    batch.socket->SendBatch(response, batch.requests);
+}
+
+size_t NotifyCoalescer::SquashEvents(EventSnapshot* events) {
+    struct keyLess {
+        bool operator()(const std::vector<std::string>* l, const std::vector<std::string>* r) const {
+            return *l < *r;
+        }
+    };
+
+    // 从后往前，每个key第一次出现的即为最新版本
+    std::set<const std::vector<std::string>*, keyLess> seen;
+    std::vector<bool> keep(events->size(), false);
+    for (size_t i = events->size(); i > 0; --i) {
+        keep[i - 1] = seen.insert(&(*events)[i - 1]->key()).second;
+    }
+
+    size_t pos = 0;
+    for (size_t i = 0; i < events->size(); ++i) {
+        if (keep[i]) {
+            if (pos != i) (*events)[pos] = std::move((*events)[i]);
+            ++pos;
+        }
+    }
+
+    auto squashed = events->size() - pos;
+    events->resize(pos);
+    squashed_ += squashed;
+    return squashed;
+}
+
+void NotifyCoalescer::GetStats(CoalesceStats* stats) const {
+    stats->frames = frames_;
+    stats->batches = batches_sent_;
+    stats->squashed = squashed_;
+}
+
+} // namespace watch
+}
+}
@@ -0,0 +1,91 @@
+#ifndef _NOTIFY_COALESCER_H_
+#define _NOTIFY_COALESCER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "common/socket_message.h"
+#include "watch_event_buffer.h"
+
+namespace sharkstore {
+namespace dataserver {
+namespace watch {
+
+struct CoalesceStats {
+    uint64_t frames = 0;    // 进入合并队列的应答帧数
+    uint64_t batches = 0;   // 实际发送次数
+    uint64_t squashed = 0;  // 合并掉的同一个key的中间版本事件数
+};
+
+// watch通知按session合并发送
+// 同一个session在时间窗口内的多个通知应答帧拼接成一个发送缓冲，一次写入socket，
+// 减少客户端watch大量key或者key频繁变更时的小包和唤醒次数；
+// 每个应答帧仍保留各自的msg_id，客户端按帧解析，不需要改协议
+class NotifyCoalescer {
+public:
+    NotifyCoalescer(int window_ms, bool squash);
+    ~NotifyCoalescer();
+
+    NotifyCoalescer(const NotifyCoalescer&) = delete;
+    NotifyCoalescer& operator=(const NotifyCoalescer&) = delete;
+
+    // 接管msg，body和tail依次拼接作为应答内容
+    // stream为true时是流式watch的后续帧，不对应新的请求
+    void Add(common::ProtoMessage* msg, const std::string& body, const std::string& tail,
+             bool stream = false);
+
+    // 立即发送所有等待中的应答
+    void Flush();
+
+    // 开启时同一个key在一次通知中只保留最新版本
+    bool Squash() const { return squash_; }
+    int WindowMs() const { return window_ms_; }
+
+    // 同一个key只保留最后(版本最新)的事件，其余事件保持原有的版本顺序
+    // 返回去掉的事件数
+    size_t SquashEvents(EventSnapshot* events);
+
+    void GetStats(CoalesceStats* stats) const;
+
+private:
+    struct Batch {
+        common::SocketBase* socket = nullptr;
+        int64_t session_id = 0;
+        int64_t msg_id = 0;
+        int64_t begin_time = 0;
+        int64_t expire_time = 0;
+        int frames = 0;
+        int requests = 0;
+        std::string data;
+    };
+
+    void run();
+    void send(Batch& batch);
+
+private:
+    const int window_ms_ = 0;
+    const bool squash_ = false;
+
+    std::mutex mu_;
+    std::condition_variable cond_;
+    std::map<int64_t, Batch> batches_;  // key: session_id
+    // <到期时间(ms), session_id>，窗口固定，按加入顺序即按到期顺序
+    std::deque<std::pair<int64_t, int64_t>> deadlines_;
+    bool running_ = true;
+    std::thread flush_thread_;
+
+    std::atomic<uint64_t> frames_ = {0};
+    std::atomic<uint64_t> batches_sent_ = {0};
+    std::atomic<uint64_t> squashed_ = {0};
+};
+
+} // namespace watch
+}
+}
+
+#endif
@@ -0,0 +1,224 @@
+_Pragma("once");
+
+#include <assert.h>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sharkstore {
+namespace dataserver {
+namespace watch {
+
+// 按字节的压缩前缀树(radix tree)
+// 用于索引prefix watcher：沿着一个key走一遍即可找出所有是它前缀的已存储key，
+// 复杂度为O(key长度)，与已存储的前缀数量和层级无关
+// 非线程安全，由调用方加锁
+template <typename T>
+class RadixTree {
+public:
+    RadixTree() : root_(new Node) {}
+    ~RadixTree() { destroy(root_); }
+
+    RadixTree(const RadixTree&) = delete;
+    RadixTree& operator=(const RadixTree&) = delete;
+
+    size_t Size() const { return size_; }
+    bool Empty() const { return size_ == 0; }
+
+    // 精确查找，不存在返回nullptr
+    T* Find(const std::string& key) {
+        Node* node = root_;
+        size_t pos = 0;
+        while (pos < key.size()) {
+            node = matchChild(node, key, pos);
+            if (node == nullptr) return nullptr;
+            pos += node->label.size();
+        }
+        return node->has_value ? &node->value : nullptr;
+    }
+
+    // 插入key，已存在时不覆盖，返回已有的值且second为false
+    std::pair<T*, bool> Insert(const std::string& key, const T& value) {
+        Node* node = root_;
+        size_t pos = 0;
+        while (pos < key.size()) {
+            size_t idx = 0;
+            Node* child = findChild(node, static_cast<unsigned char>(key[pos]), &idx);
+            if (child == nullptr) {
+                // 没有共同前缀的分支，新建叶子
+                child = new Node;
+                child->label = key.substr(pos);
+                node->children.insert(node->children.begin() + idx, child);
+                node = child;
+                break;
+            }
+
+            size_t common = commonPrefix(child->label, key, pos);
+            if (common < child->label.size()) {
+                // 分裂边：node -> mid(公共部分) -> child(剩余部分)
+                Node* mid = new Node;
+                mid->label = child->label.substr(0, common);
+                child->label.erase(0, common);
+                mid->children.push_back(child);
+                node->children[idx] = mid;
+                child = mid;
+            }
+            node = child;
+            pos += common;
+        }
+
+        if (node->has_value) {
+            return std::make_pair(&node->value, false);
+        }
+        node->has_value = true;
+        node->value = value;
+        ++size_;
+        return std::make_pair(&node->value, true);
+    }
+
+    // 删除key，不存在返回false
+    bool Erase(const std::string& key) {
+        // 记录路径用于删除后合并节点
+        std::vector<Node*> path;
+        path.push_back(root_);
+        size_t pos = 0;
+        while (pos < key.size()) {
+            Node* child = matchChild(path.back(), key, pos);
+            if (child == nullptr) return false;
+            pos += child->label.size();
+            path.push_back(child);
+        }
+
+        Node* node = path.back();
+        if (!node->has_value) return false;
+        node->has_value = false;
+        node->value = T();
+        --size_;
+
+        if (node == root_) return true;
+        Node* parent = path[path.size() - 2];
+        if (node->children.empty()) {
+            removeChild(parent, node);
+            delete node;
+            // 父节点可能只剩一个孩子，可以跟孩子合并
+            if (parent != root_ && !parent->has_value && parent->children.size() == 1) {
+                mergeChild(parent);
+            }
+        } else if (node->children.size() == 1) {
+            mergeChild(node);
+        }
+        return true;
+    }
+
+    // 对每个是key前缀(包括key本身)的已存储key，按长度从短到长调用f(前缀长度, 值)
+    // f中不能修改树
+    template <typename F>
+    void ForEachPrefix(const std::string& key, F&& f) {
+        Node* node = root_;
+        size_t pos = 0;
+        if (node->has_value) f(pos, node->value);
+        while (pos < key.size()) {
+            node = matchChild(node, key, pos);
+            if (node == nullptr) return;
+            pos += node->label.size();
+            if (node->has_value) f(pos, node->value);
+        }
+    }
+
+    // 遍历所有值，f中不能修改树
+    template <typename F>
+    void ForEach(F&& f) {
+        std::vector<Node*> stack;
+        stack.push_back(root_);
+        while (!stack.empty()) {
+            Node* node = stack.back();
+            stack.pop_back();
+            if (node->has_value) f(node->value);
+            for (auto child : node->children) {
+                stack.push_back(child);
+            }
+        }
+    }
+
+private:
+    struct Node {
+        std::string label;  // 父节点到本节点的边上的字节
+        bool has_value = false;
+        T value = T();
+        std::vector<Node*> children;  // 按label首字节升序
+    };
+
+    static bool lessFirstByte(const Node* n, unsigned char c) {
+        return static_cast<unsigned char>(n->label[0]) < c;
+    }
+
+    // 查找首字节为c的孩子，不存在时idx为插入位置
+    static Node* findChild(Node* node, unsigned char c, size_t* idx) {
+        auto it = std::lower_bound(node->children.begin(), node->children.end(), c,
+                                   lessFirstByte);
+        *idx = it - node->children.begin();
+        if (it != node->children.end() && static_cast<unsigned char>((*it)->label[0]) == c) {
+            return *it;
+        }
+        return nullptr;
+    }
+
+    // 找到整条边都能匹配key[pos...]的孩子
+    static Node* matchChild(Node* node, const std::string& key, size_t pos) {
+        size_t idx = 0;
+        Node* child = findChild(node, static_cast<unsigned char>(key[pos]), &idx);
+        if (child == nullptr || key.compare(pos, child->label.size(), child->label) != 0) {
+            return nullptr;
+        }
+        return child;
+    }
+
+    static size_t commonPrefix(const std::string& label, const std::string& key, size_t pos) {
+        size_t n = std::min(label.size(), key.size() - pos);
+        size_t i = 0;
+        while (i < n && label[i] == key[pos + i]) {
+            ++i;
+        }
+        return i;
+    }
+
+    static void removeChild(Node* parent, Node* child) {
+        auto it = std::find(parent->children.begin(), parent->children.end(), child);
+        assert(it != parent->children.end());
+        parent->children.erase(it);
+    }
+
+    // node没有值且只有一个孩子，把孩子合并进来
+    static void mergeChild(Node* node) {
+        assert(!node->has_value && node->children.size() == 1);
+        Node* child = node->children[0];
+        node->label.append(child->label);
+        node->has_value = child->has_value;
+        node->value = std::move(child->value);
+        node->children.swap(child->children);
+        child->children.clear();
+        delete child;
+    }
+
+    static void destroy(Node* node) {
+        std::vector<Node*> stack;
+        stack.push_back(node);
+        while (!stack.empty()) {
+            Node* n = stack.back();
+            stack.pop_back();
+            for (auto child : n->children) {
+                stack.push_back(child);
+            }
+            delete n;
+        }
+    }
+
+private:
+    Node* root_ = nullptr;
+    size_t size_ = 0;
+};
+
+}  // namespace watch
+}  // namespace dataserver
+}  // namespace sharkstore
@@ -41,116 +41,108 @@ CEventBuffer::CEventBuffer(const int &mapSize, const int &queueSize) {
 }
 
 CEventBuffer::~CEventBuffer() {
-    for(auto it : mapGroupBuffer) {
-        delete it.second;
-    }
     loop_flag_ = false;
 //    clear_thread_.join();
 }
 
-BufferReturnPair  CEventBuffer::loadFromBuffer(const std::string &grpKey,  int64_t userVersion,
-                                 std::vector<CEventBufferValue> &result) {
-
-    std::lock_guard<std::mutex> lock(buffer_mutex_);
-
-    int32_t resultCnt{0};
-    BufferReturnPair retPair = std::make_pair(-1, std::make_pair(0,0));
-
-    if(isEmpty() || userVersion == 0) {
-        return retPair;
+GroupValuePtr CEventBuffer::findGroup(const std::string &grpKey) {
+    sharkstore::shared_lock<shared_mutex> lock(buffer_mutex_);
+    auto it = mapGroupBuffer.find(GroupKey(grpKey, 0));
+    if (it != mapGroupBuffer.end()) {
+        return it->second;
     }
+    return nullptr;
+}
 
-    int32_t from(0), to(0);
-
-    auto it = mapGroupBuffer.find(grpKey);
-    if(it != mapGroupBuffer.end()) {
-        //to do 遍历获取版本范围内变更
-        resultCnt = it->second->getData(userVersion, result);
+GroupValuePtr CEventBuffer::createGroup(const std::string &grpKey) {
+    std::unique_lock<shared_mutex> lock(buffer_mutex_);
+    GroupKey key(grpKey);
 
-        from = it->second->lowerVersion();
-        to = it->second->upperVersion();
+    auto it = mapGroupBuffer.find(key);
+    if (it != mapGroupBuffer.end()) {
+        return it->second;
     }
 
-    retPair = std::make_pair(resultCnt, std::make_pair(from, to));
-    return retPair;
-}
-
-bool CEventBuffer::enQueue(const std::string &grpKey, const CEventBufferValue *bufferValue) {
+    //to do escasp from map
+    if(isFull()) {
+        GroupKey k(listGroupBuffer.begin()->key_, listGroupBuffer.begin()->create_time_);
+        listGroupBuffer.pop_front();
 
-    std::lock_guard<std::mutex> lock(buffer_mutex_);
-    bool ret{false};
-    int64_t queueLength(0);
-    GroupKey key(grpKey);
+        FLOG_INFO("buffer_map auto pop key:%s", EncodeToHexString(k.key_).c_str());
 
-    auto it = mapGroupBuffer.find(key);
-    if(it == mapGroupBuffer.end()) {
-
-        //to do escasp from map
-        if(isFull()) {
-            GroupKey k(listGroupBuffer.begin()->key_, listGroupBuffer.begin()->create_time_);
-            listGroupBuffer.pop_front();
-
-            FLOG_INFO("buffer_map auto pop key:%s", EncodeToHexString(k.key_).c_str());
-
-            auto itMap = mapGroupBuffer.find(k);
-            if(itMap != mapGroupBuffer.end()) {
-                deQueue(itMap->second);
-                mapGroupBuffer.erase(itMap);
-                map_size_--;
-                FLOG_INFO("map pop success, key:%s  create(ms):%" PRId64 " map-length:%" PRId32, k.key_.c_str(), k.create_time_, map_size_);
-            } else {
-                FLOG_INFO("map pop error, key:%s  create(ms):%" PRId64 " map-length:%" PRId32, k.key_.c_str(), k.create_time_, map_size_);
-            }
+        auto itMap = mapGroupBuffer.find(k);
+        if(itMap != mapGroupBuffer.end()) {
+            // 正在读取的快照仍持有该分组
+            mapGroupBuffer.erase(itMap);
+            map_size_--;
+            FLOG_INFO("map pop success, key:%s  create(ms):%" PRId64 " map-length:%" PRId32, k.key_.c_str(), k.create_time_, map_size_);
+        } else {
+            FLOG_INFO("map pop error, key:%s  create(ms):%" PRId64 " map-length:%" PRId32, k.key_.c_str(), k.create_time_, map_size_);
         }
+    }
 
-        auto grpValue = new GroupValue(queue_capacity_);
+    auto grpValue = std::make_shared<GroupValue>(queue_capacity_);
+    auto result = mapGroupBuffer.emplace(std::make_pair(key, grpValue));
+    if(!result.second) {
+        FLOG_INFO("mapGroupBuffer emplace error, key:%s", EncodeToHexString(grpKey).c_str());
+        return nullptr;
+    }
+    listGroupBuffer.push_back(key);
+    map_size_++;
 
-        if(grpValue->enQueue(*bufferValue)) {
-            listGroupBuffer.push_back(key);
-            auto result = mapGroupBuffer.emplace(std::make_pair(key, grpValue));
-            if(result.second) {
-                ret = true;
-            } else {
-                FLOG_INFO("mapGroupBuffer emplace error, key:%s", EncodeToHexString(grpKey).c_str());
-                ret = false;
-            }
-            queueLength = grpValue->length();
+    return grpValue;
+}
 
-            if(ret)
-                map_size_++;
+BufferReturnPair  CEventBuffer::loadFromBuffer(const std::string &grpKey,  int64_t userVersion,
+                                 EventSnapshot &result) {
+    BufferReturnPair retPair = std::make_pair(-1, std::make_pair(0,0));
+    if(userVersion == 0) {
+        return retPair;
+    }
 
-        } else {
-            FLOG_WARN("map[%s]->queue is full[%" PRId32 "]", EncodeToHexString(grpKey).c_str(), queue_capacity_);
-            ret = false;
+    GroupValuePtr grpValue;
+    {
+        sharkstore::shared_lock<shared_mutex> lock(buffer_mutex_);
+        if(isEmpty()) {
+            return retPair;
         }
-    } else {
-        ret = it->second->enQueue(*bufferValue);
-        if(!ret) {
-            FLOG_WARN("map[%s]->queue is full..", EncodeToHexString(grpKey).c_str());
+        auto it = mapGroupBuffer.find(GroupKey(grpKey, 0));
+        if(it != mapGroupBuffer.end()) {
+            grpValue = it->second;
         }
-        queueLength = it->second->length();
     }
 
-    FLOG_DEBUG("capacity:%" PRId32 "-%" PRId32 " >>>emplace to queue, key:%s value:%s version:%"
-                                               PRId64 " map-length:%" PRId32 " queue-length:%" PRId64,
-               map_capacity_, queue_capacity_, EncodeToHexString(grpKey).c_str(), bufferValue->value().c_str(),
-               bufferValue->version(), map_size_, queueLength);
+    int32_t resultCnt{0};
+    int64_t from(0), to(0);
+    if(grpValue != nullptr) {
+        //不持有分组表的锁，从事件环取快照
+        resultCnt = grpValue->Snapshot(userVersion, &result, &from, &to);
+    }
 
-    return ret;
+    retPair = std::make_pair(resultCnt, std::make_pair(static_cast<int32_t>(from), static_cast<int32_t>(to)));
+    return retPair;
 }
 
-bool CEventBuffer::deQueue(GroupValue   *grpVal) {
-
-    //std::lock_guard<std::mutex> lock(buffer_mutex_);
-    if(grpVal != nullptr) {
-        grpVal->clearQueue();
-        delete grpVal;
+bool CEventBuffer::enQueue(const std::string &grpKey, EventValuePtr bufferValue) {
+    auto grpValue = findGroup(grpKey);
+    if(grpValue == nullptr) {
+        grpValue = createGroup(grpKey);
+        if(grpValue == nullptr) {
+            return false;
+        }
     }
 
+    auto version = bufferValue->version();
+    grpValue->Push(std::move(bufferValue));
+
+    FLOG_DEBUG("capacity:%" PRId32 "-%" PRId32 " >>>emplace to queue, key:%s version:%"
+                                               PRId64 " queue-length:%" PRIu32,
+               map_capacity_, queue_capacity_, EncodeToHexString(grpKey).c_str(),
+               version, grpValue->Length());
+
     return true;
 }
 
-
 }
 }
 }
\ No newline at end of file
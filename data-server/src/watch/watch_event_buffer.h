@@ -3,13 +3,16 @@
 //
 _Pragma("once");
 
-#include "circular_queue.h"
+#include "event_ring.h"
+#include "base/shared_mutex.h"
 #include "proto/gen/watchpb.pb.h"
 #include "frame/sf_logger.h"
 #include "common/ds_encoding.h"
 #include "frame/sf_util.h"
 
 #include <list>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <condition_variable>
@@ -117,10 +120,18 @@ using GroupKey = struct SGroupKey {
 };
 bool operator < (const struct SGroupKey &l, const struct SGroupKey &r);
 
-using GroupValue = CircularQueue<CEventBufferValue>;
-using MapGroupBuffer = std::map<GroupKey, GroupValue *>;
+// 缓存中的事件不可变，读者只持有引用，不复制key和value
+using EventValuePtr = std::shared_ptr<const CEventBufferValue>;
+using EventSnapshot = std::vector<EventValuePtr>;
+
+using GroupValue = EventRing<CEventBufferValue>;
+using GroupValuePtr = std::shared_ptr<GroupValue>;
+using MapGroupBuffer = std::map<GroupKey, GroupValuePtr>;
 using ListGroupBuffer = std::list<GroupKey>;
 
+// 按前缀分组的事件缓存
+// 每个分组一个单写多读的事件环，写入只来自range的apply线程；
+// 分组表用读写锁保护，只在新建、淘汰分组时加写锁，读取分组内事件不加分组表的锁(见EventRing)
 class CEventBuffer {
 public:
     CEventBuffer();
@@ -128,19 +139,20 @@ public:
     ~CEventBuffer();
 
     //<hit cnt:version scope in buffer<from:to> >
-    BufferReturnPair loadFromBuffer(const std::string &grpKey, int64_t uerVersion, std::vector<CEventBufferValue> &result);
-
-    bool enQueue(const std::string &grpKey, const CEventBufferValue *bufferValue);
+    BufferReturnPair loadFromBuffer(const std::string &grpKey, int64_t uerVersion, EventSnapshot &result);
 
-    bool deQueue(GroupValue   *grpVal);
+    bool enQueue(const std::string &grpKey, EventValuePtr bufferValue);
 
     void clear(const std::string &grpKey) {
+        std::unique_lock<shared_mutex> lock(buffer_mutex_);
         GroupKey gk(grpKey);
 
         auto it = mapGroupBuffer.find(gk);
         if (it != mapGroupBuffer.end()) {
-            it->second->clearQueue();
+            it->second->Clear();
             mapGroupBuffer.erase(it);
+            map_size_--;
+            listGroupBuffer.remove_if([&grpKey](const GroupKey &k) { return k.key_ == grpKey; });
         }
     }
 
@@ -152,8 +164,9 @@ public:
         return (mapGroupBuffer.size() == MAX_EVENT_BUFFER_MAP_SIZE);
     }
 
-
-
+private:
+    GroupValuePtr findGroup(const std::string &grpKey);
+    GroupValuePtr createGroup(const std::string &grpKey);
 
 private:
     MapGroupBuffer mapGroupBuffer;
@@ -163,7 +176,7 @@ private:
     int32_t queue_capacity_{DEFAULT_EVENT_QUEUE_SIZE};
     int32_t map_size_{0};
 
-    std::mutex buffer_mutex_;
+    shared_mutex buffer_mutex_;
     std::condition_variable buffer_cond_;
 
     static int32_t milli_timeout_;
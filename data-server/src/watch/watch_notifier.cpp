@@ -0,0 +1,134 @@
+#include "watch_notifier.h"
+
+#include <algorithm>
+
+#include "base/util.h"
+#include "frame/sf_logger.h"
+
+namespace sharkstore {
+namespace dataserver {
+namespace watch {
+
+static void updateMax(std::atomic<uint64_t>& target, uint64_t value) {
+    auto current = target.load();
+    while (value > current && !target.compare_exchange_weak(current, value)) {
+    }
+}
+
+WatchNotifier::WatchNotifier(int thread_num) {
+    for (int i = 0; i < thread_num; ++i) {
+        std::unique_ptr<Worker> w(new Worker);
+        auto ptr = w.get();
+        w->thr = std::thread([this, ptr] { run(ptr); });
+
+        char name[32] = {'\0'};
+        snprintf(name, 32, "watch_notify:%d", i);
+        AnnotateThread(w->thr.native_handle(), name);
+
+        workers_.push_back(std::move(w));
+    }
+    FLOG_INFO("watch notifier started, threads: %d", thread_num);
+}
+
+WatchNotifier::~WatchNotifier() {
+    running_ = false;
+    for (auto& w : workers_) {
+        {
+            std::lock_guard<std::mutex> lock(w->mu);
+        }
+        w->cond.notify_one();
+    }
+    for (auto& w : workers_) {
+        w->thr.join();
+    }
+}
+
+void WatchNotifier::Post(uint64_t hash, std::function<void()> task) {
+    auto& w = workers_[hash % workers_.size()];
+    ++queued_tasks_;
+    {
+        std::lock_guard<std::mutex> lock(w->mu);
+        w->tasks.push_back(std::move(task));
+    }
+    w->cond.notify_one();
+}
+
+void WatchNotifier::run(Worker* w) {
+    std::deque<std::function<void()>> tasks;
+    while (running_) {
+        {
+            std::unique_lock<std::mutex> lock(w->mu);
+            w->cond.wait(lock, [this, w] { return !w->tasks.empty() || !running_; });
+            tasks.swap(w->tasks);
+        }
+        for (auto& task : tasks) {
+            if (!running_) break;
+            --queued_tasks_;
+            task();
+        }
+        tasks.clear();
+    }
+}
+
+void WatchNotifier::OnPublish(size_t backlog) {
+    ++published_;
+    updateMax(max_backlog_, backlog);
+}
+
+void WatchNotifier::OnOverflow() { ++overflowed_; }
+
+void WatchNotifier::OnReload() { ++reloads_; }
+
+void WatchNotifier::OnNotify(int64_t delay_us) {
+    auto delay = static_cast<uint64_t>(std::max<int64_t>(delay_us, 0));
+    ++notified_;
+    total_delay_us_ += delay;
+    updateMax(max_delay_us_, delay);
+}
+
+void WatchNotifier::GetStats(NotifyStats* stats) const {
+    stats->published = published_;
+    stats->notified = notified_;
+    stats->overflowed = overflowed_;
+    stats->reloads = reloads_;
+    // 各计数分别读取，并发更新时可能短暂不一致
+    auto done = stats->notified + stats->overflowed;
+    stats->backlog = stats->published > done ? stats->published - done : 0;
+    stats->max_backlog = max_backlog_;
+    stats->avg_delay_us = stats->notified == 0 ? 0 : total_delay_us_ / stats->notified;
+    stats->max_delay_us = max_delay_us_;
+    stats->queued_tasks = queued_tasks_;
+}
+
+bool NotifyLog::Push(NotifyEvent&& event, bool* schedule) {
+    std::lock_guard<std::mutex> lock(mu_);
+    *schedule = !scheduled_;
+    scheduled_ = true;
+    if (events_.size() < capacity_) {
+        events_.push_back(std::move(event));
+        return true;
+    }
+    reload_version_ = std::max(reload_version_, std::max<int64_t>(event.version, 1));
+    return false;
+}
+
+bool NotifyLog::PopAll(std::deque<NotifyEvent>* events, int64_t* reload_version) {
+    std::lock_guard<std::mutex> lock(mu_);
+    *reload_version = reload_version_;
+    if (events_.empty() && reload_version_ == 0) {
+        scheduled_ = false;
+        return false;
+    }
+    events->swap(events_);
+    reload_version_ = 0;
+    return true;
+}
+
+size_t NotifyLog::Size() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return events_.size();
+}
+
+} // namespace watch
+}
+}
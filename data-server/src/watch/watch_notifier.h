@@ -0,0 +1,123 @@
+#ifndef _WATCH_NOTIFIER_H_
+#define _WATCH_NOTIFIER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "proto/gen/watchpb.pb.h"
+
+namespace sharkstore {
+namespace dataserver {
+namespace watch {
+
+// apply线程发布的待通知事件
+struct NotifyEvent {
+    watchpb::EventType type = watchpb::PUT;
+    watchpb::WatchKeyValue kv;
+    int64_t version = 0;
+    bool prefix = false;
+    int64_t publish_time = 0; // us
+};
+
+struct NotifyStats {
+    uint64_t published = 0;     // apply线程发布的事件数
+    uint64_t notified = 0;      // 通知线程处理完的事件数
+    uint64_t overflowed = 0;    // 事件日志已满时丢弃的事件数
+    uint64_t reloads = 0;       // 日志溢出后按db/缓存重新加载watcher的次数
+    uint64_t backlog = 0;       // 所有range事件日志中等待通知的事件数
+    uint64_t max_backlog = 0;   // 单个range事件日志出现过的最大积压
+    uint64_t avg_delay_us = 0;  // 从发布到开始通知的平均延迟
+    uint64_t max_delay_us = 0;
+    uint64_t queued_tasks = 0;  // 通知线程队列中的任务数
+};
+
+// watch通知线程池
+// raft apply线程只把事件发布到range的事件日志，匹配watcher、加载事件和发送都在通知线程中完成，
+// 大量watch不会拖慢apply
+class WatchNotifier {
+public:
+    explicit WatchNotifier(int thread_num);
+    ~WatchNotifier();
+
+    WatchNotifier(const WatchNotifier&) = delete;
+    WatchNotifier& operator=(const WatchNotifier&) = delete;
+
+    // 相同hash的任务在同一个线程中按提交顺序执行
+    void Post(uint64_t hash, std::function<void()> task);
+
+    void OnPublish(size_t backlog);
+    void OnOverflow();
+    void OnReload();
+    void OnNotify(int64_t delay_us);
+
+    void GetStats(NotifyStats* stats) const;
+    int ThreadNum() const { return static_cast<int>(workers_.size()); }
+
+private:
+    struct Worker {
+        std::thread thr;
+        std::mutex mu;
+        std::condition_variable cond;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void run(Worker* w);
+
+private:
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<bool> running_ = {true};
+
+    std::atomic<uint64_t> published_ = {0};
+    std::atomic<uint64_t> notified_ = {0};
+    std::atomic<uint64_t> overflowed_ = {0};
+    std::atomic<uint64_t> reloads_ = {0};
+    std::atomic<uint64_t> max_backlog_ = {0};
+    std::atomic<uint64_t> total_delay_us_ = {0};
+    std::atomic<uint64_t> max_delay_us_ = {0};
+    std::atomic<uint64_t> queued_tasks_ = {0};
+};
+
+// range内待通知事件的有界日志
+// apply线程Push，日志从空闲变为待处理时由调用方投递一次消费任务；
+// 同一时刻最多只有一个消费者，同一个key的事件按发布顺序通知
+// 日志满后不阻塞apply，也不再记录单个事件，只标记需要重新加载：
+// 通知线程处理完已有事件后按db和事件缓存的当前状态补发给range内的watcher
+class NotifyLog {
+public:
+    explicit NotifyLog(size_t capacity) : capacity_(capacity) {}
+    ~NotifyLog() = default;
+
+    NotifyLog(const NotifyLog&) = delete;
+    NotifyLog& operator=(const NotifyLog&) = delete;
+
+    // 日志已满时丢弃事件并标记重新加载，返回false
+    // *schedule为true时调用方需要投递消费任务
+    bool Push(NotifyEvent&& event, bool* schedule);
+
+    // 取出当前所有事件，没有事件时结束本轮调度并返回false
+    // 日志溢出过时*reload_version为丢弃事件的最大版本，否则为0
+    bool PopAll(std::deque<NotifyEvent>* events, int64_t* reload_version);
+
+    size_t Size() const;
+
+private:
+    const size_t capacity_ = 0;
+    mutable std::mutex mu_;
+    std::deque<NotifyEvent> events_;
+    // 丢弃事件的最大版本，0表示没有溢出
+    int64_t reload_version_ = 0;
+    bool scheduled_ = false;
+};
+
+} // namespace watch
+}
+}
+
+#endif
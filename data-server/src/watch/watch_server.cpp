@@ -9,84 +9,98 @@ namespace watch {
 
 
 
-WatchServer::WatchServer(uint64_t watcher_set_count): watcher_set_count_(watcher_set_count) {
+WatchServer::WatchServer(uint64_t watcher_set_count, int notify_threads,
+                         int coalesce_window_ms, bool coalesce_squash): watcher_set_count_(watcher_set_count) {
     watcher_set_count_ = watcher_set_count_ > WATCHER_SET_COUNT_MIN ? watcher_set_count_ : WATCHER_SET_COUNT_MIN;
     watcher_set_count_ = watcher_set_count_ < WATCHER_SET_COUNT_MAX ? watcher_set_count_ : WATCHER_SET_COUNT_MAX;
 
     for (uint64_t i = 0; i < watcher_set_count_; ++i) {
         watcher_set_list.push_back(new WatcherSet());
     }
+
+    if (coalesce_window_ms > 0) {
+        coalescer_.reset(new NotifyCoalescer(coalesce_window_ms, coalesce_squash));
+    }
+    if (notify_threads > 0) {
+        notifier_.reset(new WatchNotifier(notify_threads));
+    }
 }
 
 WatchServer::~WatchServer() {
+    // 先停止通知线程，之后不会再访问watcher set
+    notifier_.reset();
+    // watcher set的超时线程会通过coalescer发送应答，最后停止coalescer
     for (auto watcher_set: watcher_set_list) {
        delete(watcher_set);
     }
+    coalescer_.reset();
 }
 
 WatcherSet* WatchServer::GetWatcherSet_(const WatcherKey& key) {
-    std::size_t hash = std::hash<std::string>{}(key);
+    return GetWatcherSet_(key.data(), key.size());
+}
+
+WatcherSet* WatchServer::GetWatcherSet_(const char* key, size_t len) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= static_cast<uint8_t>(key[i]);
+        hash *= 1099511628211ULL;
+    }
     return watcher_set_list[hash % watcher_set_count_];
 }
 
-WatchCode WatchServer::AddKeyWatcher(WatcherPtr& w_ptr, storage::Store *store_) {
-    int64_t msgSessionId(w_ptr->GetWatcherId());
-    std::string encode_key;
-    w_ptr->EncodeKey(&encode_key, w_ptr->GetTableId(), w_ptr->GetKeys());
+void WatchServer::AssignWatcherId(WatcherPtr& w_ptr) {
+    // 流式watch追平版本后重新加入时保留原来的watchId
+    if (!w_ptr->WatcherIdAssigned()) {
+        auto ws = GetWatcherSet_(w_ptr->GetHashKeyData(), w_ptr->GetHashKeyLen());
+        w_ptr->SetWatcherId(ws->GenWatcherId());
+    }
+}
 
-    auto wset = GetWatcherSet_(encode_key);
-    w_ptr->SetWatcherId(wset->GenWatcherId());
+WatchCode WatchServer::AddKeyWatcher(WatcherPtr& w_ptr, storage::Store *store_) {
+    int64_t msgSessionId(w_ptr->GetSessionId());
+    auto wset = GetWatcherSet_(w_ptr->GetHashKeyData(), w_ptr->GetHashKeyLen());
+    AssignWatcherId(w_ptr);
 
     FLOG_DEBUG("watch server ready to add key watcher: session_id [%" PRIu64 "] watch_id[%" PRIu64 "] key:%s",
-               msgSessionId, w_ptr->GetWatcherId(), EncodeToHexString(encode_key).c_str());
+               msgSessionId, w_ptr->GetWatcherId(), EncodeToHexString(w_ptr->GetFullEncodeKey()).c_str());
     assert(w_ptr->GetType() == WATCH_KEY);
 
-    encode_key.clear();
-    w_ptr->EncodeKey(&encode_key, w_ptr->GetTableId(), w_ptr->GetKeys(false));
-    return wset->AddKeyWatcher(encode_key, w_ptr, store_);
+    return wset->AddKeyWatcher(w_ptr->GetFullEncodeKey(), w_ptr, store_);
 }
 
 WatchCode WatchServer::AddPrefixWatcher(WatcherPtr& w_ptr, storage::Store *store_) {
     FLOG_DEBUG("watch server add prefix watcher: session_id [%" PRIu64 "]", w_ptr->GetWatcherId());
     assert(w_ptr->GetType() == WATCH_PREFIX);
-    std::string encode_key;
-
-    w_ptr->EncodeKey(&encode_key, w_ptr->GetTableId(), w_ptr->GetKeys());
 
-    auto ws = GetWatcherSet_(encode_key);
-    w_ptr->SetWatcherId(ws->GenWatcherId());
+    auto ws = GetWatcherSet_(w_ptr->GetHashKeyData(), w_ptr->GetHashKeyLen());
+    AssignWatcherId(w_ptr);
 
-    encode_key.clear();
-    w_ptr->EncodeKey(&encode_key, w_ptr->GetTableId(), w_ptr->GetKeys(false));
-    return ws->AddPrefixWatcher(encode_key, w_ptr, store_);
+    return ws->AddPrefixWatcher(w_ptr->GetFullEncodeKey(), w_ptr, store_);
 }
 
 WatchCode WatchServer::DelKeyWatcher(WatcherPtr& w_ptr) {
     FLOG_DEBUG("watch server del key watcher: watch_id [%" PRIu64 "]", w_ptr->GetWatcherId());
     assert(w_ptr->GetType() == WATCH_KEY);
 
-    std::string encode_key;
-    w_ptr->EncodeKey(&encode_key, w_ptr->GetTableId(), w_ptr->GetKeys());
-
-    auto ws = GetWatcherSet_(encode_key);
-
-    encode_key.clear();
-    w_ptr->EncodeKey(&encode_key, w_ptr->GetTableId(), w_ptr->GetKeys(false));
-    return ws->DelKeyWatcher(encode_key, w_ptr->GetWatcherId());
+    auto ws = GetWatcherSet_(w_ptr->GetHashKeyData(), w_ptr->GetHashKeyLen());
+    return ws->DelKeyWatcher(w_ptr->GetFullEncodeKey(), w_ptr->GetWatcherId());
 }
 
 WatchCode WatchServer::DelPrefixWatcher(WatcherPtr& w_ptr) {
     FLOG_DEBUG("watch server del prefix watcher: watch_id [%" PRIu64 "]", w_ptr->GetWatcherId());
     assert(w_ptr->GetType() == WATCH_PREFIX);
-    std::string encode_key;
-
-    w_ptr->EncodeKey(&encode_key, w_ptr->GetTableId(), w_ptr->GetKeys());
 
-    auto ws = GetWatcherSet_(encode_key);
+    auto ws = GetWatcherSet_(w_ptr->GetHashKeyData(), w_ptr->GetHashKeyLen());
+    return ws->DelPrefixWatcher(w_ptr->GetFullEncodeKey(), w_ptr->GetWatcherId());
+}
 
-    encode_key.clear();
-    w_ptr->EncodeKey(&encode_key, w_ptr->GetTableId(), w_ptr->GetKeys(false));
-    return ws->DelPrefixWatcher(encode_key, w_ptr->GetWatcherId());
+WatcherPtr WatchServer::CancelWatcher(WatcherPtr& w_ptr, WatcherId watcher_id) {
+    FLOG_DEBUG("watch server cancel watcher: watch_id [%" PRIu64 "]", watcher_id);
+    auto ws = GetWatcherSet_(w_ptr->GetHashKeyData(), w_ptr->GetHashKeyLen());
+    return ws->TakeWatcher(w_ptr->GetFullEncodeKey(), watcher_id, w_ptr->GetSessionId(),
+                           w_ptr->GetType() == WATCH_PREFIX);
 }
 
 WatchCode WatchServer::GetKeyWatchers(const watchpb::EventType &evtType, std::vector<WatcherPtr>& w_ptr_vec, const WatcherKey &hash, const WatcherKey& key, const int64_t &version) {
@@ -96,11 +110,19 @@ WatchCode WatchServer::GetKeyWatchers(const watchpb::EventType &evtType, std::ve
     return ws->GetKeyWatchers(evtType, w_ptr_vec, key, version);
 }
 
-WatchCode WatchServer::GetPrefixWatchers(const watchpb::EventType &evtType, std::vector<WatcherPtr>& w_ptr_vec, const PrefixKey &hash, const PrefixKey& prefix, const int64_t &version) {
-    FLOG_DEBUG("watch server get prefix watchers: key [%s]", EncodeToHexString(prefix).c_str());
+WatchCode WatchServer::GetPrefixWatchers(const watchpb::EventType &evtType, std::vector<WatcherPtr>& w_ptr_vec, const PrefixKey &hash, const WatcherKey& key, const int64_t &version) {
+    FLOG_DEBUG("watch server get prefix watchers: key [%s]", EncodeToHexString(key).c_str());
     assert(w_ptr_vec.size() == 0);
     auto wset = GetWatcherSet_(hash);
-    return wset->GetPrefixWatchers(evtType, w_ptr_vec, prefix, version);
+    return wset->GetPrefixWatchers(evtType, w_ptr_vec, key, version);
+}
+
+void WatchServer::GetRangeWatchers(const WatcherKey& start, const WatcherKey& end,
+                                   std::vector<WatcherPtr>* keyWatchers, std::vector<WatcherPtr>* prefixWatchers) {
+    // watcher按hash key分散在各个watcher set中
+    for (auto ws : watcher_set_list) {
+        ws->GetRangeWatchers(start, end, keyWatchers, prefixWatchers);
+    }
 }
 
 
@@ -5,6 +5,8 @@
 #include <mutex>
 
 #include "watcher_set.h"
+#include "watch_notifier.h"
+#include "notify_coalescer.h"
 
 namespace sharkstore {
 namespace dataserver {
@@ -16,26 +18,46 @@ namespace watch {
 class WatchServer {
 public:
     WatchServer() = default;
-    explicit WatchServer(uint64_t watcher_set_count);
+    // notify_threads为0时在apply线程中同步通知
+    // coalesce_window_ms为0时不合并，每个通知单独发送
+    explicit WatchServer(uint64_t watcher_set_count, int notify_threads = 0,
+                         int coalesce_window_ms = 0, bool coalesce_squash = false);
     WatchServer(const WatchServer&) = delete;
     WatchServer& operator=(const WatchServer&) = delete;
     ~WatchServer();
 
+    // 在注册之前为watcher分配watchId，流式watch的第一帧需要带上它
+    void AssignWatcherId(WatcherPtr&);
     WatchCode AddKeyWatcher(WatcherPtr&, storage::Store *);
     WatchCode AddPrefixWatcher(WatcherPtr&, storage::Store *);
 
     WatchCode DelKeyWatcher(WatcherPtr&);
     WatchCode DelPrefixWatcher(WatcherPtr&);
+    // 按w_ptr的key和类型找到watcher_id对应的watcher并移除，用于取消流式watch
+    // 只能取消与w_ptr同一session的watcher
+    WatcherPtr CancelWatcher(WatcherPtr& w_ptr, WatcherId watcher_id);
 
     WatchCode GetKeyWatchers(const watchpb::EventType &evtType, std::vector<WatcherPtr>&, const WatcherKey&, const WatcherKey&, const int64_t &version);
-    WatchCode GetPrefixWatchers(const watchpb::EventType &evtType, std::vector<WatcherPtr>&, const PrefixKey &, const PrefixKey &, const int64_t &version);
+    // key为事件的完整编码key，返回所有前缀匹配的watcher
+    WatchCode GetPrefixWatchers(const watchpb::EventType &evtType, std::vector<WatcherPtr>&, const PrefixKey &, const WatcherKey &, const int64_t &version);
+    // 返回key在[start, end)中的所有watcher，不移除，用于range事件日志溢出后重新加载
+    void GetRangeWatchers(const WatcherKey& start, const WatcherKey& end,
+                          std::vector<WatcherPtr>* keyWatchers, std::vector<WatcherPtr>* prefixWatchers);
+
+    // 异步通知线程池，没有开启时返回nullptr
+    WatchNotifier* Notifier() { return notifier_.get(); }
+    // 通知合并发送，没有开启时返回nullptr
+    NotifyCoalescer* Coalescer() { return coalescer_.get(); }
 
 private:
     uint64_t                    watcher_set_count_ = WATCHER_SET_COUNT_MIN;
     std::vector<WatcherSet*>    watcher_set_list;
+    std::unique_ptr<NotifyCoalescer> coalescer_;
+    std::unique_ptr<WatchNotifier> notifier_;
 
 public:
     WatcherSet* GetWatcherSet_(const WatcherKey&);
+    WatcherSet* GetWatcherSet_(const char* key, size_t len);
 };
 
 
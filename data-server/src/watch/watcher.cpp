@@ -1,4 +1,5 @@
 #include "watcher.h"
+#include "notify_coalescer.h"
 #include "common/socket_session_impl.h"
 #include "common/ds_encoding.h"
 
@@ -10,39 +11,63 @@ namespace watch {
 
 ////////////////////////////////////// watcher //////////////////////////////////////
 
-Watcher::Watcher(uint64_t table_id, const std::vector<WatcherKey*>& keys, const uint64_t &version, const int64_t &expire_time, common::ProtoMessage* msg):
-        table_id_(table_id), key_version_(version), message_(msg), watcher_id_(msg->session_id), session_id_(msg->session_id), msg_id_(msg->header.msg_id), expire_time_(expire_time) {
-    for (auto k: keys) {
-        keys_.push_back(new WatcherKey(*k));
+namespace {
+
+inline const std::string& keyRef(const std::string& key) { return key; }
+inline const std::string& keyRef(const std::string* key) { return *key; }
+
+// 表前缀之后依次编码每个分量，first_len返回编码完第一个分量时的长度
+template <class Keys>
+void encodeKeys(std::string* buf, uint64_t tableId, const Keys& keys, size_t count, size_t* first_len) {
+    buf->push_back(static_cast<char>(1));
+    EncodeUint64Ascending(buf, tableId); // column 1
+    if (first_len != nullptr) *first_len = buf->length();
+
+    size_t i = 0;
+    for (const auto& k : keys) {
+        if (i++ >= count) break;
+        const auto& key = keyRef(k);
+        EncodeBytesAscending(buf, key.c_str(), key.length());
+        if (i == 1 && first_len != nullptr) *first_len = buf->length();
     }
-    if(keys.size() > 0) {
-        keys_hash_.push_back(keys_[0]);
+}
+
+} // namespace
+
+template <class Keys>
+void Watcher::initKey(const Keys& keys) {
+    size_t hash_len = 0;
+    encodeKeys(&encode_key_, table_id_, keys, keys.size(), &hash_len);
+    encode_key_.shrink_to_fit();
+    hash_key_len_ = static_cast<uint32_t>(hash_len);
+    key_count_ = static_cast<uint32_t>(keys.size());
+
+    // 请求已经解析，watch期间应答只需要消息头，不再保留请求内容
+    if (message_ != nullptr) {
+        message_->ReleaseBody();
     }
 }
 
+Watcher::Watcher(uint64_t table_id, const std::vector<WatcherKey*>& keys, const uint64_t &version, const int64_t &expire_time, common::ProtoMessage* msg):
+        table_id_(table_id), key_version_(version), message_(msg), watcher_id_(msg->session_id), session_id_(msg->session_id), msg_id_(msg->header.msg_id), expire_time_(expire_time) {
+    initKey(keys);
+}
+
 Watcher::Watcher(WatchType type, uint64_t table_id, const std::vector<WatcherKey*>& keys, const uint64_t &version, const int64_t &expire_time, common::ProtoMessage* msg):
         table_id_(table_id), key_version_(version), message_(msg), type_(type), watcher_id_(msg->session_id),  session_id_(msg->session_id), msg_id_(msg->header.msg_id), expire_time_(expire_time) {
-    for (auto k: keys) {
-        keys_.push_back(new WatcherKey(*k));
-    }
-    if(keys.size() > 0) {
-        keys_hash_.push_back(keys_[0]);
-    }
+    initKey(keys);
+}
+
+Watcher::Watcher(WatchType type, uint64_t table_id, const google::protobuf::RepeatedPtrField<std::string>& keys, const uint64_t &version, const int64_t &expire_time, common::ProtoMessage* msg):
+        table_id_(table_id), key_version_(version), message_(msg), type_(type), watcher_id_(msg->session_id),  session_id_(msg->session_id), msg_id_(msg->header.msg_id), expire_time_(expire_time) {
+    initKey(keys);
 }
 
 Watcher::Watcher(uint64_t table_id, const std::vector<WatcherKey*>& keys):table_id_(table_id) {
-    for (auto k: keys) {
-        keys_.push_back(new WatcherKey(*k));
-    }
-    if(keys.size() > 0) {
-        keys_hash_.push_back(keys_[0]);
-    }
+    initKey(keys);
 }
 
 Watcher::~Watcher() {
-    for (auto k: keys_) {
-        delete k;
-    }
 }
 
 bool Watcher::operator>(const Watcher* other) const {
@@ -50,7 +75,74 @@ bool Watcher::operator>(const Watcher* other) const {
     return this->expire_time_ > other->expire_time_;
 }
 
+bool Watcher::AdvanceVersion(int64_t version) {
+    auto current = key_version_.load();
+    while (version > current) {
+        if (key_version_.compare_exchange_weak(current, version)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+common::ProtoMessage* Watcher::streamMessage() const {
+    // 只需要应答头部信息，不复制请求内容
+    auto msg = new common::ProtoMessage;
+    msg->session_id = message_->session_id;
+    msg->begin_time = message_->begin_time;
+    msg->expire_time = message_->expire_time;
+    msg->msg_id = message_->msg_id;
+    msg->header = message_->header;
+    msg->socket = message_->socket;
+    return msg;
+}
+
+void Watcher::sendResponse(common::ProtoMessage* msg, google::protobuf::Message* resp, bool stream) {
+    // 直接发送会越过coalescer中还没发出的通知，client可能先收到结束帧
+    if (coalescer_ != nullptr) {
+        std::string body;
+        resp->SerializeToString(&body);
+        delete resp;
+        coalescer_->Add(msg, body, std::string(), stream);
+        return;
+    }
+
+    common::SocketSessionImpl session;
+    if (stream) {
+        session.SendStream(msg, resp);
+    } else {
+        session.Send(msg, resp);
+    }
+}
+
 void Watcher::Send(google::protobuf::Message* resp) {
+    if (!stream_) {
+        Close(resp);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(send_lock_);
+    if (sent_response_flag) {
+        delete resp;
+        return;
+    }
+
+    sendResponse(streamMessage(), resp, true);
+    stream_started_ = true;
+}
+
+void Watcher::Ack(google::protobuf::Message* resp) {
+    std::lock_guard<std::mutex> lock(send_lock_);
+    if (sent_response_flag || stream_started_) {
+        delete resp;
+        return;
+    }
+
+    sendResponse(streamMessage(), resp, true);
+    stream_started_ = true;
+}
+
+void Watcher::Close(google::protobuf::Message* resp) {
     std::lock_guard<std::mutex> lock(send_lock_);
     if (sent_response_flag) {
         delete resp;
@@ -64,13 +156,61 @@ void Watcher::Send(google::protobuf::Message* resp) {
                message_->session_id, message_->header.msg_id, take_time);
 
 
-    common::SocketSessionImpl session;
-    session.Send(message_, resp);
+    sendResponse(message_, resp, false);
+
+    message_ = nullptr;
+    sent_response_flag = true;
+}
+
+void Watcher::Send(const NotifyBody& body, NotifyCoalescer* coalescer) {
+    std::lock_guard<std::mutex> lock(send_lock_);
+    if (sent_response_flag) {
+        return;
+    }
+
+    uint32_t take_time = get_micro_second() - message_->begin_time;
+
+    FLOG_DEBUG("before send notify, session_id: %" PRId64 ",task msgid: %" PRId64
+               " execute take time: %d us",
+               message_->session_id, message_->header.msg_id, take_time);
+
+    std::string tail;
+    EncodeNotifyTail(&tail, watcher_id_);
+
+    if (stream_) {
+        if (coalescer != nullptr) {
+            coalescer->Add(streamMessage(), *body, tail, true);
+        } else {
+            common::SocketSessionImpl session;
+            session.SendStream(streamMessage(), *body, tail);
+        }
+        stream_started_ = true;
+        return;
+    }
+
+    if (coalescer != nullptr) {
+        coalescer->Add(message_, *body, tail);
+    } else {
+        common::SocketSessionImpl session;
+        session.Send(message_, *body, tail);
+    }
 
     message_ = nullptr;
     sent_response_flag = true;
 }
 
+NotifyBody Watcher::SerializeNotify(const watchpb::DsWatchResponse& resp) {
+    auto body = std::make_shared<std::string>();
+    resp.SerializeToString(body.get());
+    return body;
+}
+
+void Watcher::EncodeNotifyTail(std::string* buf, WatcherId id) {
+    watchpb::DsWatchResponse patch;
+    patch.mutable_resp()->set_watchid(id);
+    patch.AppendToString(buf);
+}
+
 bool Watcher::DecodeKey(std::vector<std::string*>& keys,
                        const std::string& buf) {
     assert(keys.size() == 0 && buf.length() > 9);
@@ -113,6 +253,20 @@ void Watcher::EncodeKey(std::string* buf,
     }
 }
 
+void Watcher::EncodeKey(std::string* buf, uint64_t tableId,
+                        const google::protobuf::RepeatedPtrField<std::string>& keys, int count) {
+    assert(buf != nullptr && keys.size() != 0);
+    buf->clear();
+    encodeKeys(buf, tableId, keys, count < 0 ? keys.size() : count, nullptr);
+}
+
+void Watcher::EncodeKey(std::string* buf, uint64_t tableId,
+                        const std::vector<std::string>& keys, int count) {
+    assert(buf != nullptr && keys.size() != 0);
+    buf->clear();
+    encodeKeys(buf, tableId, keys, count < 0 ? keys.size() : count, nullptr);
+}
+
 void Watcher::EncodeValue(std::string* buf,
                          int64_t version,
                          const std::string* value,
@@ -5,6 +5,8 @@
 #include <unordered_map>
 #include <atomic>
 
+#include <google/protobuf/repeated_field.h>
+
 #include "watch.h"
 #include "common/socket_session.h"
 #include "storage/store.h"
@@ -13,11 +15,17 @@ namespace sharkstore {
 namespace dataserver {
 namespace watch {
 
+// 序列化好的通知内容，多个watcher共享
+typedef std::shared_ptr<const std::string> NotifyBody;
+
+class NotifyCoalescer;
+
 class Watcher {
 public:
     Watcher() = delete;
     Watcher(uint64_t, const std::vector<WatcherKey*>&, const uint64_t &, const int64_t &, common::ProtoMessage*);
     Watcher(WatchType, uint64_t, const std::vector<WatcherKey*>&, const uint64_t &, const int64_t &, common::ProtoMessage*);
+    Watcher(WatchType, uint64_t, const google::protobuf::RepeatedPtrField<std::string>&, const uint64_t &, const int64_t &, common::ProtoMessage*);
     Watcher(uint64_t, const std::vector<WatcherKey*>&);
     virtual ~Watcher();
     bool operator>(const Watcher* other) const;
@@ -30,9 +38,11 @@ public:
 
 private:
     uint64_t                    table_id_ = 0;
-    std::vector<std::string*>   keys_;
-    std::vector<std::string*>   keys_hash_;
-    int64_t                    key_version_ = 0;
+    // 编码后的完整key，前hash_key_len_字节为只编码第一个分量的hash key
+    std::string                 encode_key_;
+    uint32_t                    hash_key_len_ = 0;
+    uint32_t                    key_count_ = 0;
+    std::atomic<int64_t>        key_version_ = {0};
     common::ProtoMessage*       message_ = nullptr;
     WatchType                   type_ = WATCH_KEY;
     WatcherId                   watcher_id_ = 0;
@@ -43,19 +53,36 @@ private:
     // 0 key has no changing, need to add watcher
     // -1 key version is lower than buffer or buffer is empty, need to get all from db
     int64_t                     buffer_flag_ = 0;
+    // 流式watch：发送后继续保留在watcher set中，直到取消或超时
+    bool                        stream_ = false;
+    bool                        id_assigned_ = false;
+    // 流式watch是否已经推送过帧
+    bool                        stream_started_ = false;
+    // 不为空时所有应答都交给它，与同一session的通知按顺序合并发送
+    NotifyCoalescer*            coalescer_ = nullptr;
 
     std::mutex          send_lock_;
     volatile bool       sent_response_flag = false;
 
+private:
+    template <class Keys>
+    void initKey(const Keys& keys);
+
 public:
-    uint64_t GetTableId() { return table_id_; }
-    const std::vector<std::string*>& GetKeys(bool hashFlag = true) {
-        if(hashFlag) return keys_hash_;
-        return keys_;
+    uint64_t GetTableId() const { return table_id_; }
+    // hashFlag为true时只包含第一个分量，用于选择watcher set和事件缓存分组
+    WatcherKey GetEncodeKey(bool hashFlag = true) const {
+        if (hashFlag) return encode_key_.substr(0, hash_key_len_);
+        return encode_key_;
     }
+    const WatcherKey& GetFullEncodeKey() const { return encode_key_; }
+    const char* GetHashKeyData() const { return encode_key_.data(); }
+    size_t GetHashKeyLen() const { return hash_key_len_; }
+    uint32_t GetKeyCount() const { return key_count_; }
     common::ProtoMessage* GetMessage() { return message_; }
     int GetType() { return type_; }
-    void SetWatcherId(WatcherId id) { watcher_id_ = id; }
+    void SetWatcherId(WatcherId id) { watcher_id_ = id; id_assigned_ = true; }
+    bool WatcherIdAssigned() const { return id_assigned_; }
     WatcherId GetWatcherId() { return watcher_id_; }
     int64_t GetExpireTime() { return expire_time_; }
     bool IsSentResponse() {
@@ -65,6 +92,12 @@ public:
     int64_t getKeyVersion() const {
         return key_version_;
     }
+    // 推进流式watch已推送的版本，只有version更大时返回true
+    bool AdvanceVersion(int64_t version);
+
+    void SetStream(bool stream) { stream_ = stream; }
+    void SetCoalescer(NotifyCoalescer* coalescer) { coalescer_ = coalescer; }
+    bool IsStream() const { return stream_; }
     int64_t GetSessionId() const{
         return session_id_;
     }
@@ -73,7 +106,20 @@ public:
         return msg_id_;
     }
 public:
+    // 非流式watch发送后结束；流式watch作为一帧推送，watch继续有效
     virtual void Send(google::protobuf::Message* resp);
+    // 发送最后一个应答并结束watch（超时、取消）
+    virtual void Close(google::protobuf::Message* resp);
+    // 流式watch还没有推送过帧时发送确认帧，让client拿到watchId；否则丢弃resp
+    virtual void Ack(google::protobuf::Message* resp);
+    // 发送共享的通知内容，只追加本watcher的watchId
+    // coalescer不为空时交给它与同一session的其他通知合并发送
+    virtual void Send(const NotifyBody& body, NotifyCoalescer* coalescer = nullptr);
+
+    // 通知只序列化一次，watchId不要设置，由各watcher发送时追加
+    static NotifyBody SerializeNotify(const watchpb::DsWatchResponse& resp);
+    // 追加在共享内容之后，protobuf解析时会合并到同一个resp
+    static void EncodeNotifyTail(std::string* buf, WatcherId id);
 
     static bool DecodeKey(std::vector<std::string*>& keys,
                    const std::string& buf);
@@ -81,11 +127,23 @@ public:
                      std::string& buf);
     static void EncodeKey(std::string* buf,
                    uint64_t tableId, const std::vector<std::string*>& keys);
+    // 直接从请求或事件中的key编码，不需要复制成临时的std::string*数组
+    // 先清空buf，调用方可以重复使用同一个buf；count<0时编码全部分量，否则只编码前count个
+    static void EncodeKey(std::string* buf, uint64_t tableId,
+                   const google::protobuf::RepeatedPtrField<std::string>& keys, int count = -1);
+    static void EncodeKey(std::string* buf, uint64_t tableId,
+                   const std::vector<std::string>& keys, int count = -1);
     static void EncodeValue(std::string* buf,
                      int64_t version,
                      const std::string* value,
                      const std::string* extend);
 
+private:
+    // 流式推送使用的应答消息，message_保留到watch结束
+    common::ProtoMessage* streamMessage() const;
+    // 接管msg和resp，stream为true时是流式watch的后续帧
+    void sendResponse(common::ProtoMessage* msg, google::protobuf::Message* resp, bool stream);
+
 };
 
 template <class T>
@@ -69,11 +69,10 @@ WatcherSet::WatcherSet() {
 //                err->set_message("watch request timeout");
 //                resp->mutable_header()->set_allocated_error(err);
 
-                w_ptr->Send(resp);
+                w_ptr->Close(resp);
 
                 // delete in map
-                WatcherKey encode_key;
-                w_ptr->EncodeKey(&encode_key, w_ptr->GetTableId(), w_ptr->GetKeys());
+                const auto& encode_key = w_ptr->GetFullEncodeKey();
                 if (w_ptr->GetType() == WATCH_KEY) {
                     DelKeyWatcher(encode_key, w_ptr->GetWatcherId());
                 } else {
@@ -128,12 +127,48 @@ WatcherSet::~WatcherSet() {
     for(auto it : key_watcher_map_) {
         if(it.second != nullptr) delete it.second;
     }
+    prefix_watcher_tree_.ForEach([](WatcherValue* v) { delete v; });
     // todo leave members' memory alone now, todo free
 }
 
 
+WatcherValue* WatcherSet::findWatcherValue(const WatcherKey& key, bool prefixFlag) {
+    if (prefixFlag) {
+        auto v = prefix_watcher_tree_.Find(key);
+        return v == nullptr ? nullptr : *v;
+    }
+    auto it = key_watcher_map_.find(key);
+    return it == key_watcher_map_.end() ? nullptr : it->second;
+}
+
+WatcherValue* WatcherSet::addWatcherValue(const WatcherKey& key, bool prefixFlag) {
+    auto v = new WatcherValue;
+    if (prefixFlag) {
+        prefix_watcher_tree_.Insert(key, v);
+    } else {
+        key_watcher_map_.emplace(key, v);
+    }
+    return v;
+}
+
+void WatcherSet::eraseWatcherValue(const WatcherKey& key, bool prefixFlag) {
+    WatcherValue* v = nullptr;
+    if (prefixFlag) {
+        auto it = prefix_watcher_tree_.Find(key);
+        if (it == nullptr) return;
+        v = *it;
+        prefix_watcher_tree_.Erase(key);
+    } else {
+        auto it = key_watcher_map_.find(key);
+        if (it == key_watcher_map_.end()) return;
+        v = it->second;
+        key_watcher_map_.erase(it);
+    }
+    delete v;
+}
+
 // private add/del watcher
-WatchCode WatcherSet::AddWatcher(const WatcherKey& key, WatcherPtr& w_ptr, WatcherMap& key_watchers, KeyMap& key_map, storage::Store *store_, bool prefixFlag ) {
+WatchCode WatcherSet::AddWatcher(const WatcherKey& key, WatcherPtr& w_ptr, storage::Store *store_, bool prefixFlag ) {
     int64_t beginTime(getticks());
 
     std::unique_lock<std::mutex> lock_queue(watcher_queue_mutex_);
@@ -144,8 +179,8 @@ WatchCode WatcherSet::AddWatcher(const WatcherKey& key, WatcherPtr& w_ptr, Watch
     auto clientVersion = w_ptr->getKeyVersion();
 
     // add to watcher map
-    auto watcher_map_it = key_watchers.find(key);
-    if (watcher_map_it == key_watchers.end()) {
+    auto watcher_val = findWatcherValue(key, prefixFlag);
+    if (watcher_val == nullptr) {
 
         std::string val;
         std::string userKey;
@@ -169,6 +204,7 @@ WatchCode WatcherSet::AddWatcher(const WatcherKey& key, WatcherPtr& w_ptr, Watch
                     }
 
                     auto ds_resp = new watchpb::DsWatchResponse;
+                    ds_resp->mutable_resp()->set_watchid(w_ptr->GetWatcherId());
                     auto tmpVer(clientVersion);
 
                     result = loadFromDb(store_, watchpb::PUT, key, endKey, tmpVer, w_ptr->GetTableId(),
@@ -176,8 +212,18 @@ WatchCode WatcherSet::AddWatcher(const WatcherKey& key, WatcherPtr& w_ptr, Watch
                     FLOG_DEBUG("prefix mode: version:%" PRId64 " loadFromDb count:%" PRId64, tmpVer, result.first);
 
                     if (result.first > 0) {
+                        if (!w_ptr->IsStream()) {
+                            w_ptr->Send(ds_resp);
+                            return WATCH_OK;
+                        }
+                        // 流式watch推送全量后从最大版本开始继续watch
+                        for (const auto& evt : ds_resp->resp().events()) {
+                            w_ptr->AdvanceVersion(evt.kv().version());
+                        }
                         w_ptr->Send(ds_resp);
-                        return WATCH_OK;
+                        ds_resp = nullptr;
+                        clientVersion = w_ptr->getKeyVersion();
+                        result.second = true;
                     }
 
                     if(result.second) {
@@ -230,7 +276,11 @@ WatchCode WatcherSet::AddWatcher(const WatcherKey& key, WatcherPtr& w_ptr, Watch
                     }
 
                     w_ptr->Send(ds_resp);
-                    return WATCH_OK;
+                    if (!w_ptr->IsStream()) {
+                        return WATCH_OK;
+                    }
+                    w_ptr->AdvanceVersion(version);
+                    clientVersion = version;
                 }
             }
 
@@ -238,7 +288,8 @@ WatchCode WatcherSet::AddWatcher(const WatcherKey& key, WatcherPtr& w_ptr, Watch
                        prefixFlag?"prefix":"single", ret.ToString().c_str(), clientVersion, version, EncodeToHexString(key).c_str());
 
             //用户版本大于０　则返回kNotFound　client下次请求时，调整用户version为０
-            if(ret.code() == Status::kNotFound && clientVersion > 0) {
+            //流式watch继续等待key被创建
+            if(ret.code() == Status::kNotFound && clientVersion > 0 && !w_ptr->IsStream()) {
                 auto ds_resp = new watchpb::DsWatchResponse;
                 ds_resp->mutable_resp()->set_code(Status::kNotFound);
                 ds_resp->mutable_resp()->set_watchid(w_ptr->GetWatcherId());
@@ -249,11 +300,10 @@ WatchCode WatcherSet::AddWatcher(const WatcherKey& key, WatcherPtr& w_ptr, Watch
 
         }
 
-        auto v = new WatcherValue;
-        v->key_version_ = version;
-        watcher_map_it = key_watchers.insert(std::make_pair(key, v)).first;
+        watcher_val = addWatcherValue(key, prefixFlag);
+        watcher_val->key_version_ = version;
     }
-    auto& watcher_map = watcher_map_it->second->mapKeyWatcher;
+    auto& watcher_map = watcher_val->mapKeyWatcher;
 
     FLOG_INFO("AddWatcher(%s) prompt version: watcher_id:[%"
                       PRIu64
@@ -263,16 +313,16 @@ WatchCode WatcherSet::AddWatcher(const WatcherKey& key, WatcherPtr& w_ptr, Watch
                       PRIu64
                       "]   watcher_count:%" PRId64,
               prefixFlag?"prefix":"single", w_ptr->GetWatcherId(), EncodeToHexString(key).c_str(), clientVersion,
-              watcher_map_it->second->key_version_, watcher_map.size());
+              watcher_val->key_version_, watcher_map.size());
 
     //用户版本为０　内存版本有效,返回数据给client; 内存版本无效，增加watcher
     //用户版本非０　但小于内存版本,返回数据给client; 等于内存版本，增加watcher
     if(clientVersion == 0) {
-        if(watcher_map_it->second->key_version_ > 0) {
+        if(watcher_val->key_version_ > 0) {
             return WATCH_WATCHER_NOT_NEED;
         }
     } else {
-        if(clientVersion < watcher_map_it->second->key_version_) {
+        if(clientVersion < watcher_val->key_version_) {
             return WATCH_WATCHER_NOT_NEED;
         }
     }
@@ -290,7 +340,7 @@ WatchCode WatcherSet::AddWatcher(const WatcherKey& key, WatcherPtr& w_ptr, Watch
         code = WATCH_OK;
 
         FLOG_INFO("AddWatcher success, count:%" PRIu64 " queue_size:%" PRId64 " watcher_id[%" PRIu64 "] key: [%s]  take time:%" PRId64 " ms",
-                  watcher_map_it->second->mapKeyWatcher.size(), watcher_queue_.size(), w_ptr->GetWatcherId(), EncodeToHexString(key).c_str(), endTime - beginTime);
+                  watcher_map.size(), watcher_queue_.size(), w_ptr->GetWatcherId(), EncodeToHexString(key).c_str(), endTime - beginTime);
     } else {
         code = WATCH_WATCHER_EXIST;
 
@@ -300,7 +350,7 @@ WatchCode WatcherSet::AddWatcher(const WatcherKey& key, WatcherPtr& w_ptr, Watch
     return code;
 }
 
-WatchCode WatcherSet::DelWatcher(const WatcherKey& key, WatcherId watcher_id, WatcherMap& watcher_map_, KeyMap& key_map_) {
+WatchCode WatcherSet::DelWatcher(const WatcherKey& key, WatcherId watcher_id, bool prefixFlag) {
     int64_t beginTime(getticks());
     std::lock_guard<std::mutex> lock(watcher_map_mutex_);
 
@@ -339,14 +389,14 @@ WatchCode WatcherSet::DelWatcher(const WatcherKey& key, WatcherId watcher_id, Wa
     */
 
     // del from watcher map
-    auto watcher_map_it = watcher_map_.find(key);
-    if (watcher_map_it == watcher_map_.end()) {
+    auto watcher_val = findWatcherValue(key, prefixFlag);
+    if (watcher_val == nullptr) {
         FLOG_WARN("watcher del failed, key is not existed in watcher map: watch_id:[%" PRIu64 "] key: [%s]",
                   watcher_id, EncodeToHexString(key).c_str());
 
     } else {
         //mapKeyWatcher maybe already swaped when getWatcher method called, except timeout occasion
-        auto &watchers = watcher_map_it->second->mapKeyWatcher;
+        auto &watchers = watcher_val->mapKeyWatcher;
         if(watchers.size() > 0) {
             auto watcher_it = watchers.find(watcher_id);
             if (watcher_it == watchers.end()) {
@@ -366,9 +416,8 @@ WatchCode WatcherSet::DelWatcher(const WatcherKey& key, WatcherId watcher_id, Wa
             }
         }
 
-        if (watcher_map_it->second->mapKeyWatcher.empty()) {
-            delete watcher_map_it->second;
-            watcher_map_.erase(watcher_map_it);
+        if (watchers.empty()) {
+            eraseWatcherValue(key, prefixFlag);
         }
     }
 
@@ -379,31 +428,39 @@ WatchCode WatcherSet::DelWatcher(const WatcherKey& key, WatcherId watcher_id, Wa
     return WATCH_OK;
 }
 
-WatchCode WatcherSet::GetWatchers(const watchpb::EventType &evtType, std::vector<WatcherPtr>& vec, const WatcherKey& key, WatcherMap& watcherMap, WatcherValue *watcherValue, bool prefixFlag) {
+WatchCode WatcherSet::GetWatchers(const watchpb::EventType &evtType, std::vector<WatcherPtr>& vec, const WatcherKey& key, WatcherValue *watcherValue) {
     std::lock_guard<std::mutex> lock(watcher_map_mutex_);
 
-    auto itWatcherVal = watcherMap.find(key);
-    if (itWatcherVal == watcherMap.end()) {
+    auto itWatcherVal = key_watcher_map_.find(key);
+    if (itWatcherVal == key_watcher_map_.end()) {
         FLOG_DEBUG("GetWatcher end,key[%s] has no watcher.", EncodeToHexString(key).c_str());
         return WATCH_KEY_NOT_EXIST;
     }
 
     //watcherId:watchPtr
     auto watchers = itWatcherVal->second;
-    if(watchers->key_version_ < watcherValue->key_version_ && !prefixFlag) {
+    if(watchers->key_version_ < watcherValue->key_version_) {
         watchers->key_version_ = watcherValue->key_version_;
     }
 
     //to do clear version if delete event
-    if(evtType == watchpb::DELETE  && watchers->mapKeyWatcher.size() == 0 && !prefixFlag) {
+    if(evtType == watchpb::DELETE  && watchers->mapKeyWatcher.size() == 0) {
         watchers->key_version_ = 0;
     }
 
     if(watchers->mapKeyWatcher.size() > 0) {
         watchers->mapKeyWatcher.swap(watcherValue->mapKeyWatcher);
 
-        watcherMap.erase(itWatcherVal);
-        delete watchers;
+        //流式watcher继续留在map中等待后续事件
+        for (auto& it : watcherValue->mapKeyWatcher) {
+            if (it.second->IsStream()) {
+                watchers->mapKeyWatcher.emplace(it.first, it.second);
+            }
+        }
+        if (watchers->mapKeyWatcher.empty()) {
+            key_watcher_map_.erase(itWatcherVal);
+            delete watchers;
+        }
         FLOG_INFO("watcher get success,count:%" PRIu64 " key: [%s] watch_id[%" PRId64 "]",
                   watcherValue->mapKeyWatcher.size(), EncodeToHexString(key).c_str(), watcherValue->mapKeyWatcher.begin()->first );
         return WATCH_OK;
@@ -414,13 +471,41 @@ WatchCode WatcherSet::GetWatchers(const watchpb::EventType &evtType, std::vector
 
 }
 
+WatcherPtr WatcherSet::TakeWatcher(const WatcherKey& key, WatcherId watcher_id, int64_t session_id, bool prefixFlag) {
+    std::lock_guard<std::mutex> lock(watcher_map_mutex_);
+
+    auto watcher_val = findWatcherValue(key, prefixFlag);
+    if (watcher_val == nullptr) {
+        return nullptr;
+    }
+
+    auto &watchers = watcher_val->mapKeyWatcher;
+    auto it = watchers.find(watcher_id);
+    if (it == watchers.end()) {
+        return nullptr;
+    }
+    // watchId是递增分配的，只能取消本session的watch
+    if (it->second->GetSessionId() != session_id) {
+        FLOG_WARN("cancel watcher denied, watch_id:[%" PRIu64 "] session_id: %" PRId64 " owner session_id: %" PRId64,
+                  watcher_id, session_id, it->second->GetSessionId());
+        return nullptr;
+    }
+
+    auto w_ptr = it->second;
+    watchers.erase(it);
+    if (watchers.empty()) {
+        eraseWatcherValue(key, prefixFlag);
+    }
+    return w_ptr;
+}
+
 // key add/del watcher
 WatchCode WatcherSet::AddKeyWatcher(const WatcherKey& key, WatcherPtr& w_ptr, storage::Store *store_) {
-    return AddWatcher(key, w_ptr, key_watcher_map_, key_map_, store_);
+    return AddWatcher(key, w_ptr, store_);
 }
 
 WatchCode WatcherSet::DelKeyWatcher(const WatcherKey& key, WatcherId id) {
-    return DelWatcher(key, id, key_watcher_map_, key_map_);
+    return DelWatcher(key, id);
 }
 
 // key get watchers
@@ -429,7 +514,7 @@ WatchCode WatcherSet::GetKeyWatchers(const watchpb::EventType &evtType, std::vec
     //auto mapKeyWatcher = new KeyWatcherMap;
     watcherVal->key_version_ = version;
 
-    auto retCode = GetWatchers(evtType, vec, key, key_watcher_map_, watcherVal);
+    auto retCode = GetWatchers(evtType, vec, key, watcherVal);
     if( WATCH_OK == retCode) {
 
         for(auto it:watcherVal->mapKeyWatcher) {
@@ -448,33 +533,78 @@ WatchCode WatcherSet::GetKeyWatchers(const watchpb::EventType &evtType, std::vec
 
 // prefix add/del watcher
 WatchCode WatcherSet::AddPrefixWatcher(const PrefixKey& prefix, WatcherPtr& w_ptr, storage::Store *store_) {
-    return AddWatcher(prefix, w_ptr, prefix_watcher_map_, prefix_map_, store_, true);
+    return AddWatcher(prefix, w_ptr, store_, true);
 }
 
 WatchCode WatcherSet::DelPrefixWatcher(const PrefixKey& prefix, WatcherId id) {
-    return DelWatcher(prefix, id, prefix_watcher_map_, prefix_map_);
+    return DelWatcher(prefix, id, true);
 }
 
 // prefix get watchers
-WatchCode WatcherSet::GetPrefixWatchers(const watchpb::EventType &evtType, std::vector<WatcherPtr>& vec, const PrefixKey& prefix, const int64_t &version) {
-    auto watcherVal = new WatcherValue;
-    watcherVal->key_version_ = version;
-
-    auto retCode = GetWatchers(evtType, vec, prefix, prefix_watcher_map_, watcherVal, true);
-    if( WATCH_OK == retCode) {
+// 沿编码后的key遍历一次前缀树，取出所有前缀匹配的watcher（fire once，取出后删除）
+WatchCode WatcherSet::GetPrefixWatchers(const watchpb::EventType &evtType, std::vector<WatcherPtr>& vec, const WatcherKey& key, const int64_t &version) {
+    std::lock_guard<std::mutex> lock(watcher_map_mutex_);
 
-        for(auto it:(watcherVal->mapKeyWatcher)) {
-            vec.push_back(it.second);
+    // 先记录匹配的前缀长度，遍历结束后再删除
+    std::vector<size_t> matched;
+    bool found = false;
+    prefix_watcher_tree_.ForEachPrefix(key, [&matched, &found](size_t len, WatcherValue* v) {
+        found = true;
+        if (!v->mapKeyWatcher.empty()) {
+            matched.push_back(len);
         }
+    });
+    if (!found) {
+        FLOG_DEBUG("GetPrefixWatchers end,key[%s] has no watcher.", EncodeToHexString(key).c_str());
+        return WATCH_KEY_NOT_EXIST;
+    }
+    if (matched.empty()) {
+        FLOG_INFO("GetPrefixWatchers end, key [%s] has no watcher...", EncodeToHexString(key).c_str());
+        return WATCH_WATCHER_NOT_EXIST;
+    }
 
-        delete (watcherVal);
-        watcherVal = nullptr;
+    for (auto len : matched) {
+        auto prefix = key.substr(0, len);
+        auto watchers = *prefix_watcher_tree_.Find(prefix);
+        FLOG_INFO("prefix watcher get success,count:%" PRIu64 " prefix: [%s] key: [%s]",
+                  watchers->mapKeyWatcher.size(), EncodeToHexString(prefix).c_str(), EncodeToHexString(key).c_str());
+        //流式watcher继续留在树中等待后续事件
+        for (auto it = watchers->mapKeyWatcher.begin(); it != watchers->mapKeyWatcher.end();) {
+            vec.push_back(it->second);
+            if (it->second->IsStream()) {
+                ++it;
+            } else {
+                it = watchers->mapKeyWatcher.erase(it);
+            }
+        }
+        if (watchers->mapKeyWatcher.empty()) {
+            prefix_watcher_tree_.Erase(prefix);
+            delete watchers;
+        }
     }
+    return WATCH_OK;
+}
 
-    if(watcherVal != nullptr)
-        delete(watcherVal);
+void WatcherSet::GetRangeWatchers(const WatcherKey& start, const WatcherKey& end,
+                                  std::vector<WatcherPtr>* keyWatchers, std::vector<WatcherPtr>* prefixWatchers) {
+    auto inRange = [&start, &end](const WatcherKey& key) {
+        return key >= start && (end.empty() || key < end);
+    };
 
-    return retCode;
+    std::lock_guard<std::mutex> lock(watcher_map_mutex_);
+    for (const auto& it : key_watcher_map_) {
+        if (!inRange(it.first)) continue;
+        for (const auto& w : it.second->mapKeyWatcher) {
+            keyWatchers->push_back(w.second);
+        }
+    }
+    prefix_watcher_tree_.ForEach([&inRange, prefixWatchers](WatcherValue* v) {
+        for (const auto& w : v->mapKeyWatcher) {
+            if (inRange(w.second->GetFullEncodeKey())) {
+                prefixWatchers->push_back(w.second);
+            }
+        }
+    });
 }
 
 std::pair<int32_t, bool> WatcherSet::loadFromDb(storage::Store *store, const watchpb::EventType &evtType, const std::string &fromKey,
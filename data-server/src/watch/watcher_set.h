@@ -10,6 +10,7 @@
 
 #include "watch.h"
 #include "watcher.h"
+#include "radix_tree.h"
 #include "storage/store.h"
 
 namespace sharkstore {
@@ -25,6 +26,8 @@ typedef struct WatcherValue_ {
 }WatcherValue;
 //typedef std::unordered_map<Key, KeyWatcherMap*> WatcherMap;
 typedef std::unordered_map<WatcherKey, WatcherValue*> WatcherMap;
+// prefix watcher按编码后的前缀索引，一次遍历事件key即可找到所有层级的前缀
+typedef RadixTree<WatcherValue*> WatcherTree;
 
 typedef std::unordered_map<WatcherKey, int64_t > WatcherKeyMap;
 typedef std::unordered_map<WatcherId, WatcherKeyMap*> KeyMap;
@@ -48,7 +51,14 @@ public:
     WatchCode GetKeyWatchers(const watchpb::EventType &evtType, std::vector<WatcherPtr>& , const WatcherKey&, const int64_t &version);
     WatchCode AddPrefixWatcher(const PrefixKey&, WatcherPtr&, storage::Store *);
     WatchCode DelPrefixWatcher(const PrefixKey&, WatcherId);
-    WatchCode GetPrefixWatchers(const watchpb::EventType &evtType, std::vector<WatcherPtr>& , const PrefixKey&, const int64_t &version);
+    // 取出前缀匹配key（任意层级）的所有prefix watcher
+    WatchCode GetPrefixWatchers(const watchpb::EventType &evtType, std::vector<WatcherPtr>& , const WatcherKey&, const int64_t &version);
+    // 返回key在[start, end)中的所有watcher，不从watcher set中移除；end为空表示不限
+    void GetRangeWatchers(const WatcherKey& start, const WatcherKey& end,
+                          std::vector<WatcherPtr>* keyWatchers, std::vector<WatcherPtr>* prefixWatchers);
+    // 从watcher set中移除并返回指定的watcher（用于取消流式watch）
+    // watcher不存在或者不属于session_id时返回nullptr
+    WatcherPtr TakeWatcher(const WatcherKey&, WatcherId, int64_t session_id, bool prefixFlag);
     bool ChgGlobalVersion(const uint64_t &ver) noexcept {
         if(ver <= global_version_)
             return false;
@@ -78,7 +88,7 @@ public:
 private:
     WatcherMap              key_watcher_map_;
     KeyMap                  key_map_;
-    WatcherMap              prefix_watcher_map_;
+    WatcherTree             prefix_watcher_tree_;
     KeyMap                  prefix_map_;
     PriorityQueue<WatcherPtr>   watcher_queue_;
     std::mutex              watcher_map_mutex_;
@@ -92,9 +102,14 @@ private:
     std::condition_variable         watcher_expire_cond_;
     uint64_t                global_version_{0};
 private:
-    WatchCode AddWatcher(const WatcherKey&, WatcherPtr&, WatcherMap&, KeyMap&, storage::Store *, bool prefixFlag = false);
-    WatchCode DelWatcher(const WatcherKey&, WatcherId, WatcherMap&, KeyMap&);
-    WatchCode GetWatchers(const watchpb::EventType &evtType, std::vector<WatcherPtr>& vec, const WatcherKey&, WatcherMap&, WatcherValue *watcherVal, bool prefixFlag = false);
+    WatchCode AddWatcher(const WatcherKey&, WatcherPtr&, storage::Store *, bool prefixFlag = false);
+    WatchCode DelWatcher(const WatcherKey&, WatcherId, bool prefixFlag = false);
+    WatchCode GetWatchers(const watchpb::EventType &evtType, std::vector<WatcherPtr>& vec, const WatcherKey&, WatcherValue *watcherVal);
+
+    // key watcher和prefix watcher的存储访问，调用方需持有watcher_map_mutex_
+    WatcherValue* findWatcherValue(const WatcherKey&, bool prefixFlag);
+    WatcherValue* addWatcherValue(const WatcherKey&, bool prefixFlag);
+    void eraseWatcherValue(const WatcherKey&, bool prefixFlag);
 
 public:
     WatcherId GenWatcherId() {
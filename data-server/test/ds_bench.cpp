@@ -0,0 +1,767 @@
+#include <arpa/inet.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
+
+#include "common/ds_encoding.h"
+#include "common/ds_proto.h"
+#include "frame/sf_util.h"
+#include "proto/gen/funcpb.pb.h"
+#include "proto/gen/kvrpcpb.pb.h"
+#include "proto/gen/schpb.pb.h"
+#include "proto/gen/watchpb.pb.h"
+
+#include "helper/helper_util.h"
+#include "helper/query_builder.h"
+#include "helper/table.h"
+
+// data-server端到端压测客户端
+// 直接使用ds_proto协议通过TCP连接data-server，每个连接一个线程，每个连接上保持depth个请求在途(pipelining)；
+// 请求按比例混合多种功能，key按均匀、zipfian或顺序分布生成，统计吞吐和各功能的延迟分位数。
+// 延迟使用对数分桶直方图(HdrHistogram的分桶方式)记录，相对误差不超过1%。
+// -C先在服务端创建压测用的range(单副本，等待raft选出leader)，配合本地单节点data-server使用
+//
+// usage: ds_bench [-H host] [-P port] [-c connections] [-d depth] [-n requests] [-T seconds]
+//                 [-m mix] [-k keys] [-D uniform|zipfian|sequential] [-z theta] [-v value_size[-max]]
+//                 [-r range_id] [-C] [-N node_id] [-t timeout_ms]
+//
+// mix格式: get:50,put:30,scan:5,select:5,insert:5,lock:3,watch:2
+
+using namespace sharkstore;
+using namespace sharkstore::dataserver;
+using namespace sharkstore::test;
+
+namespace {
+
+enum OpType { kOpGet = 0, kOpPut, kOpScan, kOpSelect, kOpInsert, kOpLock, kOpWatch, kOpNum };
+
+const char* const kOpNames[kOpNum] = {"get", "put", "scan", "select", "insert", "lock", "watch"};
+const funcpb::FunctionID kOpFuncs[kOpNum] = {
+    funcpb::kFuncRawGet, funcpb::kFuncRawPut, funcpb::kFuncKvScan, funcpb::kFuncSelect,
+    funcpb::kFuncInsert, funcpb::kFuncLock,   funcpb::kFuncWatchPut};
+
+enum KeyDist { kDistUniform = 0, kDistZipfian, kDistSequential };
+
+struct BenchOptions {
+    std::string host = "127.0.0.1";
+    int port = 6180;
+    int connections = 4;
+    int depth = 16;              // 每个连接在途的请求数
+    uint64_t requests = 100000;  // 总请求数，duration>0时忽略
+    int duration = 0;            // 压测时长(秒)
+    int weights[kOpNum] = {50, 50, 0, 0, 0, 0, 0};
+    uint64_t keys = 100000;
+    KeyDist dist = kDistUniform;
+    double theta = 0.99;
+    int value_min = 64;
+    int value_max = 64;
+    int scan_count = 10;
+    uint64_t range_id = 1;
+    bool create_range = false;
+    uint64_t node_id = 1;
+    int timeout_ms = 5000;
+};
+
+// 对数分桶的延迟直方图，分桶方式同HdrHistogram(2位有效数字)：
+// 小于128的值每个值一个桶，之后每个2的幂区间分成64个桶，桶宽度不超过值的1/64
+class Histogram {
+public:
+    Histogram() : counts_(static_cast<size_t>(kBucketNum), 0) {}
+
+    void Record(int64_t value) {
+        auto v = static_cast<uint64_t>(value < 0 ? 0 : value);
+        ++counts_[indexOf(v)];
+        ++count_;
+        sum_ += v;
+        min_ = std::min(min_, v);
+        max_ = std::max(max_, v);
+    }
+
+    void Merge(const Histogram& other) {
+        for (size_t i = 0; i < kBucketNum; ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        count_ += other.count_;
+        sum_ += other.sum_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    uint64_t Count() const { return count_; }
+    uint64_t Max() const { return max_; }
+    uint64_t Min() const { return count_ > 0 ? min_ : 0; }
+    double Mean() const { return count_ > 0 ? static_cast<double>(sum_) / count_ : 0.0; }
+
+    // 返回不小于p%的样本所在桶的上界，p取值0~100
+    uint64_t Percentile(double p) const {
+        if (count_ == 0) return 0;
+        auto target = static_cast<uint64_t>(std::ceil(p / 100.0 * count_));
+        if (target == 0) target = 1;
+        uint64_t total = 0;
+        for (size_t i = 0; i < kBucketNum; ++i) {
+            total += counts_[i];
+            if (total >= target) {
+                return std::min(highestOf(i), max_);
+            }
+        }
+        return max_;
+    }
+
+private:
+    static const size_t kSubBucketBits = 7;
+    static const uint64_t kSubBuckets = 1ULL << kSubBucketBits;  // 128
+    static const uint64_t kHalfBuckets = kSubBuckets / 2;         // 64
+    static const size_t kBucketNum = kSubBuckets + (64 - kSubBucketBits) * kHalfBuckets;
+
+    static size_t indexOf(uint64_t v) {
+        if (v < kSubBuckets) return static_cast<size_t>(v);
+        auto shift = 63 - __builtin_clzll(v) - (kSubBucketBits - 1);
+        return static_cast<size_t>(kSubBuckets + (shift - 1) * kHalfBuckets +
+                                   ((v >> shift) - kHalfBuckets));
+    }
+
+    static uint64_t highestOf(size_t idx) {
+        if (idx < kSubBuckets) return idx;
+        auto k = idx - kSubBuckets;
+        auto shift = k / kHalfBuckets + 1;
+        auto lowest = (k % kHalfBuckets + kHalfBuckets) << shift;
+        return lowest + (1ULL << shift) - 1;
+    }
+
+private:
+    std::vector<uint64_t> counts_;
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t min_ = UINT64_MAX;
+    uint64_t max_ = 0;
+};
+
+// zipfian分布(Gray et al. "Quickly Generating Billion-Record Synthetic Databases")，
+// 与YCSB相同，key 0最热；构造时计算zeta(n)，之后只读，可以多线程共用
+class ZipfianGenerator {
+public:
+    ZipfianGenerator(uint64_t n, double theta) : n_(n), theta_(theta) {
+        zetan_ = zeta(n, theta);
+        auto zeta2 = zeta(2, theta);
+        alpha_ = 1.0 / (1.0 - theta);
+        eta_ = (1.0 - std::pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / zetan_);
+    }
+
+    // u为[0, 1)的均匀随机数
+    uint64_t Next(double u) const {
+        auto uz = u * zetan_;
+        if (uz < 1.0) return 0;
+        if (uz < 1.0 + std::pow(0.5, theta_)) return 1;
+        auto v = static_cast<uint64_t>(n_ * std::pow(eta_ * u - eta_ + 1.0, alpha_));
+        return std::min(v, n_ - 1);
+    }
+
+private:
+    static double zeta(uint64_t n, double theta) {
+        double sum = 0;
+        for (uint64_t i = 1; i <= n; ++i) {
+            sum += 1.0 / std::pow(static_cast<double>(i), theta);
+        }
+        return sum;
+    }
+
+private:
+    uint64_t n_;
+    double theta_;
+    double zetan_ = 0;
+    double alpha_ = 0;
+    double eta_ = 0;
+};
+
+// 所有连接共用的只读压测数据
+struct Workload {
+    std::unique_ptr<helper::Table> table;
+    metapb::Range meta;
+    std::string key_prefix;  // 所属表的key前缀
+    std::string end_key;
+    std::string values;      // 随机value，取其中一段使用
+    std::unique_ptr<ZipfianGenerator> zipfian;
+    int total_weight = 0;
+};
+
+struct OpStats {
+    uint64_t errors = 0;
+    Histogram latency;
+    std::string first_error;
+};
+
+struct ConnStats {
+    OpStats ops[kOpNum];
+    uint64_t sent_bytes = 0;
+    uint64_t recv_bytes = 0;
+    std::string failure;  // 连接异常结束的原因
+};
+
+struct Pending {
+    OpType op;
+    int64_t begin;
+};
+
+int connectServer(const BenchOptions& opt) {
+    struct addrinfo hints, *res = nullptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    auto port = std::to_string(opt.port);
+    if (getaddrinfo(opt.host.c_str(), port.c_str(), &hints, &res) != 0 || res == nullptr) {
+        return -1;
+    }
+    int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (fd < 0 || connect(fd, res->ai_addr, res->ai_addrlen) != 0) {
+        if (fd >= 0) close(fd);
+        freeaddrinfo(res);
+        return -1;
+    }
+    freeaddrinfo(res);
+
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    struct timeval tv;
+    tv.tv_sec = opt.timeout_ms / 1000;
+    tv.tv_usec = (opt.timeout_ms % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+bool writeAll(int fd, const std::string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        auto n = write(fd, data.data() + offset, data.size() - offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        offset += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void appendFrame(std::string* out, int func_id, int64_t msg_id, int timeout_ms,
+                 const google::protobuf::Message& req) {
+    ds_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic_number = DS_PROTO_MAGIC_NUMBER;
+    header.version = DS_PROTO_VERSION_CURRENT;
+    header.msg_type = DS_PROTO_FID_RPC_REQ;
+    header.func_id = static_cast<short>(func_id);
+    header.msg_id = msg_id;
+    header.time_out = timeout_ms;
+    header.body_len = static_cast<int>(req.ByteSizeLong());
+
+    auto offset = out->size();
+    out->resize(offset + header_size + header.body_len);
+    ds_serialize_header(&header, reinterpret_cast<ds_proto_header_t*>(&(*out)[offset]));
+    req.SerializeToArray(&(*out)[offset + header_size], header.body_len);
+}
+
+// 所有应答的第1个字段都是ResponseHeader，只解析header检查是否出错
+bool responseError(const char* data, int len, std::string* err) {
+    using google::protobuf::internal::WireFormatLite;
+
+    google::protobuf::io::CodedInputStream input(reinterpret_cast<const uint8_t*>(data), len);
+    const auto header_tag = WireFormatLite::MakeTag(1, WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+    uint32_t tag = 0;
+    while ((tag = input.ReadTag()) != 0) {
+        if (tag != header_tag) {
+            if (!WireFormatLite::SkipField(&input, tag)) break;
+            continue;
+        }
+        kvrpcpb::ResponseHeader header;
+        std::string buf;
+        if (!WireFormatLite::ReadBytes(&input, &buf) || !header.ParseFromString(buf)) {
+            break;
+        }
+        if (header.has_error()) {
+            *err = header.error().ShortDebugString();
+            return true;
+        }
+        return false;
+    }
+    if (input.ConsumedEntireMessage() && input.CurrentPosition() == len) {
+        return false;
+    }
+    *err = "invalid response";
+    return true;
+}
+
+class Connection {
+public:
+    Connection(const BenchOptions& opt, const Workload& wl, int index)
+        : opt_(opt), wl_(wl), index_(index), rand_(20181010 + index), seq_(index) {}
+
+    ~Connection() {
+        if (fd_ >= 0) close(fd_);
+    }
+
+    bool Connect() {
+        fd_ = connectServer(opt_);
+        return fd_ >= 0;
+    }
+
+    // 发送一个请求并等待应答，返回是否成功
+    bool Call(int func_id, const google::protobuf::Message& req, std::string* err) {
+        std::string out;
+        appendFrame(&out, func_id, ++msg_id_, opt_.timeout_ms, req);
+        if (!writeAll(fd_, out)) {
+            *err = "send failed";
+            return false;
+        }
+        std::vector<char> in;
+        while (true) {
+            if (!recvSome(&in)) {
+                *err = "recv failed";
+                return false;
+            }
+            if (in.size() < static_cast<size_t>(header_size)) continue;
+            ds_header_t header;
+            ds_unserialize_header(reinterpret_cast<const ds_proto_header_t*>(in.data()), &header);
+            if (in.size() < static_cast<size_t>(header_size + header.body_len)) continue;
+            return !responseError(in.data() + header_size, header.body_len, err);
+        }
+    }
+
+    // 压测循环，limit为0时一直执行到stop
+    void Run(uint64_t limit, const std::atomic<bool>* stop, ConnStats* stats) {
+        std::unordered_map<int64_t, Pending> pending;
+        std::string out;
+        std::vector<char> in;
+        size_t consumed = 0;
+        uint64_t sent = 0;
+        std::uniform_int_distribution<int> op_dist(0, wl_.total_weight - 1);
+
+        while (true) {
+            out.clear();
+            while (pending.size() < static_cast<size_t>(opt_.depth) && !stop->load() &&
+                   (limit == 0 || sent < limit)) {
+                auto op = chooseOp(op_dist(rand_));
+                auto id = ++msg_id_;
+                appendRequest(&out, op, id);
+                pending.emplace(id, Pending{op, get_micro_second()});
+                ++sent;
+            }
+            if (!out.empty()) {
+                if (!writeAll(fd_, out)) {
+                    stats->failure = "send failed";
+                    return;
+                }
+                stats->sent_bytes += out.size();
+            } else if (pending.empty()) {
+                return;
+            }
+
+            // 至少读到一个应答再继续发送
+            auto before = in.size();
+            if (!recvSome(&in)) {
+                stats->failure = pending.empty() ? "" : "recv failed or timeout";
+                return;
+            }
+            stats->recv_bytes += in.size() - before;
+
+            auto now = get_micro_second();
+            while (in.size() - consumed >= static_cast<size_t>(header_size)) {
+                ds_header_t header;
+                ds_unserialize_header(reinterpret_cast<const ds_proto_header_t*>(&in[consumed]),
+                                      &header);
+                if (in.size() - consumed < static_cast<size_t>(header_size + header.body_len)) {
+                    break;
+                }
+                auto it = pending.find(header.msg_id);
+                if (it != pending.end()) {
+                    auto& op_stats = stats->ops[it->second.op];
+                    op_stats.latency.Record(now - it->second.begin);
+                    std::string err;
+                    if (responseError(&in[consumed + header_size], header.body_len, &err)) {
+                        if (op_stats.errors++ == 0) op_stats.first_error = err;
+                    }
+                    pending.erase(it);
+                }
+                consumed += header_size + header.body_len;
+            }
+            if (consumed == in.size()) {
+                in.clear();
+                consumed = 0;
+            } else if (consumed > in.size() / 2) {
+                in.erase(in.begin(), in.begin() + consumed);
+                consumed = 0;
+            }
+        }
+    }
+
+private:
+    bool recvSome(std::vector<char>* in) {
+        auto size = in->size();
+        in->resize(size + 64 * 1024);
+        while (true) {
+            auto n = read(fd_, in->data() + size, 64 * 1024);
+            if (n < 0 && errno == EINTR) continue;
+            in->resize(size + (n > 0 ? n : 0));
+            return n > 0;
+        }
+    }
+
+    OpType chooseOp(int r) const {
+        for (int i = 0; i < kOpNum; ++i) {
+            r -= opt_.weights[i];
+            if (r < 0) return static_cast<OpType>(i);
+        }
+        return kOpGet;
+    }
+
+    uint64_t nextKey() {
+        switch (opt_.dist) {
+            case kDistZipfian:
+                return wl_.zipfian->Next(std::uniform_real_distribution<double>(0, 1)(rand_));
+            case kDistSequential: {
+                // 各连接交错递增，合起来是顺序的key
+                auto k = seq_ % opt_.keys;
+                seq_ += opt_.connections;
+                return k;
+            }
+            default:
+                return std::uniform_int_distribution<uint64_t>(0, opt_.keys - 1)(rand_);
+        }
+    }
+
+    std::string nextValue() {
+        auto len = std::uniform_int_distribution<int>(opt_.value_min, opt_.value_max)(rand_);
+        auto offset = std::uniform_int_distribution<size_t>(0, wl_.values.size() - len)(rand_);
+        return wl_.values.substr(offset, len);
+    }
+
+    void setHeader(kvrpcpb::RequestHeader* header) const {
+        header->set_range_id(wl_.meta.id());
+        header->mutable_range_epoch()->CopyFrom(wl_.meta.range_epoch());
+    }
+
+    void appendRequest(std::string* out, OpType op, int64_t msg_id) {
+        auto key = nextKey();
+        char user_key[32];
+        snprintf(user_key, sizeof(user_key), "k%012" PRIu64, key);
+
+        switch (op) {
+            case kOpGet: {
+                kvrpcpb::DsKvRawGetRequest req;
+                setHeader(req.mutable_header());
+                req.mutable_req()->set_key(wl_.key_prefix + user_key);
+                appendFrame(out, kOpFuncs[op], msg_id, opt_.timeout_ms, req);
+                break;
+            }
+            case kOpPut: {
+                kvrpcpb::DsKvRawPutRequest req;
+                setHeader(req.mutable_header());
+                req.mutable_req()->set_key(wl_.key_prefix + user_key);
+                req.mutable_req()->set_value(nextValue());
+                appendFrame(out, kOpFuncs[op], msg_id, opt_.timeout_ms, req);
+                break;
+            }
+            case kOpScan: {
+                kvrpcpb::DsKvScanRequest req;
+                setHeader(req.mutable_header());
+                req.mutable_req()->set_start(wl_.key_prefix + user_key);
+                req.mutable_req()->set_limit(wl_.end_key);
+                req.mutable_req()->set_max_count(opt_.scan_count);
+                appendFrame(out, kOpFuncs[op], msg_id, opt_.timeout_ms, req);
+                break;
+            }
+            case kOpSelect: {
+                helper::SelectRequestBuilder builder(wl_.table.get());
+                builder.SetKey({std::to_string(key)});
+                builder.AddAllFields();
+                kvrpcpb::DsSelectRequest req;
+                setHeader(req.mutable_header());
+                *req.mutable_req() = builder.Build();
+                appendFrame(out, kOpFuncs[op], msg_id, opt_.timeout_ms, req);
+                break;
+            }
+            case kOpInsert: {
+                helper::InsertRequestBuilder builder(wl_.table.get());
+                builder.AddRow({std::to_string(key), nextValue(), std::to_string(msg_id)});
+                kvrpcpb::DsInsertRequest req;
+                setHeader(req.mutable_header());
+                *req.mutable_req() = builder.Build();
+                appendFrame(out, kOpFuncs[op], msg_id, opt_.timeout_ms, req);
+                break;
+            }
+            case kOpLock: {
+                // 锁1秒后自动过期，热点key上会有加锁冲突，冲突也是正常应答
+                kvrpcpb::DsLockRequest req;
+                setHeader(req.mutable_header());
+                req.mutable_req()->set_key(user_key);
+                auto value = req.mutable_req()->mutable_value();
+                value->set_value(nextValue());
+                value->set_id("ds_bench_" + std::to_string(index_) + "_" + std::to_string(msg_id));
+                value->set_delete_time(1000);
+                value->set_by("ds_bench");
+                appendFrame(out, kOpFuncs[op], msg_id, opt_.timeout_ms, req);
+                break;
+            }
+            case kOpWatch: {
+                // 带版本的写，会触发该key上watcher的通知
+                watchpb::DsKvWatchPutRequest req;
+                setHeader(req.mutable_header());
+                auto kv = req.mutable_req()->mutable_kv();
+                kv->add_key(user_key);
+                kv->set_value(nextValue());
+                appendFrame(out, kOpFuncs[op], msg_id, opt_.timeout_ms, req);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+private:
+    const BenchOptions& opt_;
+    const Workload& wl_;
+    const int index_;
+    int fd_ = -1;
+    int64_t msg_id_ = 0;
+    std::mt19937_64 rand_;
+    uint64_t seq_;
+};
+
+// 创建单副本range，等到range可以读(选出leader)
+int createRange(const BenchOptions& opt, const Workload& wl) {
+    Connection conn(opt, wl, 0);
+    if (!conn.Connect()) {
+        fprintf(stderr, "connect %s:%d failed: %s\n", opt.host.c_str(), opt.port, strerror(errno));
+        return -1;
+    }
+
+    schpb::CreateRangeRequest req;
+    req.mutable_range()->CopyFrom(wl.meta);
+    std::string err;
+    if (!conn.Call(funcpb::kFuncCreateRange, req, &err)) {
+        fprintf(stderr, "create range %" PRIu64 " failed: %s\n", wl.meta.id(), err.c_str());
+        return -1;
+    }
+
+    kvrpcpb::DsKvRawGetRequest get;
+    get.mutable_header()->set_range_id(wl.meta.id());
+    get.mutable_header()->mutable_range_epoch()->CopyFrom(wl.meta.range_epoch());
+    get.mutable_req()->set_key(wl.key_prefix);
+    for (int i = 0; i < 100; ++i) {
+        if (conn.Call(funcpb::kFuncRawGet, get, &err)) {
+            return 0;
+        }
+        usleep(100 * 1000);
+    }
+    fprintf(stderr, "wait range %" PRIu64 " leader failed: %s\n", wl.meta.id(), err.c_str());
+    return -1;
+}
+
+bool parseMix(const char* arg, BenchOptions* opt) {
+    std::fill(opt->weights, opt->weights + kOpNum, 0);
+    std::string mix(arg);
+    size_t pos = 0;
+    while (pos < mix.size()) {
+        auto end = mix.find(',', pos);
+        if (end == std::string::npos) end = mix.size();
+        auto item = mix.substr(pos, end - pos);
+        auto colon = item.find(':');
+        auto name = item.substr(0, colon);
+        int weight = colon == std::string::npos ? 1 : atoi(item.c_str() + colon + 1);
+        auto it = std::find_if(kOpNames, kOpNames + kOpNum,
+                               [&name](const char* n) { return name == n; });
+        if (it == kOpNames + kOpNum || weight < 0) {
+            fprintf(stderr, "invalid mix item: %s\n", item.c_str());
+            return false;
+        }
+        opt->weights[it - kOpNames] = weight;
+        pos = end + 1;
+    }
+    return true;
+}
+
+void printStats(const char* name, const OpStats& stats, double seconds) {
+    const auto& h = stats.latency;
+    printf("%-8s %10" PRIu64 " %10.0f %8" PRIu64 " %9.1f %8" PRIu64 " %8" PRIu64 " %8" PRIu64
+           " %8" PRIu64 " %8" PRIu64 " %8" PRIu64 "\n",
+           name, h.Count(), seconds > 0 ? h.Count() / seconds : 0.0, stats.errors, h.Mean(),
+           h.Percentile(50), h.Percentile(90), h.Percentile(99), h.Percentile(99.9),
+           h.Percentile(99.99), h.Max());
+}
+
+void usage(const char* name) {
+    fprintf(stderr,
+            "usage: %s [-H host] [-P port] [-c connections] [-d depth] [-n requests] [-T seconds]\n"
+            "          [-m mix] [-k keys] [-D uniform|zipfian|sequential] [-z theta] [-v value_size[-max]]\n"
+            "          [-r range_id] [-C] [-N node_id] [-t timeout_ms]\n"
+            "   mix: comma separated op:weight, ops: get put scan select insert lock watch\n",
+            name);
+}
+
+int runBench(const BenchOptions& opt) {
+    Workload wl;
+    wl.table = helper::CreateAccountTable();
+    wl.meta = helper::MakeRangeMeta(wl.table.get(), 1);
+    wl.meta.set_id(opt.range_id);
+    wl.meta.mutable_peers(0)->set_node_id(opt.node_id);
+    wl.meta.mutable_peers(0)->set_id(helper::GetPeerID(opt.node_id));
+    helper::EncodeKeyPrefix(&wl.key_prefix, wl.table->GetID());
+    wl.end_key = wl.meta.end_key();
+    wl.total_weight = std::accumulate(opt.weights, opt.weights + kOpNum, 0);
+
+    std::mt19937 rand(20181010);
+    wl.values.resize(static_cast<size_t>(opt.value_max) * 2);
+    for (auto& c : wl.values) {
+        c = static_cast<char>('a' + rand() % 26);
+    }
+    if (opt.dist == kDistZipfian) {
+        wl.zipfian.reset(new ZipfianGenerator(opt.keys, opt.theta));
+    }
+
+    if (opt.create_range && createRange(opt, wl) != 0) {
+        return -1;
+    }
+
+    std::vector<std::unique_ptr<Connection>> conns;
+    for (int i = 0; i < opt.connections; ++i) {
+        conns.emplace_back(new Connection(opt, wl, i));
+        if (!conns.back()->Connect()) {
+            fprintf(stderr, "connect %s:%d failed: %s\n", opt.host.c_str(), opt.port,
+                    strerror(errno));
+            return -1;
+        }
+    }
+
+    // 总请求数平均分到每个连接
+    std::vector<ConnStats> stats(opt.connections);
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> threads;
+    auto begin = get_micro_second();
+    for (int i = 0; i < opt.connections; ++i) {
+        uint64_t limit = 0;
+        if (opt.duration <= 0) {
+            limit = opt.requests / opt.connections + (i < static_cast<int>(opt.requests % opt.connections) ? 1 : 0);
+        }
+        threads.emplace_back([&, i, limit] { conns[i]->Run(limit, &stop, &stats[i]); });
+    }
+    if (opt.duration > 0) {
+        sleep(static_cast<unsigned>(opt.duration));
+        stop = true;
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    auto seconds = (get_micro_second() - begin) / 1000000.0;
+
+    OpStats total;
+    OpStats ops[kOpNum];
+    uint64_t sent_bytes = 0, recv_bytes = 0;
+    for (const auto& s : stats) {
+        for (int i = 0; i < kOpNum; ++i) {
+            ops[i].latency.Merge(s.ops[i].latency);
+            ops[i].errors += s.ops[i].errors;
+            if (ops[i].first_error.empty()) ops[i].first_error = s.ops[i].first_error;
+            total.latency.Merge(s.ops[i].latency);
+            total.errors += s.ops[i].errors;
+        }
+        sent_bytes += s.sent_bytes;
+        recv_bytes += s.recv_bytes;
+        if (!s.failure.empty()) {
+            fprintf(stderr, "connection failed: %s\n", s.failure.c_str());
+        }
+    }
+
+    printf("server:     %s:%d, range %" PRIu64 ", connections %d, depth %d\n", opt.host.c_str(),
+           opt.port, opt.range_id, opt.connections, opt.depth);
+    printf("keys:       %" PRIu64 " %s, value %d-%d bytes\n", opt.keys,
+           opt.dist == kDistZipfian ? "zipfian" : (opt.dist == kDistSequential ? "sequential" : "uniform"),
+           opt.value_min, opt.value_max);
+    printf("total:      %" PRIu64 " requests in %.2f s, %.0f req/s, out %.1f MB/s, in %.1f MB/s\n",
+           total.latency.Count(), seconds, seconds > 0 ? total.latency.Count() / seconds : 0.0,
+           sent_bytes / seconds / 1048576, recv_bytes / seconds / 1048576);
+    printf("\n%-8s %10s %10s %8s %9s %8s %8s %8s %8s %8s %8s\n", "op", "count", "req/s", "errors",
+           "avg(us)", "p50", "p90", "p99", "p99.9", "p99.99", "max");
+    for (int i = 0; i < kOpNum; ++i) {
+        if (ops[i].latency.Count() > 0) {
+            printStats(kOpNames[i], ops[i], seconds);
+        }
+    }
+    printStats("all", total, seconds);
+    for (int i = 0; i < kOpNum; ++i) {
+        if (ops[i].errors > 0) {
+            printf("%s first error: %s\n", kOpNames[i], ops[i].first_error.c_str());
+        }
+    }
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions opt;
+    int c;
+    while ((c = getopt(argc, argv, "H:P:c:d:n:T:m:k:D:z:v:r:CN:t:h")) != -1) {
+        switch (c) {
+            case 'H': opt.host = optarg; break;
+            case 'P': opt.port = atoi(optarg); break;
+            case 'c': opt.connections = atoi(optarg); break;
+            case 'd': opt.depth = atoi(optarg); break;
+            case 'n': opt.requests = strtoull(optarg, nullptr, 10); break;
+            case 'T': opt.duration = atoi(optarg); break;
+            case 'm':
+                if (!parseMix(optarg, &opt)) return 1;
+                break;
+            case 'k': opt.keys = strtoull(optarg, nullptr, 10); break;
+            case 'D':
+                if (strcmp(optarg, "uniform") == 0) {
+                    opt.dist = kDistUniform;
+                } else if (strcmp(optarg, "zipfian") == 0) {
+                    opt.dist = kDistZipfian;
+                } else if (strcmp(optarg, "sequential") == 0) {
+                    opt.dist = kDistSequential;
+                } else {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'z': opt.theta = atof(optarg); break;
+            case 'v': {
+                opt.value_min = atoi(optarg);
+                auto dash = strchr(optarg, '-');
+                opt.value_max = dash != nullptr ? atoi(dash + 1) : opt.value_min;
+                break;
+            }
+            case 'r': opt.range_id = strtoull(optarg, nullptr, 10); break;
+            case 'C': opt.create_range = true; break;
+            case 'N': opt.node_id = strtoull(optarg, nullptr, 10); break;
+            case 't': opt.timeout_ms = atoi(optarg); break;
+            default:
+                usage(argv[0]);
+                return c == 'h' ? 0 : 1;
+        }
+    }
+    if (opt.connections <= 0 || opt.depth <= 0 || opt.keys == 0 || opt.value_min < 0 ||
+        opt.value_max < opt.value_min || opt.theta <= 0 || opt.theta == 1.0 ||
+        std::accumulate(opt.weights, opt.weights + kOpNum, 0) <= 0 ||
+        (opt.duration <= 0 && opt.requests == 0)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    return runBench(opt) == 0 ? 0 : 1;
+}
@@ -2,7 +2,7 @@
 
 RaftMock::RaftMock(const RaftOptions& ops) : ops_(ops) {}
 
-Status RaftMock::Submit(std::string& cmd) {
+Status RaftMock::Submit(std::string& cmd, uint64_t trace_id) {
     ops_.statemachine->Apply(cmd, 1);
     return Status::OK();
 }
@@ -17,7 +17,7 @@ public:
     bool IsLeader() const override;
     Status TryToLeader() override { return Status::OK(); }
 
-    Status Submit(std::string& cmd) override ;
+    Status Submit(std::string& cmd, uint64_t trace_id = 0) override ;
     Status ChangeMemeber(const ConfChange& conf) override ;
 
     void GetStatus(RaftStatus* status) const override {}
@@ -1,6 +1,7 @@
 ﻿#include <gtest/gtest.h>
 #include "helper/cpp_permission.h"
 
+#include <mutex>
 #include <fastcommon/shared_func.h>
 #include "base/status.h"
 #include "base/util.h"
@@ -19,6 +20,7 @@
 
 #include "watch/watcher.h"
 #include "common/socket_base.h"
+#include "common/ds_proto.h"
 #include "test_public_funcs.h"
 
 //extern void EncodeWatchKey(std::string *buf, const uint64_t &tableId, const std::vector<std::string *> &keys);
@@ -49,8 +51,27 @@ class SocketBaseMock: public common::SocketBase {
 public:
     virtual int Send(response_buff_t *response) {
         FLOG_DEBUG("Send mock...session_id[%" PRId64 "] msg_id[%" PRId64 "] buff:%s", response->session_id, response->msg_id, response->buff);
+        std::lock_guard<std::mutex> lock(mutex_);
+        frames_.emplace_back(response->buff + header_size, response->buff_len - header_size);
         return 0;
     }
+
+    // 流式应答不扣减收包计数
+    virtual int SendBatch(response_buff_t *response, int requests) {
+        return Send(response);
+    }
+
+    bool LastFrame(google::protobuf::Message *resp) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (frames_.empty()) {
+            return false;
+        }
+        return resp->ParseFromString(frames_.back());
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::string> frames_;
 };
 
 
@@ -323,7 +344,7 @@ protected:
         }
     }
 
-    void justWatch(const int16_t &rangeId, const std::string key1, const std::string key2, const int64_t &timeout, const int64_t &version = 0, bool prefix = false)
+    void justWatch(const int16_t &rangeId, const std::string key1, const std::string key2, const int64_t &timeout, const int64_t &version = 0, bool prefix = false, bool stream = false)
     {
         FLOG_DEBUG("justWatch...range:%d key1:%s  key2:%s  prefix:%d", rangeId, key1.c_str(), key2.c_str(), prefix );
         auto raft = static_cast<RaftMock *>(range_server_->ranges_[rangeId]->raft_.get());
@@ -354,6 +375,7 @@ protected:
         ///////////////////////////////////////////////
         req.mutable_req()->set_startversion(version);
         req.mutable_req()->set_prefix(prefix);
+        req.mutable_req()->set_stream(stream);
 
         auto len = req.ByteSizeLong();
         msg->body.resize(len);
@@ -400,6 +422,28 @@ TEST_F(WatchTest, watch_exist_singlekey_test) {
 
 }
 
+TEST_F(WatchTest, watch_stream_singlekey_test) {
+    justPut(1, "01003001", "", "01003001:value");
+    // db版本比startVersion新，第一帧即为追平帧
+    justWatch(1, "01003001", "", 5000, 0, false, true);
+
+    watchpb::DsWatchResponse resp;
+    ASSERT_TRUE(socket_.LastFrame(&resp));
+    ASSERT_TRUE(resp.resp().code() == 0);
+    ASSERT_TRUE(resp.resp().watchid() > 0);
+    ASSERT_EQ(resp.resp().events_size(), 1);
+
+    auto &evt = resp.resp().events(0);
+    ASSERT_TRUE(evt.type() == watchpb::PUT);
+    ASSERT_TRUE(evt.has_kv());
+    ASSERT_EQ(evt.kv().key_size(), 1);
+    EXPECT_EQ(evt.kv().key(0), "01003001");
+    EXPECT_EQ(evt.kv().value(), "01003001:value");
+    EXPECT_TRUE(evt.kv().version() > 0);
+
+    justDel(1, "01003001", "", "");
+}
+
 TEST_F(WatchTest, watch_notexist_singlekey_test) {
     //justPut(1, "01003001", "", "01003001:value");
     //del exists key
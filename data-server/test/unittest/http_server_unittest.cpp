@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+
+#include "net/http_server.h"
+
+int main(int argc, char* argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace {
+
+using namespace sharkstore::dataserver::net;
+
+TEST(HttpServer, ParseRequest) {
+    HttpRequest req;
+    ASSERT_TRUE(HttpServer::ParseRequest("GET /metrics HTTP/1.1\r\nHost: a\r\n\r\n", &req));
+    ASSERT_EQ(req.method, "GET");
+    ASSERT_EQ(req.path, "/metrics");
+    ASSERT_TRUE(req.query.empty());
+
+    ASSERT_TRUE(HttpServer::ParseRequest("HEAD /metrics?a=1&b=2 HTTP/1.0\r\n\r\n", &req));
+    ASSERT_EQ(req.method, "HEAD");
+    ASSERT_EQ(req.path, "/metrics");
+    ASSERT_EQ(req.query, "a=1&b=2");
+}
+
+TEST(HttpServer, ParseMalformed) {
+    HttpRequest req;
+    // 没有请求行结束符
+    ASSERT_FALSE(HttpServer::ParseRequest("GET /metrics HTTP/1.1", &req));
+    // 缺少协议版本
+    ASSERT_FALSE(HttpServer::ParseRequest("GET /metrics\r\nHost: a\r\n\r\n", &req));
+    // 空的请求路径
+    ASSERT_FALSE(HttpServer::ParseRequest("GET  HTTP/1.1\r\n\r\n", &req));
+    // 路径不是以/开头
+    ASSERT_FALSE(HttpServer::ParseRequest("GET metrics HTTP/1.1\r\n\r\n", &req));
+    ASSERT_FALSE(HttpServer::ParseRequest(" /metrics HTTP/1.1\r\n\r\n", &req));
+    ASSERT_FALSE(HttpServer::ParseRequest("GET /metrics FTP/1.1\r\n\r\n", &req));
+}
+
+} /* namespace  */
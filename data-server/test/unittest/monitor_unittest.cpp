@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
 
+#include <thread>
+
 #include "monitor/isystemstatus.h"
 #include "monitor/statistics.h"
+#include "monitor/tracer.h"
 
 int main(int argc, char* argv[]) {
     testing::InitGoogleTest(&argc, argv);
@@ -28,4 +31,158 @@ TEST(Monitor, Statistics) {
     s.ToString();
 }
 
+TEST(Monitor, FuncStatistics) {
+    Statistics s;
+    s.PushTime(HistogramType::kQWait, 100, 10);
+    s.PushTime(HistogramType::kQWait, 300, 10);
+    s.PushTime(HistogramType::kStore, 50, 1);
+    s.PushTime(HistogramType::kStore, 70);
+    s.PushTime(HistogramType::kStore, 80, Statistics::kMaxFuncID);
+
+    ASSERT_EQ(s.FuncIDs(), std::vector<int>({1, 10}));
+
+    HistogramData data;
+    ASSERT_TRUE(s.GetFuncData(10, HistogramType::kQWait, &data));
+    ASSERT_EQ(data.count, 2U);
+    ASSERT_EQ(data.max, 300);
+    ASSERT_TRUE(s.GetFuncData(10, HistogramType::kStore, &data));
+    ASSERT_EQ(data.count, 0U);
+    ASSERT_FALSE(s.GetFuncData(2, HistogramType::kStore, &data));
+
+    s.GetData(HistogramType::kStore, &data);
+    ASSERT_EQ(data.count, 3U);
+
+    // Reset只清空全局统计
+    s.Reset();
+    s.GetData(HistogramType::kQWait, &data);
+    ASSERT_EQ(data.count, 0U);
+    ASSERT_TRUE(s.GetFuncData(1, HistogramType::kStore, &data));
+    ASSERT_EQ(data.count, 1U);
+}
+
+TEST(Monitor, ShardedStatistics) {
+    Statistics s;
+    const int kThreads = 8;
+    const int kCount = 10000;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i) {
+        threads.emplace_back([&s, i] {
+            for (int j = 1; j <= kCount; ++j) {
+                s.PushTime(HistogramType::kStore, static_cast<uint64_t>(j), i);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    // 各线程分片合并后不丢失记录，线程退出后统计仍然保留
+    HistogramData data;
+    s.GetData(HistogramType::kStore, &data);
+    ASSERT_EQ(data.count, static_cast<uint64_t>(kThreads * kCount));
+    ASSERT_EQ(data.max, kCount);
+    ASSERT_NEAR(data.average, (kCount + 1) / 2.0, 0.01);
+    ASSERT_NEAR(data.median, kCount / 2.0, kCount * 0.1);
+    for (int i = 0; i < kThreads; ++i) {
+        ASSERT_TRUE(s.GetFuncData(i, HistogramType::kStore, &data));
+        ASSERT_EQ(data.count, static_cast<uint64_t>(kCount));
+    }
+
+    // 不同的实例互不影响
+    Statistics other;
+    other.PushTime(HistogramType::kStore, 1);
+    s.PushTime(HistogramType::kStore, 1);
+    other.GetData(HistogramType::kStore, &data);
+    ASSERT_EQ(data.count, 1U);
+    s.GetData(HistogramType::kStore, &data);
+    ASSERT_EQ(data.count, static_cast<uint64_t>(kThreads * kCount + 1));
+}
+
+TEST(Monitor, TracerSample) {
+    Tracer t;
+    // 默认不采样
+    ASSERT_EQ(t.Start(1, 1, 0, 100), 0U);
+
+    t.SetNodeID(3);
+    t.SetOptions(4, 1000, 10);
+    std::vector<uint64_t> ids;
+    for (int i = 0; i < 8; ++i) {
+        auto id = t.Start(0, 1, 0, 100);
+        if (id != 0) ids.push_back(id);
+    }
+    ASSERT_EQ(ids.size(), 2U);
+    // 生成的id高位为节点id
+    ASSERT_EQ(ids[0] >> 48, 3U);
+    ASSERT_NE(ids[0], ids[1]);
+
+    // 请求头中带了trace_id使用请求的
+    t.SetOptions(1, 1000, 10);
+    ASSERT_EQ(t.Start(12345, 1, 0, 100), 12345U);
+    // 相同的trace_id正在追踪，不重复采样
+    ASSERT_EQ(t.Start(12345, 1, 0, 100), 0U);
+
+    TracerStats stats;
+    t.GetStats(&stats);
+    ASSERT_EQ(stats.sampled, 3U);
+    ASSERT_EQ(stats.active, 3U);
+}
+
+TEST(Monitor, TracerSlow) {
+    Tracer t;
+    t.SetOptions(1, 1000, 2);
+
+    // leader: 快的请求不保留
+    auto fast = t.Start(1, 10, 5, 100);
+    ASSERT_EQ(fast, 1U);
+    t.Record(fast, "propose", 200);
+    t.Finish(fast, "reply", 500);
+    ASSERT_TRUE(t.GetSlowTraces().empty());
+    Trace trace;
+    ASSERT_FALSE(t.GetTrace(fast, &trace));
+
+    auto slow = t.Start(2, 10, 5, 100);
+    t.Record(slow, "propose", 200);
+    t.Record(slow, "ack", 800, 2);
+    t.Finish(slow, "reply", 2100);
+    // 结束后的记录忽略
+    t.Record(slow, "applied", 2200);
+
+    ASSERT_TRUE(t.GetTrace(slow, &trace));
+    ASSERT_TRUE(trace.origin);
+    ASSERT_EQ(trace.range_id, 10U);
+    ASSERT_EQ(trace.func_id, 5);
+    ASSERT_EQ(trace.Duration(), 2000);
+    ASSERT_EQ(trace.spans.size(), 4U);
+    ASSERT_STREQ(trace.spans[0].stage, "recv");
+    ASSERT_STREQ(trace.spans[2].stage, "ack");
+    ASSERT_EQ(trace.spans[2].node, 2U);
+    ASSERT_STREQ(trace.spans[3].stage, "reply");
+
+    // follower: 只在FinishFollower时结束，leader上的追踪不受影响
+    t.Join(3, 10, 100, 1);
+    t.Record(3, "persist", 900);
+    auto leader = t.Start(4, 10, 5, 100);
+    t.FinishFollower(leader, "applied", 5000);
+    t.FinishFollower(3, "applied", 1500);
+    ASSERT_TRUE(t.GetTrace(leader, &trace));
+    ASSERT_EQ(trace.end, 0);
+    t.Finish(leader, "timeout", 9000);
+
+    // 环形缓冲只保留最新的2个，最新的在前
+    auto traces = t.GetSlowTraces();
+    ASSERT_EQ(traces.size(), 2U);
+    ASSERT_EQ(traces[0].trace_id, 4U);
+    ASSERT_STREQ(traces[0].spans.back().stage, "timeout");
+    ASSERT_EQ(traces[1].trace_id, 3U);
+    ASSERT_FALSE(traces[1].origin);
+    ASSERT_STREQ(traces[1].spans[0].stage, "receive");
+    ASSERT_EQ(traces[1].spans[0].node, 1U);
+
+    TracerStats stats;
+    t.GetStats(&stats);
+    ASSERT_EQ(stats.finished, 4U);
+    ASSERT_EQ(stats.slow, 3U);
+    ASSERT_EQ(stats.active, 0U);
+}
+
 } /* namespace  */
@@ -0,0 +1,273 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <asio/executor_work_guard.hpp>
+#include <asio/io_context.hpp>
+#include <asio/post.hpp>
+#include <asio/read.hpp>
+#include <asio/write.hpp>
+
+#include "net/session.h"
+
+int main(int argc, char* argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace {
+
+using namespace sharkstore::dataserver::net;
+
+// 通过本地连接驱动一个Session：client端同步收发，请求交给测试决定何时应答
+class SessionTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        if (session_ != nullptr) {
+            asio::post(io_, [this] { session_.reset(); });
+        }
+        asio::error_code ec;
+        client_.close(ec);
+        work_.reset();
+        if (io_thread_.joinable()) io_thread_.join();
+    }
+
+    void start() {
+        asio::ip::tcp::acceptor acceptor(
+            io_, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+        asio::ip::tcp::socket socket(io_);
+        client_.connect(acceptor.local_endpoint());
+        acceptor.accept(socket);
+
+        handler_ = [this](const Context&, const MessagePtr& msg) {
+            std::lock_guard<std::mutex> lock(mu_);
+            requests_.push_back(msg);
+            cond_.notify_all();
+        };
+        session_ = std::make_shared<Session>(opt_, handler_, std::move(socket));
+        session_->Start();
+        io_thread_ = std::thread([this] { io_.run(); });
+    }
+
+    void sendRequest(uint8_t stream, uint64_t msg_id, uint32_t timeout = 0) {
+        Head head;
+        head.msg_type = kDataRequestType;
+        head.func_id = 1;
+        head.msg_id = msg_id;
+        head.stream_hash = static_cast<uint8_t>(stream << kStreamShift);
+        head.timeout = timeout;
+        head.body_length = 1;
+        head.Encode();
+        std::string data(reinterpret_cast<const char*>(&head), sizeof(head));
+        data.push_back('x');
+        asio::write(client_, asio::buffer(data));
+    }
+
+    // 等待session读到count个请求
+    bool waitRequests(size_t count, int timeout_ms = 3000) {
+        std::unique_lock<std::mutex> lock(mu_);
+        return cond_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                              [this, count] { return requests_.size() >= count; });
+    }
+
+    size_t requestCount() {
+        std::lock_guard<std::mutex> lock(mu_);
+        return requests_.size();
+    }
+
+    MessagePtr newResponse(uint64_t msg_id, uint8_t stream, size_t body_size = 1) {
+        auto msg = NewMessage();
+        msg->head.msg_type = kDataResponseType;
+        msg->head.func_id = 1;
+        msg->head.msg_id = msg_id;
+        msg->head.stream_hash = static_cast<uint8_t>(stream << kStreamShift);
+        msg->body.assign(body_size, 'r');
+        return msg;
+    }
+
+    void respond(uint64_t msg_id, uint8_t stream, size_t body_size = 1) {
+        session_->Write(newResponse(msg_id, stream, body_size));
+    }
+
+    // 读一个应答，返回其head
+    Head readResponse() {
+        Head head;
+        asio::read(client_, asio::buffer(&head, sizeof(head)));
+        head.Decode();
+        std::vector<char> body(head.body_length);
+        asio::read(client_, asio::buffer(body));
+        return head;
+    }
+
+    // 等待ms毫秒后是否有数据可读
+    bool readable(int ms) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        return client_.available() > 0;
+    }
+
+protected:
+    SessionOptions opt_;
+    Handler handler_;
+
+    asio::io_context io_;
+    std::unique_ptr<asio::executor_work_guard<asio::io_context::executor_type>> work_{
+        new asio::executor_work_guard<asio::io_context::executor_type>(io_.get_executor())};
+    std::thread io_thread_;
+    asio::io_context client_io_;
+    asio::ip::tcp::socket client_{client_io_};
+    std::shared_ptr<Session> session_;
+
+    std::mutex mu_;
+    std::condition_variable cond_;
+    std::vector<MessagePtr> requests_;
+};
+
+TEST_F(SessionTest, OutOfOrder) {
+    start();
+    for (uint64_t i = 1; i <= 3; ++i) {
+        sendRequest(1, i);
+    }
+    sendRequest(0, 10);
+    ASSERT_TRUE(waitRequests(4));
+
+    // 有序stream的应答按请求顺序写出，先到的应答等待前面的请求
+    respond(3, 1);
+    respond(2, 1);
+    ASSERT_FALSE(readable(50));
+
+    // stream 0不排序
+    respond(10, 0);
+    auto head = readResponse();
+    ASSERT_EQ(head.msg_id, 10U);
+    ASSERT_EQ(head.StreamID(), 0);
+
+    respond(1, 1);
+    for (uint64_t i = 1; i <= 3; ++i) {
+        head = readResponse();
+        ASSERT_EQ(head.msg_id, i);
+        ASSERT_EQ(head.StreamID(), 1);
+    }
+}
+
+TEST_F(SessionTest, WindowResume) {
+    opt_.stream_window = 4;
+    start();
+    for (uint64_t i = 1; i <= 10; ++i) {
+        sendRequest(1, i);
+    }
+
+    // 窗口用完后暂停读取
+    ASSERT_TRUE(waitRequests(4));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(requestCount(), 4U);
+
+    // 降到窗口一半以下才恢复
+    respond(1, 1);
+    respond(2, 1);
+    readResponse();
+    readResponse();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(requestCount(), 4U);
+
+    respond(3, 1);
+    readResponse();
+    ASSERT_TRUE(waitRequests(7));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(requestCount(), 7U);
+
+    for (uint64_t i = 4; i <= 10; ++i) {
+        if (i > 7) {
+            ASSERT_TRUE(waitRequests(i));
+        }
+        respond(i, 1);
+        ASSERT_EQ(readResponse().msg_id, i);
+    }
+    ASSERT_EQ(requestCount(), 10U);
+}
+
+TEST_F(SessionTest, WindowOne) {
+    // 窗口为1时一半为0，仍要在应答后恢复读取
+    opt_.stream_window = 1;
+    start();
+    for (uint64_t i = 1; i <= 3; ++i) {
+        sendRequest(1, i);
+    }
+
+    for (uint64_t i = 1; i <= 3; ++i) {
+        ASSERT_TRUE(waitRequests(i));
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        ASSERT_EQ(requestCount(), i);
+        respond(i, 1);
+        ASSERT_EQ(readResponse().msg_id, i);
+    }
+}
+
+TEST_F(SessionTest, FairWrite) {
+    opt_.stream_quantum = 1000;
+    start();
+
+    // stream 1排队多个大应答后stream 2的小应答才到，轮转时不用等stream 1写完
+    const int kLarge = 8;
+    std::mutex mu;
+    std::condition_variable cond;
+    bool queued = false;
+    asio::post(io_, [&] {
+        for (int i = 1; i <= kLarge; ++i) {
+            respond(i, 1, 4000);
+        }
+        respond(100, 2, 10);
+        std::lock_guard<std::mutex> lock(mu);
+        queued = true;
+        cond.notify_one();
+    });
+    {
+        std::unique_lock<std::mutex> lock(mu);
+        cond.wait(lock, [&queued] { return queued; });
+    }
+
+    std::vector<uint64_t> ids;
+    for (int i = 0; i <= kLarge; ++i) {
+        ids.push_back(readResponse().msg_id);
+    }
+    auto pos = std::find(ids.begin(), ids.end(), 100U) - ids.begin();
+    ASSERT_LE(pos, 2);
+
+    // stream 1自身的顺序不变
+    uint64_t expect = 1;
+    for (auto id : ids) {
+        if (id == 100) continue;
+        ASSERT_EQ(id, expect++);
+    }
+}
+
+TEST_F(SessionTest, StreamTimeout) {
+    opt_.stream_timeout_ms = 100;
+    start();
+    sendRequest(1, 1);
+    sendRequest(1, 2);
+    sendRequest(1, 3, 2000);
+    sendRequest(1, 4);
+    ASSERT_TRUE(waitRequests(4));
+
+    // 请求1一直没有应答，超时后不再挡住后面的应答
+    respond(2, 1);
+    ASSERT_FALSE(readable(20));
+    auto head = readResponse();
+    ASSERT_EQ(head.msg_id, 2U);
+
+    // 请求3带了更长的超时，期间仍然挡住请求4
+    respond(4, 1);
+    ASSERT_FALSE(readable(300));
+    respond(3, 1);
+    ASSERT_EQ(readResponse().msg_id, 3U);
+    ASSERT_EQ(readResponse().msg_id, 4U);
+
+    // 已经超时清理的请求，迟到的应答直接写出
+    respond(1, 1);
+    ASSERT_EQ(readResponse().msg_id, 1U);
+}
+
+} /* namespace  */
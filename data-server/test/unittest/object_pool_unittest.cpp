@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "common/object_pool.h"
+#include "common/socket_message.h"
+
+int main(int argc, char* argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace {
+
+using namespace sharkstore::dataserver::common;
+
+ObjectPool::Stats findStats(const std::string& name) {
+    for (const auto& s : ObjectPool::AllStats()) {
+        if (s.name == name) return s;
+    }
+    return ObjectPool::Stats();
+}
+
+TEST(ObjectPool, Reuse) {
+    auto pool = ObjectPool::Create("test_reuse", 40);
+    ASSERT_EQ(pool->ObjectSize(), 40U);
+
+    auto p1 = pool->Alloc();
+    auto p2 = pool->Alloc();
+    ASSERT_NE(p1, p2);
+    pool->Free(p1);
+    // 同一线程释放后再分配，复用缓存的对象
+    ASSERT_EQ(pool->Alloc(), p1);
+    pool->Free(p1);
+    pool->Free(p2);
+
+    auto stats = pool->GetStats();
+    ASSERT_EQ(stats.name, "test_reuse");
+    ASSERT_EQ(stats.alloc_count, 3U);
+    ASSERT_EQ(stats.free_count, 3U);
+    ASSERT_EQ(stats.in_use, 0U);
+    ASSERT_EQ(stats.create_count, 2U);
+}
+
+TEST(ObjectPool, CrossThread) {
+    auto pool = ObjectPool::Create("test_cross", 64);
+
+    // 一个线程分配，另一个线程释放
+    const int kCount = 10000;
+    std::vector<void*> objs;
+    for (int i = 0; i < kCount; ++i) {
+        objs.push_back(pool->Alloc());
+    }
+    std::thread t([&] {
+        for (auto p : objs) {
+            pool->Free(p);
+        }
+    });
+    t.join();
+
+    auto stats = pool->GetStats();
+    ASSERT_EQ(stats.alloc_count, static_cast<uint64_t>(kCount));
+    ASSERT_EQ(stats.free_count, static_cast<uint64_t>(kCount));
+    ASSERT_EQ(stats.in_use, 0U);
+    ASSERT_EQ(stats.create_count, static_cast<uint64_t>(kCount));
+    // 释放线程已退出，缓存全部归还到共享链表
+    ASSERT_EQ(stats.shared_free, static_cast<uint64_t>(kCount));
+
+    // 再次分配从共享链表取，不再向系统申请
+    std::set<void*> reused;
+    for (int i = 0; i < kCount; ++i) {
+        reused.insert(pool->Alloc());
+    }
+    ASSERT_EQ(reused.size(), static_cast<size_t>(kCount));
+    stats = pool->GetStats();
+    ASSERT_EQ(stats.create_count, static_cast<uint64_t>(kCount));
+    ASSERT_EQ(stats.in_use, static_cast<uint64_t>(kCount));
+    for (auto p : reused) {
+        pool->Free(p);
+    }
+}
+
+// 析构时才释放对象的thread_local对象
+struct ExitHolder {
+    ObjectPool* pool = nullptr;
+    void* obj = nullptr;
+
+    ~ExitHolder() {
+        if (pool == nullptr) return;
+        pool->Free(obj);
+        pool->Free(pool->Alloc());
+    }
+};
+
+TEST(ObjectPool, ThreadExit) {
+    auto pool = ObjectPool::Create("test_exit", 32);
+
+    std::thread t([pool] {
+        // 先于线程缓存构造，线程退出时在线程缓存之后析构
+        thread_local ExitHolder holder;
+        holder.pool = pool;
+        holder.obj = pool->Alloc();
+    });
+    t.join();
+
+    auto stats = pool->GetStats();
+    ASSERT_EQ(stats.alloc_count, 2U);
+    ASSERT_EQ(stats.free_count, 2U);
+    ASSERT_EQ(stats.in_use, 0U);
+    ASSERT_EQ(stats.create_count, 1U);
+    ASSERT_EQ(stats.shared_free, 1U);
+
+    // 归还的对象可以再次分配
+    auto p = pool->Alloc();
+    ASSERT_EQ(pool->GetStats().create_count, 1U);
+    pool->Free(p);
+}
+
+TEST(ObjectPool, ProtoMessage) {
+    auto before = findStats("proto_message");
+
+    auto msg = new ProtoMessage;
+    msg->body.assign(10, 'a');
+    auto copy = new ProtoMessage(*msg);
+    ASSERT_EQ(copy->body.size(), 10U);
+    delete msg;
+    delete copy;
+
+    auto after = findStats("proto_message");
+    ASSERT_EQ(after.object_size, sizeof(ProtoMessage));
+    ASSERT_EQ(after.alloc_count - before.alloc_count, 2U);
+    ASSERT_EQ(after.free_count - before.free_count, 2U);
+}
+
+} /* namespace  */
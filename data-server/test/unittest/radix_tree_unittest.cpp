@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <set>
+
+#include "common/ds_encoding.h"
+#include "watch/radix_tree.h"
+
+int main(int argc, char* argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace {
+
+using namespace sharkstore::dataserver;
+using namespace sharkstore::dataserver::watch;
+
+std::vector<std::string> prefixesOf(RadixTree<int>& tree, const std::string& key) {
+    std::vector<std::string> result;
+    tree.ForEachPrefix(key, [&](size_t len, int& v) {
+        result.push_back(key.substr(0, len));
+        EXPECT_EQ(v, static_cast<int>(len));
+    });
+    return result;
+}
+
+TEST(RadixTree, Basic) {
+    RadixTree<int> tree;
+    ASSERT_TRUE(tree.Empty());
+    ASSERT_EQ(tree.Find("a"), nullptr);
+
+    ASSERT_TRUE(tree.Insert("abc", 3).second);
+    ASSERT_TRUE(tree.Insert("ab", 2).second);
+    ASSERT_TRUE(tree.Insert("abd", 3).second);
+    ASSERT_TRUE(tree.Insert("a", 1).second);
+    ASSERT_TRUE(tree.Insert("", 0).second);
+    ASSERT_EQ(tree.Size(), 5U);
+
+    // 已存在不覆盖
+    auto ret = tree.Insert("ab", 100);
+    ASSERT_FALSE(ret.second);
+    ASSERT_EQ(*ret.first, 2);
+
+    ASSERT_EQ(*tree.Find("abc"), 3);
+    ASSERT_EQ(tree.Find("abcd"), nullptr);
+    ASSERT_EQ(tree.Find("b"), nullptr);
+
+    std::vector<std::string> expected{"", "a", "ab", "abc"};
+    ASSERT_EQ(prefixesOf(tree, "abcde"), expected);
+    expected = {"", "a", "ab"};
+    ASSERT_EQ(prefixesOf(tree, "abe"), expected);
+
+    ASSERT_TRUE(tree.Erase("ab"));
+    ASSERT_FALSE(tree.Erase("ab"));
+    ASSERT_FALSE(tree.Erase("abcd"));
+    ASSERT_EQ(tree.Find("ab"), nullptr);
+    ASSERT_EQ(*tree.Find("abc"), 3);
+    ASSERT_EQ(*tree.Find("abd"), 3);
+    expected = {"", "a", "abc"};
+    ASSERT_EQ(prefixesOf(tree, "abc"), expected);
+
+    ASSERT_TRUE(tree.Erase("abc"));
+    ASSERT_TRUE(tree.Erase("abd"));
+    ASSERT_TRUE(tree.Erase("a"));
+    ASSERT_TRUE(tree.Erase(""));
+    ASSERT_TRUE(tree.Empty());
+    ASSERT_TRUE(prefixesOf(tree, "abc").empty());
+}
+
+TEST(RadixTree, EncodedKeys) {
+    // 编码后每个分量都有结束符，"ab"不会匹配到"abc"下面的key
+    auto encode = [](const std::vector<std::string>& keys) {
+        std::string buf;
+        for (const auto& k : keys) {
+            EncodeBytesAscending(&buf, k.data(), k.size());
+        }
+        return buf;
+    };
+
+    RadixTree<int> tree;
+    tree.Insert(encode({"ab"}), 1);
+    tree.Insert(encode({"abc"}), 1);
+    tree.Insert(encode({"abc", "x"}), 2);
+    tree.Insert(encode({"abc", "x", "y"}), 3);
+
+    int count = 0;
+    tree.ForEachPrefix(encode({"abc", "x", "y", "z"}), [&](size_t, int&) { ++count; });
+    ASSERT_EQ(count, 3);
+
+    count = 0;
+    tree.ForEachPrefix(encode({"ab", "x"}), [&](size_t, int&) { ++count; });
+    ASSERT_EQ(count, 1);
+
+    count = 0;
+    tree.ForEachPrefix(encode({"abc", "xy"}), [&](size_t, int&) { ++count; });
+    ASSERT_EQ(count, 1);
+}
+
+TEST(RadixTree, Random) {
+    std::mt19937 rnd(0);
+    auto randomKey = [&rnd]() {
+        std::string key;
+        size_t len = rnd() % 8;
+        for (size_t i = 0; i < len; ++i) {
+            // 字母表小一些，多产生公共前缀
+            key.push_back(static_cast<char>("ab\x00\xff"[rnd() % 4]));
+        }
+        return key;
+    };
+
+    RadixTree<int> tree;
+    std::map<std::string, int> expected;
+    for (int i = 0; i < 20000; ++i) {
+        auto key = randomKey();
+        switch (rnd() % 3) {
+            case 0: {
+                auto ret = tree.Insert(key, i);
+                auto exp = expected.emplace(key, i);
+                ASSERT_EQ(ret.second, exp.second);
+                ASSERT_EQ(*ret.first, exp.first->second);
+                break;
+            }
+            case 1:
+                ASSERT_EQ(tree.Erase(key), expected.erase(key) > 0);
+                break;
+            default: {
+                std::vector<std::string> found;
+                tree.ForEachPrefix(key, [&](size_t len, int& v) {
+                    found.push_back(key.substr(0, len));
+                    ASSERT_EQ(v, expected[key.substr(0, len)]);
+                });
+                std::vector<std::string> want;
+                for (size_t len = 0; len <= key.size(); ++len) {
+                    if (expected.count(key.substr(0, len)) > 0) {
+                        want.push_back(key.substr(0, len));
+                    }
+                }
+                ASSERT_EQ(found, want);
+                break;
+            }
+        }
+        ASSERT_EQ(tree.Size(), expected.size());
+    }
+
+    std::set<int> values;
+    tree.ForEach([&](int& v) { values.insert(v); });
+    ASSERT_EQ(values.size(), expected.size());
+    for (auto& kv : expected) {
+        ASSERT_EQ(*tree.Find(kv.first), kv.second);
+        ASSERT_TRUE(values.count(kv.second) > 0);
+    }
+}
+
+} /* namespace  */
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include "common/socket_message.h"
+#include "proto/gen/watchpb.pb.h"
+
+int main(int argc, char* argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace {
+
+using namespace sharkstore::dataserver;
+
+TEST(SocketMessage, PeekRangeId) {
+    uint64_t range_id = 0;
+
+    kvrpcpb::DsKvRawGetRequest get;
+    get.mutable_header()->set_cluster_id(1);
+    get.mutable_header()->mutable_range_epoch()->set_version(3);
+    get.mutable_header()->set_range_id(12345678901ULL);
+    get.mutable_req()->set_key("key");
+    auto data = get.SerializeAsString();
+    ASSERT_TRUE(common::PeekRangeId(data.data(), data.size(), &range_id));
+    ASSERT_EQ(range_id, 12345678901ULL);
+
+    watchpb::DsWatchRequest watch;
+    watch.mutable_header()->set_range_id(7);
+    watch.mutable_req()->mutable_kv()->add_key("a");
+    data = watch.SerializeAsString();
+    ASSERT_TRUE(common::PeekRangeId(data.data(), data.size(), &range_id));
+    ASSERT_EQ(range_id, 7U);
+
+    // 没有header或者header中没有range_id
+    kvrpcpb::DsKvRawGetRequest no_header;
+    no_header.mutable_req()->set_key("key");
+    data = no_header.SerializeAsString();
+    ASSERT_FALSE(common::PeekRangeId(data.data(), data.size(), &range_id));
+    no_header.mutable_header()->set_cluster_id(1);
+    data = no_header.SerializeAsString();
+    ASSERT_FALSE(common::PeekRangeId(data.data(), data.size(), &range_id));
+    ASSERT_FALSE(common::PeekRangeId(nullptr, 0, &range_id));
+
+    // 数据不完整
+    data = get.SerializeAsString();
+    ASSERT_FALSE(common::PeekRangeId(data.data(), 3, &range_id));
+}
+
+TEST(SocketMessage, BodyRef) {
+    kvrpcpb::DsKvRawGetRequest get;
+    get.mutable_header()->set_range_id(3);
+    get.mutable_req()->set_key("key");
+    auto buf = std::make_shared<std::string>(get.SerializeAsString());
+
+    common::ProtoMessage msg;
+    msg.body.resize(10);
+    msg.SetBodyRef(buf, buf->data(), buf->size());
+    ASSERT_EQ(msg.body.capacity(), 0U);
+    ASSERT_EQ(msg.BodyData(), buf->data());
+    ASSERT_EQ(msg.BodySize(), buf->size());
+    ASSERT_EQ(buf.use_count(), 2);
+
+    kvrpcpb::DsKvRawGetRequest req;
+    ASSERT_TRUE(common::GetMessage(msg.BodyData(), msg.BodySize(), &req));
+    ASSERT_EQ(req.header().range_id(), 3U);
+    ASSERT_EQ(req.req().key(), "key");
+
+    // 拷贝的消息共享同一个缓冲
+    common::ProtoMessage copy(msg);
+    ASSERT_EQ(copy.BodyData(), buf->data());
+    ASSERT_EQ(buf.use_count(), 3);
+
+    msg.ReleaseBody();
+    ASSERT_EQ(msg.BodySize(), 0U);
+    ASSERT_EQ(buf.use_count(), 2);
+    copy.ReleaseBody();
+    ASSERT_EQ(buf.use_count(), 1);
+
+    // 没有引用缓冲时使用body
+    common::ProtoMessage owned;
+    owned.body.assign(buf->begin(), buf->end());
+    ASSERT_EQ(owned.BodyData(), owned.body.data());
+    ASSERT_EQ(owned.BodySize(), buf->size());
+}
+
+} /* namespace  */
@@ -0,0 +1,261 @@
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/ds_config.h"
+#include "common/ds_proto.h"
+#include "common/socket_uring_server.h"
+#include "frame/sf_socket_buff.h"
+
+int main(int argc, char* argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace {
+
+using namespace sharkstore::dataserver::common;
+
+// 本地连接驱动UringSocketServer：收到的请求原样返回，
+// response_size不为0时返回body为该大小的应答，用来填满不读的client的接收缓冲
+class UringServerTest : public ::testing::Test {
+protected:
+    static UringSocketServer* server_;
+    static size_t response_size_;
+
+    void SetUp() override {
+        supported_ = UringSocketServer::Supported();
+        if (!supported_) {
+            std::cerr << "kernel does not support io_uring multishot recv, skip" << std::endl;
+            return;
+        }
+
+        ds_config.net_config.ring_entries = 256;
+        ds_config.net_config.buff_count = 64;
+        ds_config.net_config.buff_size = 4096;
+        sf_config.socket_config.max_pkg_size = 1024 * 1024;
+        sf_config.socket_config.max_connections = 100;
+        sf_config.socket_config.network_timeout = 0;
+        sf_config.socket_config.socket_keep_time = 0;
+        response_size_ = 0;
+
+        memset(&config_, 0, sizeof(config_));
+        strcpy(config_.ip_addr, "127.0.0.1");
+        config_.port = freePort();
+        config_.event_recv_threads = 1;
+        strcpy(config_.thread_name_prefix, "ut");
+        memset(&status_, 0, sizeof(status_));
+    }
+
+    void TearDown() override {
+        for (auto fd : clients_) {
+            close(fd);
+        }
+        if (server_ != nullptr) {
+            server_->Stop();
+            delete server_;
+            server_ = nullptr;
+        }
+    }
+
+    void start() {
+        server_ = new UringSocketServer;
+        server_->Init(&config_, &status_);
+        server_->set_recv_done(echo);
+        ASSERT_EQ(server_->Start(), 0);
+    }
+
+    static void echo(request_buff_t* request, void*) {
+        auto len = request->buff_len;
+        if (response_size_ > 0) {
+            len = static_cast<int32_t>(header_size + response_size_);
+        }
+        auto response = new_response_buff(len);
+        memset(response->buff, 'r', len);
+        memcpy(response->buff, request->buff, header_size);
+        if (response_size_ > 0) {
+            ds_header_t header;
+            ds_unserialize_header(reinterpret_cast<ds_proto_header_t*>(request->buff), &header);
+            header.body_len = static_cast<int>(response_size_);
+            ds_serialize_header(&header, reinterpret_cast<ds_proto_header_t*>(response->buff));
+        } else {
+            memcpy(response->buff, request->buff, len);
+        }
+        response->buff_len = len;
+        response->session_id = request->session_id;
+        server_->Send(response);
+    }
+
+    static int freePort() {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        bind(fd, reinterpret_cast<struct sockaddr*>(&addr), len);
+        getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &len);
+        close(fd);
+        return ntohs(addr.sin_port);
+    }
+
+    int connectServer(int rcvbuf = 0) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (rcvbuf > 0) {
+            setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+        }
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(config_.port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+        clients_.push_back(fd);
+        return fd;
+    }
+
+    static std::string newRequest(int64_t msg_id, const std::string& body) {
+        ds_header_t header;
+        memset(&header, 0, sizeof(header));
+        header.magic_number = DS_PROTO_MAGIC_NUMBER;
+        header.version = DS_PROTO_VERSION_CURRENT;
+        header.msg_type = DS_PROTO_FID_RPC_REQ;
+        header.func_id = 1;
+        header.msg_id = msg_id;
+        header.body_len = static_cast<int>(body.size());
+        std::string data(header_size, '\0');
+        ds_serialize_header(&header, reinterpret_cast<ds_proto_header_t*>(&data[0]));
+        return data + body;
+    }
+
+    static bool writeAll(int fd, const std::string& data) {
+        size_t off = 0;
+        while (off < data.size()) {
+            auto n = write(fd, data.data() + off, data.size() - off);
+            if (n <= 0) return false;
+            off += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    static bool readAll(int fd, size_t len, std::string* data) {
+        data->resize(len);
+        size_t off = 0;
+        while (off < len) {
+            auto n = read(fd, &(*data)[off], len - off);
+            if (n <= 0) return false;
+            off += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // 等待服务端关闭连接，超时返回false
+    static bool waitClosed(int fd, int timeout_ms) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        char buf[65536];
+        while (std::chrono::steady_clock::now() < deadline) {
+            struct pollfd pfd = {fd, POLLIN, 0};
+            if (poll(&pfd, 1, 100) <= 0) continue;
+            auto n = read(fd, buf, sizeof(buf));
+            if (n <= 0) return true;
+        }
+        return false;
+    }
+
+protected:
+    bool supported_ = false;
+    sf_socket_thread_config_t config_;
+    sf_socket_status_t status_;
+    std::vector<int> clients_;
+};
+
+UringSocketServer* UringServerTest::server_ = nullptr;
+size_t UringServerTest::response_size_ = 0;
+
+TEST_F(UringServerTest, Echo) {
+    if (!supported_) return;
+    start();
+    int fd = connectServer();
+    ASSERT_GE(fd, 0);
+
+    // 多个请求一次写入，以及跨接收缓冲的大请求
+    std::string data;
+    std::vector<std::string> requests;
+    for (int i = 1; i <= 10; ++i) {
+        requests.push_back(newRequest(i, std::string(static_cast<size_t>(i) * 100, 'a' + i)));
+        data += requests.back();
+    }
+    requests.push_back(newRequest(11, std::string(20000, 'z')));
+    data += requests.back();
+    ASSERT_TRUE(writeAll(fd, data));
+
+    for (const auto& req : requests) {
+        std::string resp;
+        ASSERT_TRUE(readAll(fd, req.size(), &resp));
+        ASSERT_EQ(resp, req);
+    }
+    ASSERT_EQ(status_.current_connections, 1U);
+}
+
+TEST_F(UringServerTest, KeepAlive) {
+    if (!supported_) return;
+    sf_config.socket_config.socket_keep_time = 2;
+    start();
+    int fd = connectServer();
+    ASSERT_GE(fd, 0);
+
+    // 一直有请求的连接超过socket_keep_time也不关闭
+    for (int i = 1; i <= 8; ++i) {
+        auto req = newRequest(i, "ping");
+        ASSERT_TRUE(writeAll(fd, req));
+        std::string resp;
+        ASSERT_TRUE(readAll(fd, req.size(), &resp));
+        ASSERT_EQ(resp, req);
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+    ASSERT_EQ(status_.recv_timeout_count, 0U);
+    ASSERT_EQ(status_.current_connections, 1U);
+}
+
+TEST_F(UringServerTest, IdleTimeout) {
+    if (!supported_) return;
+    sf_config.socket_config.socket_keep_time = 1;
+    start();
+    int fd = connectServer();
+    ASSERT_GE(fd, 0);
+
+    ASSERT_TRUE(waitClosed(fd, 5000));
+    ASSERT_EQ(status_.recv_timeout_count, 1U);
+    ASSERT_EQ(status_.current_connections, 0U);
+}
+
+TEST_F(UringServerTest, StalledReader) {
+    if (!supported_) return;
+    sf_config.socket_config.network_timeout = 1;
+    response_size_ = 32 * 1024 * 1024;
+    start();
+    int fd = connectServer(4096);
+    ASSERT_GE(fd, 0);
+
+    // client不读应答，发送超过network_timeout没有完成时关闭连接
+    ASSERT_TRUE(writeAll(fd, newRequest(1, "big")));
+    std::this_thread::sleep_for(std::chrono::milliseconds(3500));
+    ASSERT_EQ(status_.send_timeout_count, 1U);
+    ASSERT_EQ(status_.current_connections, 0U);
+    ASSERT_TRUE(waitClosed(fd, 5000));
+}
+
+} /* namespace  */
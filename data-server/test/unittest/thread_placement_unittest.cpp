@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <pthread.h>
+#include <string.h>
+#include <thread>
+
+#include "common/ds_config.h"
+#include "server/thread_placement.h"
+
+int main(int argc, char* argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace {
+
+using namespace sharkstore::dataserver;
+using namespace sharkstore::dataserver::server;
+
+std::vector<int> currentCpus() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+    std::vector<int> cpus;
+    for (int i = 0; i < CPU_SETSIZE; ++i) {
+        if (CPU_ISSET(i, &set)) cpus.push_back(i);
+    }
+    return cpus;
+}
+
+TEST(ThreadPlacement, Parse) {
+    CpuPlacement p;
+    ASSERT_TRUE(ParseCpuPlacement("", &p).ok());
+    ASSERT_TRUE(p.Empty());
+    ASSERT_TRUE(ParseCpuPlacement("  ", &p).ok());
+    ASSERT_TRUE(p.Empty());
+
+    ASSERT_TRUE(ParseCpuPlacement("0", &p).ok());
+    ASSERT_EQ(p.cpus, std::vector<int>({0}));
+    ASSERT_FALSE(p.nodes.empty());
+
+    // numa节点0总是存在的
+    ASSERT_TRUE(ParseCpuPlacement("node:0", &p).ok());
+    ASSERT_FALSE(p.cpus.empty());
+    ASSERT_EQ(p.nodes, std::vector<int>({0}));
+    auto topology = ThreadPlacement::NumaTopology();
+    ASSERT_EQ(p.cpus, topology[0]);
+
+    ASSERT_FALSE(ParseCpuPlacement("a", &p).ok());
+    ASSERT_FALSE(ParseCpuPlacement("3-1", &p).ok());
+    ASSERT_FALSE(ParseCpuPlacement("1-", &p).ok());
+    ASSERT_FALSE(ParseCpuPlacement("100000", &p).ok());
+    ASSERT_FALSE(ParseCpuPlacement("node:", &p).ok());
+    ASSERT_FALSE(ParseCpuPlacement("node:1000", &p).ok());
+}
+
+TEST(ThreadPlacement, Format) {
+    ASSERT_EQ(FormatCpuList({}), "");
+    ASSERT_EQ(FormatCpuList({0}), "0");
+    ASSERT_EQ(FormatCpuList({0, 1, 2, 3}), "0-3");
+    ASSERT_EQ(FormatCpuList({0, 2, 3, 5, 8, 9, 10}), "0,2-3,5,8-10");
+}
+
+TEST(ThreadPlacement, Scope) {
+    auto before = currentCpus();
+    ASSERT_FALSE(before.empty());
+    auto cpu = before.back();
+
+    memset(&ds_config.affinity_config, 0, sizeof(ds_config.affinity_config));
+    snprintf(ds_config.affinity_config.fast_worker, sizeof(ds_config.affinity_config.fast_worker),
+             "%d", cpu);
+    ASSERT_TRUE(ThreadPlacement::Instance().Init().ok());
+
+    std::vector<int> in_thread;
+    {
+        ThreadPlacement::Scope scope(ThreadPlacement::kFastWorker);
+        ASSERT_EQ(currentCpus(), std::vector<int>({cpu}));
+        // 新线程继承创建者的亲和性
+        std::thread t([&in_thread] { in_thread = currentCpus(); });
+        t.join();
+    }
+    ASSERT_EQ(in_thread, std::vector<int>({cpu}));
+    ASSERT_EQ(currentCpus(), before);
+
+    // 没有配置的池不改变亲和性
+    {
+        ThreadPlacement::Scope scope(ThreadPlacement::kSlowWorker);
+        ASSERT_EQ(currentCpus(), before);
+    }
+
+    for (const auto& pool : ThreadPlacement::Instance().GetPools()) {
+        if (pool.name == ThreadPlacement::kFastWorker) {
+            ASSERT_EQ(pool.applied, 1U);
+            ASSERT_EQ(pool.placement.cpus, std::vector<int>({cpu}));
+        } else {
+            ASSERT_EQ(pool.applied, 0U);
+            ASSERT_TRUE(pool.placement.Empty());
+        }
+    }
+
+    auto threads = ThreadPlacement::GetThreads();
+    ASSERT_FALSE(threads.empty());
+
+    // 配置有误
+    snprintf(ds_config.affinity_config.rocksdb, sizeof(ds_config.affinity_config.rocksdb), "x");
+    ASSERT_FALSE(ThreadPlacement::Instance().Init().ok());
+}
+
+} /* namespace  */
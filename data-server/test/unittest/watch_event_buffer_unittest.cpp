@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+
+#include "watch/watch_event_buffer.h"
+
+int main(int argc, char* argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace {
+
+using namespace sharkstore::dataserver;
+using namespace sharkstore::dataserver::watch;
+
+EventValuePtr newEvent(const std::string& key, int64_t version) {
+    watchpb::WatchKeyValue kv;
+    kv.add_key("prefix");
+    kv.add_key(key);
+    kv.set_value("value" + std::to_string(version));
+    return std::make_shared<const CEventBufferValue>(kv, watchpb::PUT, version);
+}
+
+TEST(EventRing, Snapshot) {
+    EventRing<CEventBufferValue> ring(4);
+    EventSnapshot result;
+    int64_t lower = 0, upper = 0;
+
+    ASSERT_TRUE(ring.Empty());
+    ASSERT_EQ(ring.Snapshot(1, &result), -1);
+
+    for (int64_t v = 10; v <= 30; v += 10) {
+        ring.Push(newEvent("a", v));
+    }
+    ASSERT_EQ(ring.Length(), 3U);
+
+    // 比缓存中最旧的事件还旧
+    ASSERT_EQ(ring.Snapshot(9, &result, &lower, &upper), -1);
+    ASSERT_EQ(lower, 10);
+    ASSERT_EQ(upper, 30);
+    // 没有更新
+    ASSERT_EQ(ring.Snapshot(30, &result), 0);
+    ASSERT_EQ(ring.Snapshot(31, &result), 0);
+    ASSERT_TRUE(result.empty());
+
+    ASSERT_EQ(ring.Snapshot(10, &result), 2);
+    ASSERT_EQ(result[0]->version(), 20);
+    ASSERT_EQ(result[1]->version(), 30);
+    result.clear();
+    ASSERT_EQ(ring.Snapshot(15, &result), 2);
+    ASSERT_EQ(result[0]->version(), 20);
+    result.clear();
+
+    // 覆盖最旧的槽位
+    ring.Push(newEvent("a", 40));
+    ring.Push(newEvent("a", 50));
+    ASSERT_EQ(ring.Length(), 4U);
+    ASSERT_EQ(ring.LowerVersion(), 20);
+    ASSERT_EQ(ring.UpperVersion(), 50);
+    ASSERT_EQ(ring.Snapshot(10, &result), -1);
+    ASSERT_TRUE(result.empty());
+    ASSERT_EQ(ring.Snapshot(20, &result), 3);
+    ASSERT_EQ(result[0]->version(), 30);
+    ASSERT_EQ(result[2]->version(), 50);
+    ASSERT_EQ(result[2]->value(), "value50");
+
+    // 快照持有的事件不受覆盖影响
+    for (int64_t v = 60; v <= 100; v += 10) {
+        ring.Push(newEvent("a", v));
+    }
+    ASSERT_EQ(result[0]->version(), 30);
+    ASSERT_EQ(result[0]->value(), "value30");
+
+    ring.Clear();
+    ASSERT_TRUE(ring.Empty());
+    result.clear();
+    ASSERT_EQ(ring.Snapshot(70, &result), -1);
+}
+
+TEST(EventRing, Reclaim) {
+    EventRing<CEventBufferValue> ring(4);
+    std::vector<std::weak_ptr<const CEventBufferValue>> events;
+    for (int64_t v = 1; v <= 4; ++v) {
+        auto event = newEvent("a", v);
+        events.push_back(event);
+        ring.Push(std::move(event));
+    }
+
+    // 被覆盖的事件在没有读者后随后续写入释放，仍在环内的不释放
+    for (int64_t v = 5; v <= 8; ++v) {
+        ring.Push(newEvent("a", v));
+    }
+    for (int64_t v = 9; v <= 10; ++v) {
+        ring.Push(newEvent("a", v));
+    }
+    for (auto& event : events) {
+        ASSERT_TRUE(event.expired());
+    }
+    EventSnapshot result;
+    ASSERT_EQ(ring.Snapshot(7, &result), 3);
+    ASSERT_EQ(result[0]->version(), 8);
+}
+
+TEST(EventBuffer, Groups) {
+    CEventBuffer buffer(2, 3);
+    EventSnapshot result;
+
+    ASSERT_EQ(buffer.loadFromBuffer("g1", 1, result).first, -1);
+
+    ASSERT_TRUE(buffer.enQueue("g1", newEvent("a", 1)));
+    ASSERT_TRUE(buffer.enQueue("g1", newEvent("b", 2)));
+    ASSERT_TRUE(buffer.enQueue("g2", newEvent("c", 3)));
+
+    auto ret = buffer.loadFromBuffer("g1", 1, result);
+    ASSERT_EQ(ret.first, 1);
+    ASSERT_EQ(ret.second.first, 1);
+    ASSERT_EQ(ret.second.second, 2);
+    ASSERT_EQ(result[0]->key(1), "b");
+    result.clear();
+
+    // 版本为0或者分组不存在
+    ASSERT_EQ(buffer.loadFromBuffer("g1", 0, result).first, -1);
+    ASSERT_EQ(buffer.loadFromBuffer("g3", 1, result).first, 0);
+
+    ASSERT_TRUE(buffer.enQueue("g2", newEvent("d", 4)));
+    ASSERT_EQ(buffer.loadFromBuffer("g2", 2, result).first, -1);
+    ASSERT_EQ(buffer.loadFromBuffer("g2", 3, result).first, 1);
+    ASSERT_EQ(result[0]->key(1), "d");
+    result.clear();
+
+    buffer.clear("g2");
+    ASSERT_EQ(buffer.loadFromBuffer("g2", 3, result).first, 0);
+    ASSERT_EQ(buffer.loadFromBuffer("g1", 1, result).first, 1);
+}
+
+TEST(EventRing, Concurrent) {
+    const uint32_t kCapacity = 64;
+    const int64_t kEvents = 200000;
+    EventRing<CEventBufferValue> ring(kCapacity);
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> hits(0);
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&ring, &stop, &hits, i] {
+            EventSnapshot result;
+            int64_t version = 1;
+            while (!stop) {
+                result.clear();
+                auto cnt = ring.Snapshot(version, &result);
+                if (cnt < 0) {
+                    // 落后太多，从最旧的版本重新开始
+                    version = ring.LowerVersion();
+                    continue;
+                }
+                ASSERT_EQ(result.size(), static_cast<size_t>(cnt));
+                // 快照内版本连续，且都比请求的版本新
+                for (int32_t j = 0; j < cnt; ++j) {
+                    ASSERT_EQ(result[j]->version(), version + j + 1);
+                    ASSERT_EQ(result[j]->value(), "value" + std::to_string(version + j + 1));
+                }
+                if (cnt > 0) {
+                    version = result.back()->version();
+                    hits += cnt;
+                }
+                if (i % 2 == 0) std::this_thread::yield();
+            }
+        });
+    }
+
+    for (int64_t v = 1; v <= kEvents; ++v) {
+        ring.Push(newEvent("k", v));
+    }
+    stop = true;
+    for (auto& t : readers) {
+        t.join();
+    }
+
+    ASSERT_EQ(ring.UpperVersion(), kEvents);
+    ASSERT_EQ(ring.LowerVersion(), kEvents - kCapacity + 1);
+    ASSERT_GT(hits.load(), 0U);
+}
+
+} /* namespace  */
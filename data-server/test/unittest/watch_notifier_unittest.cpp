@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+#include "watch/watch_notifier.h"
+
+int main(int argc, char* argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace {
+
+using namespace sharkstore::dataserver;
+using namespace sharkstore::dataserver::watch;
+
+NotifyEvent newEvent(int64_t version, const std::string& key = "key") {
+    NotifyEvent event;
+    event.kv.add_key(key);
+    event.version = version;
+    return event;
+}
+
+TEST(WatchNotifier, NotifyLog) {
+    NotifyLog log(3);
+    bool schedule = false;
+    ASSERT_TRUE(log.Push(newEvent(1), &schedule));
+    ASSERT_TRUE(schedule);
+    ASSERT_TRUE(log.Push(newEvent(2), &schedule));
+    ASSERT_FALSE(schedule);
+    ASSERT_TRUE(log.Push(newEvent(3), &schedule));
+    ASSERT_FALSE(schedule);
+    ASSERT_EQ(log.Size(), 3U);
+
+    std::deque<NotifyEvent> events;
+    int64_t reload_version = -1;
+    ASSERT_TRUE(log.PopAll(&events, &reload_version));
+    ASSERT_EQ(reload_version, 0);
+    ASSERT_EQ(events.size(), 3U);
+    for (size_t i = 0; i < events.size(); ++i) {
+        ASSERT_EQ(events[i].version, static_cast<int64_t>(i + 1));
+    }
+    ASSERT_EQ(log.Size(), 0U);
+
+    // 消费者还没有结束本轮调度，不需要再次投递
+    ASSERT_TRUE(log.Push(newEvent(4), &schedule));
+    ASSERT_FALSE(schedule);
+    events.clear();
+    ASSERT_TRUE(log.PopAll(&events, &reload_version));
+    events.clear();
+    ASSERT_FALSE(log.PopAll(&events, &reload_version));
+
+    // 本轮调度结束后需要重新投递
+    ASSERT_TRUE(log.Push(newEvent(5), &schedule));
+    ASSERT_TRUE(schedule);
+}
+
+TEST(WatchNotifier, NotifyLogOverflow) {
+    NotifyLog log(2);
+    bool schedule = false;
+    ASSERT_TRUE(log.Push(newEvent(1, "a"), &schedule));
+    ASSERT_TRUE(log.Push(newEvent(2, "b"), &schedule));
+    // 已满，不阻塞也不再增长，丢弃的事件只记录最大版本
+    for (int64_t v = 3; v < 1000; ++v) {
+        ASSERT_FALSE(log.Push(newEvent(v, std::to_string(v)), &schedule));
+        ASSERT_FALSE(schedule);
+    }
+    ASSERT_FALSE(log.Push(newEvent(500, "a"), &schedule));
+    ASSERT_EQ(log.Size(), 2U);
+
+    std::deque<NotifyEvent> events;
+    int64_t reload_version = 0;
+    ASSERT_TRUE(log.PopAll(&events, &reload_version));
+    ASSERT_EQ(reload_version, 999);
+    ASSERT_EQ(events.size(), 2U);
+    ASSERT_EQ(events[0].version, 1);
+    ASSERT_EQ(events[1].version, 2);
+
+    // 重新加载的标记只取走一次，取走后重新计算容量
+    events.clear();
+    ASSERT_FALSE(log.PopAll(&events, &reload_version));
+    ASSERT_EQ(reload_version, 0);
+    ASSERT_TRUE(log.Push(newEvent(1000, "a"), &schedule));
+    ASSERT_TRUE(schedule);
+    ASSERT_TRUE(log.Push(newEvent(1001, "a"), &schedule));
+    ASSERT_FALSE(log.Push(newEvent(1002, "a"), &schedule));
+    ASSERT_TRUE(log.PopAll(&events, &reload_version));
+    ASSERT_EQ(events.size(), 2U);
+    ASSERT_EQ(reload_version, 1002);
+}
+
+TEST(WatchNotifier, NotifyLogReloadOnly) {
+    // 容量为0时所有事件都走重新加载，没有事件也要调度一次
+    NotifyLog log(0);
+    bool schedule = false;
+    ASSERT_FALSE(log.Push(newEvent(7), &schedule));
+    ASSERT_TRUE(schedule);
+
+    std::deque<NotifyEvent> events;
+    int64_t reload_version = 0;
+    ASSERT_TRUE(log.PopAll(&events, &reload_version));
+    ASSERT_TRUE(events.empty());
+    ASSERT_EQ(reload_version, 7);
+    ASSERT_FALSE(log.PopAll(&events, &reload_version));
+}
+
+TEST(WatchNotifier, Order) {
+    const int kHashes = 8;
+    const int kTasks = 1000;
+    std::vector<std::vector<int>> results(kHashes);
+    std::atomic<int> done(0);
+    {
+        WatchNotifier notifier(3);
+        for (int i = 0; i < kTasks; ++i) {
+            for (int h = 0; h < kHashes; ++h) {
+                notifier.Post(h, [&results, &done, h, i] {
+                    results[h].push_back(i);
+                    ++done;
+                });
+            }
+        }
+        while (done < kHashes * kTasks) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        NotifyStats stats;
+        notifier.GetStats(&stats);
+        ASSERT_EQ(stats.queued_tasks, 0U);
+    }
+
+    for (const auto& r : results) {
+        ASSERT_EQ(r.size(), static_cast<size_t>(kTasks));
+        for (int i = 0; i < kTasks; ++i) {
+            ASSERT_EQ(r[i], i);
+        }
+    }
+}
+
+TEST(WatchNotifier, Stats) {
+    WatchNotifier notifier(1);
+    notifier.OnPublish(3);
+    notifier.OnPublish(7);
+    notifier.OnPublish(1);
+    notifier.OnPublish(2);
+    notifier.OnOverflow();
+    notifier.OnReload();
+    notifier.OnNotify(100);
+    notifier.OnNotify(300);
+
+    NotifyStats stats;
+    notifier.GetStats(&stats);
+    ASSERT_EQ(stats.published, 4U);
+    ASSERT_EQ(stats.overflowed, 1U);
+    ASSERT_EQ(stats.reloads, 1U);
+    ASSERT_EQ(stats.notified, 2U);
+    ASSERT_EQ(stats.backlog, 1U);
+    ASSERT_EQ(stats.max_backlog, 7U);
+    ASSERT_EQ(stats.avg_delay_us, 200U);
+    ASSERT_EQ(stats.max_delay_us, 300U);
+}
+
+} /* namespace  */
@@ -0,0 +1,432 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+#include "base/util.h"
+#include "common/ds_proto.h"
+#include "frame/sf_socket_buff.h"
+#include "watch/notify_coalescer.h"
+#include "watch/watcher.h"
+#include "watch/watcher_set.h"
+
+int main(int argc, char* argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace {
+
+using namespace sharkstore::dataserver;
+using namespace sharkstore::dataserver::watch;
+
+TEST(WatchNotify, SharedBody) {
+    watchpb::DsWatchResponse resp;
+    resp.mutable_resp()->set_code(0);
+    resp.mutable_resp()->set_scope(watchpb::RESPONSE_PART);
+    for (int i = 0; i < 3; ++i) {
+        auto evt = resp.mutable_resp()->add_events();
+        evt->set_type(watchpb::PUT);
+        evt->mutable_kv()->add_key("key");
+        evt->mutable_kv()->add_key(std::to_string(i));
+        evt->mutable_kv()->set_value(std::string(100, 'v'));
+        evt->mutable_kv()->set_version(i + 1);
+    }
+
+    auto body = Watcher::SerializeNotify(resp);
+    ASSERT_FALSE(body->empty());
+
+    for (WatcherId id : {0L, 1L, 12345L, (1L << 40) + 7}) {
+        std::string data(*body);
+        Watcher::EncodeNotifyTail(&data, id);
+
+        watchpb::DsWatchResponse decoded;
+        ASSERT_TRUE(decoded.ParseFromString(data));
+
+        watchpb::DsWatchResponse expected(resp);
+        expected.mutable_resp()->set_watchid(id);
+        ASSERT_EQ(decoded.SerializeAsString(), expected.SerializeAsString());
+    }
+}
+
+TEST(WatchNotify, EmptyBody) {
+    watchpb::DsWatchResponse resp;
+    auto body = Watcher::SerializeNotify(resp);
+
+    std::string data(*body);
+    Watcher::EncodeNotifyTail(&data, 99);
+
+    watchpb::DsWatchResponse decoded;
+    ASSERT_TRUE(decoded.ParseFromString(data));
+    ASSERT_EQ(decoded.resp().watchid(), 99);
+    ASSERT_EQ(decoded.resp().events_size(), 0);
+}
+
+// 记录合并发送的数据，不经过真正的socket
+class MockSocket : public common::SocketBase {
+public:
+    int SendBatch(response_buff_t *response, int requests) override {
+        std::lock_guard<std::mutex> lock(mu);
+        sent.emplace_back(response->session_id, std::string(response->buff, response->buff_len));
+        total_requests += requests;
+        delete_response_buff(response);
+        return 0;
+    }
+
+    std::mutex mu;
+    std::vector<std::pair<int64_t, std::string>> sent;
+    int total_requests = 0;
+};
+
+common::ProtoMessage* newMessage(common::SocketBase* socket, int64_t session_id, int64_t msg_id) {
+    auto msg = new common::ProtoMessage;
+    msg->socket = socket;
+    msg->session_id = session_id;
+    msg->header.msg_id = msg_id;
+    msg->header.func_id = 0;
+    msg->header.proto_type = 0;
+    return msg;
+}
+
+// 按帧解析，返回<msg_id, body>
+std::vector<std::pair<int64_t, std::string>> parseFrames(const std::string& data) {
+    std::vector<std::pair<int64_t, std::string>> frames;
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ds_header_t header;
+        ds_unserialize_header(reinterpret_cast<const ds_proto_header_t*>(data.data() + offset), &header);
+        EXPECT_EQ(header.magic_number, DS_PROTO_MAGIC_NUMBER);
+        offset += header_size;
+        frames.emplace_back(header.msg_id, data.substr(offset, header.body_len));
+        offset += header.body_len;
+    }
+    EXPECT_EQ(offset, data.size());
+    return frames;
+}
+
+TEST(WatchNotify, Coalesce) {
+    MockSocket socket;
+    {
+        NotifyCoalescer coalescer(50, false);
+        ASSERT_EQ(coalescer.WindowMs(), 50);
+
+        for (int64_t i = 1; i <= 3; ++i) {
+            coalescer.Add(newMessage(&socket, 100, i), "body" + std::to_string(i), "tail");
+        }
+        coalescer.Add(newMessage(&socket, 200, 4), "other", "");
+
+        // 窗口到期后每个session只发送一次
+        for (int i = 0; i < 200; ++i) {
+            {
+                std::lock_guard<std::mutex> lock(socket.mu);
+                if (socket.sent.size() == 2) break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        CoalesceStats stats;
+        coalescer.GetStats(&stats);
+        ASSERT_EQ(stats.frames, 4U);
+        ASSERT_EQ(stats.batches, 2U);
+    }
+
+    ASSERT_EQ(socket.sent.size(), 2U);
+    ASSERT_EQ(socket.total_requests, 4);
+    for (const auto& s : socket.sent) {
+        auto frames = parseFrames(s.second);
+        if (s.first == 100) {
+            ASSERT_EQ(frames.size(), 3U);
+            for (int64_t i = 1; i <= 3; ++i) {
+                ASSERT_EQ(frames[i - 1].first, i);
+                ASSERT_EQ(frames[i - 1].second, "body" + std::to_string(i) + "tail");
+            }
+        } else {
+            ASSERT_EQ(s.first, 200);
+            ASSERT_EQ(frames.size(), 1U);
+            ASSERT_EQ(frames[0].first, 4);
+            ASSERT_EQ(frames[0].second, "other");
+        }
+    }
+}
+
+TEST(WatchNotify, CoalesceFlush) {
+    MockSocket socket;
+    NotifyCoalescer coalescer(60 * 1000, false);
+    coalescer.Add(newMessage(&socket, 1, 1), "a", "");
+    coalescer.Add(newMessage(&socket, 1, 2), "b", "");
+    ASSERT_TRUE(socket.sent.empty());
+
+    coalescer.Flush();
+    ASSERT_EQ(socket.sent.size(), 1U);
+    auto frames = parseFrames(socket.sent[0].second);
+    ASSERT_EQ(frames.size(), 2U);
+    ASSERT_EQ(frames[1].second, "b");
+}
+
+TEST(WatchNotify, CoalesceStopFlush) {
+    MockSocket socket;
+    {
+        NotifyCoalescer coalescer(60 * 1000, false);
+        coalescer.Add(newMessage(&socket, 1, 1), "a", "");
+    }
+    // 停止时等待中的应答仍然发出
+    ASSERT_EQ(socket.sent.size(), 1U);
+    ASSERT_EQ(socket.total_requests, 1);
+}
+
+TEST(WatchNotify, Squash) {
+    auto newEvent = [](const std::string& key, int64_t version) {
+        watchpb::WatchKeyValue kv;
+        kv.add_key("prefix");
+        kv.add_key(key);
+        return std::make_shared<const CEventBufferValue>(kv, watchpb::PUT, version);
+    };
+
+    EventSnapshot events{newEvent("a", 1), newEvent("b", 2), newEvent("a", 3),
+                         newEvent("c", 4), newEvent("b", 5), newEvent("a", 6)};
+
+    NotifyCoalescer coalescer(10, true);
+    ASSERT_TRUE(coalescer.Squash());
+    ASSERT_EQ(coalescer.SquashEvents(&events), 3U);
+
+    // 每个key只保留最新版本，且仍按版本递增
+    ASSERT_EQ(events.size(), 3U);
+    ASSERT_EQ(events[0]->key(1), "c");
+    ASSERT_EQ(events[0]->version(), 4);
+    ASSERT_EQ(events[1]->key(1), "b");
+    ASSERT_EQ(events[1]->version(), 5);
+    ASSERT_EQ(events[2]->key(1), "a");
+    ASSERT_EQ(events[2]->version(), 6);
+
+    CoalesceStats stats;
+    coalescer.GetStats(&stats);
+    ASSERT_EQ(stats.squashed, 3U);
+}
+
+TEST(WatchNotify, EncodeKey) {
+    std::vector<std::string> keys{"prefix", "a", std::string(20, 'x')};
+    std::vector<std::string*> key_ptrs;
+    for (auto& k : keys) key_ptrs.push_back(&k);
+    google::protobuf::RepeatedPtrField<std::string> pb_keys(keys.begin(), keys.end());
+
+    std::string expected;
+    Watcher::EncodeKey(&expected, 9, key_ptrs);
+
+    // 不同来源的key编码结果相同，buf会先被清空
+    std::string buf("garbage");
+    Watcher::EncodeKey(&buf, 9, pb_keys);
+    ASSERT_EQ(buf, expected);
+    Watcher::EncodeKey(&buf, 9, keys);
+    ASSERT_EQ(buf, expected);
+
+    std::string first;
+    std::vector<std::string*> first_ptr{key_ptrs[0]};
+    Watcher::EncodeKey(&first, 9, first_ptr);
+    Watcher::EncodeKey(&buf, 9, pb_keys, 1);
+    ASSERT_EQ(buf, first);
+
+    auto msg = new common::ProtoMessage;
+    msg->body.resize(1024);
+    Watcher w(WATCH_PREFIX, 9, pb_keys, 0, 0, msg);
+    ASSERT_EQ(w.GetFullEncodeKey(), expected);
+    ASSERT_EQ(w.GetEncodeKey(false), expected);
+    ASSERT_EQ(w.GetEncodeKey(), first);
+    ASSERT_EQ(std::string(w.GetHashKeyData(), w.GetHashKeyLen()), first);
+    ASSERT_EQ(w.GetKeyCount(), 3U);
+    // 请求内容在创建watcher后释放
+    ASSERT_EQ(msg->body.capacity(), 0U);
+    delete msg;
+}
+
+TEST(WatchNotify, Stream) {
+    MockSocket socket;
+    std::string key("key");
+    std::vector<WatcherKey*> keys{&key};
+    Watcher w(WATCH_KEY, 1, keys, 10, get_micro_second() + 60 * 1000 * 1000L,
+              newMessage(&socket, 100, 7));
+    w.SetStream(true);
+    w.SetWatcherId(3);
+    ASSERT_TRUE(w.IsStream());
+    ASSERT_TRUE(w.WatcherIdAssigned());
+
+    // 版本只增不减
+    ASSERT_FALSE(w.AdvanceVersion(10));
+    ASSERT_TRUE(w.AdvanceVersion(12));
+    ASSERT_FALSE(w.AdvanceVersion(11));
+    ASSERT_EQ(w.getKeyVersion(), 12);
+
+    watchpb::DsWatchResponse resp;
+    resp.mutable_resp()->add_events()->mutable_kv()->set_version(12);
+    auto body = Watcher::SerializeNotify(resp);
+
+    // 推送帧不结束watch，也不计入新的请求
+    w.Send(body);
+    {
+        NotifyCoalescer coalescer(60 * 1000, false);
+        w.Send(body, &coalescer);
+        coalescer.Flush();
+    }
+    ASSERT_FALSE(w.IsSentResponse());
+    ASSERT_EQ(socket.sent.size(), 2U);
+    ASSERT_EQ(socket.total_requests, 0);
+
+    auto final_resp = new watchpb::DsWatchResponse;
+    final_resp->mutable_resp()->set_canceled(true);
+    w.Close(final_resp);
+    ASSERT_TRUE(w.IsSentResponse());
+    w.Send(body);
+    ASSERT_EQ(socket.sent.size(), 3U);
+    ASSERT_EQ(socket.total_requests, 1);
+
+    // 所有帧使用请求的msg_id
+    for (const auto& s : socket.sent) {
+        auto frames = parseFrames(s.second);
+        ASSERT_EQ(frames.size(), 1U);
+        ASSERT_EQ(frames[0].first, 7);
+        watchpb::DsWatchResponse decoded;
+        ASSERT_TRUE(decoded.ParseFromString(frames[0].second));
+        if (&s == &socket.sent.back()) {
+            ASSERT_TRUE(decoded.resp().canceled());
+        } else {
+            ASSERT_EQ(decoded.resp().watchid(), 3);
+            ASSERT_EQ(decoded.resp().events(0).kv().version(), 12);
+        }
+    }
+}
+
+TEST(WatchNotify, StreamCloseCoalesced) {
+    MockSocket socket;
+    std::string key("key");
+    std::vector<WatcherKey*> keys{&key};
+    NotifyCoalescer coalescer(60 * 1000, false);
+    Watcher w(WATCH_KEY, 1, keys, 0, get_micro_second() + 60 * 1000 * 1000L,
+              newMessage(&socket, 100, 7));
+    w.SetStream(true);
+    w.SetWatcherId(3);
+    w.SetCoalescer(&coalescer);
+
+    watchpb::DsWatchResponse resp;
+    resp.mutable_resp()->add_events()->mutable_kv()->set_version(1);
+    w.Send(Watcher::SerializeNotify(resp), &coalescer);
+
+    // 结束帧排在还没发出的通知之后，不会先到client
+    auto final_resp = new watchpb::DsWatchResponse;
+    final_resp->mutable_resp()->set_canceled(true);
+    w.Close(final_resp);
+    ASSERT_TRUE(socket.sent.empty());
+
+    coalescer.Flush();
+    ASSERT_EQ(socket.sent.size(), 1U);
+    ASSERT_EQ(socket.total_requests, 1);
+    auto frames = parseFrames(socket.sent[0].second);
+    ASSERT_EQ(frames.size(), 2U);
+    watchpb::DsWatchResponse decoded;
+    ASSERT_TRUE(decoded.ParseFromString(frames[0].second));
+    ASSERT_EQ(decoded.resp().events_size(), 1);
+    ASSERT_TRUE(decoded.ParseFromString(frames[1].second));
+    ASSERT_TRUE(decoded.resp().canceled());
+}
+
+TEST(WatchNotify, StreamAck) {
+    MockSocket socket;
+    std::string key("key");
+    std::vector<WatcherKey*> keys{&key};
+    Watcher w(WATCH_KEY, 1, keys, 0, get_micro_second() + 60 * 1000 * 1000L,
+              newMessage(&socket, 100, 8));
+    w.SetStream(true);
+    w.SetWatcherId(5);
+
+    // 还没有推送过帧时发送确认帧，只发送一次
+    for (int i = 0; i < 2; ++i) {
+        auto ack = new watchpb::DsWatchResponse;
+        ack->mutable_resp()->set_watchid(w.GetWatcherId());
+        w.Ack(ack);
+    }
+    ASSERT_EQ(socket.sent.size(), 1U);
+    auto frames = parseFrames(socket.sent[0].second);
+    ASSERT_EQ(frames.size(), 1U);
+    watchpb::DsWatchResponse decoded;
+    ASSERT_TRUE(decoded.ParseFromString(frames[0].second));
+    ASSERT_EQ(decoded.resp().watchid(), 5);
+    ASSERT_EQ(decoded.resp().events_size(), 0);
+
+    // 已经推送过追平帧时不再确认
+    Watcher w2(WATCH_KEY, 1, keys, 0, get_micro_second() + 60 * 1000 * 1000L,
+               newMessage(&socket, 100, 9));
+    w2.SetStream(true);
+    w2.SetWatcherId(6);
+    auto catch_up = new watchpb::DsWatchResponse;
+    catch_up->mutable_resp()->set_watchid(6);
+    catch_up->mutable_resp()->add_events()->mutable_kv()->set_version(3);
+    w2.Send(catch_up);
+    w2.Ack(new watchpb::DsWatchResponse);
+    ASSERT_EQ(socket.sent.size(), 2U);
+    ASSERT_EQ(socket.total_requests, 0);
+}
+
+TEST(WatchNotify, CancelOtherSession) {
+    MockSocket socket;
+    std::string key("key");
+    std::vector<WatcherKey*> keys{&key};
+    auto expire = get_micro_second() + 60 * 1000 * 1000L;
+
+    WatcherSet ws;
+    WatcherPtr w = std::make_shared<Watcher>(WATCH_KEY, 1, keys, 0, expire, newMessage(&socket, 100, 1));
+    w->SetStream(true);
+    w->SetWatcherId(ws.GenWatcherId());
+    ASSERT_EQ(ws.AddKeyWatcher(w->GetFullEncodeKey(), w, nullptr), WATCH_OK);
+
+    // 其他session猜中watchId也不能取消
+    ASSERT_EQ(ws.TakeWatcher(w->GetFullEncodeKey(), w->GetWatcherId(), 200, false), nullptr);
+    ASSERT_EQ(ws.TakeWatcher(w->GetFullEncodeKey(), w->GetWatcherId() + 1, 100, false), nullptr);
+    ASSERT_EQ(ws.TakeWatcher(w->GetFullEncodeKey(), w->GetWatcherId(), 100, false), w);
+    ASSERT_EQ(ws.TakeWatcher(w->GetFullEncodeKey(), w->GetWatcherId(), 100, false), nullptr);
+
+    auto final_resp = new watchpb::DsWatchResponse;
+    final_resp->mutable_resp()->set_canceled(true);
+    w->Close(final_resp);
+}
+
+TEST(WatchNotify, RangeWatchers) {
+    MockSocket socket;
+    auto expire = get_micro_second() + 60 * 1000 * 1000L;
+
+    WatcherSet ws;
+    std::vector<WatcherPtr> added;
+    auto add = [&](const std::string& k, WatchType type) {
+        std::string key(k);
+        std::vector<WatcherKey*> keys{&key};
+        WatcherPtr w = std::make_shared<Watcher>(type, 1, keys, 0, expire, newMessage(&socket, 100, 1));
+        w->SetWatcherId(ws.GenWatcherId());
+        if (type == WATCH_PREFIX) {
+            ASSERT_EQ(ws.AddPrefixWatcher(w->GetFullEncodeKey(), w, nullptr), WATCH_OK);
+        } else {
+            ASSERT_EQ(ws.AddKeyWatcher(w->GetFullEncodeKey(), w, nullptr), WATCH_OK);
+        }
+        added.push_back(w);
+    };
+    add("a", WATCH_KEY);
+    add("b", WATCH_KEY);
+    add("b", WATCH_KEY);
+    add("c", WATCH_KEY);
+    add("a", WATCH_PREFIX);
+    add("b", WATCH_PREFIX);
+
+    // [b, c)
+    std::vector<WatcherPtr> keyWatchers, prefixWatchers;
+    ws.GetRangeWatchers(added[1]->GetFullEncodeKey(), added[3]->GetFullEncodeKey(), &keyWatchers, &prefixWatchers);
+    ASSERT_EQ(keyWatchers.size(), 2U);
+    for (const auto& w : keyWatchers) {
+        ASSERT_EQ(w->GetFullEncodeKey(), added[1]->GetFullEncodeKey());
+    }
+    ASSERT_EQ(prefixWatchers.size(), 1U);
+    ASSERT_EQ(prefixWatchers[0], added[5]);
+
+    // 不移除watcher，end为空表示不限
+    keyWatchers.clear();
+    prefixWatchers.clear();
+    ws.GetRangeWatchers(added[1]->GetFullEncodeKey(), "", &keyWatchers, &prefixWatchers);
+    ASSERT_EQ(keyWatchers.size(), 3U);
+    ASSERT_EQ(prefixWatchers.size(), 1U);
+}
+
+} /* namespace  */
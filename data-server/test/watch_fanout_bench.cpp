@@ -0,0 +1,371 @@
+#include "helper/cpp_permission.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fastcommon/shared_func.h>
+#include "base/util.h"
+#include "common/ds_config.h"
+#include "common/ds_proto.h"
+#include "common/socket_base.h"
+#include "frame/sf_logger.h"
+#include "frame/sf_socket_buff.h"
+#include "range/range.h"
+#include "watch/watch_server.h"
+#include "watch/watcher.h"
+
+#include "helper/helper_util.h"
+#include "helper/mock/range_context_mock.h"
+#include "helper/table.h"
+
+// watch通知扇出压测
+// 构造N个WatcherSet的WatchServer，注册单key和前缀watcher，
+// 通过Range::WatchNotify驱动put/delete事件，统计通知延迟分位数、事件吞吐和每个watcher的内存占用。
+// watcher使用流式模式，整个压测期间保持注册，每个事件都会扇出到所有匹配的watcher
+//
+// usage: watch_fanout_bench [-s sets] [-n keys] [-p prefixes] [-k key_watchers] [-w prefix_watchers]
+//                           [-e events] [-d delete_percent] [-t notify_threads] [-c coalesce_ms]
+//                           [-q] [-u sessions] [-S sample]
+
+using namespace sharkstore;
+using namespace sharkstore::dataserver;
+using namespace sharkstore::test;
+
+namespace {
+
+struct BenchOptions {
+    int watcher_sets = 8;
+    int keys = 1000;
+    int prefixes = 10;
+    int key_watchers = 10;      // 每个key的watcher数
+    int prefix_watchers = 10;   // 每个前缀的watcher数
+    int events = 100000;
+    int delete_percent = 10;
+    int notify_threads = 0;
+    int coalesce_ms = 0;
+    bool squash = false;
+    int sessions = 100;
+    int sample = 1;             // 每sample次发送解析一次应答统计延迟
+};
+
+// 代替真正的socket，统计发送的帧数、字节数和通知延迟
+class BenchSocket : public common::SocketBase {
+public:
+    explicit BenchSocket(int sample) : sample_(sample > 0 ? sample : 1) {}
+
+    void SetPublishTimes(std::vector<int64_t>* times) { publish_times_ = times; }
+
+    int Send(response_buff_t* response) override { return SendBatch(response, 1); }
+
+    int SendBatch(response_buff_t* response, int requests) override {
+        auto now = get_micro_second();
+        ++sends_;
+        bytes_ += response->buff_len;
+        if (sends_ % sample_ == 0) {
+            record(now, response->buff, response->buff_len);
+        }
+        delete_response_buff(response);
+        return 0;
+    }
+
+    uint64_t Sends() const { return sends_; }
+    uint64_t Bytes() const { return bytes_; }
+    uint64_t Frames() const { return frames_; }
+
+    std::vector<int64_t> TakeLatencies() {
+        std::lock_guard<std::mutex> lock(mu_);
+        return std::move(latencies_);
+    }
+
+private:
+    // 按帧解析应答，记录每个事件从发布到发送的时间
+    void record(int64_t now, const char* data, int32_t len) {
+        std::vector<int64_t> latencies;
+        int32_t offset = 0;
+        while (offset + static_cast<int32_t>(header_size) <= len) {
+            ds_header_t header;
+            ds_unserialize_header(reinterpret_cast<const ds_proto_header_t*>(data + offset), &header);
+            offset += header_size;
+            ++frames_;
+
+            watchpb::DsWatchResponse resp;
+            if (resp.ParseFromArray(data + offset, header.body_len)) {
+                for (const auto& evt : resp.resp().events()) {
+                    auto version = evt.kv().version();
+                    if (version > 0 && version < static_cast<int64_t>(publish_times_->size())) {
+                        latencies.push_back(now - (*publish_times_)[version]);
+                    }
+                }
+            }
+            offset += header.body_len;
+        }
+
+        std::lock_guard<std::mutex> lock(mu_);
+        latencies_.insert(latencies_.end(), latencies.begin(), latencies.end());
+    }
+
+private:
+    const int sample_;
+    std::vector<int64_t>* publish_times_ = nullptr;
+    std::atomic<uint64_t> sends_ = {0};
+    std::atomic<uint64_t> bytes_ = {0};
+    std::atomic<uint64_t> frames_ = {0};
+
+    std::mutex mu_;
+    std::vector<int64_t> latencies_;
+};
+
+// 当前进程的常驻内存(bytes)
+int64_t residentBytes() {
+    FILE* fp = fopen("/proc/self/statm", "r");
+    if (fp == nullptr) return 0;
+    long pages = 0, resident = 0;
+    if (fscanf(fp, "%ld %ld", &pages, &resident) != 2) {
+        resident = 0;
+    }
+    fclose(fp);
+    return static_cast<int64_t>(resident) * sysconf(_SC_PAGESIZE);
+}
+
+std::string prefixName(int i) { return "p" + std::to_string(i); }
+std::string keyName(int i) { return "k" + std::to_string(i); }
+
+common::ProtoMessage* newMessage(common::SocketBase* socket, int64_t session_id, int64_t msg_id) {
+    auto msg = new common::ProtoMessage;
+    msg->socket = socket;
+    msg->session_id = session_id;
+    msg->msg_id = msg_id;
+    msg->header.msg_id = msg_id;
+    msg->begin_time = get_micro_second();
+    msg->expire_time = getticks() + 3600 * 1000;
+    return msg;
+}
+
+// 所有任务都已执行完，事件日志为空时返回
+void waitNotifyDone(watch::WatchServer* watch_server, range::Range* rng) {
+    auto notifier = watch_server->Notifier();
+    if (notifier == nullptr) return;
+
+    while (true) {
+        // 同一个range的任务在同一个线程中顺序执行，屏障任务执行时前面的通知已经完成
+        std::mutex mu;
+        std::condition_variable cond;
+        bool done = false;
+        notifier->Post(rng->id_, [&] {
+            std::lock_guard<std::mutex> lock(mu);
+            done = true;
+            cond.notify_one();
+        });
+        {
+            std::unique_lock<std::mutex> lock(mu);
+            cond.wait(lock, [&done] { return done; });
+        }
+
+        watch::NotifyStats stats;
+        notifier->GetStats(&stats);
+        if (rng->GetNotifyBacklog() == 0 && stats.backlog == 0) {
+            return;
+        }
+    }
+}
+
+int64_t percentile(const std::vector<int64_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    auto idx = static_cast<size_t>(p * (sorted.size() - 1));
+    return sorted[idx];
+}
+
+void usage(const char* name) {
+    fprintf(stderr,
+            "usage: %s [-s sets] [-n keys] [-p prefixes] [-k key_watchers] [-w prefix_watchers]\n"
+            "          [-e events] [-d delete_percent] [-t notify_threads] [-c coalesce_ms]\n"
+            "          [-q] [-u sessions] [-S sample]\n",
+            name);
+}
+
+int runBench(const BenchOptions& opt) {
+    ds_config.watch_config.buffer_map_size = opt.prefixes;
+    ds_config.watch_config.buffer_queue_size = 1000;
+    ds_config.watch_config.notify_queue_size = opt.events;
+
+    mock::RangeContextMock context;
+    auto s = context.Init();
+    if (!s.ok()) {
+        fprintf(stderr, "init range context failed: %s\n", s.ToString().c_str());
+        return -1;
+    }
+    context.watch_server_.reset(new watch::WatchServer(opt.watcher_sets, opt.notify_threads,
+                                                       opt.coalesce_ms, opt.squash));
+    auto watch_server = context.WatchServer();
+
+    auto table = helper::CreateAccountTable();
+    std::shared_ptr<range::Range> rng;
+    s = context.CreateRange(helper::MakeRangeMeta(table.get()), 0, 0, &rng);
+    if (!s.ok()) {
+        fprintf(stderr, "create range failed: %s\n", s.ToString().c_str());
+        context.Destroy();
+        return -1;
+    }
+    auto table_id = rng->meta_.GetTableID();
+
+    BenchSocket socket(opt.sample);
+    std::vector<int64_t> publish_times(opt.events + 1, 0);
+    socket.SetPublishTimes(&publish_times);
+
+    // 注册watcher
+    std::vector<watch::WatcherPtr> watchers;
+    int64_t msg_id = 0;
+    auto addWatcher = [&](watch::WatchType type, const std::vector<std::string>& keys) {
+        std::vector<watch::WatcherKey*> wkeys;
+        for (const auto& k : keys) {
+            wkeys.push_back(new watch::WatcherKey(k));
+        }
+        ++msg_id;
+        auto w = std::make_shared<watch::Watcher>(type, table_id, wkeys, 0,
+                                                  get_micro_second() + 3600 * 1000000L,
+                                                  newMessage(&socket, msg_id % opt.sessions, msg_id));
+        for (auto k : wkeys) {
+            delete k;
+        }
+        w->SetStream(true);
+        auto code = (type == watch::WATCH_KEY) ? watch_server->AddKeyWatcher(w, nullptr)
+                                               : watch_server->AddPrefixWatcher(w, nullptr);
+        if (code != watch::WATCH_OK) {
+            fprintf(stderr, "add watcher failed: %d\n", static_cast<int>(code));
+        }
+        watchers.push_back(std::move(w));
+    };
+
+    auto rss_begin = residentBytes();
+    auto reg_begin = get_micro_second();
+    for (int i = 0; i < opt.keys; ++i) {
+        for (int j = 0; j < opt.key_watchers; ++j) {
+            addWatcher(watch::WATCH_KEY, {prefixName(i % opt.prefixes), keyName(i)});
+        }
+    }
+    for (int i = 0; i < opt.prefixes; ++i) {
+        for (int j = 0; j < opt.prefix_watchers; ++j) {
+            addWatcher(watch::WATCH_PREFIX, {prefixName(i)});
+        }
+    }
+    auto reg_time = get_micro_second() - reg_begin;
+    auto rss_watchers = residentBytes() - rss_begin;
+
+    // 发布事件
+    std::mt19937 rand(20181010);
+    std::uniform_int_distribution<int> key_dist(0, opt.keys - 1);
+    std::uniform_int_distribution<int> percent_dist(0, 99);
+    std::string value(64, 'v');
+    int failed = 0;
+
+    auto begin = get_micro_second();
+    for (int64_t version = 1; version <= opt.events; ++version) {
+        auto key = key_dist(rand);
+        auto type = percent_dist(rand) < opt.delete_percent ? watchpb::DELETE : watchpb::PUT;
+
+        watchpb::WatchKeyValue kv;
+        kv.add_key(prefixName(key % opt.prefixes));
+        kv.add_key(keyName(key));
+        if (type == watchpb::PUT) kv.set_value(value);
+        kv.set_version(version);
+
+        std::string err;
+        publish_times[version] = get_micro_second();
+        if (rng->WatchNotify(type, kv, version, err) < 0) {
+            ++failed;
+        }
+    }
+    auto publish_time = get_micro_second() - begin;
+    waitNotifyDone(watch_server, rng.get());
+    if (watch_server->Coalescer() != nullptr) {
+        watch_server->Coalescer()->Flush();
+    }
+    auto total_time = get_micro_second() - begin;
+
+    auto latencies = socket.TakeLatencies();
+    std::sort(latencies.begin(), latencies.end());
+
+    auto total_watchers = watchers.size();
+    printf("watchers:   key %d x %d, prefix %d x %d, sets %d, sessions %d\n",
+           opt.keys, opt.key_watchers, opt.prefixes, opt.prefix_watchers, opt.watcher_sets, opt.sessions);
+    printf("register:   %zu watchers in %.1f ms, rss +%" PRId64 " KB, %.1f bytes/watcher\n",
+           total_watchers, reg_time / 1000.0, rss_watchers / 1024,
+           total_watchers > 0 ? static_cast<double>(rss_watchers) / total_watchers : 0.0);
+    printf("events:     %d (delete %d%%, failed %d), publish %.1f ms, total %.1f ms, %.0f events/s\n",
+           opt.events, opt.delete_percent, failed, publish_time / 1000.0, total_time / 1000.0,
+           total_time > 0 ? opt.events * 1000000.0 / total_time : 0.0);
+    printf("send:       %" PRIu64 " sends, %" PRIu64 " bytes, %.1f bytes/event\n",
+           socket.Sends(), socket.Bytes(), static_cast<double>(socket.Bytes()) / opt.events);
+    printf("latency(us): p50 %" PRId64 " p90 %" PRId64 " p99 %" PRId64 " p999 %" PRId64 " max %" PRId64
+           " (%zu samples, %" PRIu64 " frames parsed)\n",
+           percentile(latencies, 0.5), percentile(latencies, 0.9), percentile(latencies, 0.99),
+           percentile(latencies, 0.999), latencies.empty() ? 0 : latencies.back(),
+           latencies.size(), socket.Frames());
+
+    if (watch_server->Notifier() != nullptr) {
+        watch::NotifyStats stats;
+        watch_server->Notifier()->GetStats(&stats);
+        printf("notifier:   threads %d, overflowed %" PRIu64 ", reloads %" PRIu64 ", max backlog %" PRIu64
+               ", avg delay %" PRIu64 " us, max delay %" PRIu64 " us\n",
+               opt.notify_threads, stats.overflowed, stats.reloads, stats.max_backlog, stats.avg_delay_us,
+               stats.max_delay_us);
+    }
+    if (watch_server->Coalescer() != nullptr) {
+        watch::CoalesceStats stats;
+        watch_server->Coalescer()->GetStats(&stats);
+        printf("coalescer:  frames %" PRIu64 ", batches %" PRIu64 ", squashed %" PRIu64 "\n",
+               stats.frames, stats.batches, stats.squashed);
+    }
+
+    // 先停止通知线程，再释放range和watcher
+    context.watch_server_.reset();
+    watchers.clear();
+    rng.reset();
+    context.ranges_.clear();
+    context.Destroy();
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions opt;
+    int c;
+    while ((c = getopt(argc, argv, "s:n:p:k:w:e:d:t:c:qu:S:h")) != -1) {
+        switch (c) {
+            case 's': opt.watcher_sets = atoi(optarg); break;
+            case 'n': opt.keys = atoi(optarg); break;
+            case 'p': opt.prefixes = atoi(optarg); break;
+            case 'k': opt.key_watchers = atoi(optarg); break;
+            case 'w': opt.prefix_watchers = atoi(optarg); break;
+            case 'e': opt.events = atoi(optarg); break;
+            case 'd': opt.delete_percent = atoi(optarg); break;
+            case 't': opt.notify_threads = atoi(optarg); break;
+            case 'c': opt.coalesce_ms = atoi(optarg); break;
+            case 'q': opt.squash = true; break;
+            case 'u': opt.sessions = atoi(optarg); break;
+            case 'S': opt.sample = atoi(optarg); break;
+            default:
+                usage(argv[0]);
+                return c == 'h' ? 0 : 1;
+        }
+    }
+    if (opt.keys <= 0 || opt.prefixes <= 0 || opt.events <= 0 || opt.sessions <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    log_init2();
+    char level[] = "CRIT";
+    set_log_level(level);
+
+    return runBench(opt) == 0 ? 0 : 1;
+}
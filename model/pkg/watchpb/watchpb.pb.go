@@ -250,6 +250,10 @@ type WatchCreateRequest struct {
 	// longPull timeOut
 	// timeUnit millisecond
 	LongPull int64 `protobuf:"varint,7,opt,name=longPull,proto3" json:"longPull,omitempty"`
+	// 流式watch：注册后持续推送版本递增的事件，直到取消或者longPull超时
+	Stream bool `protobuf:"varint,8,opt,name=stream,proto3" json:"stream,omitempty"`
+	// 取消流式watch，watchId为推送中返回的watchId
+	Cancel bool `protobuf:"varint,9,opt,name=cancel,proto3" json:"cancel,omitempty"`
 }
 
 func (m *WatchCreateRequest) Reset()                    { *m = WatchCreateRequest{} }
@@ -306,6 +310,20 @@ func (m *WatchCreateRequest) GetLongPull() int64 {
 	return 0
 }
 
+func (m *WatchCreateRequest) GetStream() bool {
+	if m != nil {
+		return m.Stream
+	}
+	return false
+}
+
+func (m *WatchCreateRequest) GetCancel() bool {
+	if m != nil {
+		return m.Cancel
+	}
+	return false
+}
+
 // watch simple key response
 type DsWatchResponse struct {
 	Header *kvrpcpb.ResponseHeader `protobuf:"bytes,1,opt,name=header" json:"header,omitempty"`
@@ -334,10 +352,11 @@ func (m *DsWatchResponse) GetResp() *WatchResponse {
 // common watch response
 type WatchResponse struct {
 	// watch_id is the ID of the watcher that corresponds to the response.
-	WatchId int64    `protobuf:"varint,1,opt,name=watchId,proto3" json:"watchId,omitempty"`
-	Code    int32    `protobuf:"varint,3,opt,name=code,proto3" json:"code,omitempty"`
-	Scope   int32    `protobuf:"varint,6,opt,name=scope,proto3" json:"scope,omitempty"`
-	Events  []*Event `protobuf:"bytes,9,rep,name=events" json:"events,omitempty"`
+	WatchId  int64    `protobuf:"varint,1,opt,name=watchId,proto3" json:"watchId,omitempty"`
+	Code     int32    `protobuf:"varint,3,opt,name=code,proto3" json:"code,omitempty"`
+	Scope    int32    `protobuf:"varint,6,opt,name=scope,proto3" json:"scope,omitempty"`
+	Events   []*Event `protobuf:"bytes,9,rep,name=events" json:"events,omitempty"`
+	Canceled bool     `protobuf:"varint,10,opt,name=canceled,proto3" json:"canceled,omitempty"`
 }
 
 func (m *WatchResponse) Reset()                    { *m = WatchResponse{} }
@@ -373,6 +392,13 @@ func (m *WatchResponse) GetEvents() []*Event {
 	return nil
 }
 
+func (m *WatchResponse) GetCanceled() bool {
+	if m != nil {
+		return m.Canceled
+	}
+	return false
+}
+
 // simple KV add request
 type DsKvWatchPutRequest struct {
 	Header *kvrpcpb.RequestHeader `protobuf:"bytes,1,opt,name=header" json:"header,omitempty"`
@@ -822,6 +848,26 @@ func (m *WatchCreateRequest) MarshalTo(dAtA []byte) (int, error) {
 		i++
 		i = encodeVarintWatchpb(dAtA, i, uint64(m.LongPull))
 	}
+	if m.Stream {
+		dAtA[i] = 0x40
+		i++
+		if m.Stream {
+			dAtA[i] = 1
+		} else {
+			dAtA[i] = 0
+		}
+		i++
+	}
+	if m.Cancel {
+		dAtA[i] = 0x48
+		i++
+		if m.Cancel {
+			dAtA[i] = 1
+		} else {
+			dAtA[i] = 0
+		}
+		i++
+	}
 	return i, nil
 }
 
@@ -905,6 +951,16 @@ func (m *WatchResponse) MarshalTo(dAtA []byte) (int, error) {
 			i += n
 		}
 	}
+	if m.Canceled {
+		dAtA[i] = 0x50
+		i++
+		if m.Canceled {
+			dAtA[i] = 1
+		} else {
+			dAtA[i] = 0
+		}
+		i++
+	}
 	return i, nil
 }
 
@@ -1341,6 +1397,12 @@ func (m *WatchCreateRequest) Size() (n int) {
 	if m.LongPull != 0 {
 		n += 1 + sovWatchpb(uint64(m.LongPull))
 	}
+	if m.Stream {
+		n += 2
+	}
+	if m.Cancel {
+		n += 2
+	}
 	return n
 }
 
@@ -1376,6 +1438,9 @@ func (m *WatchResponse) Size() (n int) {
 			n += 1 + l + sovWatchpb(uint64(l))
 		}
 	}
+	if m.Canceled {
+		n += 2
+	}
 	return n
 }
 
@@ -2155,6 +2220,46 @@ func (m *WatchCreateRequest) Unmarshal(dAtA []byte) error {
 					break
 				}
 			}
+		case 8:
+			if wireType != 0 {
+				return fmt.Errorf("proto: wrong wireType = %d for field Stream", wireType)
+			}
+			var v int
+			for shift := uint(0); ; shift += 7 {
+				if shift >= 64 {
+					return ErrIntOverflowWatchpb
+				}
+				if iNdEx >= l {
+					return io.ErrUnexpectedEOF
+				}
+				b := dAtA[iNdEx]
+				iNdEx++
+				v |= (int(b) & 0x7F) << shift
+				if b < 0x80 {
+					break
+				}
+			}
+			m.Stream = bool(v != 0)
+		case 9:
+			if wireType != 0 {
+				return fmt.Errorf("proto: wrong wireType = %d for field Cancel", wireType)
+			}
+			var v int
+			for shift := uint(0); ; shift += 7 {
+				if shift >= 64 {
+					return ErrIntOverflowWatchpb
+				}
+				if iNdEx >= l {
+					return io.ErrUnexpectedEOF
+				}
+				b := dAtA[iNdEx]
+				iNdEx++
+				v |= (int(b) & 0x7F) << shift
+				if b < 0x80 {
+					break
+				}
+			}
+			m.Cancel = bool(v != 0)
 		default:
 			iNdEx = preIndex
 			skippy, err := skipWatchpb(dAtA[iNdEx:])
@@ -2409,6 +2514,26 @@ func (m *WatchResponse) Unmarshal(dAtA []byte) error {
 				return err
 			}
 			iNdEx = postIndex
+		case 10:
+			if wireType != 0 {
+				return fmt.Errorf("proto: wrong wireType = %d for field Canceled", wireType)
+			}
+			var v int
+			for shift := uint(0); ; shift += 7 {
+				if shift >= 64 {
+					return ErrIntOverflowWatchpb
+				}
+				if iNdEx >= l {
+					return io.ErrUnexpectedEOF
+				}
+				b := dAtA[iNdEx]
+				iNdEx++
+				v |= (int(b) & 0x7F) << shift
+				if b < 0x80 {
+					break
+				}
+			}
+			m.Canceled = bool(v != 0)
 		default:
 			iNdEx = preIndex
 			skippy, err := skipWatchpb(dAtA[iNdEx:])
@@ -3545,54 +3670,55 @@ var (
 func init() { proto.RegisterFile("watchpb.proto", fileDescriptorWatchpb) }
 
 var fileDescriptorWatchpb = []byte{
-	// 776 bytes of a gzipped FileDescriptorProto
-	0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xff, 0xbc, 0x95, 0xcd, 0x4e, 0xdb, 0x4a,
-	0x14, 0xc7, 0x99, 0x38, 0x1f, 0x70, 0x48, 0x42, 0x18, 0x22, 0xf0, 0xcd, 0xd5, 0x8d, 0x7c, 0x2d,
-	0x81, 0xac, 0x08, 0x8c, 0x6e, 0x58, 0xde, 0x15, 0x6d, 0xd2, 0x16, 0x41, 0x21, 0x1a, 0x28, 0x2c,
-	0xab, 0x90, 0x0c, 0xc1, 0x8a, 0x13, 0x1b, 0x7b, 0x62, 0x12, 0xf5, 0x0d, 0xfa, 0x04, 0xed, 0xae,
-	0x8f, 0xd3, 0x65, 0x1f, 0xa1, 0xa2, 0x4f, 0xd1, 0x5d, 0x35, 0xe3, 0x8f, 0xd8, 0x09, 0x55, 0x69,
-	0x16, 0x5d, 0xc5, 0x67, 0xce, 0x7f, 0xce, 0xc7, 0x2f, 0x67, 0x66, 0xa0, 0x70, 0xdf, 0x66, 0x9d,
-	0x5b, 0xfb, 0x5a, 0xb7, 0x1d, 0x8b, 0x59, 0x38, 0x17, 0x98, 0x95, 0x72, 0xcf, 0xea, 0x59, 0x62,
-	0x6d, 0x9f, 0x7f, 0xf9, 0xee, 0x4a, 0xa1, 0xef, 0x39, 0x76, 0x27, 0x54, 0xab, 0x57, 0x90, 0x69,
-	0x7a, 0x74, 0xc8, 0xf0, 0x0e, 0xa4, 0xd9, 0xc4, 0xa6, 0x32, 0x52, 0x90, 0x56, 0xac, 0x63, 0x3d,
-	0x0c, 0x2a, 0xbc, 0x17, 0x13, 0x9b, 0x12, 0xe1, 0xc7, 0x3b, 0x90, 0xea, 0x7b, 0x72, 0x4a, 0x41,
-	0xda, 0x6a, 0x7d, 0x33, 0x52, 0x5d, 0xf1, 0xdf, 0x63, 0x3a, 0xb9, 0x6c, 0x9b, 0x23, 0x4a, 0x52,
-	0x7d, 0x4f, 0xfd, 0x88, 0xa0, 0x90, 0x58, 0xc5, 0x32, 0xe4, 0x58, 0xfb, 0xda, 0xa4, 0x47, 0x5d,
-	0x91, 0x44, 0x22, 0xa1, 0x89, 0x4b, 0x20, 0xf5, 0xe9, 0x44, 0x4e, 0x29, 0x92, 0x96, 0x27, 0xfc,
-	0x93, 0x6b, 0x3d, 0xea, 0xb8, 0x86, 0x35, 0x94, 0x25, 0x5f, 0x1b, 0x98, 0xb8, 0x0c, 0x19, 0x8f,
-	0x87, 0x93, 0xd3, 0x0a, 0xd2, 0xf2, 0xc4, 0x37, 0x70, 0x05, 0x96, 0xe9, 0xd8, 0x36, 0x1c, 0x7a,
-	0xc8, 0xe4, 0x8c, 0x82, 0xb4, 0x34, 0x89, 0x6c, 0x1e, 0x9d, 0x8e, 0x99, 0x9c, 0x15, 0x7a, 0xfe,
-	0xa9, 0x5a, 0x50, 0x6c, 0xb8, 0xa2, 0x38, 0x42, 0xef, 0x46, 0xd4, 0x65, 0x58, 0x87, 0xec, 0x2d,
-	0x6d, 0x77, 0xa9, 0x23, 0x4a, 0xe3, 0x9d, 0x85, 0x98, 0x02, 0xc5, 0x2b, 0xe1, 0x25, 0x81, 0x0a,
-	0xef, 0x81, 0xe4, 0xd0, 0xbb, 0x00, 0xc3, 0xdf, 0x49, 0x0c, 0xcf, 0x1d, 0xda, 0x66, 0x34, 0xd8,
-	0x47, 0xb8, 0x4e, 0xfd, 0x8e, 0x00, 0xcf, 0xfb, 0x02, 0x96, 0xe8, 0x57, 0x2c, 0xb1, 0x0a, 0x79,
-	0x97, 0xb5, 0x1d, 0x76, 0x19, 0x20, 0x49, 0x09, 0x24, 0x89, 0x35, 0xbc, 0x07, 0xb9, 0x1b, 0xc3,
-	0x64, 0xd4, 0x71, 0x65, 0x49, 0x91, 0xb4, 0x62, 0x7d, 0x23, 0x0a, 0xf8, 0x42, 0xac, 0x8b, 0xff,
-	0x30, 0xd4, 0x70, 0xc0, 0xc2, 0x7d, 0xd4, 0x15, 0x20, 0x25, 0x12, 0x9a, 0x73, 0x28, 0xa5, 0x18,
-	0xca, 0x4d, 0xc8, 0xda, 0x0e, 0xbd, 0x31, 0xc6, 0x82, 0xe6, 0x32, 0x09, 0x2c, 0xbe, 0xc7, 0xb4,
-	0x86, 0xbd, 0xd6, 0xc8, 0x34, 0xe5, 0x9c, 0xbf, 0x27, 0xb4, 0xd5, 0x21, 0xac, 0x45, 0xb0, 0x5d,
-	0xdb, 0x1a, 0xba, 0x14, 0xef, 0xcf, 0xd0, 0xde, 0x8a, 0xd1, 0xf6, 0x25, 0x33, 0xb8, 0x6b, 0x90,
-	0x76, 0xa8, 0x6b, 0x3f, 0x3e, 0x76, 0xe1, 0x1e, 0x22, 0x34, 0xea, 0xbb, 0x60, 0xee, 0xa2, 0x6c,
-	0xb1, 0x56, 0x51, 0xb2, 0x55, 0x0c, 0xe9, 0x8e, 0xd5, 0xa5, 0x62, 0xc4, 0x32, 0x44, 0x7c, 0xf3,
-	0xf9, 0x72, 0x3b, 0x96, 0x4d, 0x45, 0x87, 0x19, 0xe2, 0x1b, 0x78, 0x07, 0xb2, 0x94, 0x1f, 0x04,
-	0x57, 0x5e, 0x51, 0x24, 0x6d, 0xb5, 0x5e, 0x4c, 0x9e, 0x0f, 0x12, 0x78, 0x55, 0x17, 0x36, 0x1a,
-	0xee, 0xb1, 0x27, 0x0a, 0x68, 0x8d, 0xd8, 0xa2, 0xe3, 0xb5, 0x1b, 0x1f, 0xaf, 0x4a, 0x94, 0x6b,
-	0x2e, 0xb0, 0x3f, 0x5d, 0x23, 0x28, 0x27, 0x93, 0x2e, 0x8a, 0x79, 0x37, 0x81, 0x59, 0x9e, 0xcd,
-	0x3b, 0x03, 0xfa, 0x7f, 0x58, 0x9f, 0xef, 0xf4, 0x89, 0x23, 0xad, 0x4e, 0x60, 0x33, 0xaa, 0xb9,
-	0x41, 0x4d, 0x3a, 0x3d, 0x14, 0xbf, 0xcb, 0x6a, 0x3f, 0xce, 0xea, 0x9f, 0xd9, 0x9a, 0x13, 0xb1,
-	0x7d, 0x5c, 0x63, 0xd8, 0x9a, 0x4b, 0xfd, 0x67, 0x88, 0x5d, 0x42, 0xf9, 0xd1, 0x96, 0x9f, 0x7a,
-	0x0f, 0x4c, 0x8f, 0x5f, 0x2a, 0x7e, 0xfc, 0xd4, 0x6d, 0x58, 0x9b, 0x49, 0x18, 0x8d, 0x36, 0x9a,
-	0x8e, 0xb6, 0xfa, 0x09, 0x81, 0x1c, 0x75, 0xfe, 0x92, 0xb2, 0xd7, 0x23, 0x93, 0x19, 0x8b, 0x62,
-	0x7f, 0xe2, 0x3b, 0x10, 0xab, 0x59, 0x4a, 0x5c, 0x19, 0x65, 0xc8, 0x98, 0xc6, 0xc0, 0x60, 0xe2,
-	0xfa, 0x29, 0x10, 0xdf, 0x50, 0xdf, 0x23, 0xf8, 0xeb, 0x91, 0x12, 0x17, 0xfd, 0x7b, 0x42, 0x0a,
-	0xa9, 0xd8, 0x01, 0xd7, 0x40, 0xea, 0x7b, 0xfe, 0x25, 0xf9, 0xf3, 0xca, 0xb9, 0xa4, 0xa6, 0xc0,
-	0x4a, 0xf4, 0xfa, 0xe1, 0x1c, 0x48, 0xad, 0x37, 0x17, 0xa5, 0x25, 0x0c, 0x90, 0x6d, 0x34, 0x4f,
-	0x9a, 0x17, 0xcd, 0x12, 0xaa, 0xfd, 0x07, 0x70, 0xce, 0xef, 0x07, 0xff, 0x81, 0x5b, 0x87, 0x02,
-	0x69, 0x9e, 0xb7, 0xce, 0x4e, 0xcf, 0x9b, 0x6f, 0x5b, 0x87, 0x84, 0x8b, 0x4b, 0x90, 0x8f, 0x96,
-	0x0e, 0x4f, 0x4e, 0x4a, 0xa8, 0xb6, 0x0d, 0x30, 0xbd, 0x8f, 0xf1, 0x0a, 0x64, 0x4e, 0xcf, 0xfc,
-	0xb8, 0x79, 0x58, 0x3e, 0x3d, 0x0b, 0x23, 0x3f, 0x3b, 0xf8, 0xfc, 0x50, 0x45, 0x5f, 0x1e, 0xaa,
-	0xe8, 0xeb, 0x43, 0x15, 0x7d, 0xf8, 0x56, 0x5d, 0x82, 0x7f, 0x3b, 0xd6, 0x40, 0x67, 0x46, 0x4f,
-	0x77, 0x6f, 0xdb, 0x4e, 0x5f, 0xef, 0x58, 0x83, 0x81, 0x35, 0xd4, 0x87, 0x94, 0xdd, 0x5b, 0x4e,
-	0x5f, 0xef, 0x39, 0x76, 0xe7, 0x3a, 0x2b, 0xde, 0xf4, 0x83, 0x1f, 0x01, 0x00, 0x00, 0xff, 0xff,
-	0xd3, 0x63, 0xb1, 0xfa, 0x12, 0x08, 0x00, 0x00,
+	// 789 bytes of a gzipped FileDescriptorProto
+	0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xff, 0xbd, 0x56, 0xcd, 0x4e, 0xdb, 0x40,
+	0x10, 0xc6, 0x71, 0xfe, 0x98, 0x26, 0x10, 0x96, 0x08, 0xdc, 0x54, 0x45, 0xd4, 0x12, 0x15, 0x42,
+	0xd4, 0xa8, 0x70, 0xec, 0x89, 0x36, 0xe9, 0x8f, 0xa0, 0x10, 0x2d, 0x14, 0x8e, 0x95, 0x49, 0x96,
+	0x60, 0xc5, 0xb1, 0x83, 0xbd, 0x31, 0xc9, 0x2b, 0xf4, 0x05, 0xda, 0xde, 0x7a, 0xed, 0x9b, 0xf4,
+	0xd8, 0x47, 0xa8, 0xda, 0x17, 0xe9, 0xfe, 0xd8, 0x8e, 0x9d, 0x50, 0x95, 0xe6, 0xd0, 0x83, 0x15,
+	0x7f, 0x33, 0xdf, 0xce, 0xce, 0x7e, 0x33, 0xb3, 0x0e, 0x94, 0x6f, 0x4c, 0xda, 0xba, 0xea, 0x5f,
+	0x18, 0x7d, 0xcf, 0xa5, 0x2e, 0x2a, 0x84, 0xb0, 0x56, 0xed, 0xb8, 0x1d, 0x57, 0xd8, 0x76, 0xf8,
+	0x9b, 0x74, 0xd7, 0xca, 0xdd, 0xc0, 0xeb, 0xb7, 0x22, 0xb6, 0x7e, 0x0e, 0xb9, 0x46, 0x40, 0x1c,
+	0x8a, 0x1e, 0x43, 0x96, 0x8e, 0xfa, 0x44, 0x53, 0xd6, 0x95, 0xcd, 0x85, 0x5d, 0x64, 0x44, 0x41,
+	0x85, 0xf7, 0x94, 0x79, 0xb0, 0xf0, 0x33, 0x5e, 0xa6, 0x1b, 0x68, 0x19, 0xc6, 0xba, 0xb7, 0xbb,
+	0x12, 0xb3, 0xce, 0xf9, 0xef, 0x01, 0x19, 0x9d, 0x99, 0xf6, 0x80, 0x60, 0xc6, 0xd0, 0x3f, 0x2b,
+	0x50, 0x4e, 0x59, 0x91, 0x06, 0x05, 0x6a, 0x5e, 0xd8, 0xe4, 0x4d, 0x5b, 0x6c, 0xa2, 0xe2, 0x08,
+	0xa2, 0x0a, 0xa8, 0x5d, 0x32, 0x62, 0x41, 0xd5, 0xcd, 0x12, 0xe6, 0xaf, 0x9c, 0x1b, 0x10, 0xcf,
+	0xb7, 0x5c, 0x47, 0x53, 0x25, 0x37, 0x84, 0xa8, 0x0a, 0xb9, 0x80, 0x87, 0xd3, 0xb2, 0xcc, 0x5e,
+	0xc2, 0x12, 0xa0, 0x1a, 0x14, 0xc9, 0xb0, 0x6f, 0x79, 0x64, 0x9f, 0x6a, 0x39, 0xe6, 0xc8, 0xe2,
+	0x18, 0xf3, 0xe8, 0x64, 0x48, 0xb5, 0xbc, 0xe0, 0xf3, 0x57, 0xdd, 0x85, 0x85, 0xba, 0x2f, 0x92,
+	0xc3, 0xe4, 0x7a, 0x40, 0x7c, 0x8a, 0x0c, 0xc8, 0x5f, 0x11, 0xb3, 0x4d, 0x3c, 0x91, 0x1a, 0x3f,
+	0x59, 0x24, 0x53, 0xc8, 0x78, 0x2d, 0xbc, 0x38, 0x64, 0xa1, 0x27, 0xa0, 0x7a, 0xe4, 0x3a, 0x94,
+	0xe1, 0x41, 0x5a, 0x86, 0x17, 0x1e, 0x31, 0x29, 0x09, 0xd7, 0x61, 0xce, 0xd3, 0xbf, 0x66, 0x00,
+	0x4d, 0xfb, 0x42, 0x2d, 0x95, 0xbf, 0x69, 0x89, 0x74, 0x28, 0xf9, 0xd4, 0xf4, 0xe8, 0x59, 0x28,
+	0x49, 0x46, 0x48, 0x92, 0xb2, 0xb1, 0x8c, 0x0a, 0x97, 0x96, 0x4d, 0x19, 0x62, 0x8a, 0xa9, 0xac,
+	0x84, 0xcb, 0x71, 0xc0, 0x97, 0xc2, 0x2e, 0x6a, 0x18, 0x71, 0xb8, 0xc0, 0xc2, 0xcd, 0x8a, 0x91,
+	0x95, 0x02, 0x87, 0x70, 0x4a, 0x4a, 0x35, 0x21, 0xe5, 0x0a, 0xe4, 0xfb, 0x1e, 0xb9, 0xb4, 0x86,
+	0x42, 0xcd, 0x22, 0x0e, 0x11, 0x5f, 0x63, 0xbb, 0x4e, 0xa7, 0x39, 0xb0, 0x6d, 0xad, 0x20, 0xd7,
+	0x44, 0x98, 0xaf, 0xf1, 0x29, 0x3b, 0x76, 0x4f, 0x2b, 0xca, 0x35, 0x12, 0x71, 0x7b, 0xcb, 0x74,
+	0x5a, 0xc4, 0xd6, 0xe6, 0xa5, 0x5d, 0x22, 0xdd, 0x81, 0xc5, 0xb8, 0x38, 0x7e, 0xdf, 0x75, 0x7c,
+	0x82, 0x76, 0x26, 0xaa, 0xb3, 0x9a, 0xa8, 0x8e, 0xa4, 0x4c, 0x94, 0x67, 0x0b, 0xb2, 0x1e, 0xf3,
+	0xdc, 0xde, 0xa6, 0xd1, 0x1a, 0x2c, 0x38, 0xfa, 0xc7, 0xa8, 0x51, 0xe3, 0xed, 0x12, 0xda, 0x28,
+	0x69, 0x6d, 0x10, 0x64, 0x5b, 0x6e, 0x9b, 0x88, 0x9e, 0xcc, 0x61, 0xf1, 0xce, 0x1b, 0xd2, 0x6f,
+	0xb9, 0x6c, 0x72, 0xf2, 0xc2, 0x28, 0x01, 0x2b, 0x6d, 0x9e, 0xf0, 0xc9, 0xf1, 0xd9, 0xe9, 0x54,
+	0x96, 0xc3, 0x42, 0x7a, 0xa0, 0x70, 0xe8, 0xe5, 0xca, 0xc9, 0x73, 0x93, 0xb6, 0x06, 0x42, 0x87,
+	0x18, 0xeb, 0x3e, 0x2c, 0xd7, 0xfd, 0x83, 0x40, 0x24, 0xd7, 0x1c, 0xd0, 0x59, 0x7b, 0x75, 0x3b,
+	0xd9, 0xab, 0xb5, 0x38, 0x8f, 0xa9, 0xc0, 0xb2, 0x55, 0x07, 0x50, 0x4d, 0x6f, 0x3a, 0x6b, 0x0d,
+	0xb6, 0x53, 0x35, 0xd0, 0x26, 0xf7, 0x9d, 0xa8, 0xc2, 0x33, 0x58, 0x9a, 0x3e, 0xe9, 0x1d, 0xe7,
+	0x43, 0x1f, 0xc1, 0x4a, 0x9c, 0x73, 0x9d, 0x49, 0x37, 0x9e, 0xb0, 0x7f, 0xd5, 0x6a, 0x27, 0xa9,
+	0xd5, 0xc3, 0xc9, 0x9c, 0x53, 0xb1, 0xa5, 0x5c, 0x43, 0x58, 0x9d, 0xda, 0xfa, 0xff, 0x28, 0x76,
+	0x06, 0xd5, 0x5b, 0x8f, 0x7c, 0xd7, 0x4b, 0x65, 0x3c, 0xcb, 0x99, 0xe4, 0x2c, 0xeb, 0x1b, 0xb0,
+	0x38, 0xb1, 0x61, 0xdc, 0xf6, 0xca, 0xb8, 0xed, 0xf5, 0x2f, 0x0a, 0x68, 0xf1, 0xc9, 0x5f, 0x11,
+	0xfa, 0x76, 0x60, 0x53, 0x6b, 0x56, 0xd9, 0xef, 0xf8, 0x51, 0x49, 0xe4, 0xac, 0xa6, 0xee, 0x1f,
+	0x36, 0x83, 0xb6, 0xd5, 0xb3, 0xa8, 0xb8, 0xcb, 0xca, 0x58, 0x02, 0xfd, 0x83, 0x02, 0xf7, 0x6f,
+	0x49, 0x71, 0xd6, 0xf2, 0x44, 0x2a, 0x64, 0x12, 0xc3, 0xbf, 0xc9, 0xbe, 0x5c, 0x81, 0xbc, 0x71,
+	0xff, 0x9c, 0x39, 0xa7, 0x6c, 0xad, 0xc3, 0x7c, 0xfc, 0x29, 0x45, 0x05, 0x50, 0x9b, 0xef, 0x4e,
+	0x2b, 0x73, 0x08, 0x20, 0x5f, 0x6f, 0x1c, 0x36, 0x4e, 0x1b, 0x15, 0x65, 0xeb, 0x29, 0xc0, 0x09,
+	0xbf, 0x3b, 0xe4, 0xd7, 0x72, 0x09, 0xca, 0xb8, 0x71, 0xd2, 0x3c, 0x3e, 0x3a, 0x69, 0xbc, 0x6f,
+	0xee, 0x63, 0x4e, 0xae, 0x40, 0x29, 0x36, 0xed, 0x1f, 0x1e, 0xb2, 0x25, 0x1b, 0x00, 0xe3, 0xcb,
+	0x1d, 0xcd, 0x43, 0xee, 0xe8, 0x58, 0xc6, 0x2d, 0x41, 0xf1, 0xe8, 0x38, 0x8a, 0xfc, 0x7c, 0xef,
+	0xdb, 0xcf, 0x35, 0xe5, 0x3b, 0x7b, 0x7e, 0xb0, 0xe7, 0xd3, 0xaf, 0xb5, 0x39, 0x78, 0xd4, 0x72,
+	0x7b, 0x06, 0xb5, 0x3a, 0x86, 0x7f, 0x65, 0x7a, 0x5d, 0x83, 0xa1, 0x9e, 0xeb, 0x18, 0x0e, 0xa1,
+	0x37, 0x2e, 0x83, 0x1d, 0xa6, 0xc3, 0x45, 0x5e, 0xfc, 0x41, 0xd8, 0xfb, 0x0d, 0x4e, 0x1d, 0xd9,
+	0x1f, 0x5f, 0x08, 0x00, 0x00,
 }